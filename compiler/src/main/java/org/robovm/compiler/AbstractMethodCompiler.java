@@ -34,6 +34,7 @@ import org.robovm.compiler.llvm.Label;
 import org.robovm.compiler.llvm.Ret;
 import org.robovm.compiler.llvm.Unreachable;
 import org.robovm.compiler.llvm.Value;
+import org.robovm.compiler.profile.Profile;
 import org.robovm.compiler.trampoline.Trampoline;
 
 import soot.SootClass;
@@ -90,8 +91,22 @@ public abstract class AbstractMethodCompiler {
          * tree shaking. So in OSX/iOS x86 builds we make method functions
          * strong and we behave as if tree shaking was disabled.
          */
-        return FunctionBuilder.method(method,
-                !(config.getOs().getFamily() == Family.darwin && config.getArch() == Arch.x86));
+        boolean weak = !(config.getOs().getFamily() == Family.darwin && config.getArch() == Arch.x86);
+        Profile profile = config.getProfile();
+        // Only methods compiled from bytecode have been profiled
+        if (profile != null && !profile.isEmpty() && !method.isNative()) {
+            String owner = getInternalName(method.getDeclaringClass());
+            String desc = getDescriptor(method);
+            if (profile.isHot(owner, method.getName(), desc)) {
+                return FunctionBuilder.hotMethod(method, weak, 
+                        config.getOs().getFamily() == Family.darwin 
+                            ? "__TEXT,__text_hot,regular,pure_instructions" : ".text.hot");
+            }
+            if (profile.getCount(owner, method.getName(), desc) == 0) {
+                return FunctionBuilder.coldMethod(method, weak);
+            }
+        }
+        return FunctionBuilder.method(method, weak);
     }
 
     private void compileSynchronizedWrapper(ModuleBuilder moduleBuilder, SootMethod method) {
@@ -53,6 +53,7 @@ import org.robovm.compiler.clazz.Clazzes;
 import org.robovm.compiler.clazz.Path;
 import org.robovm.compiler.config.Arch;
 import org.robovm.compiler.config.Config;
+import org.robovm.compiler.config.Config.ProfileInstrumentation;
 import org.robovm.compiler.config.Config.TreeShakerMode;
 import org.robovm.compiler.config.OS;
 import org.robovm.compiler.config.Resource;
@@ -304,7 +305,10 @@ public class AppCompiler {
             Clazz clazz, Set<Clazz> compileQueue, Set<Clazz> compiled) throws IOException {
 
         boolean result = false;
-        if (config.isClean() || classCompiler.mustCompile(clazz)) {
+        if (config.isClean()) {
+            classCompiler.compile(clazz, executor, listener);
+            result = true;
+        } else if (classCompiler.mustCompile(clazz) && !classCompiler.restoreFromObjectCache(clazz)) {
             classCompiler.compile(clazz, executor, listener);
             result = true;
         }
@@ -441,6 +445,11 @@ public class AppCompiler {
 
         long duration = System.currentTimeMillis() - start;
         config.getLogger().info("Compiled %d classes in %.2f seconds", compiledCount, duration / 1000.0);
+        ObjectCache objectCache = classCompiler.getObjectCache();
+        if (objectCache != null) {
+            config.getLogger().info("Object cache %s: %d hits, %d misses, %d classes added",
+                    objectCache.getDir(), objectCache.getHits(), objectCache.getMisses(), objectCache.getStores());
+        }
 
         return linkClasses;
     }
@@ -500,6 +509,8 @@ public class AppCompiler {
                     builder.installDir(new File(args[++i]));
                 } else if ("-cache".equals(args[i])) {
                     builder.cacheDir(new File(args[++i]));
+                } else if ("-shared-cache".equals(args[i])) {
+                    builder.sharedCacheDir(new File(args[++i]));
                 } else if ("-home".equals(args[i])) {
                     builder.home(new Config.Home(new File(args[++i])));
                 } else if ("-tmp".equals(args[i])) {
@@ -539,6 +550,25 @@ public class AppCompiler {
                     builder.useDebugLibs(true);
                 } else if ("-dump-intermediates".equals(args[i])) {
                     builder.dumpIntermediates(true);
+                } else if ("-profile-instrument".equals(args[i])) {
+                    String s = args[++i];
+                    builder.profileInstrumentation(ProfileInstrumentation.valueOf(s));
+                } else if ("-profile-use".equals(args[i])) {
+                    builder.profileInput(new File(args[++i]));
+                } else if ("-disable-zero-cost-exceptions".equals(args[i])) {
+                    builder.zeroCostExceptions(false);
+                } else if ("-whole-program".equals(args[i])) {
+                    builder.wholeProgramOptimization(true);
+                } else if ("-disable-escape-analysis".equals(args[i])) {
+                    builder.escapeAnalysis(false);
+                } else if ("-vectorize-loops".equals(args[i])) {
+                    builder.vectorizeLoops(true);
+                } else if ("-incremental-link".equals(args[i])) {
+                    builder.incrementalLinking(true);
+                } else if ("-function-order".equals(args[i])) {
+                    builder.functionOrderFile(new File(args[++i]));
+                } else if ("-order-functions".equals(args[i])) {
+                    builder.orderFunctions(true);
                 } else if ("-dynamic-jni".equals(args[i])) {
                     // TODO: Old option not used any longer. We still accept it
                     // for now. Delete it in a future release.
@@ -885,6 +915,10 @@ public class AppCompiler {
                          + "                        archives to search for class files.");
         System.err.println("  -cache <dir>          Directory where cached compiled class files will be placed.\n" 
                          + "                        Default is ~/.robovm/cache");
+        System.err.println("  -shared-cache <dir>   Directory of an object cache which can be shared between\n"
+                         + "                        builds, checkouts and machines. Compiled classes are looked\n"
+                         + "                        up by the hashes of their contents and dependencies before\n"
+                         + "                        compiling them.");
         System.err.println("  -clean                Compile class files even if a compiled version already \n" 
                          + "                        exists in the cache.");
         System.err.println("  -d <dir>              Install the generated executable and other files in <dir>.\n" 
@@ -940,6 +974,43 @@ public class AppCompiler {
                          + "                        install dir specified using -d.");
         System.err.println("  -debug                Generates debug information");
         System.err.println("  -use-debug-libs       Links against debug versions of the RoboVM VM libraries");
+        System.err.println("  -profile-instrument <mode>\n"
+                         + "                        Instruments all compiled methods for profiling. Allowed values\n"
+                         + "                        are 'none', 'counts' (method entry counts) and 'timings' (entry\n"
+                         + "                        counts and CPU cycles). Run the app with\n"
+                         + "                        -rvm:ProfileFile=<file> to write a hot method report on exit.");
+        System.err.println("  -profile-use <file>   Uses a report written by an app compiled with\n"
+                         + "                        -profile-instrument to guide optimizations: branch weights,\n"
+                         + "                        hot/cold methods and guarded direct calls at virtual call\n"
+                         + "                        sites dominated by a single receiver class.");
+        System.err.println("  -disable-zero-cost-exceptions\n"
+                         + "                        Compiles try/catch blocks using the register saving trycatch\n"
+                         + "                        mechanism instead of unwind tables on Linux x86_64.");
+        System.err.println("  -whole-program        Optimizes all classes as a single LLVM module when linking.\n"
+                         + "                        Allows methods to be inlined across classes at the cost of\n"
+                         + "                        a slower, single threaded link step. Ignored with -debug.");
+        System.err.println("  -disable-escape-analysis\n"
+                         + "                        Allocates all objects on the heap. By default objects and\n"
+                         + "                        small arrays which never leave the method creating them are\n"
+                         + "                        allocated on the stack in non-debug builds.");
+        System.err.println("  -vectorize-loops      Duplicates loops over arrays guarded by a runtime check so\n"
+                         + "                        that array accesses need no checks and runs the LLVM loop\n"
+                         + "                        and SLP vectorizers. Slower builds and larger executables.\n"
+                         + "                        Ignored with -debug.");
+        System.err.println("  -incremental-link     Links the compiled classes into cached groups of object\n"
+                         + "                        files and only relinks the groups containing changed\n"
+                         + "                        classes. Speeds up linking when only a few classes have\n"
+                         + "                        changed. Ignored with -whole-program.");
+        System.err.println("  -function-order <file>\n"
+                         + "                        Places the methods listed in <file> first in the\n"
+                         + "                        executable, in order, to reduce the number of pages\n"
+                         + "                        touched at startup. Each line is either a symbol or a\n"
+                         + "                        method on the form owner.name(desc), e.g.\n"
+                         + "                        com.example.Main.main([Ljava/lang/String;)V.");
+        System.err.println("  -order-functions      Places the methods most likely to run at startup first in\n"
+                         + "                        the executable. Uses the -profile-use report if given.\n"
+                         + "                        Otherwise the main class initializer, main method and\n"
+                         + "                        their callees are placed first.");
         System.err.println("  -libs <list>          : separated list of static library files (.a), object\n"
                          + "                        files (.o) and system libraries that should be included\n" 
                          + "                        when linking the final executable.");
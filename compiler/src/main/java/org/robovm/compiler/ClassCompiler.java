@@ -32,6 +32,8 @@ import java.io.InputStreamReader;
 import java.io.OutputStream;
 import java.io.OutputStreamWriter;
 import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collection;
 import java.util.Collections;
 import java.util.Comparator;
 import java.util.HashMap;
@@ -63,7 +65,10 @@ import org.robovm.compiler.llvm.Bitcast;
 import org.robovm.compiler.llvm.Br;
 import org.robovm.compiler.llvm.Constant;
 import org.robovm.compiler.llvm.ConstantBitcast;
+import org.robovm.compiler.llvm.ConstantPtrtoint;
 import org.robovm.compiler.llvm.Fence;
+import org.robovm.compiler.llvm.FloatingPointConstant;
+import org.robovm.compiler.llvm.FloatingPointType;
 import org.robovm.compiler.llvm.Function;
 import org.robovm.compiler.llvm.FunctionDeclaration;
 import org.robovm.compiler.llvm.FunctionRef;
@@ -72,18 +77,23 @@ import org.robovm.compiler.llvm.Global;
 import org.robovm.compiler.llvm.GlobalRef;
 import org.robovm.compiler.llvm.Icmp;
 import org.robovm.compiler.llvm.IntegerConstant;
+import org.robovm.compiler.llvm.IntegerType;
+import org.robovm.compiler.llvm.Inttoptr;
 import org.robovm.compiler.llvm.Label;
 import org.robovm.compiler.llvm.Linkage;
 import org.robovm.compiler.llvm.Load;
 import org.robovm.compiler.llvm.NullConstant;
 import org.robovm.compiler.llvm.Ordering;
+import org.robovm.compiler.llvm.PackedStructureConstant;
 import org.robovm.compiler.llvm.PackedStructureConstantBuilder;
+import org.robovm.compiler.llvm.PackedStructureType;
 import org.robovm.compiler.llvm.PointerType;
 import org.robovm.compiler.llvm.Ret;
 import org.robovm.compiler.llvm.Store;
 import org.robovm.compiler.llvm.StructureConstant;
 import org.robovm.compiler.llvm.StructureConstantBuilder;
 import org.robovm.compiler.llvm.StructureType;
+import org.robovm.compiler.llvm.Type;
 import org.robovm.compiler.llvm.Value;
 import org.robovm.compiler.llvm.Variable;
 import org.robovm.compiler.llvm.VariableRef;
@@ -123,11 +133,24 @@ import soot.ShortType;
 import soot.SootClass;
 import soot.SootField;
 import soot.SootMethod;
+import soot.Unit;
 import soot.VoidType;
+import soot.jimple.AssignStmt;
+import soot.jimple.DoubleConstant;
+import soot.jimple.FloatConstant;
+import soot.jimple.IntConstant;
 import soot.jimple.Jimple;
 import soot.jimple.JimpleBody;
+import soot.jimple.LongConstant;
+import soot.jimple.NopStmt;
+import soot.jimple.ReturnVoidStmt;
+import soot.jimple.StaticFieldRef;
 import soot.jimple.internal.JReturnVoidStmt;
 import soot.tagkit.ConstantValueTag;
+import soot.tagkit.DoubleConstantValueTag;
+import soot.tagkit.FloatConstantValueTag;
+import soot.tagkit.IntegerConstantValueTag;
+import soot.tagkit.LongConstantValueTag;
 import soot.tagkit.Tag;
 
 /**
@@ -147,6 +170,7 @@ public class ClassCompiler {
     public static final int CI_ERROR = 0x100;
     public static final int CI_INITIALIZED = 0x200;
     public static final int CI_FINALIZABLE = 0x400;
+    public static final int CI_PREINITIALIZED = 0x800;
 
     public static final int CI_ERROR_TYPE_NONE = 0x0;
     public static final int CI_ERROR_TYPE_NO_CLASS_DEF_FOUND = 0x1;
@@ -219,6 +243,7 @@ public class ClassCompiler {
     private final GlobalValueMethodCompiler globalValueMethodCompiler;
     private final AttributesEncoder attributesEncoder;
     private final TrampolineCompiler trampolineResolver;
+    private final ObjectCache objectCache;
     
     private final ByteArrayOutputStream output = new ByteArrayOutputStream(256 * 1024);
     
@@ -232,6 +257,16 @@ public class ClassCompiler {
         this.globalValueMethodCompiler = new GlobalValueMethodCompiler(config);
         this.attributesEncoder = new AttributesEncoder();
         this.trampolineResolver = new TrampolineCompiler(config);
+        this.objectCache = config.getSharedCacheDir() != null
+                ? new ObjectCache(config, config.getSharedCacheDir()) : null;
+    }
+    
+    /**
+     * Returns the {@link ObjectCache} shared between builds or {@code null}
+     * if {@link Config#getSharedCacheDir()} hasn't been set.
+     */
+    public ObjectCache getObjectCache() {
+        return objectCache;
     }
     
     public boolean mustCompile(Clazz clazz) {
@@ -239,6 +274,10 @@ public class ClassCompiler {
         if (!oFile.exists() || oFile.lastModified() < clazz.lastModified() || oFile.length() == 0) {
             return true;
         }
+        if (config.isWholeProgramOptimization() && !config.getBcFile(clazz).exists()) {
+            // The Linker needs the bitcode of every class
+            return true;
+        }
         
         ClazzInfo ci = clazz.getClazzInfo();
         if (ci == null) {
@@ -280,6 +319,35 @@ public class ClassCompiler {
         return dependencies.isEmpty();
     }
     
+    /**
+     * Restores the compiled files of the specified class from the
+     * {@link ObjectCache} if it has been compiled before with the same
+     * dependencies and options, possibly by another build. Should only be
+     * called if {@link #mustCompile(Clazz)} returns {@code true}.
+     * 
+     * @return {@code true} if the class was restored, {@code false} if it
+     *         must be compiled.
+     */
+    public boolean restoreFromObjectCache(Clazz clazz) throws IOException {
+        if (objectCache == null) {
+            return false;
+        }
+        try {
+            if (!objectCache.restore(clazz)) {
+                return false;
+            }
+        } catch (IOException e) {
+            config.getLogger().warn("Failed to restore %s from the object cache: %s", clazz, e.getMessage());
+            return false;
+        }
+        config.getLogger().debug("Restored %s from the object cache", clazz);
+        File oFile = config.getOFile(clazz);
+        for (CompilerPlugin plugin : config.getCompilerPlugins()) {
+            plugin.afterObjectFile(config, clazz, oFile);
+        }
+        return true;
+    }
+
     public void compile(Clazz clazz, Executor executor, ClassCompilerListener listener) throws IOException {
         reset();        
         
@@ -304,17 +372,25 @@ public class ClassCompiler {
         cCode.addAll(bridgeMethodCompiler.getCWrapperFunctions());
         cCode.addAll(callbackMethodCompiler.getCWrapperFunctions());
         
-        scheduleMachineCodeGeneration(executor, listener, config, clazz, output.toByteArray(), cCode);
+        scheduleMachineCodeGeneration(executor, listener, config, objectCache, clazz, output.toByteArray(), cCode);
     }
 
     private static void scheduleMachineCodeGeneration(Executor executor, final ClassCompilerListener listener,
-            final Config config, final Clazz clazz, final byte[] llData, final List<String> cCode) {
+            final Config config, final ObjectCache objectCache, final Clazz clazz, final byte[] llData,
+            final List<String> cCode) {
         
         Runnable task = new Runnable() {
             @Override
             public void run() {
                 try {
                     generateMachineCode(config, clazz, llData, cCode);
+                    if (objectCache != null) {
+                        try {
+                            objectCache.store(clazz);
+                        } catch (IOException e) {
+                            config.getLogger().warn("Failed to add %s to the object cache: %s", clazz, e.getMessage());
+                        }
+                    }
                     listener.success(clazz);
                 } catch (Throwable t) {
                     listener.failure(clazz, t);
@@ -377,11 +453,13 @@ public class ClassCompiler {
                     }
                 }
                 
+                prepareForUnwinding(config, module);
+
                 try (PassManager passManager = createPassManager(config)) {
                     passManager.run(module);
                 }
 
-                if (config.isDumpIntermediates()) {
+                if (config.isDumpIntermediates() || config.isWholeProgramOptimization()) {
                     File bcFile = config.getBcFile(clazz);
                     bcFile.getParentFile().mkdirs();
                     module.writeBitcode(bcFile);
@@ -556,6 +634,24 @@ public class ClassCompiler {
         }
     }
 
+    /**
+     * {@link FunctionBuilder} marks all functions {@code nounwind}. With
+     * zero-cost exceptions that isn't true any longer and the unwinder must
+     * be able to step through every compiled frame so this replaces
+     * {@code nounwind} with {@code uwtable} on all functions in the module.
+     */
+    static void prepareForUnwinding(Config config, Module module) {
+        if (!config.isZeroCostExceptions()) {
+            return;
+        }
+        for (org.robovm.llvm.Function f : module.getFunctions()) {
+            if (!f.getName().startsWith("llvm.")) {
+                f.removeAttribute(Attribute.NoUnwindAttribute);
+                f.addAttribute(Attribute.UWTable);
+            }
+        }
+    }
+
     private static PassManager createPassManager(Config config) {
         PassManager passManager = new PassManager();
         
@@ -569,6 +665,15 @@ public class ClassCompiler {
                 builder.useAlwaysInliner(true);
                 builder.populateModulePassManager(passManager);
             }
+            if (config.isVectorizeLoops()) {
+                // The builder doesn't add the vectorizers unless told to by
+                // command line options. Loops over arrays can be vectorized
+                // once RangeAnalysis has removed the checks from them.
+                passManager.addLoopVectorizePass();
+                passManager.addSLPVectorizePass();
+                passManager.addInstructionCombiningPass();
+                passManager.addCFGSimplificationPass();
+            }
         }
         
         return passManager;
@@ -576,7 +681,6 @@ public class ClassCompiler {
     
     private static void patchAsmWithFunctionSizes(Config config, Clazz clazz, InputStream inStream, OutputStream outStream) throws IOException {
         String labelPrefix = config.getOs().getFamily() == OS.Family.darwin ? "_" : "";
-        String localLabelPrefix = config.getOs().getFamily() == OS.Family.darwin ? "L" : ".L";
         
         Set<String> functionNames = new HashSet<String>();
         for (SootMethod method : clazz.getSootClass().getMethods()) {
@@ -590,7 +694,46 @@ public class ClassCompiler {
         Pattern methodImplPattern = Pattern.compile("\\s*\\.(?:quad|long)\\s+\"?(" 
                 + Pattern.quote(labelPrefix + Symbols.methodSymbolPrefix(clazz.getInternalName())) 
                 + "[^\\s\"]+)\"?.*");
+
+        patchAsmWithFunctionSizes(config, functionNames, Collections.singleton(infoStructLabel), 
+                methodImplPattern, inStream, outStream);
+    }
+
+    /**
+     * Patches the sizes of the specified functions into the info structs of
+     * an assembly file which may contain the code of several classes. This
+     * is used by the {@link Linker} when compiling all classes as a single
+     * module. Functions which haven't been emitted as code in the assembly
+     * file (e.g. methods replaced by stripped method stubs) get size 0.
+     */
+    static void patchAsmWithFunctionSizes(Config config, Collection<Clazz> classes, InputStream inStream, OutputStream outStream) throws IOException {
+        String labelPrefix = config.getOs().getFamily() == OS.Family.darwin ? "_" : "";
+
+        Set<String> functionNames = new HashSet<String>();
+        Set<String> infoStructLabels = new HashSet<String>();
+        for (Clazz clazz : classes) {
+            ClazzInfo ci = clazz.getClazzInfo();
+            for (MethodInfo mi : ci.getMethods()) {
+                if (!mi.isAbstract()) {
+                    functionNames.add(labelPrefix + Symbols.methodSymbol(clazz.getInternalName(), mi.getName(), mi.getDesc()));
+                }
+            }
+            infoStructLabels.add(labelPrefix + Symbols.infoStructSymbol(clazz.getInternalName()));
+        }
+
+        Pattern methodImplPattern = Pattern.compile("\\s*\\.(?:quad|long)\\s+\"?(" 
+                + Pattern.quote(labelPrefix + Symbols.EXTERNAL_SYMBOL_PREFIX) 
+                + "[^\\s\"]+)\"?.*");
+
+        patchAsmWithFunctionSizes(config, functionNames, infoStructLabels, methodImplPattern, inStream, outStream);
+    }
+
+    private static void patchAsmWithFunctionSizes(Config config, Set<String> functionNames, Set<String> infoStructLabels,
+            Pattern methodImplPattern, InputStream inStream, OutputStream outStream) throws IOException {
+
+        String localLabelPrefix = config.getOs().getFamily() == OS.Family.darwin ? "L" : ".L";
         
+        Set<String> emittedFunctions = new HashSet<String>();
         BufferedReader in = null;
         BufferedWriter out = null;
         try {
@@ -610,7 +753,7 @@ public class ClassCompiler {
                         }
                         if (functionNames.contains(label)) {
                             currentFunction = label;
-                        } else if (label.equals(infoStructLabel)) {
+                        } else if (infoStructLabels.contains(label)) {
                             break;
                         }
                     }
@@ -619,6 +762,7 @@ public class ClassCompiler {
                     out.write(localLabelPrefix);
                     out.write(currentFunction);
                     out.write("_end\":\n\n");
+                    emittedFunctions.add(currentFunction);
                     currentFunction = null;
                     out.write(line);
                     out.write('\n');
@@ -638,7 +782,11 @@ public class ClassCompiler {
                         line = in.readLine();
                         if (line.contains(String.valueOf(DUMMY_METHOD_SIZE))) {
                             out.write("\t.long\t");
-                            out.write("\"" + localLabelPrefix + functionName + "_end\" - \"" + functionName + "\"");
+                            if (emittedFunctions.contains(functionName)) {
+                                out.write("\"" + localLabelPrefix + functionName + "_end\" - \"" + functionName + "\"");
+                            } else {
+                                out.write("0");
+                            }
                             out.write('\n');
                         } else {
                             out.write(line);
@@ -999,6 +1147,16 @@ public class ClassCompiler {
     private void createLookupFunction(SootMethod m) {
         Function function = FunctionBuilder.lookup(m, true);
         mb.addFunction(function);
+        if (sootClass.isInterface()) {
+            // The Linker may replace the lookup function with one which calls
+            // the implementations directly. It falls back to the dispatch
+            // function for other receivers.
+            Function dispatch = FunctionBuilder.dispatch(m);
+            mb.addFunction(dispatch);
+            Value result = tailcall(function, dispatch.ref(), function.getParameterRefs());
+            function.add(new Ret(result));
+            function = dispatch;
+        }
 
         Variable reserved0 = function.newVariable(I8_PTR_PTR);
         function.add(new Getelementptr(reserved0, function.getParameterRef(0), 0, 4));
@@ -1136,6 +1294,10 @@ public class ClassCompiler {
         if (hasFinalizer(sootClass)) {
             flags |= CI_FINALIZABLE;
         }
+        StructureConstant preinitializedClassData = createPreinitializedClassData();
+        if (preinitializedClassData != null) {
+            flags |= CI_PREINITIALIZED;
+        }
         
         // Create the ClassInfoHeader structure.
         StructureConstantBuilder header = new StructureConstantBuilder();
@@ -1181,6 +1343,19 @@ public class ClassCompiler {
             body.add(new ConstantBitcast(attributesEncoder.getClassAttributes().ref(), I8_PTR));
         }
         
+        if (preinitializedClassData != null) {
+            // The runtime copies exactly this many bytes from the constant 
+            // data into the class. The class data size in the header also 
+            // includes the Class struct and any trailing padding.
+            if (classFields.isEmpty()) {
+                body.add(new NullConstant(I8_PTR));
+                body.add(new IntegerConstant(0));
+            } else {
+                body.add(new ConstantBitcast(mb.newGlobal(preinitializedClassData, true).ref(), I8_PTR));
+                body.add(sizeof((StructureType) classType.getTypeAt(1)));
+            }
+        }
+        
         for (SootClass s : sootClass.getInterfaces()) {
             body.add(getString(getInternalName(s)));
         }
@@ -1432,11 +1607,42 @@ public class ClassCompiler {
     private Function createAllocator() {
         Function fn = FunctionBuilder.allocator(sootClass);
         Value info = getInfoStruct(fn, sootClass);        
-        Value result = call(fn, BC_ALLOCATE, fn.getParameterRef(0), info);
+        Value result;
+        if (canAllocateFromFreeList(sootClass)) {
+            result = call(fn, ALLOC_OBJECT, fn.getParameterRef(0), info, sizeof(instanceType));
+        } else {
+            result = call(fn, BC_ALLOCATE, fn.getParameterRef(0), info);
+        }
         fn.add(new Ret(result));
         return fn;
     }
 
+    /**
+     * Returns whether instances of the specified class may be popped inline
+     * from the per-thread free lists. Objects on those lists are scanned 
+     * conservatively by the GC. Classes which the runtime marks with a 
+     * special mark procedure (finalizable classes, references, throwables,
+     * structs and memory blocks) must go through <code>_bcAllocate()</code>.
+     * So must abstract classes and interfaces which cannot be instantiated.
+     */
+    private static boolean canAllocateFromFreeList(SootClass sootClass) {
+        if (sootClass.isAbstract() || sootClass.isInterface()) {
+            return false;
+        }
+        for (SootClass c = sootClass; c.hasSuperclass(); c = c.getSuperclass()) {
+            if (hasFinalizer(c)) {
+                return false;
+            }
+            String name = c.getName();
+            if (name.equals("java.lang.Class") || name.equals("java.lang.ref.Reference")
+                    || name.equals("java.lang.Throwable") || name.equals("org.robovm.rt.bro.Struct")
+                    || name.equals("java.nio.MemoryBlock")) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     private Function createLdcClass() {
         Function fn = FunctionBuilder.ldcInternal(sootClass);
         Value info = getInfoStruct(fn, sootClass);
@@ -1517,28 +1723,64 @@ public class ClassCompiler {
         return fn;
     }
     
+    /**
+     * Creates the function which ensures the current class has been 
+     * initialized before calling <code>targetFn</code>. The wrapper calls
+     * through a per target slot which initially points at a slow path. The
+     * slow path checks the {@link #CI_INITIALIZED} flag, initializes the class
+     * if needed and, once the flag has been set, publishes 
+     * <code>targetFn</code> in the slot. From then on the wrapper jumps 
+     * straight to the target without loading the class flags.
+     * <p>
+     * The slot is accessed as a pointer sized integer using acquire/release
+     * ordering so that a thread which sees the published target also sees 
+     * the static data written by <code>&lt;clinit&gt;</code>.
+     */
     private Function createClassInitWrapperFunction(FunctionRef targetFn) {
+        IntegerType slotType = config.getArch().is32Bit() ? I32 : I64;
+        GlobalRef slotRef = new GlobalRef(Symbols.clinitSlotSymbol(targetFn.getName()), slotType);
+        Function slowPath = createClassInitSlowPathFunction(targetFn, slotRef, slotType);
+        mb.addFunction(slowPath);
+        mb.addGlobal(new Global(slotRef.getName(), Linkage._private, 
+                new ConstantPtrtoint(slowPath.ref(), slotType)));
+        
         Function fn = FunctionBuilder.clinitWrapper(targetFn);
+        Variable slot = fn.newVariable(slotType);
+        fn.add(new Load(slot, slotRef, false, Ordering.acquire, slotType.getBits() / 8));
+        Variable target = fn.newVariable(targetFn.getType());
+        fn.add(new Inttoptr(target, slot.ref(), targetFn.getType()));
+        Value result = tailcall(fn, target.ref(), fn.getParameterRefs());
+        fn.add(new Ret(result));
+        return fn;
+    }
+    
+    private Function createClassInitSlowPathFunction(FunctionRef targetFn, GlobalRef slotRef, IntegerType slotType) {
+        Function fn = FunctionBuilder.clinitSlowPath(targetFn);
         Value info = getInfoStruct(fn, sootClass);
+        call(fn, INITIALIZE_CLASS, fn.getParameterRef(0), info);
         Variable infoHeader = fn.newVariable(new PointerType(new StructureType(I8_PTR, I32)));
         fn.add(new Bitcast(infoHeader, info, infoHeader.getType()));
         Variable infoHeaderFlags = fn.newVariable(new PointerType(I32));
         fn.add(new Getelementptr(infoHeaderFlags, infoHeader.ref(), 0, 1));
         Variable flags = fn.newVariable(I32);
-        fn.add(new Load(flags, infoHeaderFlags.ref()));
+        fn.add(new Load(flags, infoHeaderFlags.ref(), true));
         Variable initializedFlag = fn.newVariable(I32);
         fn.add(new And(initializedFlag, flags.ref(), new IntegerConstant(CI_INITIALIZED)));
         Variable initialized = fn.newVariable(I1);
         fn.add(new Icmp(initialized, Icmp.Condition.eq, initializedFlag.ref(), new IntegerConstant(CI_INITIALIZED)));
-        Label trueLabel = new Label();
-        Label falseLabel = new Label();
-        fn.add(new Br(initialized.ref(), fn.newBasicBlockRef(trueLabel), fn.newBasicBlockRef(falseLabel)));
-        fn.newBasicBlock(trueLabel);
+        Label publishLabel = new Label();
+        Label callLabel = new Label();
+        fn.add(new Br(initialized.ref(), fn.newBasicBlockRef(publishLabel), fn.newBasicBlockRef(callLabel)));
+        // _bcInitializeClass() returns without setting CI_INITIALIZED if the 
+        // current thread is running <clinit>. Only publish the target once 
+        // <clinit> has completed.
+        fn.newBasicBlock(publishLabel);
+        fn.add(new Store(new ConstantPtrtoint(targetFn, slotType), slotRef, false, 
+                Ordering.release, slotType.getBits() / 8));
+        fn.add(new Br(fn.newBasicBlockRef(callLabel)));
+        fn.newBasicBlock(callLabel);
         Value result = call(fn, targetFn, fn.getParameterRefs());
         fn.add(new Ret(result));
-        fn.newBasicBlock(falseLabel);
-        call(fn, BC_INITIALIZE_CLASS, fn.getParameterRef(0), info);
-        fn.add(new Br(fn.newBasicBlockRef(trueLabel)));
         return fn;
     }
 
@@ -1564,6 +1806,126 @@ public class ClassCompiler {
         }
     }
     
+    /**
+     * Returns the static field values of the current class as they will be 
+     * once its <code>&lt;clinit&gt;</code> has run or <code>null</code> if the
+     * class cannot be pre-initialized at build time. A class qualifies if it
+     * directly extends <code>java.lang.Object</code> and its 
+     * <code>&lt;clinit&gt;</code> (including any <code>ConstantValue</code> 
+     * attributes) only stores primitive constants or <code>null</code> into 
+     * static fields of the class itself. Running such a 
+     * <code>&lt;clinit&gt;</code> has no observable side effects so the 
+     * runtime can copy the values into the class and mark it initialized as 
+     * soon as it has been loaded.
+     */
+    private StructureConstant createPreinitializedClassData() {
+        if (sootClass.isInterface() || !sootClass.hasSuperclass() 
+                || !sootClass.getSuperclass().getName().equals("java.lang.Object")) {
+            return null;
+        }
+        
+        Map<SootField, Constant> values = new HashMap<>();
+        for (SootField field : classFields) {
+            for (Tag tag : field.getTags()) {
+                Constant value = null;
+                if (tag instanceof DoubleConstantValueTag) {
+                    value = getStaticFieldConstant(field, ((DoubleConstantValueTag) tag).getDoubleValue());
+                } else if (tag instanceof FloatConstantValueTag) {
+                    value = getStaticFieldConstant(field, ((FloatConstantValueTag) tag).getFloatValue());
+                } else if (tag instanceof IntegerConstantValueTag) {
+                    value = getStaticFieldConstant(field, ((IntegerConstantValueTag) tag).getIntValue());
+                } else if (tag instanceof LongConstantValueTag) {
+                    value = getStaticFieldConstant(field, ((LongConstantValueTag) tag).getLongValue());
+                } else if (tag instanceof ConstantValueTag) {
+                    // String constants must be interned at runtime
+                    return null;
+                } else {
+                    continue;
+                }
+                if (value == null) {
+                    return null;
+                }
+                values.put(field, value);
+            }
+        }
+        
+        if (sootClass.declaresMethod("<clinit>", Collections.emptyList(), VoidType.v())) {
+            SootMethod clinit = sootClass.getMethod("<clinit>", Collections.emptyList(), VoidType.v());
+            for (Unit unit : clinit.retrieveActiveBody().getUnits()) {
+                if (unit instanceof ReturnVoidStmt) {
+                    break;
+                }
+                if (unit instanceof NopStmt) {
+                    continue;
+                }
+                if (!(unit instanceof AssignStmt) || !(((AssignStmt) unit).getLeftOp() instanceof StaticFieldRef)) {
+                    return null;
+                }
+                SootField field = ((StaticFieldRef) ((AssignStmt) unit).getLeftOp()).getField();
+                if (field.getDeclaringClass() != sootClass) {
+                    return null;
+                }
+                soot.Value v = ((AssignStmt) unit).getRightOp();
+                Constant value = null;
+                if (v instanceof soot.jimple.NullConstant) {
+                    value = new NullConstant(getType(field.getType()));
+                } else if (v instanceof IntConstant) {
+                    value = getStaticFieldConstant(field, ((IntConstant) v).value);
+                } else if (v instanceof LongConstant) {
+                    value = getStaticFieldConstant(field, ((LongConstant) v).value);
+                } else if (v instanceof FloatConstant) {
+                    value = getStaticFieldConstant(field, ((FloatConstant) v).value);
+                } else if (v instanceof DoubleConstant) {
+                    value = getStaticFieldConstant(field, ((DoubleConstant) v).value);
+                }
+                if (value == null) {
+                    return null;
+                }
+                values.put(field, value);
+            }
+        }
+        
+        StructureType dataType = (StructureType) classType.getTypeAt(1);
+        Value[] data = new Value[classFields.size()];
+        for (int i = 0; i < data.length; i++) {
+            SootField field = classFields.get(i);
+            StructureType paddedType = (StructureType) dataType.getTypeAt(i);
+            StructureType paddingType = (StructureType) paddedType.getTypeAt(0);
+            Value[] padding = new Value[paddingType.getTypeCount()];
+            Arrays.fill(padding, new IntegerConstant((byte) 0));
+            Constant value = values.get(field);
+            if (value == null) {
+                value = getStaticFieldConstant(field, 0);
+            }
+            data[i] = new PackedStructureConstant((PackedStructureType) paddedType, 
+                    new PackedStructureConstant((PackedStructureType) paddingType, padding), value);
+        }
+        return new StructureConstant(dataType, data);
+    }
+    
+    private static Constant getStaticFieldConstant(SootField field, Number value) {
+        Type type = getType(field.getType());
+        if (type instanceof IntegerType) {
+            IntegerType t = (IntegerType) type;
+            long v = value.longValue();
+            if (t.getBits() == 8) {
+                v = (byte) v;
+            } else if (t.getBits() == 16) {
+                v = (short) v;
+            } else if (t.getBits() == 32) {
+                v = (int) v;
+            }
+            return new IntegerConstant(v, t);
+        }
+        if (type instanceof FloatingPointType) {
+            return new FloatingPointConstant(value.doubleValue(), (FloatingPointType) type);
+        }
+        if (type instanceof PointerType && value.longValue() == 0) {
+            return new NullConstant(type);
+        }
+        return null;
+    }
+    
     private static boolean hasConstantValueTags(List<SootField> classFields) {
         for (SootField field : classFields) {
             for (Tag tag : field.getTags()) {
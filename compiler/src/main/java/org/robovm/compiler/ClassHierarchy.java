@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.clazz.ClazzInfo;
+import org.robovm.compiler.clazz.MethodInfo;
+
+/**
+ * Class hierarchy of the closed set of classes linked into an executable.
+ * Used by the {@link Linker} to find the methods which may be called by a
+ * virtual or interface call. Classes created at runtime (proxies) are not
+ * part of the hierarchy.
+ */
+public class ClassHierarchy {
+    /**
+     * Maps the internal name of every class and interface to the concrete
+     * classes which extend or implement it (including the class itself).
+     */
+    private final Map<String, List<ClazzInfo>> concreteSubtypes = new HashMap<>();
+
+    public ClassHierarchy(Collection<Clazz> classes) {
+        for (Clazz clazz : classes) {
+            ClazzInfo ci = clazz.getClazzInfo();
+            if (ci == null || ci.isInterface() || ci.isAbstract()) {
+                continue;
+            }
+            Set<String> supertypes = new HashSet<>();
+            if (!collectSupertypes(ci, supertypes)) {
+                // Classes with missing supertypes cannot be instantiated
+                continue;
+            }
+            for (String supertype : supertypes) {
+                List<ClazzInfo> l = concreteSubtypes.get(supertype);
+                if (l == null) {
+                    l = new ArrayList<>();
+                    concreteSubtypes.put(supertype, l);
+                }
+                l.add(ci);
+            }
+        }
+    }
+
+    private static boolean collectSupertypes(ClazzInfo ci, Set<String> result) {
+        if (ci.isPhantom()) {
+            return false;
+        }
+        if (!result.add(ci.getInternalName())) {
+            return true;
+        }
+        if (!ci.isInterface() && ci.hasSuperclass() && !collectSupertypes(ci.getSuperclass(), result)) {
+            return false;
+        }
+        for (ClazzInfo interfaze : ci.getInterfaces()) {
+            if (!collectSupertypes(interfaze, result)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Returns the concrete classes which extend or implement the specified
+     * class or interface.
+     */
+    public List<ClazzInfo> getConcreteSubtypes(ClazzInfo ci) {
+        List<ClazzInfo> l = concreteSubtypes.get(ci.getInternalName());
+        return l != null ? Collections.unmodifiableList(l) : Collections.<ClazzInfo>emptyList();
+    }
+
+    /**
+     * Returns the distinct methods called when the method {@code mi} declared
+     * by {@code owner} is invoked virtually on instances of the concrete
+     * classes which extend or implement {@code owner}, keyed by the class
+     * declaring each method. Returns {@code null} if the implementations
+     * cannot be determined statically, e.g. if any of the classes doesn't
+     * implement the method or if package private methods are involved, or
+     * if there are more than {@code max} implementations.
+     */
+    public Map<ClazzInfo, MethodInfo> findImplementations(ClazzInfo owner, MethodInfo mi, int max) {
+        boolean packagePrivate = !mi.isPublic() && !mi.isProtected();
+        Map<ClazzInfo, MethodInfo> result = new LinkedHashMap<>();
+        for (ClazzInfo receiver : getConcreteSubtypes(owner)) {
+            ClazzInfo implClass = null;
+            MethodInfo impl = null;
+            ClazzInfo c = receiver;
+            while (c != null && !c.isPhantom()) {
+                MethodInfo m = c.getMethod(mi.getName(), mi.getDesc());
+                // Private methods never override
+                if (m != null && !m.isPrivate()) {
+                    implClass = c;
+                    impl = m;
+                    break;
+                }
+                c = c.hasSuperclass() ? c.getSuperclass() : null;
+            }
+            if (impl == null || impl.isStatic() || impl.isAbstract()) {
+                // IncompatibleClassChangeError or AbstractMethodError
+                return null;
+            }
+            if (packagePrivate ? !implClass.getInternalName().equals(owner.getInternalName())
+                    : !impl.isPublic() && !impl.isProtected()) {
+                // Whether a package private method overrides depends on
+                // the packages of the classes. Leave it to the vtable.
+                return null;
+            }
+            result.put(implClass, impl);
+            if (result.size() > max) {
+                return null;
+            }
+        }
+        return result;
+    }
+}
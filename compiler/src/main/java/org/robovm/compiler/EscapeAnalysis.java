@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import static org.robovm.compiler.Types.*;
+
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.Map;
+
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.config.Config;
+
+import soot.Body;
+import soot.Local;
+import soot.PrimType;
+import soot.RefType;
+import soot.SootClass;
+import soot.SootField;
+import soot.SootMethod;
+import soot.Unit;
+import soot.Value;
+import soot.ValueBox;
+import soot.VoidType;
+import soot.jimple.ArrayRef;
+import soot.jimple.AssignStmt;
+import soot.jimple.DefinitionStmt;
+import soot.jimple.InstanceFieldRef;
+import soot.jimple.InstanceInvokeExpr;
+import soot.jimple.IntConstant;
+import soot.jimple.InvokeExpr;
+import soot.jimple.InvokeStmt;
+import soot.jimple.LengthExpr;
+import soot.jimple.NewArrayExpr;
+import soot.jimple.NewExpr;
+import soot.jimple.SpecialInvokeExpr;
+
+/**
+ * Finds the objects and small primitive arrays allocated by a method which
+ * never leave it and can be allocated on the stack of the method instead of
+ * the heap. The analysis is intentionally simple: the local the new
+ * object is assigned to must be assigned only once and may only be used to
+ * read and write fields or array elements and as receiver of calls to
+ * methods which do the same with {@code this}. Any other use, e.g. storing
+ * it in a field, passing it as an argument, returning it or synchronizing on
+ * it, makes the object escape.
+ * <p>
+ * A stack allocated object is indistinguishable from a heap allocated one
+ * to the code using it: it has the same layout and its class pointer is set
+ * so virtual calls work as usual. The memory is reused every time the
+ * allocation is executed which is safe since the previous object can't be
+ * reachable once its only local has been overwritten.
+ */
+public class EscapeAnalysis {
+    /**
+     * Maximum length of arrays allocated on the stack.
+     */
+    public static final int MAX_ARRAY_LENGTH = 32;
+    /**
+     * Maximum number of instance fields (including inherited ones) of
+     * objects allocated on the stack.
+     */
+    private static final int MAX_INSTANCE_FIELDS = 16;
+    /**
+     * Maximum number of stack allocations per method.
+     */
+    private static final int MAX_ALLOCATIONS = 8;
+    /**
+     * Methods called on a stack allocated object with more units than this
+     * aren't analyzed and make the object escape.
+     */
+    private static final int MAX_CALLEE_UNITS = 200;
+
+    private final Config config;
+    /**
+     * Caches whether {@code this} escapes from a method when invoked on an
+     * instance of a specific class. Keyed by the class name and the method
+     * signature.
+     */
+    private final Map<String, Boolean> thisEscapes = new HashMap<>();
+
+    public EscapeAnalysis(Config config) {
+        this.config = config;
+    }
+
+    /**
+     * Returns the {@code new} and {@code newarray} statements in the
+     * specified {@link Body} of a method in the class {@code caller} which
+     * allocate objects which don't escape the method. The values are the
+     * classes of the allocated objects or {@code null} for arrays.
+     */
+    public Map<AssignStmt, SootClass> findStackAllocations(Clazz caller, Body body) {
+        Map<AssignStmt, SootClass> result = new LinkedHashMap<>();
+        Map<Local, Integer> defCounts = null;
+        for (Unit unit : body.getUnits()) {
+            if (result.size() == MAX_ALLOCATIONS) {
+                break;
+            }
+            if (!(unit instanceof AssignStmt) || !(((AssignStmt) unit).getLeftOp() instanceof Local)) {
+                continue;
+            }
+            AssignStmt stmt = (AssignStmt) unit;
+            Value rightOp = stmt.getRightOp();
+            SootClass sootClass = null;
+            if (rightOp instanceof NewExpr) {
+                sootClass = getStackAllocatableClass(caller, ((NewExpr) rightOp).getBaseType());
+                if (sootClass == null) {
+                    continue;
+                }
+            } else if (rightOp instanceof NewArrayExpr) {
+                NewArrayExpr expr = (NewArrayExpr) rightOp;
+                if (!(expr.getBaseType() instanceof PrimType) || !(expr.getSize() instanceof IntConstant)) {
+                    continue;
+                }
+                int length = ((IntConstant) expr.getSize()).value;
+                if (length < 0 || length > MAX_ARRAY_LENGTH) {
+                    continue;
+                }
+            } else {
+                continue;
+            }
+            if (defCounts == null) {
+                defCounts = countDefinitions(body);
+            }
+            Local local = (Local) stmt.getLeftOp();
+            if (defCounts.get(local) == 1 && !escapes(body, local, sootClass)) {
+                result.put(stmt, sootClass);
+            }
+        }
+        return result;
+    }
+
+    private SootClass getStackAllocatableClass(Clazz caller, RefType type) {
+        Clazz clazz = config.getClazzes().load(getInternalName(type));
+        if (clazz == null || !Access.checkClassAccessible(clazz, caller)) {
+            return null;
+        }
+        SootClass sootClass = clazz.getSootClass();
+        if (sootClass.isPhantom() || sootClass.isInterface() || sootClass.isAbstract()) {
+            return null;
+        }
+        int fieldCount = 0;
+        for (SootClass c = sootClass; c.hasSuperclass(); c = c.getSuperclass()) {
+            String name = c.getName();
+            if (c.isPhantom() || name.equals("java.lang.Throwable") || name.equals("java.lang.ref.Reference")
+                    || name.equals("org.robovm.rt.bro.NativeObject")) {
+                // Throwables record the stack trace, References are tracked
+                // by the GC and the methods of NativeObjects are rewritten
+                // by compiler plugins after we have analyzed them.
+                return null;
+            }
+            if (c.declaresMethod("finalize", Collections.<soot.Type>emptyList(), VoidType.v())) {
+                return null;
+            }
+            for (SootField f : c.getFields()) {
+                if (!f.isStatic()) {
+                    fieldCount++;
+                }
+            }
+        }
+        return fieldCount <= MAX_INSTANCE_FIELDS ? sootClass : null;
+    }
+
+    private static Map<Local, Integer> countDefinitions(Body body) {
+        Map<Local, Integer> counts = new HashMap<>();
+        for (Unit unit : body.getUnits()) {
+            if (unit instanceof DefinitionStmt && ((DefinitionStmt) unit).getLeftOp() instanceof Local) {
+                Local local = (Local) ((DefinitionStmt) unit).getLeftOp();
+                Integer count = counts.get(local);
+                counts.put(local, count == null ? 1 : count + 1);
+            }
+        }
+        return counts;
+    }
+
+    /**
+     * Returns {@code true} if the object referenced by {@code local} may
+     * escape the method {@code body} belongs to. {@code sootClass} is the
+     * exact class of the object or {@code null} if it's an array.
+     */
+    private boolean escapes(Body body, Local local, SootClass sootClass) {
+        for (Unit unit : body.getUnits()) {
+            if (!uses(unit, local)) {
+                continue;
+            }
+            if (unit instanceof InvokeStmt) {
+                if (escapes(((InvokeStmt) unit).getInvokeExpr(), local, sootClass)) {
+                    return true;
+                }
+            } else if (unit instanceof AssignStmt) {
+                Value leftOp = ((AssignStmt) unit).getLeftOp();
+                Value rightOp = ((AssignStmt) unit).getRightOp();
+                if (rightOp == local) {
+                    // Copied to another local, stored in a field, array
+                    // element or static field
+                    return true;
+                }
+                if (leftOp instanceof InstanceFieldRef && ((InstanceFieldRef) leftOp).getBase() == local
+                        || leftOp instanceof ArrayRef && ((ArrayRef) leftOp).getBase() == local) {
+                    // Field or array element write. rightOp is an immediate.
+                    continue;
+                }
+                if (!(leftOp instanceof Local)) {
+                    return true;
+                }
+                if (rightOp instanceof InstanceFieldRef && ((InstanceFieldRef) rightOp).getBase() == local
+                        || rightOp instanceof ArrayRef && ((ArrayRef) rightOp).getBase() == local
+                        || rightOp instanceof LengthExpr && ((LengthExpr) rightOp).getOp() == local) {
+                    continue;
+                }
+                if (!(rightOp instanceof InvokeExpr) || escapes((InvokeExpr) rightOp, local, sootClass)) {
+                    return true;
+                }
+            } else {
+                // Compared, thrown, returned, synchronized on, etc
+                return true;
+            }
+        }
+        return false;
+    }
+
+    private static boolean uses(Unit unit, Local local) {
+        for (ValueBox box : unit.getUseBoxes()) {
+            if (box.getValue() == local) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    private boolean escapes(InvokeExpr expr, Local local, SootClass sootClass) {
+        if (sootClass == null || !(expr instanceof InstanceInvokeExpr)
+                || ((InstanceInvokeExpr) expr).getBase() != local || expr.getArgs().contains(local)) {
+            return true;
+        }
+        SootMethod target = null;
+        try {
+            if (expr instanceof SpecialInvokeExpr) {
+                target = expr.getMethod();
+            } else {
+                target = resolve(sootClass, expr.getMethodRef().getSubSignature().getString());
+            }
+        } catch (RuntimeException e) {
+            // Missing method. Let the trampoline handle it.
+            return true;
+        }
+        if (target == null || target.isStatic() || target.isAbstract() || target.isNative()
+                || target.isSynchronized()) {
+            return true;
+        }
+        return thisEscapes(target, sootClass);
+    }
+
+    /**
+     * Finds the method called by a virtual or interface call on an instance
+     * of {@code sootClass}. Returns {@code null} if a package private method
+     * is found since such methods may not override the called method.
+     */
+    private static SootMethod resolve(SootClass sootClass, String subSignature) {
+        for (SootClass c = sootClass; c != null; c = c.hasSuperclass() ? c.getSuperclass() : null) {
+            if (c.declaresMethod(subSignature)) {
+                SootMethod m = c.getMethod(subSignature);
+                if (!m.isPrivate()) {
+                    return m.isPublic() || m.isProtected() ? m : null;
+                }
+            }
+        }
+        return null;
+    }
+
+    private boolean thisEscapes(SootMethod method, SootClass sootClass) {
+        String key = sootClass.getName() + " " + method.getSignature();
+        Boolean cached = thisEscapes.get(key);
+        if (cached != null) {
+            return cached;
+        }
+        // Assume it escapes while analyzing recursive calls
+        thisEscapes.put(key, true);
+        boolean result = true;
+        Clazz clazz = config.getClazzes().load(getInternalName(method.getDeclaringClass()));
+        if (clazz != null) {
+            try {
+                // Loading the Clazz makes sure the method bodies have been resolved
+                clazz.getSootClass();
+                Body body = method.retrieveActiveBody();
+                if (body.getUnits().size() <= MAX_CALLEE_UNITS) {
+                    Local thisLocal = body.getThisLocal();
+                    result = countDefinitions(body).get(thisLocal) != 1 || escapes(body, thisLocal, sootClass);
+                }
+            } catch (RuntimeException e) {
+                // No body available
+            }
+        }
+        thisEscapes.put(key, result);
+        return result;
+    }
+}
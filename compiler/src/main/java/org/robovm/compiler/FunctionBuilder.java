@@ -194,6 +194,11 @@ public class FunctionBuilder {
                 .linkage(external).attribs(noinline, optsize).build();
     }
 
+    public static Function clinitSlowPath(FunctionRef targetFn) {
+        return new FunctionBuilder(clinitSlowPathSymbol(targetFn.getName()), targetFn)
+                .linkage(_private).attribs(noinline, optsize, cold).build();
+    }
+
     public static Function lookup(SootMethod method, boolean isWeak) {
         return new FunctionBuilder(lookupWrapperSymbol(method), 
                 getFunctionType(method)).linkage(isWeak ? weak : external).build();
@@ -206,6 +211,17 @@ public class FunctionBuilder {
             .linkage(isWeak ? weak : external).build();
     }
 
+    /**
+     * Creates the function which does the actual itable dispatch of an
+     * interface method lookup function. The {@link Linker} falls back to it
+     * in the lookup functions it replaces for receivers which don't match
+     * any of the statically known implementations (e.g. proxies).
+     */
+    public static Function dispatch(SootMethod method) {
+        return new FunctionBuilder(dispatchSymbol(method), getFunctionType(method))
+                .linkage(external).attribs(alwaysinline, optsize).build();
+    }
+
     public static Function synchronizedWrapper(SootMethod method) {
         return new FunctionBuilder(synchronizedWrapperSymbol(method), getFunctionType(method))
                 .linkage(external).attribs(noinline, optsize).build();
@@ -216,6 +232,26 @@ public class FunctionBuilder {
                 .attribs(noinline, optsize).build();
     }
 
+    /**
+     * Creates the function of a method which is hot according to the
+     * profile used for the compile. Hot methods are optimized for speed 
+     * rather than size and are put in the specified section to keep them 
+     * together in the final binary.
+     */
+    public static Function hotMethod(SootMethod method, boolean weak, String section) {
+        return new FunctionBuilder(methodSymbol(method), getFunctionType(method)).linkage(weak ? Linkage.weak : external)
+                .attribs(noinline).section(section).build();
+    }
+
+    /**
+     * Creates the function of a method which was never called when the 
+     * profile used for the compile was recorded.
+     */
+    public static Function coldMethod(SootMethod method, boolean weak) {
+        return new FunctionBuilder(methodSymbol(method), getFunctionType(method)).linkage(weak ? Linkage.weak : external)
+                .attribs(noinline, optsize, cold).build();
+    }
+
     public static Function info(String internalName) {
         return new FunctionBuilder(infoSymbol(internalName), new FunctionType(I8_PTR_PTR))
                 .linkage(external).attribs(alwaysinline, optsize).build();
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import static org.robovm.compiler.Symbols.*;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Deque;
+import java.util.HashSet;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Set;
+
+import org.apache.commons.io.FileUtils;
+import org.apache.commons.lang3.tuple.ImmutableTriple;
+import org.apache.commons.lang3.tuple.Triple;
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.clazz.ClazzInfo;
+import org.robovm.compiler.clazz.Dependency;
+import org.robovm.compiler.clazz.InvokeMethodDependency;
+import org.robovm.compiler.clazz.MethodInfo;
+import org.robovm.compiler.config.Config;
+import org.robovm.compiler.profile.Profile;
+import org.robovm.compiler.profile.Profile.MethodProfile;
+
+/**
+ * Determines the functions which should be laid out first and in order in
+ * the text segment of the executable so that the code run during startup is
+ * packed into as few pages as possible. {@link ClassCompiler} and
+ * {@link Linker} emit every function into a section of its own which lets
+ * the system linker reorder them. The order is taken from the first of:
+ * <ul>
+ * <li>The {@link Config#getFunctionOrderFile()}. Each line contains either
+ * a method on the form {@code owner.name(desc)}, e.g. recorded by a startup
+ * trace, or a raw symbol. Empty lines and lines starting with {@code #} are
+ * ignored.</li>
+ * <li>The methods called while recording the {@link Config#getProfile()},
+ * most called first.</li>
+ * <li>A static guess: the main class initializer, the main method and the
+ * methods and class initializers reachable from them through calls, nearest
+ * first.</li>
+ * </ul>
+ */
+public class FunctionOrder {
+    /**
+     * Maximum number of methods ordered by the static guess. The further away
+     * from the main method the less likely it is to be called at startup.
+     */
+    private static final int MAX_STATIC_METHODS = 4096;
+
+    private final Config config;
+
+    public FunctionOrder(Config config) {
+        this.config = config;
+    }
+
+    /**
+     * Returns the symbols of the functions to place first, in order. Returns
+     * an empty list if function ordering hasn't been enabled.
+     */
+    public List<String> getSymbols() throws IOException {
+        if (config.getFunctionOrderFile() != null) {
+            return parse(FileUtils.readLines(config.getFunctionOrderFile(), "UTF-8"));
+        }
+        if (!config.isOrderFunctions()) {
+            return new ArrayList<>();
+        }
+        Set<String> reachableMethods = new HashSet<>();
+        for (Triple<String, String, String> node : config.getDependencyGraph().findReachableMethods()) {
+            reachableMethods.add(node.getLeft() + "." + node.getMiddle() + node.getRight());
+        }
+        Profile profile = config.getProfile();
+        List<Triple<String, String, String>> methods = new ArrayList<>();
+        if (profile != null && !profile.isEmpty()) {
+            for (MethodProfile mp : profile.getMethods()) {
+                if (mp.getCount() > 0) {
+                    methods.add(new ImmutableTriple<>(mp.getOwner(), mp.getName(), mp.getDesc()));
+                }
+            }
+        } else {
+            methods.addAll(findStartupMethods());
+        }
+        List<String> result = new ArrayList<>();
+        for (Triple<String, String, String> m : methods) {
+            if (!reachableMethods.contains(m.getLeft() + "." + m.getMiddle() + m.getRight())) {
+                // Removed by the tree shaker
+                continue;
+            }
+            MethodInfo mi = findMethod(m.getLeft(), m.getMiddle(), m.getRight());
+            if (mi != null && mi.isSynchronized()) {
+                // Callers call the wrapper which calls the method
+                result.add(synchronizedWrapperSymbol(m.getLeft(), m.getMiddle(), m.getRight()));
+            }
+            result.add(methodSymbol(m.getLeft(), m.getMiddle(), m.getRight()));
+        }
+        return result;
+    }
+
+    /**
+     * Converts the specified lines of a function order file into symbols.
+     */
+    static List<String> parse(List<String> lines) {
+        Set<String> result = new LinkedHashSet<>();
+        for (String line : lines) {
+            line = line.trim();
+            if (line.isEmpty() || line.startsWith("#")) {
+                continue;
+            }
+            parse(line, result);
+        }
+        return new ArrayList<>(result);
+    }
+
+    private static void parse(String method, Set<String> result) {
+        int descStart = method.indexOf('(');
+        int nameStart = descStart != -1 ? method.lastIndexOf('.', descStart) : -1;
+        if (method.startsWith(EXTERNAL_SYMBOL_PREFIX) || nameStart <= 0) {
+            result.add(method);
+        } else {
+            String owner = method.substring(0, nameStart);
+            String name = method.substring(nameStart + 1, descStart);
+            String desc = method.substring(descStart);
+            // Synchronized methods are called through a wrapper. Wrappers
+            // which don't exist are ignored by the linker.
+            result.add(synchronizedWrapperSymbol(owner, name, desc));
+            result.add(methodSymbol(owner, name, desc));
+        }
+    }
+
+    /**
+     * Returns the methods likely to be called first when the app starts.
+     */
+    private List<Triple<String, String, String>> findStartupMethods() {
+        List<Triple<String, String, String>> result = new ArrayList<>();
+        if (config.getMainClass() == null) {
+            return result;
+        }
+        Set<String> visited = new HashSet<>();
+        Deque<Triple<String, String, String>> queue = new ArrayDeque<>();
+        String mainClass = config.getMainClass().replace('.', '/');
+        queue.add(new ImmutableTriple<>(mainClass, "<clinit>", "()V"));
+        queue.add(new ImmutableTriple<>(mainClass, "main", "([Ljava/lang/String;)V"));
+        while (!queue.isEmpty() && result.size() < MAX_STATIC_METHODS) {
+            Triple<String, String, String> m = queue.poll();
+            String key = m.getLeft() + "." + m.getMiddle() + m.getRight();
+            if (!visited.add(key)) {
+                continue;
+            }
+            // Calls may name a subclass of the class declaring the method
+            ClazzInfo owner = findDeclaringClass(m.getLeft(), m.getMiddle(), m.getRight());
+            MethodInfo mi = owner != null ? findMethod(owner.getInternalName(), m.getMiddle(), m.getRight()) : null;
+            if (mi == null) {
+                continue;
+            }
+            result.add(new ImmutableTriple<>(owner.getInternalName(), m.getMiddle(), m.getRight()));
+            for (Dependency dep : mi.getDependencies()) {
+                if (dep instanceof InvokeMethodDependency) {
+                    InvokeMethodDependency imd = (InvokeMethodDependency) dep;
+                    if (!imd.getOwner().equals(m.getLeft())) {
+                        // The class of the callee will be initialized first
+                        queue.add(new ImmutableTriple<>(imd.getOwner(), "<clinit>", "()V"));
+                    }
+                    queue.add(new ImmutableTriple<>(imd.getOwner(), imd.getMethodName(), imd.getMethodDesc()));
+                }
+            }
+        }
+        return result;
+    }
+
+    private ClazzInfo findDeclaringClass(String owner, String name, String desc) {
+        Clazz clazz = config.getClazzes().load(owner);
+        ClazzInfo ci = clazz != null ? clazz.getClazzInfo() : null;
+        while (ci != null && !ci.isPhantom()) {
+            if (ci.getMethod(name, desc) != null) {
+                return ci;
+            }
+            ci = ci.hasSuperclass() ? ci.getSuperclass() : null;
+        }
+        return null;
+    }
+
+    private MethodInfo findMethod(String owner, String name, String desc) {
+        Clazz clazz = config.getClazzes().load(owner);
+        ClazzInfo ci = clazz != null ? clazz.getClazzInfo() : null;
+        MethodInfo mi = ci != null ? ci.getMethod(name, desc) : null;
+        return mi != null && !mi.isAbstract() && !mi.isNative() ? mi : null;
+    }
+
+    /**
+     * Writes a GNU ld script which places the sections of the specified
+     * functions, in order, before all other code. The script is passed to
+     * the linker using {@code -T} and only adds to the default script.
+     */
+    public static void writeLinkerScript(File file, List<String> symbols) throws IOException {
+        StringBuilder sb = new StringBuilder();
+        sb.append("SECTIONS\n{\n    .text.ordered :\n    {\n");
+        // Methods considered hot by a profile are compiled into .text.hot
+        sb.append("        *(.text.hot .text.hot.*)\n");
+        for (String symbol : symbols) {
+            // Section names are glob patterns also when quoted. Method
+            // symbols contain [ and ] but never * or ?.
+            sb.append("        *(\".text.").append(symbol.replace('[', '?').replace(']', '?')).append("\")\n");
+        }
+        sb.append("    }\n}\nINSERT BEFORE .text;\n");
+        FileUtils.writeStringToFile(file, sb.toString(), "UTF-8");
+    }
+
+    /**
+     * Writes an order file for the Xcode linker's {@code -order_file} option
+     * which places the specified functions, in order, before all other code.
+     */
+    public static void writeOrderFile(File file, List<String> symbols) throws IOException {
+        List<String> lines = new ArrayList<>();
+        for (String symbol : symbols) {
+            lines.add("_" + symbol);
+        }
+        FileUtils.writeLines(file, "UTF-8", lines, "\n");
+    }
+}
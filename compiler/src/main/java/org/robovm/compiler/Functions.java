@@ -80,6 +80,7 @@ public class Functions {
     public static final FunctionRef BC_LDC_STRING = new FunctionRef("_bcLdcString", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, I8_PTR));
     public static final FunctionRef BC_LOOKUP_VIRTUAL_METHOD = new FunctionRef("_bcLookupVirtualMethod", new FunctionType(I8_PTR, ENV_PTR, OBJECT_PTR, I8_PTR, I8_PTR));
     public static final FunctionRef BC_LOOKUP_INTERFACE_METHOD = new FunctionRef("_bcLookupInterfaceMethod", new FunctionType(I8_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I8_PTR, I8_PTR));
+    public static final FunctionRef IC_LOOKUP = new FunctionRef("ic_lookup", new FunctionType(I8_PTR, ENV_PTR, INLINE_CACHE_PTR, I8_PTR_PTR, OBJECT_PTR, I32, I8_PTR));
     public static final FunctionRef BC_LOOKUP_INTERFACE_METHOD_IMPL = new FunctionRef("_bcLookupInterfaceMethodImpl", new FunctionType(I8_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32));
     public static final FunctionRef BC_CHECKCAST = new FunctionRef("_bcCheckcast", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR));
     public static final FunctionRef BC_CHECKCAST_ARRAY = new FunctionRef("_bcCheckcastArray", new FunctionType(OBJECT_PTR, ENV_PTR, OBJECT_PTR, OBJECT_PTR));
@@ -95,6 +96,7 @@ public class Functions {
     public static final FunctionRef BC_ATTACH_THREAD_FROM_CALLBACK = new FunctionRef("_bcAttachThreadFromCallback", new FunctionType(ENV_PTR));
     public static final FunctionRef BC_DETACH_THREAD_FROM_CALLBACK = new FunctionRef("_bcDetachThreadFromCallback", new FunctionType(VOID, ENV_PTR));
     public static final FunctionRef RVM_TRYCATCH_ENTER = new FunctionRef("rvmTrycatchEnter", new FunctionType(I32, ENV_PTR, TRYCATCH_CONTEXT_PTR));
+    public static final FunctionRef BC_PERSONALITY = new FunctionRef("_bcPersonality", new FunctionType(I32, true));
     public static final FunctionRef BC_TRYCATCH_LEAVE = new FunctionRef("_bcTrycatchLeave", new FunctionType(VOID, ENV_PTR));
     public static final FunctionRef BC_ABSTRACT_METHOD_CALLED = new FunctionRef("_bcAbstractMethodCalled", new FunctionType(VOID, ENV_PTR, OBJECT_PTR));
     public static final FunctionRef BC_NON_PUBLIC_METHOD_CALLED = new FunctionRef("_bcNonPublicMethodCalled", new FunctionType(VOID, ENV_PTR, OBJECT_PTR));
@@ -106,11 +108,20 @@ public class Functions {
 
     public static final FunctionRef REGISTER_FINALIZABLE = new FunctionRef("register_finalizable", new FunctionType(VOID, ENV_PTR, OBJECT_PTR));
     public static final FunctionRef CHECK_NULL = new FunctionRef("checknull", new FunctionType(I8, ENV_PTR, OBJECT_PTR));
+    public static final FunctionRef CHECK_NULL_EXPLICIT = new FunctionRef("checknull_explicit", new FunctionType(VOID, ENV_PTR, OBJECT_PTR));
     public static final FunctionRef CHECK_NULL_I8_PTR = new FunctionRef("checknull_i8_ptr", new FunctionType(I8, ENV_PTR, I8_PTR));
     public static final FunctionRef CHECK_LOWER = new FunctionRef("checklower", new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I32));
     public static final FunctionRef CHECK_UPPER = new FunctionRef("checkupper", new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I32));
     public static final FunctionRef CHECK_STACK_OVERFLOW = new FunctionRef("checkso", new FunctionType(VOID));
+    public static final FunctionRef PROFILE_COUNT = new FunctionRef("profile_count", new FunctionType(VOID, PROFILE_COUNTER_PTR));
+    public static final FunctionRef PROFILE_ENTER = new FunctionRef("profile_enter", new FunctionType(I64, PROFILE_COUNTER_PTR));
+    public static final FunctionRef PROFILE_EXIT = new FunctionRef("profile_exit", new FunctionType(VOID, PROFILE_COUNTER_PTR, I64));
+    public static final FunctionRef PROFILE_BRANCH = new FunctionRef("profile_branch", new FunctionType(VOID, PROFILE_COUNTER_PTR, I1));
+    public static final FunctionRef BC_PROFILE_RECEIVER = new FunctionRef("_bcProfileReceiver", new FunctionType(VOID, PROFILE_RECEIVER_SITE_PTR, OBJECT_PTR));
     public static final FunctionRef ARRAY_LENGTH = new FunctionRef("arraylength", new FunctionType(I32, OBJECT_PTR));
+    public static final FunctionRef INITIALIZE_CLASS = new FunctionRef("initializeclass", new FunctionType(VOID, ENV_PTR, I8_PTR_PTR));
+    public static final FunctionRef ALLOC_OBJECT = new FunctionRef("allocobject", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, I32));
+    public static final FunctionRef INIT_STACK_OBJECT = new FunctionRef("initstackobject", new FunctionType(VOID, OBJECT_PTR, I32, CLASS_PTR));
     public static final FunctionRef BALOAD = new FunctionRef("baload", new FunctionType(I8, OBJECT_PTR, I32));
     public static final FunctionRef SALOAD = new FunctionRef("saload", new FunctionType(I16, OBJECT_PTR, I32));
     public static final FunctionRef CALOAD = new FunctionRef("caload", new FunctionType(I16, OBJECT_PTR, I32));
@@ -127,6 +138,23 @@ public class Functions {
     public static final FunctionRef FASTORE = new FunctionRef("fastore", new FunctionType(VOID, OBJECT_PTR, I32, FLOAT));
     public static final FunctionRef DASTORE = new FunctionRef("dastore", new FunctionType(VOID, OBJECT_PTR, I32, DOUBLE));
     public static final FunctionRef AASTORE = new FunctionRef("aastore", new FunctionType(VOID, OBJECT_PTR, I32, OBJECT_PTR));
+    public static final FunctionRef ARRAY_COVERS = new FunctionRef("arraycovers", new FunctionType(I1, OBJECT_PTR, I32));
+    public static final FunctionRef ARRAY_LENGTH_INBOUNDS = new FunctionRef("arraylength_inbounds", new FunctionType(I32, OBJECT_PTR));
+    public static final FunctionRef BALOAD_INBOUNDS = new FunctionRef("baload_inbounds", new FunctionType(I8, OBJECT_PTR, I32));
+    public static final FunctionRef SALOAD_INBOUNDS = new FunctionRef("saload_inbounds", new FunctionType(I16, OBJECT_PTR, I32));
+    public static final FunctionRef CALOAD_INBOUNDS = new FunctionRef("caload_inbounds", new FunctionType(I16, OBJECT_PTR, I32));
+    public static final FunctionRef IALOAD_INBOUNDS = new FunctionRef("iaload_inbounds", new FunctionType(I32, OBJECT_PTR, I32));
+    public static final FunctionRef LALOAD_INBOUNDS = new FunctionRef("laload_inbounds", new FunctionType(I64, OBJECT_PTR, I32));
+    public static final FunctionRef FALOAD_INBOUNDS = new FunctionRef("faload_inbounds", new FunctionType(FLOAT, OBJECT_PTR, I32));
+    public static final FunctionRef DALOAD_INBOUNDS = new FunctionRef("daload_inbounds", new FunctionType(DOUBLE, OBJECT_PTR, I32));
+    public static final FunctionRef AALOAD_INBOUNDS = new FunctionRef("aaload_inbounds", new FunctionType(OBJECT_PTR, OBJECT_PTR, I32));
+    public static final FunctionRef BASTORE_INBOUNDS = new FunctionRef("bastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, I8));
+    public static final FunctionRef SASTORE_INBOUNDS = new FunctionRef("sastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, I16));
+    public static final FunctionRef CASTORE_INBOUNDS = new FunctionRef("castore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, I16));
+    public static final FunctionRef IASTORE_INBOUNDS = new FunctionRef("iastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, I32));
+    public static final FunctionRef LASTORE_INBOUNDS = new FunctionRef("lastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, I64));
+    public static final FunctionRef FASTORE_INBOUNDS = new FunctionRef("fastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, FLOAT));
+    public static final FunctionRef DASTORE_INBOUNDS = new FunctionRef("dastore_inbounds", new FunctionType(VOID, OBJECT_PTR, I32, DOUBLE));
     public static final FunctionRef F2I = new FunctionRef("f2i", new FunctionType(I32, FLOAT));
     public static final FunctionRef F2L = new FunctionRef("f2l", new FunctionType(I64, FLOAT));
     public static final FunctionRef D2I = new FunctionRef("d2i", new FunctionType(I32, DOUBLE));
@@ -146,10 +174,10 @@ public class Functions {
     public static final FunctionRef CHECKCAST_WRAPPER = new FunctionRef("checkcastWrapper", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR));
     public static final FunctionRef INSTANCEOF_WRAPPER = new FunctionRef("instanceofWrapper", new FunctionType(I32, ENV_PTR, I8_PTR_PTR, OBJECT_PTR));
     public static final FunctionRef CHECKCAST_CLASS = new FunctionRef("checkcast_class", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32, I32));
-    public static final FunctionRef CHECKCAST_INTERFACE = new FunctionRef("checkcast_interface", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32));
+    public static final FunctionRef CHECKCAST_INTERFACE = new FunctionRef("checkcast_interface", new FunctionType(OBJECT_PTR, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32, I8_PTR));
     public static final FunctionRef CHECKCAST_PRIM_ARRAY = new FunctionRef("checkcast_prim_array", new FunctionType(OBJECT_PTR, ENV_PTR, CLASS_PTR, OBJECT_PTR));
     public static final FunctionRef INSTANCEOF_CLASS = new FunctionRef("instanceof_class", new FunctionType(I32, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32, I32));
-    public static final FunctionRef INSTANCEOF_INTERFACE = new FunctionRef("instanceof_interface", new FunctionType(I32, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32));
+    public static final FunctionRef INSTANCEOF_INTERFACE = new FunctionRef("instanceof_interface", new FunctionType(I32, ENV_PTR, I8_PTR_PTR, OBJECT_PTR, I32, I8_PTR));
     public static final FunctionRef INSTANCEOF_PRIM_ARRAY = new FunctionRef("instanceof_prim_array", new FunctionType(I32, ENV_PTR, CLASS_PTR, OBJECT_PTR));
     public static final FunctionRef OBJECT_CLASS = new FunctionRef("Object_class", new FunctionType(CLASS_PTR, OBJECT_PTR));
     public static final FunctionRef CLASS_VITABLE = new FunctionRef("Class_vitable", new FunctionType(VITABLE_PTR, CLASS_PTR));
@@ -206,6 +234,63 @@ public class Functions {
             throw new IllegalArgumentException("Unknown Type: " + sootType);
         }
     }
+
+    /**
+     * Returns the non-volatile variant of the function returned by
+     * {@link #getArrayLoad(soot.Type)} used for accesses which are known to
+     * be in bounds.
+     */
+    public static FunctionRef getArrayLoadInBounds(soot.Type sootType) {
+        if (sootType.equals(soot.BooleanType.v())) {
+            return BALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.ByteType.v())) {
+            return BALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.ShortType.v())) {
+            return SALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.CharType.v())) {
+            return CALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.IntType.v())) {
+            return IALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.LongType.v())) {
+            return LALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.FloatType.v())) {
+            return FALOAD_INBOUNDS;
+        } else if (sootType.equals(soot.DoubleType.v())) {
+            return DALOAD_INBOUNDS;
+        } else if (sootType instanceof soot.RefLikeType) {
+            return AALOAD_INBOUNDS;
+        } else {
+            throw new IllegalArgumentException("Unknown Type: " + sootType);
+        }
+    }
+
+    /**
+     * Returns the non-volatile variant of the function returned by
+     * {@link #getArrayStore(soot.Type)} used for accesses which are known to
+     * be in bounds. Object arrays have no such variant since stores to them
+     * must be type checked.
+     */
+    public static FunctionRef getArrayStoreInBounds(soot.Type sootType) {
+        if (sootType.equals(soot.BooleanType.v())) {
+            return BASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.ByteType.v())) {
+            return BASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.ShortType.v())) {
+            return SASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.CharType.v())) {
+            return CASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.IntType.v())) {
+            return IASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.LongType.v())) {
+            return LASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.FloatType.v())) {
+            return FASTORE_INBOUNDS;
+        } else if (sootType.equals(soot.DoubleType.v())) {
+            return DASTORE_INBOUNDS;
+        } else {
+            throw new IllegalArgumentException("Unknown Type: " + sootType);
+        }
+    }
     
     public static FunctionRef getNewArray(soot.Type sootType) {
         if (sootType.equals(soot.BooleanType.v())) {
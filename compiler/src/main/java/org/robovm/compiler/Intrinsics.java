@@ -25,6 +25,16 @@ import java.util.Map;
 import org.robovm.compiler.llvm.FunctionRef;
 import org.robovm.compiler.llvm.FunctionType;
 
+import soot.ArrayType;
+import soot.BooleanType;
+import soot.ByteType;
+import soot.CharType;
+import soot.DoubleType;
+import soot.FloatType;
+import soot.IntType;
+import soot.LongType;
+import soot.RefLikeType;
+import soot.ShortType;
 import soot.SootFieldRef;
 import soot.SootMethod;
 import soot.SootMethodRef;
@@ -73,6 +83,175 @@ public class Intrinsics {
         SIMPLE_INTRINSICS.put("java/lang/Math/sin(D)D", 
                 new FunctionRef("intrinsics.java_lang_Math_sin", 
                         new FunctionType(DOUBLE, ENV_PTR, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/min(II)I", 
+                new FunctionRef("intrinsics.java_lang_Math_min_I", 
+                        new FunctionType(I32, ENV_PTR, I32, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/max(II)I", 
+                new FunctionRef("intrinsics.java_lang_Math_max_I", 
+                        new FunctionType(I32, ENV_PTR, I32, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/min(JJ)J", 
+                new FunctionRef("intrinsics.java_lang_Math_min_J", 
+                        new FunctionType(I64, ENV_PTR, I64, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/max(JJ)J", 
+                new FunctionRef("intrinsics.java_lang_Math_max_J", 
+                        new FunctionType(I64, ENV_PTR, I64, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/min(FF)F", 
+                new FunctionRef("intrinsics.java_lang_Math_min_F", 
+                        new FunctionType(FLOAT, ENV_PTR, FLOAT, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/max(FF)F", 
+                new FunctionRef("intrinsics.java_lang_Math_max_F", 
+                        new FunctionType(FLOAT, ENV_PTR, FLOAT, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/min(DD)D", 
+                new FunctionRef("intrinsics.java_lang_Math_min_D", 
+                        new FunctionType(DOUBLE, ENV_PTR, DOUBLE, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/max(DD)D", 
+                new FunctionRef("intrinsics.java_lang_Math_max_D", 
+                        new FunctionType(DOUBLE, ENV_PTR, DOUBLE, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/fma(FFF)F", 
+                new FunctionRef("intrinsics.java_lang_Math_fma_F", 
+                        new FunctionType(FLOAT, ENV_PTR, FLOAT, FLOAT, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/lang/Math/fma(DDD)D", 
+                new FunctionRef("intrinsics.java_lang_Math_fma_D", 
+                        new FunctionType(DOUBLE, ENV_PTR, DOUBLE, DOUBLE, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Integer/bitCount(I)I", 
+                new FunctionRef("intrinsics.java_lang_Integer_bitCount", 
+                        new FunctionType(I32, ENV_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Long/bitCount(J)I", 
+                new FunctionRef("intrinsics.java_lang_Long_bitCount", 
+                        new FunctionType(I32, ENV_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Integer/numberOfLeadingZeros(I)I", 
+                new FunctionRef("intrinsics.java_lang_Integer_numberOfLeadingZeros", 
+                        new FunctionType(I32, ENV_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Long/numberOfLeadingZeros(J)I", 
+                new FunctionRef("intrinsics.java_lang_Long_numberOfLeadingZeros", 
+                        new FunctionType(I32, ENV_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Integer/numberOfTrailingZeros(I)I", 
+                new FunctionRef("intrinsics.java_lang_Integer_numberOfTrailingZeros", 
+                        new FunctionType(I32, ENV_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Long/numberOfTrailingZeros(J)I", 
+                new FunctionRef("intrinsics.java_lang_Long_numberOfTrailingZeros", 
+                        new FunctionType(I32, ENV_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Integer/reverseBytes(I)I", 
+                new FunctionRef("intrinsics.java_lang_Integer_reverseBytes", 
+                        new FunctionType(I32, ENV_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Long/reverseBytes(J)J", 
+                new FunctionRef("intrinsics.java_lang_Long_reverseBytes", 
+                        new FunctionType(I64, ENV_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/Float/floatToRawIntBits(F)I", 
+                new FunctionRef("intrinsics.java_lang_Float_floatToRawIntBits", 
+                        new FunctionType(I32, ENV_PTR, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/lang/Float/floatToIntBits(F)I", 
+                new FunctionRef("intrinsics.java_lang_Float_floatToIntBits", 
+                        new FunctionType(I32, ENV_PTR, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/lang/Float/intBitsToFloat(I)F", 
+                new FunctionRef("intrinsics.java_lang_Float_intBitsToFloat", 
+                        new FunctionType(FLOAT, ENV_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/lang/Double/doubleToRawLongBits(D)J", 
+                new FunctionRef("intrinsics.java_lang_Double_doubleToRawLongBits", 
+                        new FunctionType(I64, ENV_PTR, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Double/doubleToLongBits(D)J", 
+                new FunctionRef("intrinsics.java_lang_Double_doubleToLongBits", 
+                        new FunctionType(I64, ENV_PTR, DOUBLE)));
+        SIMPLE_INTRINSICS.put("java/lang/Double/longBitsToDouble(J)D", 
+                new FunctionRef("intrinsics.java_lang_Double_longBitsToDouble", 
+                        new FunctionType(DOUBLE, ENV_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/lang/String/equals(Ljava/lang/Object;)Z", 
+                new FunctionRef("intrinsics.java_lang_String_equals", 
+                        new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR)));
+        SIMPLE_INTRINSICS.put("java/lang/String/hashCode()I", 
+                new FunctionRef("intrinsics.java_lang_String_hashCode", 
+                        new FunctionType(I32, ENV_PTR, OBJECT_PTR)));
+        
+        // boolean[] and byte[] as well as char[] and short[] share intrinsics
+        FunctionRef equalsB = new FunctionRef("intrinsics.java_util_Arrays_equals_B", 
+                new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR));
+        FunctionRef equalsC = new FunctionRef("intrinsics.java_util_Arrays_equals_C", 
+                new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([Z[Z)Z", equalsB);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([B[B)Z", equalsB);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([C[C)Z", equalsC);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([S[S)Z", equalsC);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([I[I)Z", 
+                new FunctionRef("intrinsics.java_util_Arrays_equals_I", 
+                        new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([J[J)Z", 
+                new FunctionRef("intrinsics.java_util_Arrays_equals_J", 
+                        new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([F[F)Z", 
+                new FunctionRef("intrinsics.java_util_Arrays_equals_F", 
+                        new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/equals([D[D)Z", 
+                new FunctionRef("intrinsics.java_util_Arrays_equals_D", 
+                        new FunctionType(I8, ENV_PTR, OBJECT_PTR, OBJECT_PTR)));
+        FunctionRef fillB = new FunctionRef("intrinsics.java_util_Arrays_fill_B", 
+                new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I8));
+        FunctionRef fillC = new FunctionRef("intrinsics.java_util_Arrays_fill_C", 
+                new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I16));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([ZZ)V", fillB);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([BB)V", fillB);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([CC)V", fillC);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([SS)V", fillC);
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([II)V", 
+                new FunctionRef("intrinsics.java_util_Arrays_fill_I", 
+                        new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I32)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([JJ)V", 
+                new FunctionRef("intrinsics.java_util_Arrays_fill_J", 
+                        new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I64)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([FF)V", 
+                new FunctionRef("intrinsics.java_util_Arrays_fill_F", 
+                        new FunctionType(VOID, ENV_PTR, OBJECT_PTR, FLOAT)));
+        SIMPLE_INTRINSICS.put("java/util/Arrays/fill([DD)V", 
+                new FunctionRef("intrinsics.java_util_Arrays_fill_D", 
+                        new FunctionType(VOID, ENV_PTR, OBJECT_PTR, DOUBLE)));
+    }
+    
+    /**
+     * An intrinsic which only handles some of the calls to a method. The
+     * guard function is called first with as many of the leading arguments of
+     * the call as it takes. If it returns <code>true</code> the intrinsic
+     * function is called instead of the method. Otherwise the method is
+     * called as usual, e.g. to throw an exception.
+     */
+    public static class GuardedIntrinsic {
+        private final FunctionRef guard;
+        private final FunctionRef function;
+
+        GuardedIntrinsic(FunctionRef guard, FunctionRef function) {
+            this.guard = guard;
+            this.function = function;
+        }
+
+        public FunctionRef getGuard() {
+            return guard;
+        }
+
+        public FunctionRef getFunction() {
+            return function;
+        }
+    }
+    
+    private static final FunctionType ARRAYCOPY_GUARD_TYPE = 
+            new FunctionType(I1, ENV_PTR, OBJECT_PTR, I32, OBJECT_PTR, I32, I32);
+    private static final FunctionType ARRAYCOPY_TYPE = 
+            new FunctionType(VOID, ENV_PTR, OBJECT_PTR, I32, OBJECT_PTR, I32, I32);
+    private static final FunctionRef ARRAYCOPY_GUARD = 
+            new FunctionRef("intrinsics.java_lang_System_arraycopy_guard", ARRAYCOPY_GUARD_TYPE);
+    private static final FunctionRef ARRAYCOPY_GUARD_L = 
+            new FunctionRef("intrinsics.java_lang_System_arraycopy_guard_L", ARRAYCOPY_GUARD_TYPE);
+    private static final FunctionRef STRING_INDEX_OF_GUARD = 
+            new FunctionRef("intrinsics.java_lang_String_indexOf_guard", 
+                    new FunctionType(I1, ENV_PTR, OBJECT_PTR, I32));
+    
+    private static final Map<String, GuardedIntrinsic> GUARDED_INTRINSICS;
+    
+    static {
+        GUARDED_INTRINSICS = new HashMap<String, GuardedIntrinsic>();
+        GUARDED_INTRINSICS.put("java/lang/String/indexOf(I)I", new GuardedIntrinsic(STRING_INDEX_OF_GUARD, 
+                new FunctionRef("intrinsics.java_lang_String_indexOf", 
+                        new FunctionType(I32, ENV_PTR, OBJECT_PTR, I32))));
+        GUARDED_INTRINSICS.put("java/lang/String/indexOf(II)I", new GuardedIntrinsic(STRING_INDEX_OF_GUARD, 
+                new FunctionRef("intrinsics.java_lang_String_indexOf_start", 
+                        new FunctionType(I32, ENV_PTR, OBJECT_PTR, I32, I32))));
     }
     
     private static final FunctionRef LDC_PRIM_Z = new FunctionRef("intrinsics.ldc_prim_Z", new FunctionType(OBJECT_PTR, ENV_PTR));
@@ -111,6 +290,60 @@ public class Intrinsics {
         return null;
     }
 
+    public static GuardedIntrinsic getGuardedIntrinsic(SootMethod currMethod, Stmt stmt, InvokeExpr expr) {
+        SootMethodRef methodRef = expr.getMethodRef();
+        GuardedIntrinsic intrinsic = GUARDED_INTRINSICS.get(getInternalName(methodRef.declaringClass()) + "/" 
+                + methodRef.name() + getDescriptor(methodRef));
+        if (intrinsic != null) {
+            return intrinsic;
+        }
+        
+        if ("arraycopy".equals(methodRef.name()) 
+                && "java.lang.System".equals(methodRef.declaringClass().getName())
+                && methodRef.parameterTypes().size() == 5) {
+            
+            return getArraycopyIntrinsic(expr.getArg(0).getType(), expr.getArg(2).getType());
+        }
+        
+        return null;
+    }
+    
+    /**
+     * Returns the {@link GuardedIntrinsic} to use for
+     * <code>System.arraycopy()</code> calls with source and destination
+     * arrays of the specified static types. For arrays of primitives the
+     * static types tell the actual element type. Arrays of references are
+     * copied directly if they are of the same class at runtime.
+     */
+    private static GuardedIntrinsic getArraycopyIntrinsic(soot.Type srcType, soot.Type dstType) {
+        if (!(srcType instanceof ArrayType) || !(dstType instanceof ArrayType)) {
+            return null;
+        }
+        soot.Type srcElemType = ((ArrayType) srcType).getElementType();
+        soot.Type dstElemType = ((ArrayType) dstType).getElementType();
+        if (srcElemType instanceof RefLikeType && dstElemType instanceof RefLikeType) {
+            return new GuardedIntrinsic(ARRAYCOPY_GUARD_L, 
+                    new FunctionRef("intrinsics.java_lang_System_arraycopy_L", ARRAYCOPY_TYPE));
+        }
+        if (!srcElemType.equals(dstElemType)) {
+            return null;
+        }
+        String suffix;
+        if (srcElemType == BooleanType.v() || srcElemType == ByteType.v()) {
+            suffix = "B";
+        } else if (srcElemType == CharType.v() || srcElemType == ShortType.v()) {
+            suffix = "C";
+        } else if (srcElemType == IntType.v() || srcElemType == FloatType.v()) {
+            suffix = "I";
+        } else if (srcElemType == LongType.v() || srcElemType == DoubleType.v()) {
+            suffix = "J";
+        } else {
+            return null;
+        }
+        return new GuardedIntrinsic(ARRAYCOPY_GUARD, 
+                new FunctionRef("intrinsics.java_lang_System_arraycopy_" + suffix, ARRAYCOPY_TYPE));
+    }
+
     public static FunctionRef getIntrinsic(SootMethod currMethod, DefinitionStmt stmt) {
         soot.Value rightOp = stmt.getRightOp();
         if (rightOp instanceof StaticFieldRef) {
@@ -24,6 +24,8 @@ import static org.robovm.compiler.llvm.Linkage.*;
 import static org.robovm.compiler.llvm.Type.*;
 
 import java.io.BufferedOutputStream;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
 import java.io.File;
 import java.io.FileOutputStream;
 import java.io.IOException;
@@ -33,6 +35,7 @@ import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collections;
+import java.util.Comparator;
 import java.util.HashMap;
 import java.util.HashSet;
 import java.util.LinkedList;
@@ -40,13 +43,14 @@ import java.util.List;
 import java.util.Map;
 import java.util.Map.Entry;
 import java.util.Objects;
-import java.util.Random;
 import java.util.Set;
 import java.util.TreeSet;
+import java.util.concurrent.Callable;
 import java.util.concurrent.Executor;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
 import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
 
 import org.apache.commons.io.FileUtils;
 import org.apache.commons.lang3.tuple.Triple;
@@ -62,6 +66,7 @@ import org.robovm.compiler.hash.ModifiedUtf8HashFunction;
 import org.robovm.compiler.llvm.Alias;
 import org.robovm.compiler.llvm.ArrayConstant;
 import org.robovm.compiler.llvm.ArrayConstantBuilder;
+import org.robovm.compiler.llvm.Br;
 import org.robovm.compiler.llvm.Constant;
 import org.robovm.compiler.llvm.ConstantBitcast;
 import org.robovm.compiler.llvm.ConstantGetelementptr;
@@ -70,7 +75,10 @@ import org.robovm.compiler.llvm.FunctionDeclaration;
 import org.robovm.compiler.llvm.FunctionRef;
 import org.robovm.compiler.llvm.FunctionType;
 import org.robovm.compiler.llvm.Global;
+import org.robovm.compiler.llvm.Icmp;
+import org.robovm.compiler.llvm.Icmp.Condition;
 import org.robovm.compiler.llvm.IntegerConstant;
+import org.robovm.compiler.llvm.Label;
 import org.robovm.compiler.llvm.NullConstant;
 import org.robovm.compiler.llvm.Ret;
 import org.robovm.compiler.llvm.StructureConstant;
@@ -78,12 +86,18 @@ import org.robovm.compiler.llvm.StructureConstantBuilder;
 import org.robovm.compiler.llvm.Type;
 import org.robovm.compiler.llvm.Unreachable;
 import org.robovm.compiler.llvm.Value;
+import org.robovm.compiler.llvm.Variable;
 import org.robovm.compiler.plugin.CompilerPlugin;
+import org.robovm.compiler.profile.Profile;
+import org.robovm.compiler.util.DigestUtil;
+import org.robovm.compiler.util.ToolchainUtil;
 import org.robovm.llvm.Context;
 import org.robovm.llvm.Module;
 import org.robovm.llvm.PassManager;
+import org.robovm.llvm.PassManagerBuilder;
 import org.robovm.llvm.Target;
 import org.robovm.llvm.TargetMachine;
+import org.robovm.llvm.binding.Attribute;
 import org.robovm.llvm.binding.CodeGenFileType;
 import org.robovm.llvm.binding.RelocMode;
 
@@ -93,6 +107,26 @@ import org.robovm.llvm.binding.RelocMode;
 public class Linker {
 
     private static final TypeInfo[] EMPTY_TYPE_INFOS = new TypeInfo[0];
+    // Must match the size of the cache in isinstance_interface() in header.ll
+    private static final int INTERFACE_TYPE_CACHE_SIZE = 8;
+    // Virtual methods with more implementations are called through the vtable/itable
+    private static final int MAX_DEVIRTUALIZED_IMPLEMENTATIONS = 3;
+    // Same as the threshold used by LLVM's inliner at -O2
+    private static final int WHOLE_PROGRAM_INLINE_THRESHOLD = 225;
+    // Number of partially linked object files the class object files are grouped into by incremental linking
+    private static final int PARTIAL_LINK_GROUPS = 64;
+    /**
+     * Classes (and packages if ending with '/') with methods which must never
+     * be inlined in whole program mode since they walk the call stack to find
+     * their caller (e.g. {@code Class.forName()}) or rely on their own frame
+     * being on the stack.
+     */
+    private static final String[] NEVER_INLINE = {
+        "java/lang/Class", "java/lang/ClassLoader", "java/lang/Runtime", 
+        "java/lang/System", "java/lang/Thread", "java/lang/Throwable",
+        "java/lang/reflect/", "java/security/", "dalvik/system/VMStack", 
+        "org/robovm/rt/VM", "sun/reflect/"
+    };
 
     private static class TypeInfo implements Comparable<TypeInfo> {
         boolean error;
@@ -138,6 +172,23 @@ public class Linker {
         }
     }
 
+    /**
+     * State shared by the tasks generating the linker modules in parallel.
+     * The collections are never modified once the tasks have been started.
+     */
+    private static class ModuleState {
+        Map<ClazzInfo, TypeInfo> typeInfos;
+        final Set<String> checkcasts = new HashSet<>();
+        final Set<String> instanceofs = new HashSet<>();
+        final Set<String> reachableMethods = new HashSet<>();
+        // Name and descriptor of all methods invoked virtually
+        final Set<String> invokedMethods = new HashSet<>();
+        ClassHierarchy hierarchy;
+        final AtomicInteger totalMethodCount = new AtomicInteger();
+        final AtomicInteger reachableMethodCount = new AtomicInteger();
+        final AtomicInteger devirtualizedMethodCount = new AtomicInteger();
+    }
+
     private final Config config;
     private final Map<String, byte[]> runtimeData = new HashMap<>();
 
@@ -193,6 +244,7 @@ public class Linker {
         Set<Clazz> linkClasses = new TreeSet<Clazz>(classes);
         config.getLogger().info("Linking %d classes (%s %s %s)", linkClasses.size(),
                 os, arch, config.isDebug() ? "debug" : "release");
+        long start = System.currentTimeMillis();
 
         ModuleBuilder mb = new ModuleBuilder();
         mb.addInclude(getClass().getClassLoader().getResource(String.format("header-%s-%s.ll", os.getFamily(), arch)));
@@ -276,6 +328,9 @@ public class Linker {
         if (config.getMainClass() != null) {
             mb.addGlobal(new Global("_bcMainClass", mb.getString(config.getMainClass())));
         }
+        if (config.isZeroCostExceptions()) {
+            mb.addGlobal(new Global("_bcZeroCostExceptions", new IntegerConstant((byte) 1)));
+        }
 
         ModuleBuilder[] mbs = new ModuleBuilder[config.getThreads() + 1];
         FunctionRef[] stubRefs = new FunctionRef[mbs.length];
@@ -301,149 +356,319 @@ public class Linker {
         
         mb.addGlobal(new Global("_bcStrippedMethodStubs", stubRefsArray.build()));
         
-        Random rnd = new Random();
-
         buildTypeInfos(typeInfos);
         
-        Set<String> checkcasts = new HashSet<>();
-        Set<String> instanceofs = new HashSet<>();
+        final ModuleState state = new ModuleState();
+        state.typeInfos = typeInfos;
         Set<String> invokes = new HashSet<>();
         for (Clazz clazz : linkClasses) {
             ClazzInfo ci = clazz.getClazzInfo();
-            checkcasts.addAll(ci.getCheckcasts());
-            instanceofs.addAll(ci.getInstanceofs());
+            state.checkcasts.addAll(ci.getCheckcasts());
+            state.instanceofs.addAll(ci.getInstanceofs());
             invokes.addAll(ci.getInvokes());
         }
 
-        Set<String> reachableMethods = new HashSet<>();
         for (Triple<String, String, String> node : config.getDependencyGraph().findReachableMethods()) {
-            reachableMethods.add(node.getLeft() + "." + node.getMiddle() + node.getRight());
+            state.reachableMethods.add(node.getLeft() + "." + node.getMiddle() + node.getRight());
         }
         
-        int totalMethodCount = 0;
-        int reachableMethodCount = 0;
-        for (Clazz clazz : linkClasses) {
-            int mbIdx = rnd.nextInt(mbs.length - 1) + 1;
-            ClazzInfo ci = clazz.getClazzInfo();
+        for (String invoke : invokes) {
+            state.invokedMethods.add(invoke.substring(invoke.lastIndexOf('.', invoke.indexOf('(')) + 1));
+        }
+        state.hierarchy = config.isDebug() ? null : new ClassHierarchy(linkClasses);
 
-            // Create strong stubs for unused methods which override the weak
-            // ones generated by ClassCompiler. This must be done before we
-            // override lookup functions below otherwise we may get duplicate
-            // symbols errors.
-            for (MethodInfo mi : ci.getMethods()) {
-                if (!mi.isAbstract()) { 
-                    totalMethodCount++;
-                    if (!reachableMethods.contains(clazz.getInternalName() + "." + mi.getName() + mi.getDesc())) {
-                        createStrippedMethodStub(stubRefs[mbIdx], mbs[mbIdx], clazz, mi);
-                    } else {
-                        reachableMethodCount++;
+        // Distribute the classes evenly over the linker modules and generate
+        // the modules in parallel. Each task only adds to its own module and
+        // only reads the state shared with the other tasks.
+        final List<List<Clazz>> buckets = new ArrayList<>();
+        for (int i = 1; i < mbs.length; i++) {
+            buckets.add(new ArrayList<Clazz>());
+        }
+        int classIdx = 0;
+        for (Clazz clazz : linkClasses) {
+            buckets.get(classIdx++ % buckets.size()).add(clazz);
+        }
+        List<Callable<Void>> tasks = new ArrayList<>();
+        for (int i = 1; i < mbs.length; i++) {
+            final ModuleBuilder moduleBuilder = mbs[i];
+            final FunctionRef stubRef = stubRefs[i];
+            final List<Clazz> bucket = buckets.get(i - 1);
+            tasks.add(new Callable<Void>() {
+                public Void call() throws Exception {
+                    for (Clazz clazz : bucket) {
+                        addClass(moduleBuilder, stubRef, clazz, state);
                     }
+                    return null;
                 }
-            }
+            });
+        }
+        execute(tasks);
+        config.getLogger().info("Generated %d linker modules in %.2f seconds", mbs.length,
+                (System.currentTimeMillis() - start) / 1000.0);
+
+        config.getLogger().info("%d methods out of %d included in the executable",
+                state.reachableMethodCount.get(), state.totalMethodCount.get());
+        if (state.hierarchy != null) {
+            config.getLogger().info("%d virtual methods devirtualized", state.devirtualizedMethodCount.get());
+        }
 
-            TypeInfo typeInfo = typeInfos.get(ci);
-            if (typeInfo.error) {
-                // Add an empty TypeInfo
-                mb.addGlobal(new Global(Symbols.typeInfoSymbol(clazz.getInternalName()),
-                        new StructureConstantBuilder()
-                                .add(new IntegerConstant(typeInfo.id))
-                                .add(new IntegerConstant(0))
-                                .add(new IntegerConstant(-1))
-                                .add(new IntegerConstant(0))
-                                .add(new IntegerConstant(0))
-                                .build()));
-            } else {
-                int[] classIds = new int[typeInfo.classTypes.length];
-                for (int i = 0; i < typeInfo.classTypes.length; i++) {
-                    classIds[i] = typeInfo.classTypes[i].id;
-                }
-                int[] interfaceIds = new int[typeInfo.interfaceTypes.length];
-                for (int i = 0; i < typeInfo.interfaceTypes.length; i++) {
-                    interfaceIds[i] = typeInfo.interfaceTypes[i].id;
+        List<File> objectFiles = new ArrayList<File>();
+
+        start = System.currentTimeMillis();
+        if (config.isWholeProgramOptimization()) {
+            Set<String> inlinableMethods = new HashSet<>();
+            Set<String> hotMethods = new HashSet<>();
+            Profile profile = config.getProfile();
+            for (Clazz clazz : linkClasses) {
+                if (!isInlinable(clazz)) {
+                    continue;
                 }
-                mb.addGlobal(new Global(Symbols.typeInfoSymbol(clazz.getInternalName()),
-                        new StructureConstantBuilder()
-                                .add(new IntegerConstant(typeInfo.id))
-                                .add(new IntegerConstant((typeInfo.classTypes.length - 1) * 4 + 5 * 4))
-                                .add(new IntegerConstant(-1))
-                                .add(new IntegerConstant(typeInfo.classTypes.length))
-                                .add(new IntegerConstant(typeInfo.interfaceTypes.length))
-                                .add(new ArrayConstantBuilder(I32).add(classIds).build())
-                                .add(new ArrayConstantBuilder(I32).add(interfaceIds).build())
-                                .build()));
-
-                if (!config.isDebug() && !ci.isInterface() && !ci.isFinal() && typeInfo.children.isEmpty()) {
-                    // Non-final class with 0 children. Override every lookup
-                    // function with one
-                    // which doesn't do any lookup.
-                    for (MethodInfo mi : ci.getMethods()) {
-                        String name = mi.getName();
-                        if (!name.equals("<clinit>") && !name.equals("<init>")
-                                && !mi.isPrivate() && !mi.isStatic() && !mi.isFinal() && !mi.isAbstract()) {
-
-                            if (invokes.contains(clazz.getInternalName() + "." + name + mi.getDesc())) {
-                                if (reachableMethods.contains(clazz.getInternalName() + "." + name + mi.getDesc())) {
-                                    mbs[mbIdx].addFunction(createLookup(mbs[mbIdx], ci, mi));
-                                }
-                            }
+                for (MethodInfo mi : clazz.getClazzInfo().getMethods()) {
+                    if (!mi.isAbstract() && !mi.isNative() && !mi.isCallback()) {
+                        String symbol = methodSymbol(clazz.getInternalName(), mi.getName(), mi.getDesc());
+                        inlinableMethods.add(symbol);
+                        if (profile != null && profile.isHot(clazz.getInternalName(), mi.getName(), mi.getDesc())) {
+                            hotMethods.add(symbol);
                         }
                     }
                 }
             }
+            objectFiles.add(generateMachineCode(config, mb, 0));
+            objectFiles.add(generateWholeProgramMachineCode(config, 
+                    Arrays.copyOfRange(mbs, 1, mbs.length), linkClasses, inlinableMethods, hotMethods));
+            // The lines files contain address offsets into the code of the
+            // class .o files and can't be used with the whole program .o.
+        } else {
+            objectFiles.addAll(generateMachineCode(config, mbs));
+        }
+        config.getLogger().info("Generated machine code for %d linker modules in %.2f seconds", mbs.length,
+                (System.currentTimeMillis() - start) / 1000.0);
 
-            if (checkcasts.contains(clazz.getInternalName())) {
-                mbs[mbIdx].addFunction(createCheckcast(mbs[mbIdx], clazz, typeInfo));
-            }
-            if (instanceofs.contains(clazz.getInternalName())) {
-                mbs[mbIdx].addFunction(createInstanceof(mbs[mbIdx], clazz, typeInfo));
+        if (!config.isWholeProgramOptimization()) {
+            if (config.isIncrementalLinking()) {
+                objectFiles.addAll(partialLink(linkClasses));
+            } else {
+                for (Clazz clazz : linkClasses) {
+                    objectFiles.add(config.getOFile(clazz));
+                }
+
+                /*
+                 * Assemble the lines files for all linked classes into the module.
+                 */
+                for (Clazz clazz : linkClasses) {
+                    File f = config.getLinesOFile(clazz);
+                    if (f.exists() && f.length() > 0) {
+                        objectFiles.add(f);
+                    }
+                }
             }
         }
-        config.getLogger().info("%d methods out of %d included in the executable", reachableMethodCount, totalMethodCount);
 
-        List<File> objectFiles = new ArrayList<File>();
+        start = System.currentTimeMillis();
+        config.getTarget().build(objectFiles);
+        config.getLogger().info("Built binary from %d object files in %.2f seconds", objectFiles.size(),
+                (System.currentTimeMillis() - start) / 1000.0);
+    }
 
-        generateMachineCode(config, mbs, objectFiles);
+    /**
+     * Links the object files of the specified classes into
+     * {@link #PARTIAL_LINK_GROUPS} relocatable object files. Classes are
+     * assigned to groups by the hashes of their names so that a class always
+     * ends up in the same group. The object file of a group is cached in
+     * {@link Config#getCacheDir()} and only linked again if any of the
+     * object files in the group has changed or if classes have been added
+     * to or removed from the group.
+     */
+    private List<File> partialLink(Set<Clazz> linkClasses) throws IOException {
+        long start = System.currentTimeMillis();
 
-        for (Clazz clazz : linkClasses) {
-            objectFiles.add(config.getOFile(clazz));
+        final List<List<File>> groups = new ArrayList<>();
+        for (int i = 0; i < PARTIAL_LINK_GROUPS; i++) {
+            groups.add(new ArrayList<File>());
         }
-
-        /*
-         * Assemble the lines files for all linked classes into the module.
-         */
         for (Clazz clazz : linkClasses) {
+            List<File> group = groups.get((clazz.getInternalName().hashCode() & 0x7fffffff) % PARTIAL_LINK_GROUPS);
+            group.add(config.getOFile(clazz));
             File f = config.getLinesOFile(clazz);
             if (f.exists() && f.length() > 0) {
-                objectFiles.add(f);
+                group.add(f);
             }
         }
 
-        config.getTarget().build(objectFiles);
+        final File dir = new File(config.getCacheDir(), "linker");
+        dir.mkdirs();
+        config.getTmpDir().mkdirs();
+        final List<File> result = new ArrayList<>();
+        final AtomicInteger linkedCount = new AtomicInteger();
+        List<Callable<Void>> tasks = new ArrayList<>();
+        for (int i = 0; i < groups.size(); i++) {
+            final List<File> group = groups.get(i);
+            if (group.isEmpty()) {
+                continue;
+            }
+            StringBuilder sb = new StringBuilder();
+            for (File f : group) {
+                sb.append(f.getAbsolutePath()).append(' ').append(f.lastModified())
+                    .append(' ').append(f.length()).append('\n');
+            }
+            final String prefix = "group" + i + "-";
+            final File groupO = new File(dir, prefix + DigestUtil.sha1(sb.toString()) + ".o");
+            result.add(groupO);
+            if (groupO.exists()) {
+                continue;
+            }
+            tasks.add(new Callable<Void>() {
+                public Void call() throws Exception {
+                    File tmpO = new File(config.getTmpDir(), groupO.getName());
+                    ToolchainUtil.partialLink(config, prefix + "partial", group, tmpO);
+                    // Remove the outdated object files of this group
+                    for (File f : dir.listFiles()) {
+                        if (f.getName().startsWith(prefix)) {
+                            f.delete();
+                        }
+                    }
+                    FileUtils.moveFile(tmpO, groupO);
+                    linkedCount.incrementAndGet();
+                    return null;
+                }
+            });
+        }
+        execute(tasks);
+
+        config.getLogger().info("Linked %d of %d class object groups in %.2f seconds", linkedCount.get(),
+                result.size(), (System.currentTimeMillis() - start) / 1000.0);
+        return result;
     }
 
-    private void generateMachineCode(final Config config, ModuleBuilder[] mbs,
-            final List<File> objectFiles) throws IOException {
+    /**
+     * Adds the stubs of stripped methods, the type info, the devirtualized
+     * lookup functions and the checkcast and instanceof functions of the
+     * specified class to the specified linker module.
+     */
+    private void addClass(ModuleBuilder mb, FunctionRef stubRef, Clazz clazz, ModuleState state) {
+        ClazzInfo ci = clazz.getClazzInfo();
+
+        // Create strong stubs for unused methods which override the weak
+        // ones generated by ClassCompiler. This must be done before we
+        // override lookup functions below otherwise we may get duplicate
+        // symbols errors.
+        for (MethodInfo mi : ci.getMethods()) {
+            if (!mi.isAbstract()) { 
+                state.totalMethodCount.incrementAndGet();
+                if (!state.reachableMethods.contains(clazz.getInternalName() + "." + mi.getName() + mi.getDesc())) {
+                    createStrippedMethodStub(stubRef, mb, clazz, mi);
+                } else {
+                    state.reachableMethodCount.incrementAndGet();
+                }
+            }
+        }
+
+        TypeInfo typeInfo = state.typeInfos.get(ci);
+        if (typeInfo.error) {
+            // Add an empty TypeInfo
+            mb.addGlobal(new Global(Symbols.typeInfoSymbol(clazz.getInternalName()),
+                    new StructureConstantBuilder()
+                            .add(new IntegerConstant(typeInfo.id))
+                            .add(new IntegerConstant(0))
+                            .add(new IntegerConstant(-1))
+                            .add(new IntegerConstant(0))
+                            .add(new IntegerConstant(0))
+                            .build()));
+        } else {
+            int[] classIds = new int[typeInfo.classTypes.length];
+            for (int i = 0; i < typeInfo.classTypes.length; i++) {
+                classIds[i] = typeInfo.classTypes[i].id;
+            }
+            int[] interfaceIds = new int[typeInfo.interfaceTypes.length];
+            for (int i = 0; i < typeInfo.interfaceTypes.length; i++) {
+                interfaceIds[i] = typeInfo.interfaceTypes[i].id;
+            }
+            mb.addGlobal(new Global(Symbols.typeInfoSymbol(clazz.getInternalName()),
+                    new StructureConstantBuilder()
+                            .add(new IntegerConstant(typeInfo.id))
+                            .add(new IntegerConstant((typeInfo.classTypes.length - 1) * 4 + 5 * 4))
+                            .add(new IntegerConstant(-1))
+                            .add(new IntegerConstant(typeInfo.classTypes.length))
+                            .add(new IntegerConstant(typeInfo.interfaceTypes.length))
+                            .add(new ArrayConstantBuilder(I32).add(classIds).build())
+                            .add(new ArrayConstantBuilder(I32).add(interfaceIds).build())
+                            .build()));
+
+            if (state.hierarchy != null && !ci.isFinal() && !isProxySupertype(ci)) {
+                // Override the lookup functions of virtual methods with
+                // only a few implementations in the linked classes with
+                // ones which call the implementations directly.
+                for (MethodInfo mi : ci.getMethods()) {
+                    String name = mi.getName();
+                    if (!name.equals("<clinit>") && !name.equals("<init>")
+                            && !mi.isPrivate() && !mi.isStatic() && !mi.isFinal()
+                            && state.invokedMethods.contains(name + mi.getDesc())) {
+
+                        Map<ClazzInfo, MethodInfo> impls = 
+                                state.hierarchy.findImplementations(ci, mi, MAX_DEVIRTUALIZED_IMPLEMENTATIONS);
+                        Function fn = createDevirtualizedLookup(mb, ci, mi, impls, 
+                                state.typeInfos, state.reachableMethods);
+                        if (fn != null) {
+                            mb.addFunction(fn);
+                            if (ci.isInterface()) {
+                                // Makes call sites skip the inline cache. See MethodCompiler.
+                                mb.addGlobal(new Global(devirtualizedSymbol(
+                                        clazz.getInternalName(), name, mi.getDesc()),
+                                        new IntegerConstant((byte) 1), true));
+                            }
+                            state.devirtualizedMethodCount.incrementAndGet();
+                        }
+                    }
+                }
+            }
+        }
+
+        if (state.checkcasts.contains(clazz.getInternalName())) {
+            mb.addFunction(createCheckcast(mb, clazz, typeInfo));
+        }
+        if (state.instanceofs.contains(clazz.getInternalName())) {
+            mb.addFunction(createInstanceof(mb, clazz, typeInfo));
+        }
+    }
 
+    private List<File> generateMachineCode(final Config config, ModuleBuilder[] mbs) throws IOException {
         /*
          * Make sure the tmpDir exists before we launch the worker threads. This
          * is to prevent a race between threads to create this folder. See #631.
          */
         config.getTmpDir().mkdirs();
 
+        final File[] objectFiles = new File[mbs.length];
+        List<Callable<Void>> tasks = new ArrayList<>();
+        for (int i = 0; i < mbs.length; i++) {
+            final ModuleBuilder mb = mbs[i];
+            final int num = i;
+            tasks.add(new Callable<Void>() {
+                public Void call() throws Exception {
+                    objectFiles[num] = generateMachineCode(config, mb, num);
+                    return null;
+                }
+            });
+        }
+        execute(tasks);
+        return Arrays.asList(objectFiles);
+    }
+
+    /**
+     * Runs the specified tasks using {@link Config#getThreads()} threads and
+     * waits for all of them to complete. Rethrows the first exception thrown
+     * by any of the tasks.
+     */
+    private void execute(List<Callable<Void>> tasks) throws IOException {
         Executor executor = config.getThreads() <= 1 ? AppCompiler.SAME_THREAD_EXECUTOR
                 : Executors.newFixedThreadPool(config.getThreads());
 
         final List<Throwable> errors = Collections.synchronizedList(new ArrayList<Throwable>());
-        for (int i = 0; i < mbs.length; i++) {
-            final ModuleBuilder mb = mbs[i];
-            final int num = i;
+        for (final Callable<Void> task : tasks) {
             executor.execute(new Runnable() {
                 public void run() {
                     try {
-                        File linkerO = generateMachineCode(config, mb, num);
-                        synchronized (objectFiles) {
-                            objectFiles.add(linkerO);
-                        }
+                        task.call();
                     } catch (Throwable t) {
                         errors.add(t);
                     }
@@ -469,6 +694,9 @@ public class Linker {
             if (t instanceof RuntimeException) {
                 throw (RuntimeException) t;
             }
+            if (t instanceof Error) {
+                throw (Error) t;
+            }
             throw new CompilerException(t);
         }
     }
@@ -486,6 +714,7 @@ public class Linker {
                 FileUtils.writeStringToFile(linkerLl, ir, "utf-8");
             }
             try (Module module = Module.parseIR(context, ir, "linker" + num + ".ll")) {
+                ClassCompiler.prepareForUnwinding(config, module);
                 try (PassManager passManager = new PassManager()) {
                     passManager.addAlwaysInlinerPass();
                     passManager.addPromoteMemoryToRegisterPass();
@@ -522,6 +751,118 @@ public class Linker {
         return linkerO;
     }
 
+    private static boolean isInlinable(Clazz clazz) {
+        String name = clazz.getInternalName();
+        for (String s : NEVER_INLINE) {
+            if (s.endsWith("/") ? name.startsWith(s) : name.equals(s)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Links the bitcode of all classes written by the {@link ClassCompiler}
+     * and the specified linker modules into a single module, optimizes it
+     * and compiles it into a single object file which replaces the class
+     * object files. The strong stripped method stubs and lookup functions in
+     * the linker modules replace the weak definitions in the class modules
+     * when linking. The remaining weak method, lookup and trampoline target
+     * functions are then made external and the {@code noinline} attribute is
+     * removed from {@code inlinableMethods} which lets the inliner inline
+     * methods and resolved virtual calls across classes. {@code hotMethods}
+     * are also given the {@code inlinehint} attribute. This is what lets the
+     * direct calls at profile guarded call sites be inlined.
+     */
+    private File generateWholeProgramMachineCode(Config config, ModuleBuilder[] mbs, 
+            Set<Clazz> classes, Set<String> inlinableMethods, Set<String> hotMethods) throws IOException {
+
+        long start = System.currentTimeMillis();
+        File wholeProgramO = new File(config.getTmpDir(), "wholeprogram.o");
+        wholeProgramO.getParentFile().mkdirs();
+
+        try (Context context = new Context()) {
+            try (Module module = Module.parseIR(context, mbs[0].build().toString(), "linker1.ll")) {
+                for (int i = 1; i < mbs.length; i++) {
+                    try (Module m = Module.parseIR(context, mbs[i].build().toString(), "linker" + (i + 1) + ".ll")) {
+                        module.link(m);
+                    }
+                }
+                for (Clazz clazz : classes) {
+                    byte[] bc = FileUtils.readFileToByteArray(config.getBcFile(clazz));
+                    try (Module m = Module.parseIR(context, bc, clazz.getClassName())) {
+                        module.link(m);
+                    }
+                }
+
+                ClassCompiler.prepareForUnwinding(config, module);
+                for (org.robovm.llvm.Function f : module.getFunctions()) {
+                    String name = f.getName();
+                    if (!name.startsWith(EXTERNAL_SYMBOL_PREFIX) && !name.startsWith(INTERNAL_SYMBOL_PREFIX)) {
+                        continue;
+                    }
+                    if (f.getLinkage() == org.robovm.llvm.binding.Linkage.WeakAnyLinkage) {
+                        // Weak functions may be overridden at link time and
+                        // are never inlined. All overrides have been linked in
+                        // above so these are the final definitions.
+                        f.setLinkage(org.robovm.llvm.binding.Linkage.ExternalLinkage);
+                    }
+                    if (inlinableMethods.contains(name)) {
+                        f.removeAttribute(Attribute.NoInlineAttribute);
+                        if (hotMethods.contains(name)) {
+                            f.addAttribute(Attribute.InlineHintAttribute);
+                        }
+                    }
+                }
+
+                try (PassManager passManager = new PassManager()) {
+                    try (PassManagerBuilder builder = new PassManagerBuilder()) {
+                        builder.setSetOptLevel(2);
+                        builder.setDisableTailCalls(true);
+                        builder.useInlinerWithThreshold(WHOLE_PROGRAM_INLINE_THRESHOLD);
+                        builder.populateModulePassManager(passManager);
+                    }
+                    passManager.run(module);
+                }
+
+                if (config.isDumpIntermediates()) {
+                    module.writeBitcode(new File(config.getTmpDir(), "wholeprogram.bc"));
+                }
+
+                String triple = config.getTriple();
+                Target target = Target.lookupTarget(triple);
+                try (TargetMachine targetMachine = target.createTargetMachine(triple,
+                        config.getArch().getLlvmCpu(), null, null, RelocMode.RelocPIC, null)) {
+                    targetMachine.setAsmVerbosityDefault(true);
+                    targetMachine.setFunctionSections(true);
+                    targetMachine.setDataSections(true);
+                    targetMachine.getOptions().setNoFramePointerElim(true);
+                    // NOTE: Doesn't have any effect on x86. See #503.
+                    targetMachine.getOptions().setPositionIndependentExecutable(true);
+
+                    ByteArrayOutputStream output = new ByteArrayOutputStream(16 * 1024 * 1024);
+                    targetMachine.emit(module, output, CodeGenFileType.AssemblyFile);
+                    byte[] asm = output.toByteArray();
+                    output.reset();
+                    ClassCompiler.patchAsmWithFunctionSizes(config, classes, new ByteArrayInputStream(asm), output);
+                    asm = output.toByteArray();
+
+                    if (config.isDumpIntermediates()) {
+                        FileUtils.writeByteArrayToFile(new File(config.getTmpDir(), "wholeprogram.s"), asm);
+                    }
+
+                    try (OutputStream outO = new BufferedOutputStream(new FileOutputStream(wholeProgramO))) {
+                        targetMachine.assemble(asm, "wholeprogram", outO);
+                    }
+                }
+            }
+        }
+
+        config.getLogger().info("Whole program optimization of %d classes took %d ms", 
+                classes.size(), System.currentTimeMillis() - start);
+        return wholeProgramO;
+    }
+
     private TypeInfo buildTypeInfo(TypeInfo typeInfo, Map<ClazzInfo, TypeInfo> typeInfos) {
         if (typeInfo.error || typeInfo.classTypes != null) {
             return typeInfo;
@@ -666,6 +1007,19 @@ public class Linker {
         mb.addAlias(alias);
     }
     
+    /**
+     * Creates the cache of {@code TypeInfo}s known to implement an interface
+     * used by the inline interface type checks in header.ll.
+     */
+    private Constant createInterfaceTypeCache(ModuleBuilder mb) {
+        ArrayConstantBuilder entries = new ArrayConstantBuilder(I8_PTR);
+        for (int i = 0; i < INTERFACE_TYPE_CACHE_SIZE; i++) {
+            entries.add(new NullConstant(I8_PTR));
+        }
+        Global cache = mb.newGlobal(entries.build());
+        return new ConstantBitcast(cache.ref(), I8_PTR);
+    }
+
     private Function createCheckcast(ModuleBuilder mb, Clazz clazz, TypeInfo typeInfo) {
         Function fn = FunctionBuilder.checkcast(clazz);
         Value info = getInfoStruct(mb, fn, clazz);
@@ -682,7 +1036,8 @@ public class Linker {
         } else {
             Value result = call(fn, CHECKCAST_INTERFACE, fn.getParameterRef(0), info,
                     fn.getParameterRef(1),
-                    new IntegerConstant(typeInfo.id));
+                    new IntegerConstant(typeInfo.id),
+                    createInterfaceTypeCache(mb));
             fn.add(new Ret(result));
         }
         return fn;
@@ -704,14 +1059,91 @@ public class Linker {
         } else {
             Value result = call(fn, INSTANCEOF_INTERFACE, fn.getParameterRef(0), info,
                     fn.getParameterRef(1),
-                    new IntegerConstant(typeInfo.id));
+                    new IntegerConstant(typeInfo.id),
+                    createInterfaceTypeCache(mb));
             fn.add(new Ret(result));
         }
         return fn;
     }
 
-    private Function createLookup(ModuleBuilder mb, ClazzInfo ci, MethodInfo mi) {
+    /**
+     * Returns {@code true} if proxy classes created at runtime may be 
+     * subclasses of the specified class.
+     */
+    private static boolean isProxySupertype(ClazzInfo ci) {
+        return ci.getInternalName().equals("java/lang/Object") 
+                || ci.getInternalName().equals("java/lang/reflect/Proxy");
+    }
+
+    /**
+     * Creates a lookup function for the virtual method {@code mi} declared
+     * by {@code ci} which calls the specified implementations directly. The
+     * receiver is tested against the classes declaring the implementations
+     * starting with the most derived class. Since every linked class calls
+     * one of the implementations the last test can be skipped for classes.
+     * For interfaces all tests are made and the itable dispatch function is
+     * called if none matches (e.g. when the receiver is a proxy). Returns
+     * {@code null} if the implementations are unknown or if an
+     * implementation has been stripped.
+     */
+    private Function createDevirtualizedLookup(ModuleBuilder mb, ClazzInfo ci, MethodInfo mi, 
+            Map<ClazzInfo, MethodInfo> impls, final Map<ClazzInfo, TypeInfo> typeInfos, Set<String> reachableMethods) {
+
+        if (impls == null || impls.isEmpty()) {
+            return null;
+        }
+        List<ClazzInfo> implClasses = new ArrayList<>(impls.keySet());
+        for (ClazzInfo implCi : implClasses) {
+            TypeInfo typeInfo = typeInfos.get(implCi);
+            MethodInfo implMi = impls.get(implCi);
+            if (typeInfo == null || typeInfo.error || isProxySupertype(implCi)
+                    || !reachableMethods.contains(implCi.getInternalName() + "." 
+                            + implMi.getName() + implMi.getDesc())) {
+                return null;
+            }
+        }
+        Collections.sort(implClasses, new Comparator<ClazzInfo>() {
+            public int compare(ClazzInfo o1, ClazzInfo o2) {
+                int depth1 = typeInfos.get(o1).classTypes.length;
+                int depth2 = typeInfos.get(o2).classTypes.length;
+                return depth1 > depth2 ? -1 : (depth1 == depth2 ? 0 : 1);
+            }
+        });
+
         Function function = FunctionBuilder.lookup(ci, mi, false);
+        for (int i = 0; i < implClasses.size(); i++) {
+            ClazzInfo implCi = implClasses.get(i);
+            FunctionRef target = getImplementationRef(mb, function, implCi, impls.get(implCi));
+            if (i == implClasses.size() - 1 && !ci.isInterface()) {
+                function.add(new Ret(tailcall(function, target, function.getParameterRefs())));
+                return function;
+            }
+            TypeInfo typeInfo = typeInfos.get(implCi);
+            Value isInstance = call(function, INSTANCEOF_CLASS, function.getParameterRef(0), 
+                    getInfoStruct(mb, function, implCi.getClazz()), function.getParameterRef(1),
+                    new IntegerConstant((typeInfo.classTypes.length - 1) * 4 + 5 * 4),
+                    new IntegerConstant(typeInfo.id));
+            Variable matches = function.newVariable(I1);
+            function.add(new Icmp(matches, Condition.ne, isInstance, new IntegerConstant(0)));
+            Label matchLabel = new Label();
+            Label nextLabel = new Label();
+            function.add(new Br(matches.ref(), function.newBasicBlockRef(matchLabel), 
+                    function.newBasicBlockRef(nextLabel)));
+            function.newBasicBlock(matchLabel);
+            function.add(new Ret(tailcall(function, target, function.getParameterRefs())));
+            function.newBasicBlock(nextLabel);
+        }
+
+        FunctionRef dispatch = new FunctionRef(
+                dispatchSymbol(ci.getInternalName(), mi.getName(), mi.getDesc()), function.getType());
+        if (!mb.hasSymbol(dispatch.getName())) {
+            mb.addFunctionDeclaration(new FunctionDeclaration(dispatch));
+        }
+        function.add(new Ret(tailcall(function, dispatch, function.getParameterRefs())));
+        return function;
+    }
+
+    private FunctionRef getImplementationRef(ModuleBuilder mb, Function function, ClazzInfo ci, MethodInfo mi) {
         String targetFnName = mi.isSynchronized()
                 ? Symbols.synchronizedWrapperSymbol(ci.getInternalName(), mi.getName(), mi.getDesc())
                 : Symbols.methodSymbol(ci.getInternalName(), mi.getName(), mi.getDesc());
@@ -720,9 +1152,7 @@ public class Linker {
         if (!mb.hasSymbol(fn.getName())) {
             mb.addFunctionDeclaration(new FunctionDeclaration(fn));
         }
-        Value result = tailcall(function, fn, function.getParameterRefs());
-        function.add(new Ret(result));
-        return function;
+        return fn;
     }
 
     private Value getInfoStruct(ModuleBuilder mb, Function f, Clazz clazz) {
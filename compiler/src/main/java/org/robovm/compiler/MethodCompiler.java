@@ -23,17 +23,25 @@ import static org.robovm.compiler.llvm.Linkage.*;
 import static org.robovm.compiler.llvm.Type.*;
 
 import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Collection;
 import java.util.Collections;
 import java.util.HashMap;
 import java.util.HashSet;
+import java.util.Iterator;
+import java.util.LinkedHashSet;
+import java.util.LinkedList;
 import java.util.List;
 import java.util.Map;
 import java.util.Map.Entry;
 import java.util.Set;
 import java.util.TreeMap;
 
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.clazz.MethodInfo;
 import org.robovm.compiler.config.Config;
+import org.robovm.compiler.config.Config.ProfileInstrumentation;
+import org.robovm.compiler.config.OS;
 import org.robovm.compiler.llvm.Add;
 import org.robovm.compiler.llvm.AliasRef;
 import org.robovm.compiler.llvm.Alloca;
@@ -44,10 +52,14 @@ import org.robovm.compiler.llvm.BasicBlock;
 import org.robovm.compiler.llvm.BasicBlockRef;
 import org.robovm.compiler.llvm.Bitcast;
 import org.robovm.compiler.llvm.Br;
+import org.robovm.compiler.llvm.BranchWeightsMetadata;
 import org.robovm.compiler.llvm.Call;
 import org.robovm.compiler.llvm.Constant;
 import org.robovm.compiler.llvm.ConstantBitcast;
+import org.robovm.compiler.llvm.ConstantGetelementptr;
+import org.robovm.compiler.llvm.ConstantPtrtoint;
 import org.robovm.compiler.llvm.ConstantTrunc;
+import org.robovm.compiler.llvm.Extractvalue;
 import org.robovm.compiler.llvm.Fadd;
 import org.robovm.compiler.llvm.Fdiv;
 import org.robovm.compiler.llvm.FloatingPointConstant;
@@ -57,6 +69,7 @@ import org.robovm.compiler.llvm.Fpext;
 import org.robovm.compiler.llvm.Fptrunc;
 import org.robovm.compiler.llvm.Fsub;
 import org.robovm.compiler.llvm.Function;
+import org.robovm.compiler.llvm.FunctionDeclaration;
 import org.robovm.compiler.llvm.FunctionRef;
 import org.robovm.compiler.llvm.FunctionType;
 import org.robovm.compiler.llvm.Getelementptr;
@@ -69,11 +82,13 @@ import org.robovm.compiler.llvm.IntegerConstant;
 import org.robovm.compiler.llvm.IntegerType;
 import org.robovm.compiler.llvm.Invoke;
 import org.robovm.compiler.llvm.Label;
+import org.robovm.compiler.llvm.Landingpad;
 import org.robovm.compiler.llvm.Load;
 import org.robovm.compiler.llvm.Lshr;
 import org.robovm.compiler.llvm.Mul;
 import org.robovm.compiler.llvm.NullConstant;
 import org.robovm.compiler.llvm.Or;
+import org.robovm.compiler.llvm.Phi;
 import org.robovm.compiler.llvm.PointerType;
 import org.robovm.compiler.llvm.Ret;
 import org.robovm.compiler.llvm.Sext;
@@ -81,6 +96,7 @@ import org.robovm.compiler.llvm.Shl;
 import org.robovm.compiler.llvm.Sitofp;
 import org.robovm.compiler.llvm.Store;
 import org.robovm.compiler.llvm.StructureConstantBuilder;
+import org.robovm.compiler.llvm.StructureType;
 import org.robovm.compiler.llvm.Sub;
 import org.robovm.compiler.llvm.Switch;
 import org.robovm.compiler.llvm.Trunc;
@@ -91,6 +107,8 @@ import org.robovm.compiler.llvm.Variable;
 import org.robovm.compiler.llvm.VariableRef;
 import org.robovm.compiler.llvm.Xor;
 import org.robovm.compiler.llvm.Zext;
+import org.robovm.compiler.profile.Profile.BranchProfile;
+import org.robovm.compiler.profile.Profile.ReceiverProfile;
 import org.robovm.compiler.trampoline.Anewarray;
 import org.robovm.compiler.trampoline.Checkcast;
 import org.robovm.compiler.trampoline.GetField;
@@ -128,6 +146,7 @@ import soot.UnitBox;
 import soot.jimple.AddExpr;
 import soot.jimple.AndExpr;
 import soot.jimple.ArrayRef;
+import soot.jimple.AssignStmt;
 import soot.jimple.BinopExpr;
 import soot.jimple.CastExpr;
 import soot.jimple.CaughtExceptionRef;
@@ -198,15 +217,61 @@ import soot.util.Chain;
  */
 public class MethodCompiler extends AbstractMethodCompiler {
 
+    // Must match PROFILE_COUNTER_* in types.h
+    private static final int PROFILE_COUNTER_METHOD = 0;
+    private static final int PROFILE_COUNTER_BRANCH = 1;
+    // Must match PROFILE_RECEIVER_SLOTS in types.h
+    private static final int PROFILE_RECEIVER_SLOTS = 4;
+    // Must match INLINE_CACHE_SIZE in bc.c
+    private static final int INLINE_CACHE_SIZE = 4;
+    
+    /**
+     * Share of all calls at a virtual call site which must have been made
+     * on the same receiver class for the site to get a guarded direct call.
+     */
+    private static final double GUARDED_CALL_MIN_RATIO = 0.9;
+    private static final long GUARDED_CALL_MIN_COUNT = 100;
+
     private Function function;
     private Map<Unit, List<Trap>> trapsAt;
     private Value env;
     private ModuleBuilder moduleBuilder;
     
     private Variable dims;
+    private Map<Unit, Integer> branchIndexes;
+    private Map<Unit, Integer> callSiteIndexes;
+
+    /**
+     * The landingpad which calls made by the unit being compiled unwind to
+     * or {@code null} if the unit isn't inside a try block or if we're not
+     * compiling with zero-cost exceptions. The tag of the {@link Label} is
+     * the {@link Global} holding the {@code LandingPad} list of the trap set
+     * covering the unit.
+     */
+    private Label currentLandingPad;
+    private Set<Label> usedLandingPads;
+
+    private final EscapeAnalysis escapeAnalysis;
+    /**
+     * The allocations in the method being compiled which don't escape it
+     * mapped to the stack memory used for the allocated object.
+     */
+    private Map<DefinitionStmt, Variable> stackAllocations;
+    /**
+     * The array accesses in loops of the method being compiled which can be
+     * done without checks if the {@link RangeAnalysis.Guard} they map to
+     * holds.
+     */
+    private Map<Stmt, RangeAnalysis.Guard> inBoundsAccesses;
+    /**
+     * The values of the {@link RangeAnalysis.Guard}s which are checked at
+     * runtime. Computed before entering the loops.
+     */
+    private Map<RangeAnalysis.Guard, Variable> rangeGuards;
     
     public MethodCompiler(Config config) {
         super(config);
+        this.escapeAnalysis = new EscapeAnalysis(config);
     }
     
     protected Function doCompile(ModuleBuilder moduleBuilder, SootMethod method) {
@@ -233,6 +298,20 @@ public class MethodCompiler extends AbstractMethodCompiler {
         
         PackManager.v().getPack("jtp").apply(body);
         PackManager.v().getPack("jop").apply(body);
+        inBoundsAccesses = config.isDebug() 
+                ? Collections.<Stmt, RangeAnalysis.Guard>emptyMap() 
+                : RangeAnalysis.findInBoundsAccesses(body);
+        if (!config.isVectorizeLoops()) {
+            // Accesses which need a runtime guard are emitted both checked
+            // and unchecked and LLVM duplicates the loop to hoist the guard.
+            // Only do that when asked to.
+            for (Iterator<RangeAnalysis.Guard> it = inBoundsAccesses.values().iterator(); it.hasNext();) {
+                if (!it.next().isStatic()) {
+                    it.remove();
+                }
+            }
+        }
+        rangeGuards = new HashMap<RangeAnalysis.Guard, Variable>();
         PackManager.v().getPack("jap").apply(body);
 
         if (body.getUnits().getFirst() == prependedNop && prependedNop.getBoxesPointingToThis().isEmpty()) {
@@ -245,6 +324,11 @@ public class MethodCompiler extends AbstractMethodCompiler {
         Map<Unit, List<Unit>> branchTargets = getBranchTargets(body);
         Map<Unit, Integer> trapHandlers = getTrapHandlers(body);
         Map<Unit, Integer> selChanges = new HashMap<Unit, Integer>();
+        boolean zeroCostExceptions = config.isZeroCostExceptions();
+        List<Global> landingPadLists = new ArrayList<>();
+        currentLandingPad = null;
+        usedLandingPads = new LinkedHashSet<>();
+        indexProfiledUnits(units);
         
         int multiANewArrayMaxDims = 0;
         Set<Local> locals = new HashSet<Local>();
@@ -280,12 +364,35 @@ public class MethodCompiler extends AbstractMethodCompiler {
             dims = function.newVariable("dims", new PointerType(new ArrayType(multiANewArrayMaxDims, I32)));
             function.add(new Alloca(dims, new ArrayType(multiANewArrayMaxDims, I32)));
         }
+
+        stackAllocations = new HashMap<DefinitionStmt, Variable>();
+        if (config.isEscapeAnalysis()) {
+            for (Entry<AssignStmt, SootClass> entry : escapeAnalysis.findStackAllocations(clazz, body).entrySet()) {
+                Type type = getStackAllocationType(entry.getKey(), entry.getValue());
+                Variable memory = function.newVariable(new PointerType(type));
+                // Heap objects are 8 byte aligned. The field layout depends on it.
+                function.add(new Alloca(memory, type, 8));
+                stackAllocations.put(entry.getKey(), memory);
+            }
+        }
+        
+        Value profileCounter = null;
+        Value profileStart = null;
+        if (config.getProfileInstrumentation() != ProfileInstrumentation.none) {
+            profileCounter = createProfileCounter(method);
+            if (config.getProfileInstrumentation() == ProfileInstrumentation.timings) {
+                profileStart = call(PROFILE_ENTER, profileCounter);
+            } else {
+                call(PROFILE_COUNT, profileCounter);
+            }
+        }
         
         if (emitCheckStackOverflow) {
             call(CHECK_STACK_OVERFLOW);
         }
         
         Value trycatchContext = null;
+        StructureConstantBuilder landingPadsPtrs = new StructureConstantBuilder();
         if (!body.getTraps().isEmpty()) {
             List<List<Trap>> recordedTraps = new ArrayList<List<Trap>>();
             for (Unit unit : units) {
@@ -298,7 +405,10 @@ public class MethodCompiler extends AbstractMethodCompiler {
                     incoming.addAll(branchTargets.get(unit));
                 }
                 
-                if (unit == units.getFirst() || trapHandlers.containsKey(unit) 
+                // Landingpads are picked while emitting the units in order
+                // rather than at runtime so with zero-cost exceptions every
+                // unit needs an entry.
+                if (zeroCostExceptions || unit == units.getFirst() || trapHandlers.containsKey(unit) 
                         || trapsDiffer(unit, incoming)) {
                     
                     List<Trap> traps = getTrapsAt(unit);
@@ -315,7 +425,6 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 }
             }
             
-            StructureConstantBuilder landingPadsPtrs = new StructureConstantBuilder();
             for (List<Trap> traps : recordedTraps) {
                 StructureConstantBuilder landingPads = new StructureConstantBuilder();
                 for (Trap trap : traps) {
@@ -351,7 +460,11 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 landingPads.add(new StructureConstantBuilder().add(new NullConstant(I8_PTR)).add(new IntegerConstant(0)).build());
                 Global g = moduleBuilder.newGlobal(landingPads.build(), true);
                 landingPadsPtrs.add(new ConstantBitcast(g.ref(), I8_PTR));
+                landingPadLists.add(g);
             }
+        }
+        
+        if (!body.getTraps().isEmpty() && !zeroCostExceptions) {
             Global g = moduleBuilder.newGlobal(landingPadsPtrs.build(), true);
             Variable ctx = function.newVariable(TRYCATCH_CONTEXT_PTR);
             Variable bcCtx = function.newVariable(BC_TRYCATCH_CONTEXT_PTR);
@@ -393,21 +506,25 @@ public class MethodCompiler extends AbstractMethodCompiler {
             
             if (selChanges.containsKey(unit)) {
                 int sel = selChanges.get(unit);
-                // trycatchContext->sel = sel
-                Variable selPtr = function.newVariable(new PointerType(I32));
-                function.add(new Getelementptr(selPtr, trycatchContext, 0, 1)).attach(unit);
-                function.add(new Store(new IntegerConstant(sel), selPtr.ref())).attach(unit);
+                if (zeroCostExceptions) {
+                    currentLandingPad = sel == 0 ? null : new Label(landingPadLists.get(sel - 1));
+                } else {
+                    // trycatchContext->sel = sel
+                    Variable selPtr = function.newVariable(new PointerType(I32));
+                    function.add(new Getelementptr(selPtr, trycatchContext, 0, 1)).attach(unit);
+                    function.add(new Store(new IntegerConstant(sel), selPtr.ref())).attach(unit);
+                }
             }
             
             if (unit instanceof DefinitionStmt) {
                 assign((DefinitionStmt) unit);
             } else if (unit instanceof ReturnStmt) {
-                if (!body.getTraps().isEmpty()) {
+                if (!body.getTraps().isEmpty() && !zeroCostExceptions) {
                     trycatchLeave(function);
                 }
                 return_((ReturnStmt) unit);
             } else if (unit instanceof ReturnVoidStmt) {
-                if (!body.getTraps().isEmpty()) {
+                if (!body.getTraps().isEmpty() && !zeroCostExceptions) {
                     trycatchLeave(function);
                 }
                 returnVoid((ReturnVoidStmt) unit);
@@ -433,6 +550,11 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 throw new IllegalArgumentException("Unknown Unit type: " + unit.getClass());
             }
         }
+        currentLandingPad = null;
+        
+        for (Label label : usedLandingPads) {
+            landingPad(label, trapHandlers);
+        }
         
         if (this.className.equals("java/lang/Object") && "<init>".equals(method.getName())) {
             // Compile Object.<init>(). JLS 12.6.1: "An object o is not finalizable until its constructor has invoked 
@@ -449,9 +571,315 @@ public class MethodCompiler extends AbstractMethodCompiler {
             }
         }
 
+        if (profileStart != null) {
+            // Accumulate the cycles spent in this method before each ret. 
+            // Exits through a thrown exception are not timed.
+            for (BasicBlock bb : function.getBasicBlocks()) {
+                if (bb.last() instanceof Ret) {
+                    Call call = new Call(PROFILE_EXIT, profileCounter, profileStart);
+                    call.attach(bb.last().getAttachment(Unit.class));
+                    bb.insertBefore(bb.last(), call);
+                }
+            }
+        }
+
         return function;
     }
     
+    /**
+     * Creates the {@code ProfileCounter} of the specified method. All counters
+     * are emitted into the same section which the runtime walks when writing
+     * the hot method report (see profile.c).
+     */
+    private Value createProfileCounter(SootMethod method) {
+        return createProfileCounter(Symbols.profileCounterSymbol(method), PROFILE_COUNTER_METHOD, 0);
+    }
+
+    private Value createProfileCounter(String symbol, int kind, int index) {
+        String section = config.getOs().getFamily() == OS.Family.darwin 
+                ? "__DATA,__robovm_prof" : "robovm_prof";
+        Global counter = new Global(symbol, internal, 
+                new StructureConstantBuilder()
+                    .add(new IntegerConstant(0L))
+                    .add(new IntegerConstant(0L))
+                    .add(moduleBuilder.getString(className + "." + sootMethod.getName() + getDescriptor(sootMethod)))
+                    .add(new IntegerConstant(kind))
+                    .add(new IntegerConstant(index))
+                    .build(), false, section);
+        moduleBuilder.addGlobal(counter);
+        return new ConstantBitcast(counter.ref(), PROFILE_COUNTER_PTR);
+    }
+
+    private Value createProfileReceiverSite(int index) {
+        // Section names on Darwin are limited to 16 characters
+        String section = config.getOs().getFamily() == OS.Family.darwin 
+                ? "__DATA,__robovm_prof_rc" : "robovm_prof_rcv";
+        StructureConstantBuilder receivers = new StructureConstantBuilder();
+        for (int i = 0; i < PROFILE_RECEIVER_SLOTS; i++) {
+            receivers.add(new StructureConstantBuilder()
+                    .add(new NullConstant(I8_PTR))
+                    .add(new IntegerConstant(0L)).build());
+        }
+        Global site = new Global(Symbols.profileReceiverSiteSymbol(sootMethod, index), internal, 
+                new StructureConstantBuilder()
+                    .add(moduleBuilder.getString(className + "." + sootMethod.getName() + getDescriptor(sootMethod)))
+                    .add(new IntegerConstant(index))
+                    .add(new IntegerConstant(0L))
+                    .add(receivers.build())
+                    .build(), false, section);
+        moduleBuilder.addGlobal(site);
+        return new ConstantBitcast(site.ref(), PROFILE_RECEIVER_SITE_PTR);
+    }
+
+    /**
+     * Numbers the conditional branches and the virtual and interface call
+     * sites of the method being compiled in unit order. These numbers
+     * identify branches and call sites in profile reports so they must not
+     * depend on whether the method is compiled with profile instrumentation
+     * or with a profile.
+     */
+    private void indexProfiledUnits(Chain<Unit> units) {
+        branchIndexes = new HashMap<>();
+        callSiteIndexes = new HashMap<>();
+        if (config.getProfileInstrumentation() == ProfileInstrumentation.none && config.getProfile() == null) {
+            return;
+        }
+        for (Unit unit : units) {
+            if (unit instanceof IfStmt) {
+                branchIndexes.put(unit, branchIndexes.size());
+            } else if (((Stmt) unit).containsInvokeExpr()) {
+                InvokeExpr expr = ((Stmt) unit).getInvokeExpr();
+                if (expr instanceof VirtualInvokeExpr || expr instanceof InterfaceInvokeExpr) {
+                    callSiteIndexes.put(unit, callSiteIndexes.size());
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the method called when {@code methodRef} is invoked virtually
+     * on an instance of the class with the specified internal name or
+     * {@code null} if the method cannot be called directly.
+     */
+    private SootMethod resolveGuardedTarget(String receiver, SootMethodRef methodRef) {
+        if (receiver.startsWith("[")) {
+            return null;
+        }
+        Clazz receiverClazz = config.getClazzes().load(receiver);
+        if (receiverClazz == null) {
+            return null;
+        }
+        SootClass c = receiverClazz.getSootClass();
+        if (c.isInterface() || c.isPhantom()) {
+            return null;
+        }
+        while (c != null) {
+            if (c.declaresMethod(methodRef.name(), methodRef.parameterTypes(), methodRef.returnType())) {
+                SootMethod m = c.getMethod(methodRef.name(), methodRef.parameterTypes(), methodRef.returnType());
+                // Package private methods may not override the method being
+                // called and synchronized methods are called through a
+                // wrapper. Leave those to the trampoline.
+                if (m.isStatic() || m.isAbstract() || m.isSynchronized() 
+                        || !(m.isPublic() || m.isProtected())) {
+                    return null;
+                }
+                return m;
+            }
+            c = c.hasSuperclass() ? c.getSuperclass() : null;
+        }
+        return null;
+    }
+
+    /**
+     * Returns the info struct of the specified class as an {@code i8*}.
+     */
+    private Value getInfoStruct(String internalName) {
+        if (internalName.equals(className)) {
+            // See the comment about #1007 in doCompile()
+            return new AliasRef(Symbols.infoStructSymbol(className) + "_i8ptr", I8_PTR);
+        }
+        Global g = new Global(Symbols.infoStructSymbol(internalName), I8_PTR, true);
+        if (!moduleBuilder.hasSymbol(g.getName())) {
+            moduleBuilder.addGlobal(g);
+        }
+        return new ConstantBitcast(g.ref(), I8_PTR);
+    }
+
+    /**
+     * Returns the interface method called by an {@code invokeinterface} of
+     * {@code methodRef} searching the super interfaces of the referenced
+     * interface breadth first, or {@code null} if the method cannot be 
+     * resolved at compile time.
+     */
+    private SootMethod resolveInterfaceMethod(SootMethodRef methodRef) {
+        LinkedList<SootClass> queue = new LinkedList<>();
+        Set<SootClass> visited = new HashSet<>();
+        queue.add(methodRef.declaringClass());
+        while (!queue.isEmpty()) {
+            SootClass c = queue.removeFirst();
+            if (c.isPhantom() || !c.isInterface()) {
+                return null;
+            }
+            if (visited.add(c)) {
+                if (c.declaresMethod(methodRef.name(), methodRef.parameterTypes(), methodRef.returnType())) {
+                    SootMethod m = c.getMethod(methodRef.name(), methodRef.parameterTypes(), methodRef.returnType());
+                    return m.isStatic() || !m.isPublic() ? null : m;
+                }
+                queue.addAll(c.getInterfaces());
+            }
+        }
+        return null;
+    }
+
+    /**
+     * Calls the method through its trampoline. {@code invokeinterface} calls
+     * which can be resolved at compile time go through a per call site
+     * inline cache instead of the trampoline. The cache maps receiver 
+     * classes to implementations and falls back to the itable scan in
+     * {@code _bcInlineCacheMiss()} when the receiver class isn't found. 
+     * Receivers which don't implement the method are handed back to the 
+     * trampoline. If the {@link Linker} finds that only a few classes
+     * implement the interface method it replaces the lookup function called
+     * by the trampoline with one which calls the implementations directly
+     * and sets the method's devirtualized flag which makes the call site
+     * skip the inline cache.
+     */
+    private Value virtualCall(Stmt stmt, InvokeExpr expr, FunctionRef trampolineRef, Value[] args) {
+        if (!(expr instanceof InterfaceInvokeExpr)) {
+            return call(stmt, trampolineRef, args);
+        }
+        SootMethod method = resolveInterfaceMethod(expr.getMethodRef());
+        ITable.Entry entry = method != null 
+                ? config.getITableCache().get(method.getDeclaringClass()).getEntry(method) : null;
+        if (entry == null) {
+            return call(stmt, trampolineRef, args);
+        }
+        if (config.isDebug()) {
+            return inlineCacheCall(stmt, method, entry, trampolineRef, args);
+        }
+
+        String flagName = Symbols.devirtualizedSymbol(method);
+        if (!moduleBuilder.hasSymbol(flagName)) {
+            // Overridden by a strong definition in the Linker
+            moduleBuilder.addGlobal(new Global(flagName, weak, new IntegerConstant((byte) 0), true));
+        }
+        Variable flag = function.newVariable(I8);
+        function.add(new Load(flag, moduleBuilder.getGlobalRef(flagName))).attach(stmt);
+        Variable devirtualized = function.newVariable(I1);
+        function.add(new Icmp(devirtualized, Condition.ne, flag.ref(), new IntegerConstant((byte) 0))).attach(stmt);
+        Label directLabel = new Label();
+        Label cacheLabel = new Label();
+        Label joinLabel = new Label();
+        function.add(new Br(devirtualized.ref(), function.newBasicBlockRef(directLabel), 
+                function.newBasicBlockRef(cacheLabel))).attach(stmt);
+
+        function.newBasicBlock(directLabel);
+        Value directResult = call(stmt, trampolineRef, args);
+        BasicBlockRef directBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(cacheLabel);
+        Value cacheResult = inlineCacheCall(stmt, method, entry, trampolineRef, args);
+        BasicBlockRef cacheBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(joinLabel);
+
+        if (directResult == null) {
+            return null;
+        }
+        Variable result = function.newVariable(directResult.getType());
+        function.add(new Phi(result, new VariableRef[] {(VariableRef) directResult, (VariableRef) cacheResult}, 
+                new BasicBlockRef[] {directBlock, cacheBlock})).attach(stmt);
+        return result.ref();
+    }
+
+    private Value inlineCacheCall(Stmt stmt, SootMethod method, ITable.Entry entry, 
+            FunctionRef trampolineRef, Value[] args) {
+
+        String interfaceName = getInternalName(method.getDeclaringClass());
+        // The itable index is compiled in. Recompile if the interface changes.
+        clazz.getClazzInfo().addClassDependency(interfaceName, false);
+
+        StructureConstantBuilder entries = new StructureConstantBuilder();
+        for (int i = 0; i < INLINE_CACHE_SIZE; i++) {
+            entries.add(new StructureConstantBuilder()
+                    .add(new NullConstant(I8_PTR))
+                    .add(new NullConstant(I8_PTR)).build());
+        }
+        Global cache = moduleBuilder.newGlobal(new StructureConstantBuilder()
+                .add(entries.build())
+                .add(new IntegerConstant(0)).build());
+        Variable header = function.newVariable(I8_PTR_PTR);
+        function.add(new Bitcast(header, getInfoStruct(interfaceName), I8_PTR_PTR)).attach(stmt);
+        Value impl = call(stmt, IC_LOOKUP, env, new ConstantBitcast(cache.ref(), INLINE_CACHE_PTR), 
+                header.ref(), args[1], new IntegerConstant(entry.getIndex()), 
+                new ConstantBitcast(trampolineRef, I8_PTR));
+        Variable f = function.newVariable(trampolineRef.getType());
+        function.add(new Bitcast(f, impl, f.getType())).attach(stmt);
+        return call(stmt, f.ref(), args);
+    }
+
+    /**
+     * Calls {@code target} directly if the class of the receiver is
+     * {@code receiver} and through {@code fallback} otherwise. Method
+     * functions are weak and {@code noinline} so the direct call is only
+     * inlined when linking with whole program optimization (see
+     * {@link Linker}).
+     */
+    private Value guardedCall(Stmt stmt, InvokeExpr expr, String receiver, ReceiverProfile rp, 
+            SootMethod target, FunctionRef fallback, Value[] args) {
+        
+        // ClassInfoHeader->clazz is the first field of the info struct. It is
+        // NULL until the class has been loaded.
+        Variable receiverClassPtr = function.newVariable(new PointerType(CLASS_PTR));
+        function.add(new Bitcast(receiverClassPtr, getInfoStruct(receiver), receiverClassPtr.getType())).attach(stmt);
+        Variable receiverClass = function.newVariable(CLASS_PTR);
+        function.add(new Load(receiverClass, receiverClassPtr.ref())).attach(stmt);
+        Value objectClass = call(stmt, OBJECT_CLASS, args[1]);
+        Variable isReceiver = function.newVariable(I1);
+        function.add(new Icmp(isReceiver, Condition.eq, objectClass, receiverClass.ref())).attach(stmt);
+
+        Label directLabel = new Label();
+        Label virtualLabel = new Label();
+        Label joinLabel = new Label();
+        long hits = rp.getCount(receiver);
+        function.add(new Br(isReceiver.ref(), function.newBasicBlockRef(directLabel), 
+                function.newBasicBlockRef(virtualLabel))
+            .addMetadata(new BranchWeightsMetadata(hits, rp.getCount() - hits))).attach(stmt);
+
+        FunctionRef targetRef = new FunctionRef(Symbols.methodSymbol(target), getFunctionType(target));
+        if (target.getDeclaringClass() != sootClass && !moduleBuilder.hasSymbol(targetRef.getName())) {
+            moduleBuilder.addFunctionDeclaration(new FunctionDeclaration(targetRef));
+        }
+        function.newBasicBlock(directLabel);
+        Value directResult = call(stmt, targetRef, args);
+        // The calls may have been emitted as invokes which end the blocks
+        // they were made in.
+        BasicBlockRef directBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(virtualLabel);
+        Value virtualResult = virtualCall(stmt, expr, fallback, args);
+        BasicBlockRef virtualBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(joinLabel);
+        
+        // Make sure the receiver class and target method are linked in and
+        // that this class is recompiled if any of them changes.
+        MethodInfo mi = clazz.getClazzInfo().getMethod(sootMethod.getName(), getDescriptor(sootMethod));
+        if (mi != null) {
+            mi.addClassDependency(receiver, false);
+            mi.addInvokeMethodDependency(getInternalName(target.getDeclaringClass()), 
+                    target.getName(), getDescriptor(target), false);
+        }
+        
+        if (directResult == null) {
+            return null;
+        }
+        Variable result = function.newVariable(directResult.getType());
+        function.add(new Phi(result, new VariableRef[] {(VariableRef) directResult, (VariableRef) virtualResult}, 
+                new BasicBlockRef[] {directBlock, virtualBlock})).attach(stmt);
+        return result.ref();
+    }
+    
     /**
      * Returns <code>true</code> if the {@link Trap}s at {@link Unit} <code>unit</code>
      * differ from any of those at the {@link Unit}s that branch to <code>unit</code>.
@@ -545,6 +973,69 @@ public class MethodCompiler extends AbstractMethodCompiler {
             || instr instanceof Switch;
     }
 
+    private Type getStackAllocationType(AssignStmt stmt, SootClass allocClass) {
+        if (allocClass != null) {
+            // The layout is compiled in. Recompile if the class or any of
+            // its superclasses change.
+            for (SootClass c = allocClass; c.hasSuperclass(); c = c.getSuperclass()) {
+                clazz.getClazzInfo().addClassDependency(getInternalName(c), false);
+            }
+            return getInstanceType(config.getOs(), config.getArch(), allocClass);
+        }
+        NewArrayExpr expr = (NewArrayExpr) stmt.getRightOp();
+        int length = ((soot.jimple.IntConstant) expr.getSize()).value;
+        return new StructureType(DATA_OBJECT, I32, new ArrayType(length, getType(expr.getBaseType())));
+    }
+
+    /**
+     * Initializes the stack memory of an allocation found by
+     * {@link EscapeAnalysis}. The memory is cleared and the class pointer
+     * set just like the heap allocators do.
+     */
+    private Value stackAllocate(DefinitionStmt stmt) {
+        Variable memory = stackAllocations.get(stmt);
+        soot.Value rightOp = stmt.getRightOp();
+        Value clazzPtr = null;
+        if (rightOp instanceof NewExpr) {
+            SootClass allocClass = ((NewExpr) rightOp).getBaseType().getSootClass();
+            Value info = getInfoStruct(getInternalName(allocClass));
+            // Initialize the class unless done already just like the class
+            // init wrapper of the allocator does.
+            Variable infoPtr = function.newVariable(I8_PTR_PTR);
+            function.add(new Bitcast(infoPtr, info, I8_PTR_PTR)).attach(stmt);
+            call(stmt, INITIALIZE_CLASS, env, infoPtr.ref());
+            // The info struct is declared constant but is updated by the
+            // runtime so the class pointer must be loaded using a volatile
+            // load.
+            Variable header = function.newVariable(new PointerType(new StructureType(CLASS_PTR, I32)));
+            function.add(new Bitcast(header, info, header.getType())).attach(stmt);
+            Variable clazzPtrPtr = function.newVariable(new PointerType(CLASS_PTR));
+            function.add(new Getelementptr(clazzPtrPtr, header.ref(), 0, 0)).attach(stmt);
+            Variable v = function.newVariable(CLASS_PTR);
+            function.add(new Load(v, clazzPtrPtr.ref(), true)).attach(stmt);
+            clazzPtr = v.ref();
+        } else {
+            soot.Type baseType = ((NewArrayExpr) rightOp).getBaseType();
+            Variable v = function.newVariable(CLASS_PTR);
+            function.add(new Load(v, new GlobalRef("array_" + getDescriptor(baseType), CLASS_PTR))).attach(stmt);
+            clazzPtr = v.ref();
+        }
+
+        Variable o = function.newVariable(OBJECT_PTR);
+        function.add(new Bitcast(o, memory.ref(), OBJECT_PTR)).attach(stmt);
+        // sizeof(type) == (i32) &((type*) null)[1]
+        Constant size = new ConstantPtrtoint(new ConstantGetelementptr(
+                new NullConstant((PointerType) memory.getType()), 1), I32);
+        function.add(new Call(INIT_STACK_OBJECT, o.ref(), size, clazzPtr)).attach(stmt);
+        if (rightOp instanceof NewArrayExpr) {
+            Variable lengthPtr = function.newVariable(new PointerType(I32));
+            function.add(new Getelementptr(lengthPtr, memory.ref(), 0, 1)).attach(stmt);
+            function.add(new Store(immediate(stmt, (Immediate) ((NewArrayExpr) rightOp).getSize()),
+                    lengthPtr.ref())).attach(stmt);
+        }
+        return o.ref();
+    }
+
     private Value immediate(Unit unit, Immediate v) {
         // v is either a soot.Local or a soot.jimple.Constant
         if (v instanceof soot.Local) {
@@ -635,35 +1126,59 @@ public class MethodCompiler extends AbstractMethodCompiler {
         return call(null, fn, args);
     }
     
+    /**
+     * Calls {@code fn}. Inside try blocks this emits an {@link Invoke}
+     * unwinding to the landingpad of the current trap set when compiling
+     * with zero-cost exceptions. The invoke terminates the current basic
+     * block so the code following the call ends up in a new block.
+     */
     private Value call(Unit unit, Value fn, Value ... args) {
         Variable result = null;
         Type returnType = ((FunctionType) fn.getType()).getReturnType();
         if (returnType != VOID) {
             result = function.newVariable(returnType);
         }
-        function.add(new Call(result, fn, args)).attach(unit);
+        if (currentLandingPad != null && !isIntrinsic(fn)) {
+            Label label = new Label();
+            BasicBlockRef to = function.newBasicBlockRef(label);
+            BasicBlockRef unwind = function.newBasicBlockRef(currentLandingPad);
+            function.add(new Invoke(result, fn, to, unwind, args)).attach(unit);
+            function.newBasicBlock(label);
+            usedLandingPads.add(currentLandingPad);
+        } else {
+            function.add(new Call(result, fn, args)).attach(unit);
+        }
         return result == null ? null : result.ref();
     }
     
-//    private Value callOrInvoke(Unit unit, Value fn, Value ... args) {
-//        Variable result = null;
-//        Type returnType = ((FunctionType) fn.getType()).getReturnType();
-//        if (returnType != VOID) {
-//            result = this.function.newVariable(returnType);
-//        }
-//        List<Trap> traps = getTrapsAt(unit);
-//        if (!traps.isEmpty()) {
-//            Label label = new Label();
-//            BasicBlockRef to = function.newBasicBlockRef(label);
-//            BasicBlockRef unwind = function.newBasicBlockRef(new Label(traps));
-//            function.add(new Invoke(result, fn, to, unwind, args));
-//            function.newBasicBlock(label);
-//            recordedTraps.add(traps);
-//        } else {
-//            function.add(new Call(result, fn, args));
-//        }
-//        return result == null ? null : result.ref();
-//    }
+    private static boolean isIntrinsic(Value fn) {
+        // LLVM intrinsics can't be invoked. None of the ones we call throw.
+        return fn instanceof FunctionRef && ((FunctionRef) fn).getName().startsWith("llvm.");
+    }
+    
+    /**
+     * Emits the landingpad identified by {@code label}. The personality
+     * routine (_bcPersonality() in bc.c) matches the exception against the
+     * {@code LandingPad} list in the catch clause and passes the id of the
+     * matching handler as selector.
+     */
+    private void landingPad(Label label, Map<Unit, Integer> trapHandlers) {
+        Global landingPads = (Global) label.getTag();
+        function.newBasicBlock(label);
+        Variable lp = function.newVariable(new StructureType(I8_PTR, I32));
+        function.add(new Landingpad(lp, new ConstantBitcast(BC_PERSONALITY, I8_PTR), 
+                new Landingpad.Catch(new ConstantBitcast(landingPads.ref(), I8_PTR))));
+        Variable sel = function.newVariable(I32);
+        function.add(new Extractvalue(sel, lp.ref(), 1));
+        Map<IntegerConstant, BasicBlockRef> alt = new TreeMap<IntegerConstant, BasicBlockRef>();
+        for (Entry<Unit, Integer> entry : trapHandlers.entrySet()) {
+            alt.put(new IntegerConstant(entry.getValue() + 1), function.newBasicBlockRef(new Label(entry.getKey())));
+        }
+        // The personality never lands here with an id other than those in
+        // the LandingPad list so any of them will do as default.
+        BasicBlockRef dflt = alt.remove(alt.keySet().iterator().next());
+        function.add(new Switch(sel.ref(), dflt, alt));
+    }
     
     private boolean canAccessDirectly(FieldRef ref) {
         SootClass sootClass = this.sootMethod.getDeclaringClass();
@@ -751,7 +1266,13 @@ public class MethodCompiler extends AbstractMethodCompiler {
             i++;
         }
         Value result = null;
+        boolean viaTrampoline = false;
+        ReceiverProfile guardedProfile = null;
+        String guardedReceiver = null;
+        SootMethod guardedTarget = null;
         FunctionRef functionRef = config.isDebug() ? null : Intrinsics.getIntrinsic(sootMethod, stmt, expr);
+        Intrinsics.GuardedIntrinsic guardedIntrinsic = functionRef != null || config.isDebug() 
+                ? null : Intrinsics.getGuardedIntrinsic(sootMethod, stmt, expr);
         if (functionRef == null) {
             Trampoline trampoline = null;
             String targetClassName = getInternalName(methodRef.declaringClass());
@@ -782,9 +1303,57 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 }
             } else {
                 functionRef = trampoline.getFunctionRef();
+                viaTrampoline = true;
+                Integer site = callSiteIndexes.get(stmt);
+                if (site != null && config.getProfileInstrumentation() != ProfileInstrumentation.none) {
+                    call(stmt, BC_PROFILE_RECEIVER, createProfileReceiverSite(site), args.get(1));
+                } else if (site != null && config.getProfile() != null) {
+                    guardedProfile = config.getProfile().getReceivers(className, 
+                            sootMethod.getName(), getDescriptor(sootMethod), site);
+                    guardedReceiver = guardedProfile != null 
+                            ? guardedProfile.getDominantClass(GUARDED_CALL_MIN_RATIO, GUARDED_CALL_MIN_COUNT) : null;
+                    guardedTarget = guardedReceiver != null ? resolveGuardedTarget(guardedReceiver, methodRef) : null;
+                }
+            }
+        }
+        Value[] callArgs = args.toArray(new Value[0]);
+        Label joinLabel = null;
+        Value intrinsicResult = null;
+        BasicBlockRef intrinsicBlock = null;
+        if (guardedIntrinsic != null) {
+            // Call the intrinsic if the guard allows it and the method if not
+            FunctionRef guard = guardedIntrinsic.getGuard();
+            int guardArgCount = ((FunctionType) guard.getType()).getParameterTypes().length;
+            Value handled = call(stmt, guard, Arrays.copyOf(callArgs, guardArgCount));
+            Label intrinsicLabel = new Label();
+            Label methodLabel = new Label();
+            joinLabel = new Label();
+            function.add(new Br(handled, function.newBasicBlockRef(intrinsicLabel), 
+                    function.newBasicBlockRef(methodLabel))).attach(stmt);
+            function.newBasicBlock(intrinsicLabel);
+            intrinsicResult = call(stmt, guardedIntrinsic.getFunction(), callArgs);
+            intrinsicBlock = function.getCurrentBasicBlock().ref();
+            function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+            function.newBasicBlock(methodLabel);
+        }
+        if (guardedTarget != null) {
+            result = guardedCall(stmt, expr, guardedReceiver, guardedProfile, guardedTarget, functionRef, callArgs);
+        } else if (viaTrampoline) {
+            result = virtualCall(stmt, expr, functionRef, callArgs);
+        } else {
+            result = call(stmt, functionRef, callArgs);
+        }
+        if (guardedIntrinsic != null) {
+            BasicBlockRef methodBlock = function.getCurrentBasicBlock().ref();
+            function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+            function.newBasicBlock(joinLabel);
+            if (result != null) {
+                Variable phi = function.newVariable(result.getType());
+                function.add(new Phi(phi, new VariableRef[] {(VariableRef) intrinsicResult, (VariableRef) result}, 
+                        new BasicBlockRef[] {intrinsicBlock, methodBlock})).attach(stmt);
+                result = phi.ref();
             }
         }
-        result = call(stmt, functionRef, args.toArray(new Value[0]));
         if (result != null) {
             return widenToI32Value(stmt, result, methodRef.returnType().equals(CharType.v()));
         } else {
@@ -795,7 +1364,13 @@ public class MethodCompiler extends AbstractMethodCompiler {
     private void checkNull(Stmt stmt, Value base) {
         NullCheckTag nullCheckTag = (NullCheckTag) stmt.getTag("NullCheckTag");
         if (nullCheckTag == null || nullCheckTag.needCheck()) {
-            call(stmt, CHECK_NULL, env, base);
+            if (currentLandingPad != null) {
+                // The unwind tables only cover calls so inside try blocks
+                // we can't rely on the SIGSEGV handler throwing the NPE.
+                call(stmt, CHECK_NULL_EXPLICIT, env, base);
+            } else {
+                call(stmt, CHECK_NULL, env, base);
+            }
         }
     }
     
@@ -865,9 +1440,7 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 return;
             } else {
                 Value index = immediate(stmt, (Immediate) ref.getIndex());
-                checkNull(stmt, base);
-                checkBounds(stmt, base, index);
-                result = call(stmt, getArrayLoad(ref.getType()), base, index);
+                result = arrayLoad(stmt, ref.getType(), base, index);
                 result = widenToI32Value(stmt, result, isUnsigned(ref.getType()));
             }
         } else if (rightOp instanceof InstanceFieldRef) {
@@ -1083,6 +1656,8 @@ public class MethodCompiler extends AbstractMethodCompiler {
                     trampolines.add(trampoline);
                     result = call(stmt, trampoline.getFunctionRef(), env, op);
                 }
+            } else if (stackAllocations.containsKey(stmt)) {
+                result = stackAllocate(stmt);
             } else if (rightOp instanceof NewExpr) {
                 String targetClassName = getInternalName(((NewExpr) rightOp).getBaseType());
                 FunctionRef fn = null;
@@ -1163,13 +1738,7 @@ public class MethodCompiler extends AbstractMethodCompiler {
                 ArrayRef ref = (ArrayRef) leftOp;
                 VariableRef base = (VariableRef) immediate(stmt, (Immediate) ref.getBase());
                 Value index = immediate(stmt, (Immediate) ref.getIndex());
-                checkNull(stmt, base);
-                checkBounds(stmt, base, index);
-                if (leftOp.getType() instanceof RefLikeType) {
-                    call(stmt, BC_SET_OBJECT_ARRAY_ELEMENT, env, base, index, narrowedResult);
-                } else {
-                    call(stmt, getArrayStore(leftOp.getType()), base, index, narrowedResult);
-                }
+                arrayStore(stmt, leftOp.getType(), base, index, narrowedResult);
             } else if (leftOp instanceof InstanceFieldRef) {
                 InstanceFieldRef ref = (InstanceFieldRef) leftOp;
                 Value base = immediate(stmt, (Immediate) ref.getBase());
@@ -1242,9 +1811,22 @@ public class MethodCompiler extends AbstractMethodCompiler {
         Variable result = function.newVariable(Type.I1);
         function.add(new Icmp(result, c, op1, op2)).attach(stmt);
         Unit nextUnit = sootMethod.getActiveBody().getUnits().getSuccOf(stmt);
-        function.add(new Br(new VariableRef(result), 
+        Br br = new Br(new VariableRef(result), 
                 function.newBasicBlockRef(new Label(stmt.getTarget())), 
-                function.newBasicBlockRef(new Label(nextUnit)))).attach(stmt);
+                function.newBasicBlockRef(new Label(nextUnit)));
+        Integer index = branchIndexes.get(stmt);
+        if (index != null && config.getProfileInstrumentation() != ProfileInstrumentation.none) {
+            Value counter = createProfileCounter(Symbols.profileBranchCounterSymbol(sootMethod, index), 
+                    PROFILE_COUNTER_BRANCH, index);
+            call(stmt, PROFILE_BRANCH, counter, result.ref());
+        } else if (index != null && config.getProfile() != null) {
+            BranchProfile bp = config.getProfile().getBranch(className, sootMethod.getName(), 
+                    getDescriptor(sootMethod), index);
+            if (bp != null && bp.getCount() > 0) {
+                br.addMetadata(new BranchWeightsMetadata(bp.getTaken(), bp.getNotTaken()));
+            }
+        }
+        function.add(br).attach(stmt);
     }
     
     private void lookupSwitch(LookupSwitchStmt stmt) {
@@ -1306,5 +1888,112 @@ public class MethodCompiler extends AbstractMethodCompiler {
          */
         Variable v = function.newVariable(I32);
         function.add(new Add(v, new IntegerConstant(0), new IntegerConstant(0))).attach(stmt);
+        
+        // Compute the guards of the loop following this NOP, if any
+        for (RangeAnalysis.Guard guard : inBoundsAccesses.values()) {
+            if (guard.getPreheader() == stmt && !guard.isStatic() && !rangeGuards.containsKey(guard)) {
+                rangeGuards.put(guard, rangeGuard(stmt, guard));
+            }
+        }
+    }
+
+    private Variable rangeGuard(Stmt stmt, RangeAnalysis.Guard guard) {
+        Variable result = null;
+        if (guard.getIndex() != null) {
+            Value index = immediate(stmt, guard.getIndex());
+            result = function.newVariable(I1);
+            function.add(new Icmp(result, Condition.sge, index, new IntegerConstant(0))).attach(stmt);
+        }
+        if (guard.getArray() != null) {
+            Value array = immediate(stmt, guard.getArray());
+            Value bound = immediate(stmt, (Immediate) guard.getBound());
+            Variable covers = function.newVariable(I1);
+            function.add(new Call(covers, ARRAY_COVERS, array, bound)).attach(stmt);
+            if (result != null) {
+                Variable and = function.newVariable(I1);
+                function.add(new And(and, result.ref(), covers.ref())).attach(stmt);
+                result = and;
+            } else {
+                result = covers;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Loads an array element. Omits the null and bounds checks if the access
+     * has been found to be in bounds by {@link RangeAnalysis}. If that
+     * depends on a guard computed at runtime both a checked and an unchecked
+     * load are emitted.
+     */
+    private Value arrayLoad(Stmt stmt, soot.Type type, VariableRef base, Value index) {
+        RangeAnalysis.Guard guard = inBoundsAccesses.get(stmt);
+        if (guard == null) {
+            checkNull(stmt, base);
+            checkBounds(stmt, base, index);
+            return call(stmt, getArrayLoad(type), base, index);
+        }
+        if (guard.isStatic()) {
+            return call(stmt, getArrayLoadInBounds(type), base, index);
+        }
+        Label fastLabel = new Label();
+        Label slowLabel = new Label();
+        Label joinLabel = new Label();
+        function.add(new Br(rangeGuards.get(guard).ref(), function.newBasicBlockRef(fastLabel), 
+                function.newBasicBlockRef(slowLabel))).attach(stmt);
+        function.newBasicBlock(fastLabel);
+        Value fastResult = call(stmt, getArrayLoadInBounds(type), base, index);
+        BasicBlockRef fastBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(slowLabel);
+        checkNull(stmt, base);
+        checkBounds(stmt, base, index);
+        Value slowResult = call(stmt, getArrayLoad(type), base, index);
+        BasicBlockRef slowBlock = function.getCurrentBasicBlock().ref();
+        function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+        function.newBasicBlock(joinLabel);
+        Variable result = function.newVariable(fastResult.getType());
+        function.add(new Phi(result, new VariableRef[] {(VariableRef) fastResult, (VariableRef) slowResult}, 
+                new BasicBlockRef[] {fastBlock, slowBlock})).attach(stmt);
+        return result.ref();
+    }
+
+    /**
+     * Stores an array element. See {@link #arrayLoad(Stmt, soot.Type, VariableRef, Value)}.
+     */
+    private void arrayStore(Stmt stmt, soot.Type type, VariableRef base, Value index, Value value) {
+        RangeAnalysis.Guard guard = inBoundsAccesses.get(stmt);
+        if (guard == null) {
+            checkNull(stmt, base);
+            checkBounds(stmt, base, index);
+            arrayStore(stmt, type, base, index, value, false);
+        } else if (guard.isStatic()) {
+            arrayStore(stmt, type, base, index, value, true);
+        } else {
+            Label fastLabel = new Label();
+            Label slowLabel = new Label();
+            Label joinLabel = new Label();
+            function.add(new Br(rangeGuards.get(guard).ref(), function.newBasicBlockRef(fastLabel), 
+                    function.newBasicBlockRef(slowLabel))).attach(stmt);
+            function.newBasicBlock(fastLabel);
+            arrayStore(stmt, type, base, index, value, true);
+            function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+            function.newBasicBlock(slowLabel);
+            checkNull(stmt, base);
+            checkBounds(stmt, base, index);
+            arrayStore(stmt, type, base, index, value, false);
+            function.add(new Br(function.newBasicBlockRef(joinLabel))).attach(stmt);
+            function.newBasicBlock(joinLabel);
+        }
+    }
+
+    private void arrayStore(Stmt stmt, soot.Type type, VariableRef base, Value index, Value value, boolean inBounds) {
+        if (type instanceof RefLikeType) {
+            call(stmt, BC_SET_OBJECT_ARRAY_ELEMENT, env, base, index, value);
+        } else if (inBounds) {
+            call(stmt, getArrayStoreInBounds(type), base, index, value);
+        } else {
+            call(stmt, getArrayStore(type), base, index, value);
+        }
     }
 }
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import java.io.File;
+import java.io.IOException;
+import java.net.URISyntaxException;
+import java.nio.file.AtomicMoveNotSupportedException;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.security.CodeSource;
+import java.util.Collection;
+import java.util.List;
+import java.util.Map;
+import java.util.TreeSet;
+import java.util.concurrent.ConcurrentHashMap;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import org.apache.commons.io.FileUtils;
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.clazz.ClazzInfo;
+import org.robovm.compiler.clazz.Dependency;
+import org.robovm.compiler.config.Config;
+import org.robovm.compiler.plugin.CompilerPlugin;
+import org.robovm.compiler.util.DigestUtil;
+
+/**
+ * Cache of compiled classes which can be shared between builds, checkouts
+ * and machines through a local directory. Unlike the per-build cache in
+ * {@link Config#getCacheDir()}, which relies on file timestamps, entries are
+ * looked up by content hashes only:
+ * <ul>
+ * <li>The class key is the hash of the bytes of the class, the compiler
+ * version and the {@link Config} options which affect the generated code.</li>
+ * <li>The classes a class depends on are only known after it has been
+ * compiled. Every entry under a class key therefore lists the names of the
+ * dependencies and is named after the hash of the names and bytes of those
+ * classes as found when the entry was stored.</li>
+ * </ul>
+ * Entries are written to a temporary directory which is then renamed so
+ * concurrent builds never see partially written entries. The cache never
+ * needs network access and is never cleaned up automatically.
+ */
+public class ObjectCache {
+    private static final String DEPS_FILE = "deps";
+    private static final String INFO_FILE = "class.info";
+    private static final String O_FILE = "class.o";
+    private static final String LINES_O_FILE = "class.lines.o";
+    private static final String BC_FILE = "class.bc";
+
+    private final Config config;
+    private final File dir;
+    private final Map<String, String> signatures = new ConcurrentHashMap<>();
+    private final AtomicInteger hits = new AtomicInteger();
+    private final AtomicInteger misses = new AtomicInteger();
+    private final AtomicInteger stores = new AtomicInteger();
+    private String configKey;
+
+    public ObjectCache(Config config, File dir) {
+        this.config = config;
+        this.dir = dir;
+    }
+
+    public File getDir() {
+        return dir;
+    }
+
+    /**
+     * Returns the number of classes restored by {@link #restore(Clazz)}.
+     */
+    public int getHits() {
+        return hits.get();
+    }
+
+    /**
+     * Returns the number of classes not found by {@link #restore(Clazz)}.
+     */
+    public int getMisses() {
+        return misses.get();
+    }
+
+    /**
+     * Returns the number of classes added by {@link #store(Clazz)}.
+     */
+    public int getStores() {
+        return stores.get();
+    }
+
+    /**
+     * Copies the object file, line numbers object file, bitcode and
+     * {@link ClazzInfo} of the specified class from this cache into the
+     * per-build cache if the class has been compiled before using the same
+     * options and dependencies.
+     * 
+     * @return {@code true} if the class was restored, {@code false} if it
+     *         must be compiled.
+     */
+    public boolean restore(Clazz clazz) throws IOException {
+        File[] entryDirs = getClassDir(clazz).listFiles();
+        if (entryDirs != null) {
+            for (File entryDir : entryDirs) {
+                File depsFile = new File(entryDir, DEPS_FILE);
+                if (entryDir.getName().startsWith(".") || !depsFile.exists()) {
+                    continue;
+                }
+                List<String> depNames = FileUtils.readLines(depsFile, "UTF-8");
+                if (entryDir.getName().equals(getDependenciesKey(depNames)) && restore(clazz, entryDir)) {
+                    hits.incrementAndGet();
+                    return true;
+                }
+            }
+        }
+        misses.incrementAndGet();
+        return false;
+    }
+
+    private boolean restore(Clazz clazz, File entryDir) throws IOException {
+        File bcEntry = new File(entryDir, BC_FILE);
+        if (config.isWholeProgramOptimization() && !bcEntry.exists()) {
+            return false;
+        }
+
+        // Make sure the class is compiled if anything below fails. The object
+        // file is restored last.
+        File oFile = config.getOFile(clazz);
+        oFile.delete();
+
+        copyAtomically(new File(entryDir, INFO_FILE), config.getInfoFile(clazz));
+        clazz.clearClazzInfo();
+        ClazzInfo ci = clazz.getClazzInfo();
+        if (ci == null) {
+            return false;
+        }
+        // The paths of the dependencies are those of the build which stored
+        // the entry. Without this ClassCompiler.mustCompile() would return
+        // true for the class in every build.
+        ci.relocateDependencies();
+        clazz.saveClazzInfo();
+
+        restoreOptional(new File(entryDir, LINES_O_FILE), config.getLinesOFile(clazz));
+        restoreOptional(bcEntry, config.getBcFile(clazz));
+        copyAtomically(new File(entryDir, O_FILE), oFile);
+        return true;
+    }
+
+    private void restoreOptional(File src, File dest) throws IOException {
+        if (src.exists()) {
+            copyAtomically(src, dest);
+        } else if (dest.exists()) {
+            // Make sure there's no stale file lingering
+            dest.delete();
+        }
+    }
+
+    /**
+     * Adds the files of the specified class, which must just have been
+     * compiled, to this cache. Does nothing if the cache already contains
+     * them.
+     */
+    public void store(Clazz clazz) throws IOException {
+        ClazzInfo ci = clazz.getClazzInfo();
+        File oFile = config.getOFile(clazz);
+        if (ci == null || !oFile.exists()) {
+            throw new IllegalStateException(clazz + " has not been compiled");
+        }
+        TreeSet<String> depNames = new TreeSet<>();
+        for (Dependency dep : ci.getAllDependencies()) {
+            depNames.add(dep.getClassName());
+        }
+
+        File classDir = getClassDir(clazz);
+        File entryDir = new File(classDir, getDependenciesKey(depNames));
+        if (entryDir.exists()) {
+            return;
+        }
+        classDir.mkdirs();
+        File tmpDir = Files.createTempDirectory(classDir.toPath(), ".tmp").toFile();
+        try {
+            FileUtils.writeLines(new File(tmpDir, DEPS_FILE), "UTF-8", depNames);
+            copy(config.getInfoFile(clazz), new File(tmpDir, INFO_FILE));
+            copy(oFile, new File(tmpDir, O_FILE));
+            File linesOFile = config.getLinesOFile(clazz);
+            if (linesOFile.exists()) {
+                copy(linesOFile, new File(tmpDir, LINES_O_FILE));
+            }
+            File bcFile = config.getBcFile(clazz);
+            if (config.isWholeProgramOptimization() && bcFile.exists()) {
+                copy(bcFile, new File(tmpDir, BC_FILE));
+            }
+            try {
+                Files.move(tmpDir.toPath(), entryDir.toPath(), StandardCopyOption.ATOMIC_MOVE);
+                stores.incrementAndGet();
+            } catch (IOException e) {
+                if (!entryDir.exists()) {
+                    throw e;
+                }
+                // Stored by a concurrent build
+            }
+        } finally {
+            FileUtils.deleteQuietly(tmpDir);
+        }
+    }
+
+    private File getClassDir(Clazz clazz) throws IOException {
+        String key = DigestUtil.sha1(getConfigKey() + clazz.getInternalName() + " "
+                + getSignature(clazz.getInternalName()));
+        return new File(new File(dir, key.substring(0, 2)), key);
+    }
+
+    private String getDependenciesKey(Collection<String> classNames) throws IOException {
+        StringBuilder sb = new StringBuilder();
+        for (String className : classNames) {
+            sb.append(className).append(' ').append(getSignature(className)).append('\n');
+        }
+        return DigestUtil.sha1(sb.toString());
+    }
+
+    /**
+     * Returns a string which changes when the class with the specified name
+     * changes, moves to or from the bootclasspath or is removed.
+     */
+    private String getSignature(String className) throws IOException {
+        String signature = signatures.get(className);
+        if (signature == null) {
+            Clazz clazz = config.getClazzes().load(className);
+            if (clazz == null) {
+                signature = "-";
+            } else {
+                signature = (clazz.isInBootClasspath() ? "B" : "C") + DigestUtil.sha1(clazz.getBytes());
+            }
+            signatures.put(className, signature);
+        }
+        return signature;
+    }
+
+    private synchronized String getConfigKey() throws IOException {
+        if (configKey == null) {
+            StringBuilder sb = new StringBuilder();
+            sb.append(Version.getVersion()).append('\n');
+            // Snapshot builds of the compiler share the same version
+            File compilerJar = getCompilerJar();
+            if (compilerJar != null) {
+                sb.append(DigestUtil.sha1(compilerJar)).append('\n');
+            }
+            sb.append(config.getOs()).append('\n');
+            sb.append(config.getArch()).append(' ').append(config.getArch().getLlvmCpu()).append('\n');
+            sb.append(config.getTriple()).append('\n');
+            // The name of the per-build cache dir encodes the build type and
+            // all other options which must never be mixed
+            sb.append(config.getCacheDir().getName()).append('\n');
+            for (CompilerPlugin plugin : config.getCompilerPlugins()) {
+                sb.append(plugin.getClass().getName()).append('\n');
+            }
+            configKey = sb.toString();
+        }
+        return configKey;
+    }
+
+    private static File getCompilerJar() {
+        CodeSource codeSource = ObjectCache.class.getProtectionDomain().getCodeSource();
+        if (codeSource != null && codeSource.getLocation() != null) {
+            try {
+                File f = new File(codeSource.getLocation().toURI());
+                if (f.isFile()) {
+                    return f;
+                }
+            } catch (URISyntaxException | IllegalArgumentException e) {
+            }
+        }
+        return null;
+    }
+
+    private static void copy(File src, File dest) throws IOException {
+        // Don't preserve the timestamp. ClassCompiler.mustCompile() compares
+        // the timestamps of the object files to those of the class files.
+        Files.copy(src.toPath(), dest.toPath(), StandardCopyOption.REPLACE_EXISTING);
+    }
+
+    private static void copyAtomically(File src, File dest) throws IOException {
+        dest.getParentFile().mkdirs();
+        File tmp = File.createTempFile(dest.getName(), ".tmp", dest.getParentFile());
+        try {
+            copy(src, tmp);
+            try {
+                Files.move(tmp.toPath(), dest.toPath(), StandardCopyOption.REPLACE_EXISTING,
+                        StandardCopyOption.ATOMIC_MOVE);
+            } catch (AtomicMoveNotSupportedException e) {
+                Files.move(tmp.toPath(), dest.toPath(), StandardCopyOption.REPLACE_EXISTING);
+            }
+        } finally {
+            tmp.delete();
+        }
+    }
+}
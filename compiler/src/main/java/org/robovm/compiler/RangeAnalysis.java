@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import soot.Body;
+import soot.IntType;
+import soot.Local;
+import soot.PatchingChain;
+import soot.Trap;
+import soot.Unit;
+import soot.Value;
+import soot.ValueBox;
+import soot.jimple.AddExpr;
+import soot.jimple.ArrayRef;
+import soot.jimple.AssignStmt;
+import soot.jimple.DefinitionStmt;
+import soot.jimple.GeExpr;
+import soot.jimple.GotoStmt;
+import soot.jimple.IfStmt;
+import soot.jimple.IntConstant;
+import soot.jimple.Jimple;
+import soot.jimple.LeExpr;
+import soot.jimple.LengthExpr;
+import soot.jimple.NopStmt;
+import soot.jimple.Stmt;
+import soot.toolkits.graph.BriefUnitGraph;
+import soot.toolkits.graph.UnitGraph;
+
+/**
+ * Finds counted loops of the form
+ * <pre>
+ * for (int i = start; i &lt; bound; i++) {
+ *     ... a[i] ...
+ * }
+ * </pre>
+ * and the array accesses in them indexed by the induction variable which are
+ * always in bounds. Within such a loop {@code 0 <= start <= i < bound} holds
+ * as long as {@code i} is only incremented at the end of the loop body and
+ * neither the bound nor the array local changes. If {@code bound} is
+ * {@code a.length} the accesses to {@code a} are known to be in bounds once
+ * {@code start} is known to be non-negative. For other arrays the loop is
+ * versioned: a guard checking that the array is non-null and at least
+ * {@code bound} elements long is computed once before the loop and selects
+ * between unchecked and checked accesses. LLVM's loop unswitching turns this
+ * into two copies of the loop where the fast one has no checks at all.
+ * <p>
+ * The analysis modifies the {@link Body} of the method: a {@link NopStmt}
+ * marking where the guards are computed is inserted before the loop header
+ * and if the header reads {@code a.length} that read is hoisted out of the
+ * loop.
+ */
+public class RangeAnalysis {
+
+    /**
+     * The condition which makes the accesses to an array in a loop safe.
+     */
+    public static class Guard {
+        private final NopStmt preheader;
+        private final Local index;
+        private final Local array;
+        private final Value bound;
+
+        Guard(NopStmt preheader, Local index, Local array, Value bound) {
+            this.preheader = preheader;
+            this.index = index;
+            this.array = array;
+            this.bound = bound;
+        }
+
+        /**
+         * Returns the {@link NopStmt} before the loop where the guard must
+         * be computed.
+         */
+        public NopStmt getPreheader() {
+            return preheader;
+        }
+
+        /**
+         * Returns the induction variable which must be non-negative when
+         * entering the loop or {@code null} if it is known to be.
+         */
+        public Local getIndex() {
+            return index;
+        }
+
+        /**
+         * Returns the array which must be non-null and have at least
+         * {@link #getBound()} elements or {@code null} if it is known to.
+         */
+        public Local getArray() {
+            return array;
+        }
+
+        /**
+         * Returns the exclusive upper bound of the induction variable. Either
+         * a {@link Local} or an {@link IntConstant}.
+         */
+        public Value getBound() {
+            return bound;
+        }
+
+        /**
+         * Returns {@code true} if the guarded accesses are always in bounds
+         * and the guard doesn't have to be computed at runtime.
+         */
+        public boolean isStatic() {
+            return index == null && array == null;
+        }
+    }
+
+    /**
+     * Returns the {@link ArrayRef} accessing statements in the specified
+     * {@link Body} which can be done without null and bounds checks if the
+     * {@link Guard} they map to holds.
+     */
+    public static Map<Stmt, Guard> findInBoundsAccesses(Body body) {
+        Map<Stmt, Guard> result = new LinkedHashMap<>();
+        List<Unit> units = new ArrayList<>(body.getUnits());
+        Map<Unit, Integer> indexes = new HashMap<>();
+        for (int i = 0; i < units.size(); i++) {
+            indexes.put(units.get(i), i);
+        }
+        UnitGraph graph = null;
+        for (int i = 0; i < units.size(); i++) {
+            Unit unit = units.get(i);
+            if (unit instanceof GotoStmt) {
+                Integer header = indexes.get(((GotoStmt) unit).getTarget());
+                if (header != null && header < i) {
+                    if (graph == null) {
+                        graph = new BriefUnitGraph(body);
+                    }
+                    analyzeLoop(body, units, indexes, graph, header, i, result);
+                }
+            }
+        }
+        return result;
+    }
+
+    private static void analyzeLoop(Body body, List<Unit> units, Map<Unit, Integer> indexes, UnitGraph graph,
+            int start, int end, Map<Stmt, Guard> result) {
+
+        Unit header = units.get(start);
+        Unit prev = body.getUnits().getPredOf(header);
+        if (prev == null || !prev.fallsThrough()) {
+            return;
+        }
+
+        // The latch must be 'i = i + 1' directly followed by the back edge
+        Local index = getIncrementedLocal(units.get(end - 1));
+        if (index == null) {
+            return;
+        }
+
+        // The header is either 'if i >= bound goto exit' or
+        // 'len = lengthof a; if i >= len goto exit'
+        int ifIndex = start;
+        Local lengthLocal = null;
+        Local lengthArray = null;
+        if (header instanceof AssignStmt && ((AssignStmt) header).getLeftOp() instanceof Local
+                && ((AssignStmt) header).getRightOp() instanceof LengthExpr
+                && ((LengthExpr) ((AssignStmt) header).getRightOp()).getOp() instanceof Local) {
+            lengthLocal = (Local) ((AssignStmt) header).getLeftOp();
+            lengthArray = (Local) ((LengthExpr) ((AssignStmt) header).getRightOp()).getOp();
+            ifIndex++;
+        }
+        if (!(units.get(ifIndex) instanceof IfStmt)) {
+            return;
+        }
+        IfStmt ifStmt = (IfStmt) units.get(ifIndex);
+        Value bound = getBound(ifStmt.getCondition(), index);
+        if (bound == null || lengthLocal != null && bound != lengthLocal
+                || lengthLocal == null && !(bound instanceof Local || bound instanceof IntConstant)
+                || bound instanceof Local && !(bound.getType() instanceof IntType)) {
+            return;
+        }
+        Integer exit = indexes.get(ifStmt.getTarget());
+        if (exit == null || exit >= start && exit <= end) {
+            return;
+        }
+
+        // The loop must only be entered through the header. Exception
+        // handlers are entered from the top of the method when not using
+        // landing pads so the loop must not contain any.
+        for (int i = start; i <= end; i++) {
+            for (Unit pred : graph.getPredsOf(units.get(i))) {
+                Integer p = indexes.get(pred);
+                if (p == null || (p < start || p > end) && !(i == start && pred == prev)) {
+                    return;
+                }
+            }
+        }
+        for (Trap trap : body.getTraps()) {
+            if (trap.getBeginUnit() == header || trap.getEndUnit() == header) {
+                return;
+            }
+            Integer handler = indexes.get(trap.getHandlerUnit());
+            if (handler == null || handler >= start && handler <= end) {
+                return;
+            }
+        }
+
+        // The induction variable may only be changed by the latch. The
+        // bound and the array locals must not be changed at all.
+        Set<Value> defined = new HashSet<>();
+        for (int i = start; i <= end; i++) {
+            for (ValueBox box : units.get(i).getDefBoxes()) {
+                if (box.getValue() == index && i != end - 1) {
+                    return;
+                }
+                defined.add(box.getValue());
+            }
+        }
+        if (lengthLocal == null && defined.contains(bound) || defined.contains(lengthArray)) {
+            return;
+        }
+        List<Stmt> accesses = new ArrayList<>();
+        for (int i = ifIndex + 1; i < end - 1; i++) {
+            Unit unit = units.get(i);
+            if (unit instanceof AssignStmt) {
+                ArrayRef ref = getArrayRef((AssignStmt) unit);
+                if (ref != null && ref.getIndex() == index && ref.getBase() instanceof Local
+                        && !defined.contains(ref.getBase())) {
+                    accesses.add((Stmt) unit);
+                }
+            }
+        }
+        if (accesses.isEmpty()) {
+            return;
+        }
+
+        boolean indexNonNegative = prev instanceof DefinitionStmt && ((DefinitionStmt) prev).getLeftOp() == index
+                && ((DefinitionStmt) prev).getRightOp() instanceof IntConstant
+                && ((IntConstant) ((DefinitionStmt) prev).getRightOp()).value >= 0;
+
+        PatchingChain<Unit> chain = body.getUnits();
+        if (lengthLocal != null) {
+            // Read the length once before the loop and let the header use
+            // the hoisted value. The null check is done by the hoisted read.
+            Local length = Jimple.v().newLocal(newLocalName(body, "$len"), IntType.v());
+            body.getLocals().add(length);
+            AssignStmt hoisted = Jimple.v().newAssignStmt(length, Jimple.v().newLengthExpr(lengthArray));
+            hoisted.addAllTagsOf(header);
+            chain.getNonPatchingChain().insertBefore(hoisted, header);
+            ((AssignStmt) header).setRightOp(length);
+            bound = length;
+        }
+        NopStmt preheader = Jimple.v().newNopStmt();
+        preheader.addAllTagsOf(header);
+        chain.getNonPatchingChain().insertBefore(preheader, header);
+
+        Map<Value, Guard> guards = new HashMap<>();
+        for (Stmt stmt : accesses) {
+            Local array = (Local) getArrayRef((AssignStmt) stmt).getBase();
+            Guard guard = guards.get(array);
+            if (guard == null) {
+                guard = new Guard(preheader, indexNonNegative ? null : index,
+                        array == lengthArray ? null : array, bound);
+                guards.put(array, guard);
+            }
+            result.put(stmt, guard);
+        }
+    }
+
+    private static Local getIncrementedLocal(Unit unit) {
+        if (!(unit instanceof AssignStmt) || !(((AssignStmt) unit).getRightOp() instanceof AddExpr)) {
+            return null;
+        }
+        Value left = ((AssignStmt) unit).getLeftOp();
+        AddExpr expr = (AddExpr) ((AssignStmt) unit).getRightOp();
+        if (!(left instanceof Local) || !(left.getType() instanceof IntType)) {
+            return null;
+        }
+        IntConstant one = IntConstant.v(1);
+        if (expr.getOp1() == left && one.equals(expr.getOp2())
+                || expr.getOp2() == left && one.equals(expr.getOp1())) {
+            return (Local) left;
+        }
+        return null;
+    }
+
+    private static Value getBound(Value condition, Local index) {
+        if (condition instanceof GeExpr && ((GeExpr) condition).getOp1() == index) {
+            return ((GeExpr) condition).getOp2();
+        }
+        if (condition instanceof LeExpr && ((LeExpr) condition).getOp2() == index) {
+            return ((LeExpr) condition).getOp1();
+        }
+        return null;
+    }
+
+    private static ArrayRef getArrayRef(AssignStmt stmt) {
+        if (stmt.getLeftOp() instanceof ArrayRef) {
+            return (ArrayRef) stmt.getLeftOp();
+        }
+        if (stmt.getRightOp() instanceof ArrayRef) {
+            return (ArrayRef) stmt.getRightOp();
+        }
+        return null;
+    }
+
+    private static String newLocalName(Body body, String prefix) {
+        for (int i = 0;; i++) {
+            String name = prefix + i;
+            boolean exists = false;
+            for (Local l : body.getLocals()) {
+                if (l.getName().equals(name)) {
+                    exists = true;
+                    break;
+                }
+            }
+            if (!exists) {
+                return name;
+            }
+        }
+    }
+}
@@ -173,6 +173,18 @@ public class Symbols {
     public static String linetableSymbol(SootMethod method) {
         return methodSymbol(method, "linetable");
     }
+
+    public static String profileCounterSymbol(SootMethod method) {
+        return methodSymbol(method, "profilecounter");
+    }
+
+    public static String profileBranchCounterSymbol(SootMethod method, int index) {
+        return methodSymbol(method, "profilebranch" + index);
+    }
+
+    public static String profileReceiverSiteSymbol(SootMethod method, int index) {
+        return methodSymbol(method, "profilereceiver" + index);
+    }
     
     public static String methodSymbolPrefix(String owner) {
         StringBuilder sb = new StringBuilder(EXTERNAL_SYMBOL_PREFIX);
@@ -242,10 +254,34 @@ public class Symbols {
         return functionWrapper(methodSymbol(owner, name, desc), "lookup");
     }
 
+    public static String dispatchSymbol(SootMethod method) {
+        return functionWrapper(methodSymbol(method), "dispatch");
+    }
+
+    public static String dispatchSymbol(String owner, String name, String desc) {
+        return functionWrapper(methodSymbol(owner, name, desc), "dispatch");
+    }
+
+    public static String devirtualizedSymbol(SootMethod method) {
+        return methodSymbol(method, "devirtualized");
+    }
+
+    public static String devirtualizedSymbol(String owner, String name, String desc) {
+        return methodSymbol(owner, name, desc, "devirtualized");
+    }
+
     public static String clinitWrapperSymbol(String targetFnName) {
         return functionWrapper(targetFnName, "clinit");
     }
 
+    public static String clinitSlowPathSymbol(String targetFnName) {
+        return functionWrapper(targetFnName, "clinit_slow");
+    }
+
+    public static String clinitSlotSymbol(String targetFnName) {
+        return functionWrapper(targetFnName, "clinit_slot");
+    }
+
     private static String functionWrapper(String targetFnName, String type) {
         if (!targetFnName.startsWith(EXTERNAL_SYMBOL_PREFIX) && !targetFnName.startsWith(INTERNAL_SYMBOL_PREFIX)) {
             throw new IllegalArgumentException("Expected symbol prefix not found: " + targetFnName);
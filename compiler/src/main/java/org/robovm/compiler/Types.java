@@ -27,6 +27,7 @@ import java.util.List;
 import org.robovm.compiler.config.Arch;
 import org.robovm.compiler.config.OS;
 import org.robovm.compiler.llvm.AggregateType;
+import org.robovm.compiler.llvm.ArrayType;
 import org.robovm.compiler.llvm.Bitcast;
 import org.robovm.compiler.llvm.Constant;
 import org.robovm.compiler.llvm.ConstantGetelementptr;
@@ -76,7 +77,7 @@ public class Types {
     public static final StructureType BC_TRYCATCH_CONTEXT = new StructureType("BcTrycatchContext", TRYCATCH_CONTEXT, I8_PTR);
     public static final Type BC_TRYCATCH_CONTEXT_PTR = new PointerType(BC_TRYCATCH_CONTEXT);
     public static final Type ENV_PTR = new PointerType(new StructureType("Env", I8_PTR, I8_PTR, I8_PTR, 
-            I8_PTR, I8_PTR, I8_PTR, I8_PTR, I8_PTR, I32));
+            I8_PTR, I8_PTR, I8_PTR, I8_PTR, I8_PTR, I32, new ArrayType(8, I8_PTR)));
     // Dummy Class type definition. The real one is in header.ll
     public static final StructureType CLASS = new StructureType("Class", I8_PTR);
     public static final Type CLASS_PTR = new PointerType(CLASS);
@@ -87,6 +88,15 @@ public class Types {
     // Dummy VITable type definition. The real one is in header.ll
     public static final StructureType VITABLE = new StructureType("VITable", I8_PTR);
     public static final Type VITABLE_PTR = new PointerType(VITABLE);
+    // Dummy ProfileCounter type definition. The real one is in header.ll
+    public static final StructureType PROFILE_COUNTER = new StructureType("ProfileCounter", I64, I64, I8_PTR, I32, I32);
+    public static final Type PROFILE_COUNTER_PTR = new PointerType(PROFILE_COUNTER);
+    // Dummy ProfileReceiverSite type definition. The real one is in header.ll
+    public static final StructureType PROFILE_RECEIVER_SITE = new StructureType("ProfileReceiverSite", I8_PTR, I32, I64);
+    public static final Type PROFILE_RECEIVER_SITE_PTR = new PointerType(PROFILE_RECEIVER_SITE);
+    // Dummy InlineCache type definition. The real one is in header.ll
+    public static final StructureType INLINE_CACHE = new StructureType("InlineCache", I8_PTR);
+    public static final Type INLINE_CACHE_PTR = new PointerType(INLINE_CACHE);
     
     public static final Type OBJECT_PTR = new PointerType(OBJECT);
     public static final Type METHOD_PTR = new PointerType(new OpaqueType("Method"));
@@ -91,6 +91,14 @@ public abstract class Clazz implements Comparable<Clazz> {
         return clazzInfo;
     }
 
+    /**
+     * Discards the {@link ClazzInfo} returned by {@link #getClazzInfo()}. It
+     * will be read from the info file again the next time it's needed.
+     */
+    public void clearClazzInfo() {
+        clazzInfo = null;
+    }
+
     public ClazzInfo resetClazzInfo() {
         clazzInfo = new ClazzInfo(this, getSootClass());
         return clazzInfo;
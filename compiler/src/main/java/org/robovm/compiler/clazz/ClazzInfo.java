@@ -271,6 +271,31 @@ public class ClazzInfo implements Serializable {
         dependencies = new HashMap<String, Dependency>();
     }
 
+    /**
+     * Looks up all classes this class depends on again and updates the paths
+     * recorded for them. Used when this {@link ClazzInfo} was saved by a
+     * build with a different classpath, e.g. when it has been restored from
+     * the {@link org.robovm.compiler.ObjectCache}.
+     */
+    public void relocateDependencies() {
+        Collection<Dependency> deps = dependencies.values();
+        clearDependencies();
+        for (Dependency dep : deps) {
+            if (dep instanceof InvokeMethodDependency) {
+                MethodDependency md = (MethodDependency) dep;
+                addInvokeMethodDependency(md.getOwner(), md.getMethodName(), md.getMethodDesc(), md.isWeak());
+            } else if (dep instanceof SuperMethodDependency) {
+                MethodDependency md = (MethodDependency) dep;
+                addSuperMethodDependency(md.getOwner(), md.getMethodName(), md.getMethodDesc(), md.isWeak());
+            } else {
+                addClassDependency(dep.getClassName(), dep.isWeak());
+            }
+        }
+        for (MethodInfo mi : methods) {
+            mi.relocateDependencies();
+        }
+    }
+
     public Set<Dependency> getDependencies() {
         return new HashSet<Dependency>(dependencies.values());
     }
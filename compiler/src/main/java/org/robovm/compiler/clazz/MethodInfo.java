@@ -98,6 +98,25 @@ public class MethodInfo implements Serializable {
         }
     }
 
+    /**
+     * @see ClazzInfo#relocateDependencies()
+     */
+    void relocateDependencies() {
+        Collection<Dependency> deps = dependencies.values();
+        dependencies = new HashMap<>();
+        for (Dependency dep : deps) {
+            if (dep instanceof InvokeMethodDependency) {
+                MethodDependency md = (MethodDependency) dep;
+                addInvokeMethodDependency(md.getOwner(), md.getMethodName(), md.getMethodDesc(), md.isWeak());
+            } else if (dep instanceof SuperMethodDependency) {
+                MethodDependency md = (MethodDependency) dep;
+                addSuperMethodDependency(md.getOwner(), md.getMethodName(), md.getMethodDesc(), md.isWeak());
+            } else {
+                addClassDependency(dep.getClassName(), dep.isWeak());
+            }
+        }
+    }
+
     public Set<Dependency> getDependencies() {
         return new HashSet<Dependency>(dependencies.values());
     }
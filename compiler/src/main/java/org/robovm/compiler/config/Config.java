@@ -25,6 +25,7 @@ import java.io.InputStreamReader;
 import java.io.OutputStream;
 import java.io.OutputStreamWriter;
 import java.io.Reader;
+import java.io.StringReader;
 import java.io.Writer;
 import java.lang.reflect.Field;
 import java.lang.reflect.Method;
@@ -65,6 +66,7 @@ import org.robovm.compiler.plugin.LaunchPlugin;
 import org.robovm.compiler.plugin.Plugin;
 import org.robovm.compiler.plugin.PluginArgument;
 import org.robovm.compiler.plugin.TargetPlugin;
+import org.robovm.compiler.profile.Profile;
 import org.robovm.compiler.plugin.annotation.AnnotationImplPlugin;
 import org.robovm.compiler.plugin.lambda.LambdaPlugin;
 import org.robovm.compiler.plugin.objc.InterfaceBuilderClassesPlugin;
@@ -114,6 +116,16 @@ public class Config {
         none, conservative, aggressive
     };
 
+    /**
+     * Method profiling instrumentation emitted by the compiler.
+     * {@link #counts} emits a per-method entry counter. {@link #timings}
+     * additionally accumulates the CPU cycle counter delta between method
+     * entry and normal method return.
+     */
+    public enum ProfileInstrumentation {
+        none, counts, timings
+    };
+
     @Element(required = false)
     private File installDir = null;
     @Element(required = false)
@@ -185,6 +197,7 @@ public class Config {
     private Home home = null;
     private File tmpDir;
     private File cacheDir = new File(System.getProperty("user.home"), ".robovm/cache");
+    private File sharedCacheDir = null;
     private File ccBinPath = null;
 
     private boolean clean = false;
@@ -193,6 +206,15 @@ public class Config {
     private boolean skipLinking = false;
     private boolean skipInstall = false;
     private boolean dumpIntermediates = false;
+    private ProfileInstrumentation profileInstrumentation = ProfileInstrumentation.none;
+    private File profileInput = null;
+    private boolean zeroCostExceptions = true;
+    private boolean wholeProgramOptimization = false;
+    private boolean escapeAnalysis = true;
+    private boolean vectorizeLoops = false;
+    private boolean incrementalLinking = false;
+    private File functionOrderFile = null;
+    private boolean orderFunctions = false;
     private int threads = Runtime.getRuntime().availableProcessors();
     private Logger logger = Logger.NULL_LOGGER;
 
@@ -215,6 +237,7 @@ public class Config {
     private transient Config configBeforeBuild;
     private transient DependencyGraph dependencyGraph;
     private transient Arch sliceArch;
+    private transient Profile profile;
 
     protected Config() throws IOException {
         // Add standard plugins
@@ -265,6 +288,15 @@ public class Config {
         return osArchCacheDir;
     }
 
+    /**
+     * Returns the directory of the {@link org.robovm.compiler.ObjectCache}
+     * shared between builds or {@code null} if no object cache should be
+     * used.
+     */
+    public File getSharedCacheDir() {
+        return sharedCacheDir;
+    }
+
     public File getCcBinPath() {
         return ccBinPath;
     }
@@ -310,6 +342,91 @@ public class Config {
         return dumpIntermediates;
     }
 
+    public ProfileInstrumentation getProfileInstrumentation() {
+        return profileInstrumentation;
+    }
+
+    public File getProfileInput() {
+        return profileInput;
+    }
+
+    /**
+     * Returns the {@link Profile} read from {@link #getProfileInput()} or
+     * {@code null} if no profile should be used to guide optimizations.
+     */
+    public Profile getProfile() {
+        return profile;
+    }
+
+    /**
+     * Returns {@code true} if try/catch blocks are compiled into LLVM
+     * landingpads and DWARF unwind tables. Only supported on Linux x86_64.
+     * Other targets always use the trycatch mechanism which saves the
+     * registers on entry to every method with a try/catch block.
+     */
+    public boolean isZeroCostExceptions() {
+        return zeroCostExceptions && os == OS.linux && sliceArch == Arch.x86_64;
+    }
+
+    /**
+     * Returns {@code true} if the {@link org.robovm.compiler.Linker} should
+     * merge the bitcode of all linked classes into a single module and
+     * optimize it as a whole which lets LLVM inline methods across classes.
+     * Never enabled for debug builds.
+     */
+    public boolean isWholeProgramOptimization() {
+        return wholeProgramOptimization && !debug;
+    }
+
+    /**
+     * Returns {@code true} if objects and small arrays which never leave the
+     * method creating them should be allocated on the stack of that method.
+     * Never enabled for debug builds.
+     */
+    public boolean isEscapeAnalysis() {
+        return escapeAnalysis && !debug;
+    }
+
+    /**
+     * Returns {@code true} if loops over arrays should be versioned on a
+     * runtime guard so that their array accesses need no checks, and the
+     * LLVM loop and SLP vectorizers be run. Makes builds slower and
+     * executables larger. Array checks which can be eliminated without a
+     * guard are always eliminated. Never enabled for debug builds.
+     */
+    public boolean isVectorizeLoops() {
+        return vectorizeLoops && !debug;
+    }
+
+    /**
+     * Returns {@code true} if the {@link org.robovm.compiler.Linker} should
+     * link the class object files into cached partially linked object files
+     * which are only relinked if any of their classes have changed. Ignored
+     * with whole program optimization.
+     */
+    public boolean isIncrementalLinking() {
+        return incrementalLinking;
+    }
+
+    /**
+     * Returns the file listing the methods to place first in the executable,
+     * in the order they should be placed, or {@code null} if none has been
+     * set. See {@link org.robovm.compiler.FunctionOrder}.
+     */
+    public File getFunctionOrderFile() {
+        return functionOrderFile;
+    }
+
+    /**
+     * Returns {@code true} if the methods most likely to run at startup
+     * should be placed first in the executable when no
+     * {@link #getFunctionOrderFile()} has been set. The order is taken from
+     * the {@link #getProfile()} if available.
+     */
+    public boolean isOrderFunctions() {
+        return orderFunctions;
+    }
+
     public boolean isSkipRuntimeLib() {
         return skipRuntimeLib != null && skipRuntimeLib.booleanValue();
     }
@@ -890,7 +1007,32 @@ public class Config {
 
         File osDir = new File(cacheDir, os.toString());
         File archDir = new File(osDir, sliceArch.toString());
-        osArchCacheDir = new File(archDir, debug ? "debug" : "release");
+        String buildType = debug ? "debug" : "release";
+        if (profileInstrumentation != ProfileInstrumentation.none) {
+            // Instrumented object files must never be mixed with regular ones
+            buildType += "-profile-" + profileInstrumentation;
+        }
+        if (profileInput != null) {
+            // Object files optimized using different profiles must never be mixed
+            String s = FileUtils.readFileToString(profileInput, "UTF-8");
+            profile = Profile.read(new StringReader(s));
+            buildType += "-pgo-" + DigestUtil.sha1(s);
+        }
+        if (!zeroCostExceptions && os == OS.linux && sliceArch == Arch.x86_64) {
+            // Methods compiled without unwind tables can't be unwound through
+            buildType += "-trycatch";
+        }
+        if (wholeProgramOptimization && !debug) {
+            // The class bitcode needed by the Linker is only kept in this cache
+            buildType += "-wpo";
+        }
+        if (!escapeAnalysis && !debug) {
+            buildType += "-noea";
+        }
+        if (vectorizeLoops && !debug) {
+            buildType += "-vec";
+        }
+        osArchCacheDir = new File(archDir, buildType);
         osArchCacheDir.mkdirs();
 
         this.clazzes = new Clazzes(this, realBootclasspath, classpath);
@@ -1162,6 +1304,11 @@ public class Config {
             return this;
         }
 
+        public Builder sharedCacheDir(File sharedCacheDir) {
+            config.sharedCacheDir = sharedCacheDir;
+            return this;
+        }
+
         public Builder clean(boolean b) {
             config.clean = b;
             return this;
@@ -1187,6 +1334,51 @@ public class Config {
             return this;
         }
 
+        public Builder zeroCostExceptions(boolean b) {
+            config.zeroCostExceptions = b;
+            return this;
+        }
+
+        public Builder wholeProgramOptimization(boolean b) {
+            config.wholeProgramOptimization = b;
+            return this;
+        }
+
+        public Builder escapeAnalysis(boolean b) {
+            config.escapeAnalysis = b;
+            return this;
+        }
+
+        public Builder vectorizeLoops(boolean b) {
+            config.vectorizeLoops = b;
+            return this;
+        }
+
+        public Builder incrementalLinking(boolean b) {
+            config.incrementalLinking = b;
+            return this;
+        }
+
+        public Builder functionOrderFile(File functionOrderFile) {
+            config.functionOrderFile = functionOrderFile;
+            return this;
+        }
+
+        public Builder orderFunctions(boolean b) {
+            config.orderFunctions = b;
+            return this;
+        }
+
+        public Builder profileInstrumentation(ProfileInstrumentation profileInstrumentation) {
+            config.profileInstrumentation = profileInstrumentation;
+            return this;
+        }
+
+        public Builder profileInput(File profileInput) {
+            config.profileInput = profileInput;
+            return this;
+        }
+
         public Builder skipRuntimeLib(boolean b) {
             config.skipRuntimeLib = b;
             return this;
@@ -26,10 +26,16 @@ import java.util.Set;
 public class Alloca extends Instruction {
     private final Variable result;
     private final Type type;
+    private final int alignment;
 
     public Alloca(Variable result, Type type) {
+        this(result, type, 0);
+    }
+
+    public Alloca(Variable result, Type type, int alignment) {
         this.result = result;
         this.type = type;
+        this.alignment = alignment;
     }
 
     @Override
@@ -47,6 +53,9 @@ public class Alloca extends Instruction {
 
     @Override
     public String toString() {
+        if (alignment > 0) {
+            return result + " = alloca " + type + ", align " + alignment;
+        }
         return result + " = alloca " + type;
     }
 }
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler.llvm;
+
+/**
+ * {@link Metadata} used to attach branch weights to a conditional
+ * {@link Br}. Weights are scaled down proportionally to fit in an
+ * {@code i32}. LLVM doesn't accept zero weights so the smallest weight
+ * emitted is 1.
+ */
+public class BranchWeightsMetadata extends Metadata {
+    private final MetadataNode value;
+
+    public BranchWeightsMetadata(long trueWeight, long falseWeight) {
+        long max = Math.max(trueWeight, falseWeight);
+        long scale = max > Integer.MAX_VALUE ? max / Integer.MAX_VALUE + 1 : 1;
+        this.value = new MetadataNode(new MetadataString("branch_weights"), 
+                new IntegerConstant((int) Math.max(1, trueWeight / scale)), 
+                new IntegerConstant((int) Math.max(1, falseWeight / scale)));
+    }
+
+    @Override
+    public String toString() {
+        return "!prof " + value;
+    }
+    
+}
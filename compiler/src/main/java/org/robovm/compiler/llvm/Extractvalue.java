@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler.llvm;
+
+import java.util.Collections;
+import java.util.Set;
+
+/**
+ * Extracts a member of an aggregate value, e.g. the selector of a
+ * {@link Landingpad} result.
+ */
+public class Extractvalue extends Instruction {
+    private final Variable result;
+    private final Value aggregate;
+    private final int[] indices;
+
+    public Extractvalue(Variable result, Value aggregate, int ... indices) {
+        if (indices.length == 0) {
+            throw new IllegalArgumentException("At least one index expected");
+        }
+        this.result = result;
+        this.aggregate = aggregate;
+        this.indices = indices;
+    }
+
+    @Override
+    public Set<Variable> getWritesTo() {
+        return Collections.singleton(result);
+    }
+
+    @Override
+    public Set<VariableRef> getReadsFrom() {
+        if (aggregate instanceof VariableRef) {
+            return Collections.singleton((VariableRef) aggregate);
+        }
+        return super.getReadsFrom();
+    }
+
+    @Override
+    public String toString() {
+        StringBuilder sb = new StringBuilder();
+        sb.append(result);
+        sb.append(" = extractvalue ");
+        sb.append(aggregate.getType());
+        sb.append(' ');
+        sb.append(aggregate);
+        for (int index : indices) {
+            sb.append(", ");
+            sb.append(index);
+        }
+        return sb.toString();
+    }
+}
@@ -22,6 +22,6 @@ package org.robovm.compiler.llvm;
  */
 public enum FunctionAttribute {
 
-    noinline, optsize, alwaysinline, nounwind;
+    noinline, optsize, alwaysinline, nounwind, cold;
     
 }
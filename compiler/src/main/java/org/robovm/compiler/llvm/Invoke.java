@@ -16,6 +16,8 @@
  */
 package org.robovm.compiler.llvm;
 
+import java.util.HashSet;
+import java.util.Set;
 
 /**
  *
@@ -49,6 +51,13 @@ public class Invoke extends FunctionCallInstruction {
         this.unwind = unwind;
     }
 
+    @Override
+    public Set<BasicBlockRef> getBranchTargets() {
+        Set<BasicBlockRef> result = new HashSet<>();
+        result.add(to);
+        result.add(unwind);
+        return result;
+    }
     
     @Override
     public int hashCode() {
@@ -16,6 +16,9 @@
  */
 package org.robovm.compiler.llvm;
 
+import java.util.Collections;
+import java.util.Set;
+
 /**
  * @author niklas
  *
@@ -40,6 +43,11 @@ public class Landingpad extends Instruction {
         System.arraycopy(clauses, 0, this.clauses, 0, clauses.length);
     }
 
+    @Override
+    public Set<Variable> getWritesTo() {
+        return Collections.singleton(result);
+    }
+
     @Override
     public String toString() {
         StringBuilder sb = new StringBuilder();
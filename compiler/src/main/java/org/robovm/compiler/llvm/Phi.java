@@ -28,8 +28,19 @@ import java.util.Set;
 public class Phi extends Instruction {
     private final Variable result;
     private final VariableRef[] vars;
+    private final BasicBlockRef[] blocks;
 
     public Phi(Variable result, VariableRef ... vars) {
+        this(result, vars, null);
+    }
+
+    /**
+     * Creates a phi which takes {@code vars[i]} when control comes from
+     * {@code blocks[i]}. Use this when a variable isn't defined in the block
+     * which branches to the block containing the phi, e.g. when it is the
+     * result of an {@link Invoke}.
+     */
+    public Phi(Variable result, VariableRef[] vars, BasicBlockRef[] blocks) {
         if (vars.length < 2) {
             throw new IllegalArgumentException("At least two variables expected");
         }
@@ -39,8 +50,12 @@ public class Phi extends Instruction {
                 throw new IllegalArgumentException("Type mismatch in variable " + vars[i]);
             }
         }
+        if (blocks != null && blocks.length != vars.length) {
+            throw new IllegalArgumentException("Expected one block per variable");
+        }
         this.result = result;
         this.vars = vars;
+        this.blocks = blocks;
     }
     
     @Override
@@ -66,9 +81,12 @@ public class Phi extends Instruction {
             sb.append("[ ");
             sb.append(vars[i].toString());
             sb.append(", ");
-            BasicBlock bb = basicBlock.getFunction().getDefinedIn(vars[i]);
             sb.append('%');
-            sb.append(bb.getName());
+            if (blocks != null) {
+                sb.append(blocks[i].getName());
+            } else {
+                sb.append(basicBlock.getFunction().getDefinedIn(vars[i]).getName());
+            }
             sb.append(" ]");
         }
         return sb.toString();
@@ -0,0 +1,472 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler.profile;
+
+import java.io.BufferedReader;
+import java.io.File;
+import java.io.IOException;
+import java.io.PrintWriter;
+import java.io.Reader;
+import java.io.StringReader;
+import java.io.Writer;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.Comparator;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Map.Entry;
+
+import org.apache.commons.io.FileUtils;
+import org.apache.commons.io.IOUtils;
+
+/**
+ * Report written by profile instrumented code (see
+ * {@code -profile-instrument} and {@code -rvm:ProfileFile=<file>}) and read
+ * back in by {@code -profile-use}. Each non-comment line of a report is one of
+ * 
+ * <pre>
+ * m TAB &lt;count&gt; TAB &lt;cycles&gt; TAB &lt;method&gt;
+ * b TAB &lt;count&gt; TAB &lt;taken&gt; TAB &lt;method&gt; TAB &lt;index&gt;
+ * r TAB &lt;count&gt; TAB &lt;class&gt; TAB &lt;method&gt; TAB &lt;index&gt;
+ * </pre>
+ * 
+ * where {@code method} is {@code <owner>.<name><desc>} and {@code owner} is
+ * the internal name of the class declaring the method. {@code m} lines hold
+ * the number of calls to a method. {@code b} lines hold the number of times
+ * the {@code index}th conditional branch in a method was executed and taken.
+ * {@code r} lines hold the number of times a class was seen as receiver at
+ * the {@code index}th virtual or interface call site in a method. A
+ * {@code class} of {@code *} counts receivers which didn't fit in the
+ * per-site table. Version 1 reports, which only contain method lines without
+ * the leading {@code m} field, are also accepted. Lines starting with
+ * {@code #} are ignored.
+ */
+public class Profile {
+    public static final int VERSION = 2;
+
+    /**
+     * Fraction of all method calls in a profile which must be covered by the
+     * methods considered hot.
+     */
+    private static final double HOT_FRACTION = 0.9;
+
+    /**
+     * Class name used in reports for receivers not recorded separately.
+     */
+    public static final String OTHER_RECEIVERS = "*";
+
+    private final Map<String, MethodProfile> methods = new LinkedHashMap<>();
+    private final Map<String, BranchProfile> branches = new LinkedHashMap<>();
+    private final Map<String, ReceiverProfile> receivers = new LinkedHashMap<>();
+    private long hotThreshold = -1;
+
+    /**
+     * Profile data for a single method.
+     */
+    public static class MethodProfile {
+        private final String owner;
+        private final String name;
+        private final String desc;
+        private long count;
+        private long cycles;
+
+        MethodProfile(String owner, String name, String desc, long count, long cycles) {
+            this.owner = owner;
+            this.name = name;
+            this.desc = desc;
+            this.count = count;
+            this.cycles = cycles;
+        }
+
+        public String getOwner() {
+            return owner;
+        }
+
+        public String getName() {
+            return name;
+        }
+
+        public String getDesc() {
+            return desc;
+        }
+
+        public long getCount() {
+            return count;
+        }
+
+        public long getCycles() {
+            return cycles;
+        }
+
+        @Override
+        public String toString() {
+            return key(owner, name, desc);
+        }
+    }
+
+    /**
+     * Profile data for a single conditional branch.
+     */
+    public static class BranchProfile {
+        private final String method;
+        private final int index;
+        private long count;
+        private long taken;
+
+        BranchProfile(String method, int index, long count, long taken) {
+            this.method = method;
+            this.index = index;
+            this.count = count;
+            this.taken = taken;
+        }
+
+        public int getIndex() {
+            return index;
+        }
+
+        public long getCount() {
+            return count;
+        }
+
+        public long getTaken() {
+            return taken;
+        }
+
+        public long getNotTaken() {
+            return count - taken;
+        }
+
+        @Override
+        public String toString() {
+            return method + "#" + index;
+        }
+    }
+
+    /**
+     * Receiver classes seen at a single virtual or interface call site.
+     */
+    public static class ReceiverProfile {
+        private final String method;
+        private final int index;
+        private final Map<String, Long> classes = new LinkedHashMap<>();
+        private long count;
+
+        ReceiverProfile(String method, int index) {
+            this.method = method;
+            this.index = index;
+        }
+
+        public int getIndex() {
+            return index;
+        }
+
+        /**
+         * Returns the total number of calls made at this site.
+         */
+        public long getCount() {
+            return count;
+        }
+
+        /**
+         * Returns the number of calls made at this site with the specified
+         * class as receiver.
+         */
+        public long getCount(String clazz) {
+            Long l = classes.get(clazz);
+            return l != null ? l : 0;
+        }
+
+        /**
+         * Returns the internal name of the class which was the receiver of at
+         * least {@code minRatio} of all calls made at this site, or
+         * {@code null} if no such class exists or the site was called less
+         * than {@code minCount} times.
+         */
+        public String getDominantClass(double minRatio, long minCount) {
+            if (count < minCount || count == 0) {
+                return null;
+            }
+            for (Entry<String, Long> entry : classes.entrySet()) {
+                if (!OTHER_RECEIVERS.equals(entry.getKey()) && entry.getValue() >= minRatio * count) {
+                    return entry.getKey();
+                }
+            }
+            return null;
+        }
+
+        void add(String clazz, long n) {
+            classes.put(clazz, getCount(clazz) + n);
+            count += n;
+        }
+
+        @Override
+        public String toString() {
+            return method + "#" + index;
+        }
+    }
+
+    public Profile() {
+    }
+
+    public static Profile read(File file) throws IOException {
+        return read(FileUtils.readFileToString(file, "UTF-8"));
+    }
+
+    public static Profile read(Reader reader) throws IOException {
+        return read(IOUtils.toString(reader));
+    }
+
+    private static Profile read(String s) throws IOException {
+        Profile profile = new Profile();
+        BufferedReader reader = new BufferedReader(new StringReader(s));
+        String line = null;
+        int lineNumber = 0;
+        while ((line = reader.readLine()) != null) {
+            lineNumber++;
+            line = line.trim();
+            if (line.isEmpty() || line.startsWith("#")) {
+                continue;
+            }
+            String[] parts = line.split("\t");
+            if (parts.length == 3) {
+                // Version 1 method line
+                parts = new String[] {"m", parts[0], parts[1], parts[2]};
+            }
+            String type = parts[0];
+            if (!(type.equals("m") && parts.length == 4 
+                    || (type.equals("b") || type.equals("r")) && parts.length == 5)) {
+                throw new IOException("Malformed profile line " + lineNumber + ": " + line);
+            }
+            String method = parts[3];
+            int descStart = method.indexOf('(');
+            int nameStart = descStart == -1 ? -1 : method.lastIndexOf('.', descStart);
+            if (nameStart <= 0) {
+                throw new IOException("Malformed method in profile line " + lineNumber + ": " + method);
+            }
+            String owner = method.substring(0, nameStart);
+            String name = method.substring(nameStart + 1, descStart);
+            String desc = method.substring(descStart);
+            try {
+                long count = Long.parseLong(parts[1]);
+                if (type.equals("m")) {
+                    profile.add(owner, name, desc, count, Long.parseLong(parts[2]));
+                } else if (type.equals("b")) {
+                    profile.addBranch(owner, name, desc, Integer.parseInt(parts[4]), 
+                            count, Long.parseLong(parts[2]));
+                } else {
+                    profile.addReceiver(owner, name, desc, Integer.parseInt(parts[4]), parts[2], count);
+                }
+            } catch (NumberFormatException e) {
+                throw new IOException("Malformed count in profile line " + lineNumber + ": " + line);
+            }
+        }
+        return profile;
+    }
+
+    private static String key(String owner, String name, String desc) {
+        return owner + "." + name + desc;
+    }
+
+    private static String key(String owner, String name, String desc, int index) {
+        return key(owner, name, desc) + "#" + index;
+    }
+
+    /**
+     * Adds the specified counts to the method. Used when merging the reports
+     * of several runs.
+     */
+    public void add(String owner, String name, String desc, long count, long cycles) {
+        String key = key(owner, name, desc);
+        MethodProfile mp = methods.get(key);
+        if (mp == null) {
+            methods.put(key, new MethodProfile(owner, name, desc, count, cycles));
+        } else {
+            mp.count += count;
+            mp.cycles += cycles;
+        }
+        hotThreshold = -1;
+    }
+
+    /**
+     * Adds the specified counts to the {@code index}th conditional branch in
+     * the method.
+     */
+    public void addBranch(String owner, String name, String desc, int index, long count, long taken) {
+        String key = key(owner, name, desc, index);
+        BranchProfile bp = branches.get(key);
+        if (bp == null) {
+            branches.put(key, new BranchProfile(key(owner, name, desc), index, count, taken));
+        } else {
+            bp.count += count;
+            bp.taken += taken;
+        }
+    }
+
+    /**
+     * Adds the specified count to the receiver class at the {@code index}th
+     * virtual or interface call site in the method.
+     */
+    public void addReceiver(String owner, String name, String desc, int index, String clazz, long count) {
+        String key = key(owner, name, desc, index);
+        ReceiverProfile rp = receivers.get(key);
+        if (rp == null) {
+            rp = new ReceiverProfile(key(owner, name, desc), index);
+            receivers.put(key, rp);
+        }
+        rp.add(clazz, count);
+    }
+
+    public void merge(Profile other) {
+        for (MethodProfile mp : other.methods.values()) {
+            add(mp.owner, mp.name, mp.desc, mp.count, mp.cycles);
+        }
+        for (Entry<String, BranchProfile> entry : other.branches.entrySet()) {
+            BranchProfile bp = branches.get(entry.getKey());
+            BranchProfile obp = entry.getValue();
+            if (bp == null) {
+                branches.put(entry.getKey(), new BranchProfile(obp.method, obp.index, obp.count, obp.taken));
+            } else {
+                bp.count += obp.count;
+                bp.taken += obp.taken;
+            }
+        }
+        for (Entry<String, ReceiverProfile> entry : other.receivers.entrySet()) {
+            ReceiverProfile rp = receivers.get(entry.getKey());
+            ReceiverProfile orp = entry.getValue();
+            if (rp == null) {
+                rp = new ReceiverProfile(orp.method, orp.index);
+                receivers.put(entry.getKey(), rp);
+            }
+            for (Entry<String, Long> c : orp.classes.entrySet()) {
+                rp.add(c.getKey(), c.getValue());
+            }
+        }
+    }
+
+    public boolean isEmpty() {
+        return methods.isEmpty() && branches.isEmpty() && receivers.isEmpty();
+    }
+
+    /**
+     * Returns the profile of the specified method or {@code null} if the
+     * method was never called.
+     */
+    public MethodProfile getMethod(String owner, String name, String desc) {
+        return methods.get(key(owner, name, desc));
+    }
+
+    /**
+     * Returns the number of times the specified method was called.
+     */
+    public long getCount(String owner, String name, String desc) {
+        MethodProfile mp = getMethod(owner, name, desc);
+        return mp != null ? mp.count : 0;
+    }
+
+    public long getMaxCount() {
+        long max = 0;
+        for (MethodProfile mp : methods.values()) {
+            max = Math.max(max, mp.count);
+        }
+        return max;
+    }
+
+    /**
+     * Returns {@code true} if the specified method is among the most called
+     * methods which together account for 90% of all calls in this profile.
+     */
+    public boolean isHot(String owner, String name, String desc) {
+        if (hotThreshold == -1) {
+            long total = 0;
+            for (MethodProfile mp : methods.values()) {
+                total += mp.count;
+            }
+            long sum = 0;
+            hotThreshold = Long.MAX_VALUE;
+            for (MethodProfile mp : getMethods()) {
+                if (sum >= HOT_FRACTION * total || mp.count == 0) {
+                    break;
+                }
+                sum += mp.count;
+                hotThreshold = mp.count;
+            }
+        }
+        return getCount(owner, name, desc) >= hotThreshold;
+    }
+
+    /**
+     * Returns the profile of the {@code index}th conditional branch in the
+     * specified method or {@code null} if the branch was never executed.
+     */
+    public BranchProfile getBranch(String owner, String name, String desc, int index) {
+        return branches.get(key(owner, name, desc, index));
+    }
+
+    /**
+     * Returns the receivers seen at the {@code index}th virtual or interface
+     * call site in the specified method or {@code null} if the site was never
+     * executed.
+     */
+    public ReceiverProfile getReceivers(String owner, String name, String desc, int index) {
+        return receivers.get(key(owner, name, desc, index));
+    }
+
+    /**
+     * Returns all methods in this profile sorted on call count, hottest first.
+     */
+    public List<MethodProfile> getMethods() {
+        List<MethodProfile> l = new ArrayList<>(methods.values());
+        Collections.sort(l, new Comparator<MethodProfile>() {
+            @Override
+            public int compare(MethodProfile o1, MethodProfile o2) {
+                if (o1.count != o2.count) {
+                    return o1.count > o2.count ? -1 : 1;
+                }
+                if (o1.cycles != o2.cycles) {
+                    return o1.cycles > o2.cycles ? -1 : 1;
+                }
+                return o1.toString().compareTo(o2.toString());
+            }
+        });
+        return l;
+    }
+
+    public void write(Writer writer) throws IOException {
+        PrintWriter out = new PrintWriter(writer);
+        out.println("# robovm-profile " + VERSION);
+        out.println("# m\tcount\tcycles\tmethod");
+        out.println("# b\tcount\ttaken\tmethod\tindex");
+        out.println("# r\tcount\tclass\tmethod\tindex");
+        for (MethodProfile mp : getMethods()) {
+            out.println("m\t" + mp.count + "\t" + mp.cycles + "\t" + mp);
+        }
+        for (BranchProfile bp : branches.values()) {
+            out.println("b\t" + bp.count + "\t" + bp.taken + "\t" + bp.method + "\t" + bp.index);
+        }
+        for (ReceiverProfile rp : receivers.values()) {
+            for (Entry<String, Long> entry : rp.classes.entrySet()) {
+                out.println("r\t" + entry.getValue() + "\t" + entry.getKey() + "\t" 
+                        + rp.method + "\t" + rp.index);
+            }
+        }
+        out.flush();
+        if (out.checkError()) {
+            throw new IOException("Failed to write profile");
+        }
+    }
+}
@@ -42,6 +42,7 @@ import java.util.zip.ZipOutputStream;
 import org.apache.commons.io.FileUtils;
 import org.apache.commons.io.IOUtils;
 import org.apache.commons.lang3.StringUtils;
+import org.robovm.compiler.FunctionOrder;
 import org.robovm.compiler.clazz.Path;
 import org.robovm.compiler.config.Arch;
 import org.robovm.compiler.config.Config;
@@ -144,6 +145,11 @@ public abstract class AbstractTarget implements Target {
         exportedSymbols.add("JNI_OnLoad_*");
         exportedSymbols.addAll(config.getExportedSymbols());
 
+        List<String> orderedFunctions = new FunctionOrder(config).getSymbols();
+        if (!orderedFunctions.isEmpty()) {
+            config.getLogger().info("Placing %d functions first in the binary", orderedFunctions.size());
+        }
+
         if (config.getOs().getFamily() == OS.Family.linux) {
             ccArgs.add("-Wl,-rpath=$ORIGIN");
             ccArgs.add("-Wl,--gc-sections");
@@ -162,6 +168,14 @@ public abstract class AbstractTarget implements Target {
                 ccArgs.add("-Wl,--dynamic-list=" + dynamicListFile.getAbsolutePath());
             }
 
+            if (!orderedFunctions.isEmpty()) {
+                // Adds to the default linker script. Each function is in a
+                // section of its own.
+                File functionOrderFile = new File(config.getTmpDir(), "function_order.ld");
+                FunctionOrder.writeLinkerScript(functionOrderFile, orderedFunctions);
+                ccArgs.add("-Wl,-T," + functionOrderFile.getAbsolutePath());
+            }
+
         } else if (config.getOs().getFamily() == OS.Family.darwin) {
             ccArgs.add("-ObjC");
 
@@ -193,6 +207,12 @@ public abstract class AbstractTarget implements Target {
             ccArgs.add("-exported_symbols_list");
             ccArgs.add(exportedSymbolsFile.getAbsolutePath());
 
+            if (!orderedFunctions.isEmpty()) {
+                File functionOrderFile = new File(config.getTmpDir(), "function_order");
+                FunctionOrder.writeOrderFile(functionOrderFile, orderedFunctions);
+                ccArgs.add("-Wl,-order_file," + functionOrderFile.getAbsolutePath());
+            }
+
             ccArgs.add("-Wl,-no_implicit_dylibs");
             ccArgs.add("-Wl,-dead_strip");
         }
@@ -16,6 +16,10 @@
  */
 package org.robovm.compiler.util;
 
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
 import java.io.UnsupportedEncodingException;
 import java.security.MessageDigest;
 import java.security.NoSuchAlgorithmException;
@@ -42,6 +46,22 @@ public class DigestUtil {
         }
     }
     
+    public static String sha1(byte[] bytes) {
+        return encodeHex(digest("SHA1", bytes));
+    }
+
+    public static String sha1(File file) throws IOException {
+        MessageDigest md = getDigest("SHA1");
+        try (InputStream in = new FileInputStream(file)) {
+            byte[] buffer = new byte[64 * 1024];
+            int n;
+            while ((n = in.read(buffer)) != -1) {
+                md.update(buffer, 0, n);
+            }
+        }
+        return encodeHex(md.digest());
+    }
+
     private static byte[] digest(String algorithm, byte[] bytes) {
         return getDigest(algorithm).digest(bytes);
     }
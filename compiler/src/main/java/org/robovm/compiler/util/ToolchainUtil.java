@@ -317,8 +317,8 @@ public class ToolchainUtil {
         new Executor(config.getLogger(), getPackageApplication()).args(appDir, "-o", outFile).exec();
     }
 
-    private static List<File> writeObjectsFiles(Config config, List<File> objectFiles, int maxObjectsPerFile,
-            boolean quote) throws IOException {
+    private static List<File> writeObjectsFiles(Config config, String name, List<File> objectFiles,
+            int maxObjectsPerFile, boolean quote) throws IOException {
 
         ArrayList<File> files = new ArrayList<>();
         for (int i = 0, start = 0; start < objectFiles.size(); i++, start += maxObjectsPerFile) {
@@ -328,7 +328,7 @@ public class ToolchainUtil {
                 paths.add((quote ? "\"" : "") + f.getAbsolutePath() + (quote ? "\"" : ""));
             }
 
-            File objectsFile = new File(config.getTmpDir(), "objects" + i);
+            File objectsFile = new File(config.getTmpDir(), name + i);
             FileUtils.writeLines(objectsFile, paths, "\n");
             files.add(objectsFile);
         }
@@ -347,14 +347,47 @@ public class ToolchainUtil {
          * 
          * The linker on Linux will fail if we don't quote paths with spaces.
          */
-        List<File> objectsFiles = writeObjectsFiles(config, objectFiles, isDarwin ? 0xffff : Integer.MAX_VALUE,
-                !isDarwin);
+        List<File> objectsFiles = writeObjectsFiles(config, "objects", objectFiles,
+                isDarwin ? 0xffff : Integer.MAX_VALUE, !isDarwin);
 
         List<String> opts = new ArrayList<String>();
         if (config.isDebug()) {
             opts.add("-g");
         }
-        if (isDarwin) {
+        opts.addAll(getObjectsFilesOpts(config, objectsFiles));
+        opts.addAll(args);
+
+        new Executor(config.getLogger(), getCcPath(config)).args("-o", outFile, opts, libs).exec();
+    }
+
+    /**
+     * Links the specified object files into a single relocatable object file
+     * which can be passed to {@link #link(Config, List, List, List, File)}
+     * instead of them. Sections and weak symbols are kept as is so the final
+     * link still strips unused functions and lets strong symbols override
+     * weak ones.
+     * 
+     * @param name unique name used for the temporary files. Partial links
+     *        may run concurrently.
+     */
+    public static void partialLink(Config config, String name, List<File> objectFiles, File outFile)
+            throws IOException {
+
+        boolean isDarwin = config.getOs().getFamily() == OS.Family.darwin;
+        List<File> objectsFiles = writeObjectsFiles(config, name + "-objects", objectFiles,
+                isDarwin ? 0xffff : Integer.MAX_VALUE, !isDarwin);
+
+        List<String> opts = new ArrayList<String>();
+        opts.add("-r");
+        opts.add("-nostdlib");
+        opts.addAll(getObjectsFilesOpts(config, objectsFiles));
+
+        new Executor(config.getLogger(), getCcPath(config)).args("-o", outFile, opts).exec();
+    }
+
+    private static List<String> getObjectsFilesOpts(Config config, List<File> objectsFiles) {
+        List<String> opts = new ArrayList<String>();
+        if (config.getOs().getFamily() == OS.Family.darwin) {
             opts.add("-arch");
             opts.add(config.getArch().getClangName());
             for (File objectsFile : objectsFiles) {
@@ -366,9 +399,7 @@ public class ToolchainUtil {
                 opts.add("@" + objectsFile.getAbsolutePath());
             }
         }
-        opts.addAll(args);
-
-        new Executor(config.getLogger(), getCcPath(config)).args("-o", outFile, opts, libs).exec();
+        return opts;
     }
 
     private static String getCcPath(Config config) throws IOException {
@@ -1,6 +1,9 @@
 %TrycatchContext = type {i8*, i32, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i32, i16}
 %BcTrycatchContext = type {%TrycatchContext, i8*}
 
+; Personality routine of the landingpads emitted for try/catch blocks. See bc.c.
+declare i32 @_bcPersonality(...)
+
 define private void @checkso() alwaysinline {
   tail call void asm sideeffect "mov -0x10000(%rsp), %rax", "~{rax},~{dirflag},~{fpsr},~{flags},~{cc}"() nounwind
   ret void
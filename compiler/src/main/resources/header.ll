@@ -1,7 +1,7 @@
 %GatewayFrame = type {i8*, i8*, i8*}
 %StackFrame = type {i8*, i8*}
 %Thread = type {i32} ; Incomplete. Just enough to get threadId
-%Env = type {i8*, i8*, i8*, %Thread*, i8*, i8*, %GatewayFrame*, i8*, i32}
+%Env = type {i8*, i8*, i8*, %Thread*, i8*, i8*, %GatewayFrame*, i8*, i32, [8 x i8*]}
 %DebugEnv = type {%Env, i8*, i8*, i8*, i8*, i8, i8}
 %TypeInfo = type {i32, i32, i32, i32, i32, [0 x i32]}
 %VITable = type {i16, [0 x i8*]}
@@ -24,6 +24,16 @@
 %FloatArray = type {%DataObject, i32, float}
 %DoubleArray = type {%DataObject, i32, double}
 %ObjectArray = type {%DataObject, i32, %Object*}
+; NOTE: Must match the layout of java.lang.String as computed by the compiler (references first, then by alignment and then by name): value, count, hashCode, offset
+%String = type {%DataObject, %Object*, i32, i32, i32}
+
+; Per-method and per-branch profiling counter emitted when profile instrumentation is enabled. Must match ProfileCounter in types.h.
+%ProfileCounter = type {i64, i64, i8*, i32, i32}
+; Per-call site receiver class profile. Must match ProfileReceiverSite in types.h.
+%ProfileReceiverSite = type {i8*, i32, i64, [4 x {%Class*, i64}]}
+
+; Per-call site interface method cache. Must match InlineCache in bc.c.
+%InlineCache = type {[4 x {%Class*, i8*}], i32}
 
 @prim_Z = external global %Class*
 @prim_B = external global %Class*
@@ -48,6 +58,8 @@ declare %Object* @_bcAllocate(%Env*, i8**)
 declare %Object* @_bcLdcArrayBootClass(%Env*, %Object**, i8*)
 declare %Object* @_bcLdcArrayClass(%Env*, %Object**, i8*)
 declare %Object* @_bcLdcClass(%Env*, i8**)
+declare void @_bcProfileReceiver(%ProfileReceiverSite*, %Object*)
+declare i8* @_bcInlineCacheMiss(%Env*, %InlineCache*, i8**, %Object*, i32, i8*)
 declare %Object* @_bcNewObjectArray(%Env*, i32, %Object*)
 declare %Object* @_bcCheckcast(%Env*, i8**, %Object*)
 declare %Object* @_bcCheckcastArray(%Env*, %Object*, %Object*)
@@ -118,9 +130,21 @@ declare void @_bcHookInstrumented(%Env*, i32, i32, i8*, i8*)
 declare i8* @llvm.frameaddress(i32) nounwind readnone
 declare void @llvm.memcpy.p0i8.p0i8.i32(i8*, i8*, i32, i32, i1)
 declare void @llvm.memmove.p0i8.p0i8.i64(i8*, i8*, i64, i32, i1)
+declare void @llvm.memset.p0i8.i32(i8*, i8, i32, i32, i1)
 declare double @llvm.sqrt.f64(double)
 declare double @llvm.cos.f64(double)
 declare double @llvm.sin.f64(double)
+declare float @llvm.fma.f32(float, float, float)
+declare double @llvm.fma.f64(double, double, double)
+declare i32 @llvm.ctpop.i32(i32)
+declare i64 @llvm.ctpop.i64(i64)
+declare i32 @llvm.ctlz.i32(i32, i1)
+declare i64 @llvm.ctlz.i64(i64, i1)
+declare i32 @llvm.cttz.i32(i32, i1)
+declare i64 @llvm.cttz.i64(i64, i1)
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.bswap.i64(i64)
+declare i64 @llvm.readcyclecounter()
 
 define private i32 @Thread_threadId(%Thread* %t) alwaysinline {
     %1 = getelementptr %Thread* %t, i32 0, i32 0 ; Thread->threadId
@@ -388,6 +412,771 @@ define private void @intrinsics.org_robovm_rt_VM_memmove64(%Env* %env, i64 %s1,
     ret void
 }
 
+define private i32 @intrinsics.java_lang_Integer_bitCount(%Env* %env, i32 %i) alwaysinline {
+    %1 = call i32 @llvm.ctpop.i32(i32 %i)
+    ret i32 %1
+}
+
+define private i32 @intrinsics.java_lang_Long_bitCount(%Env* %env, i64 %l) alwaysinline {
+    %1 = call i64 @llvm.ctpop.i64(i64 %l)
+    %2 = trunc i64 %1 to i32
+    ret i32 %2
+}
+
+define private i32 @intrinsics.java_lang_Integer_numberOfLeadingZeros(%Env* %env, i32 %i) alwaysinline {
+    %1 = call i32 @llvm.ctlz.i32(i32 %i, i1 false)
+    ret i32 %1
+}
+
+define private i32 @intrinsics.java_lang_Long_numberOfLeadingZeros(%Env* %env, i64 %l) alwaysinline {
+    %1 = call i64 @llvm.ctlz.i64(i64 %l, i1 false)
+    %2 = trunc i64 %1 to i32
+    ret i32 %2
+}
+
+define private i32 @intrinsics.java_lang_Integer_numberOfTrailingZeros(%Env* %env, i32 %i) alwaysinline {
+    %1 = call i32 @llvm.cttz.i32(i32 %i, i1 false)
+    ret i32 %1
+}
+
+define private i32 @intrinsics.java_lang_Long_numberOfTrailingZeros(%Env* %env, i64 %l) alwaysinline {
+    %1 = call i64 @llvm.cttz.i64(i64 %l, i1 false)
+    %2 = trunc i64 %1 to i32
+    ret i32 %2
+}
+
+define private i32 @intrinsics.java_lang_Integer_reverseBytes(%Env* %env, i32 %i) alwaysinline {
+    %1 = call i32 @llvm.bswap.i32(i32 %i)
+    ret i32 %1
+}
+
+define private i64 @intrinsics.java_lang_Long_reverseBytes(%Env* %env, i64 %l) alwaysinline {
+    %1 = call i64 @llvm.bswap.i64(i64 %l)
+    ret i64 %1
+}
+
+define private i32 @intrinsics.java_lang_Math_min_I(%Env* %env, i32 %a, i32 %b) alwaysinline {
+    %1 = icmp slt i32 %a, %b
+    %2 = select i1 %1, i32 %a, i32 %b
+    ret i32 %2
+}
+
+define private i32 @intrinsics.java_lang_Math_max_I(%Env* %env, i32 %a, i32 %b) alwaysinline {
+    %1 = icmp sgt i32 %a, %b
+    %2 = select i1 %1, i32 %a, i32 %b
+    ret i32 %2
+}
+
+define private i64 @intrinsics.java_lang_Math_min_J(%Env* %env, i64 %a, i64 %b) alwaysinline {
+    %1 = icmp slt i64 %a, %b
+    %2 = select i1 %1, i64 %a, i64 %b
+    ret i64 %2
+}
+
+define private i64 @intrinsics.java_lang_Math_max_J(%Env* %env, i64 %a, i64 %b) alwaysinline {
+    %1 = icmp sgt i64 %a, %b
+    %2 = select i1 %1, i64 %a, i64 %b
+    ret i64 %2
+}
+
+; Math.min() and Math.max() on floating point values return NaN if any of the
+; arguments is NaN and order -0.0 before 0.0. The bits of equal values are
+; or:ed (min) or and:ed (max) to get the sign of zeros right.
+define private float @intrinsics.java_lang_Math_min_F(%Env* %env, float %a, float %b) alwaysinline {
+    %lt = fcmp olt float %a, %b
+    %eq = fcmp oeq float %a, %b
+    %nan = fcmp uno float %a, %b
+    %1 = bitcast float %a to i32
+    %2 = bitcast float %b to i32
+    %3 = or i32 %1, %2
+    %4 = bitcast i32 %3 to float
+    %5 = select i1 %lt, float %a, float %b
+    %6 = select i1 %eq, float %4, float %5
+    %7 = select i1 %nan, float 0x7FF8000000000000, float %6 ; Float.NaN
+    ret float %7
+}
+
+define private float @intrinsics.java_lang_Math_max_F(%Env* %env, float %a, float %b) alwaysinline {
+    %gt = fcmp ogt float %a, %b
+    %eq = fcmp oeq float %a, %b
+    %nan = fcmp uno float %a, %b
+    %1 = bitcast float %a to i32
+    %2 = bitcast float %b to i32
+    %3 = and i32 %1, %2
+    %4 = bitcast i32 %3 to float
+    %5 = select i1 %gt, float %a, float %b
+    %6 = select i1 %eq, float %4, float %5
+    %7 = select i1 %nan, float 0x7FF8000000000000, float %6 ; Float.NaN
+    ret float %7
+}
+
+define private double @intrinsics.java_lang_Math_min_D(%Env* %env, double %a, double %b) alwaysinline {
+    %lt = fcmp olt double %a, %b
+    %eq = fcmp oeq double %a, %b
+    %nan = fcmp uno double %a, %b
+    %1 = bitcast double %a to i64
+    %2 = bitcast double %b to i64
+    %3 = or i64 %1, %2
+    %4 = bitcast i64 %3 to double
+    %5 = select i1 %lt, double %a, double %b
+    %6 = select i1 %eq, double %4, double %5
+    %7 = select i1 %nan, double 0x7FF8000000000000, double %6 ; Double.NaN
+    ret double %7
+}
+
+define private double @intrinsics.java_lang_Math_max_D(%Env* %env, double %a, double %b) alwaysinline {
+    %gt = fcmp ogt double %a, %b
+    %eq = fcmp oeq double %a, %b
+    %nan = fcmp uno double %a, %b
+    %1 = bitcast double %a to i64
+    %2 = bitcast double %b to i64
+    %3 = and i64 %1, %2
+    %4 = bitcast i64 %3 to double
+    %5 = select i1 %gt, double %a, double %b
+    %6 = select i1 %eq, double %4, double %5
+    %7 = select i1 %nan, double 0x7FF8000000000000, double %6 ; Double.NaN
+    ret double %7
+}
+
+define private float @intrinsics.java_lang_Math_fma_F(%Env* %env, float %a, float %b, float %c) alwaysinline {
+    %1 = call float @llvm.fma.f32(float %a, float %b, float %c)
+    ret float %1
+}
+
+define private double @intrinsics.java_lang_Math_fma_D(%Env* %env, double %a, double %b, double %c) alwaysinline {
+    %1 = call double @llvm.fma.f64(double %a, double %b, double %c)
+    ret double %1
+}
+
+define private i32 @intrinsics.java_lang_Float_floatToRawIntBits(%Env* %env, float %f) alwaysinline {
+    %1 = bitcast float %f to i32
+    ret i32 %1
+}
+
+define private i32 @intrinsics.java_lang_Float_floatToIntBits(%Env* %env, float %f) alwaysinline {
+    %nan = fcmp uno float %f, %f
+    %1 = bitcast float %f to i32
+    %2 = select i1 %nan, i32 2143289344, i32 %1 ; 0x7fc00000
+    ret i32 %2
+}
+
+define private float @intrinsics.java_lang_Float_intBitsToFloat(%Env* %env, i32 %i) alwaysinline {
+    %1 = bitcast i32 %i to float
+    ret float %1
+}
+
+define private i64 @intrinsics.java_lang_Double_doubleToRawLongBits(%Env* %env, double %d) alwaysinline {
+    %1 = bitcast double %d to i64
+    ret i64 %1
+}
+
+define private i64 @intrinsics.java_lang_Double_doubleToLongBits(%Env* %env, double %d) alwaysinline {
+    %nan = fcmp uno double %d, %d
+    %1 = bitcast double %d to i64
+    %2 = select i1 %nan, i64 9221120237041090560, i64 %1 ; 0x7ff8000000000000
+    ret i64 %2
+}
+
+define private double @intrinsics.java_lang_Double_longBitsToDouble(%Env* %env, i64 %l) alwaysinline {
+    %1 = bitcast i64 %l to double
+    ret double %1
+}
+
+; Returns true if System.arraycopy(%src, %srcPos, %dst, %dstPos, %length)
+; can't throw any exception when %src and %dst are known to be arrays of the
+; same primitive type or null. The arraycopy intrinsics below may only be
+; called if this returns true. Otherwise System.arraycopy() must be called to
+; get the exception.
+define private i1 @intrinsics.java_lang_System_arraycopy_guard(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %srcNull = icmp eq %Object* %src, null
+    %dstNull = icmp eq %Object* %dst, null
+    %null = or i1 %srcNull, %dstNull
+    br i1 %null, label %Fail, label %NotNull
+NotNull:
+    %srcLength = call i32 @arraylength_inbounds(%Object* %src)
+    %dstLength = call i32 @arraylength_inbounds(%Object* %dst)
+    %1 = or i32 %srcPos, %dstPos
+    %2 = or i32 %1, %length
+    %negative = icmp slt i32 %2, 0
+    %3 = sub i32 %srcLength, %length
+    %srcOut = icmp sgt i32 %srcPos, %3
+    %4 = sub i32 %dstLength, %length
+    %dstOut = icmp sgt i32 %dstPos, %4
+    %5 = or i1 %negative, %srcOut
+    %6 = or i1 %5, %dstOut
+    %ok = xor i1 %6, true
+    ret i1 %ok
+Fail:
+    ret i1 false
+}
+
+; Same as above for arrays of references. Every element of %src can be stored
+; in %dst if both arrays are of the same class.
+define private i1 @intrinsics.java_lang_System_arraycopy_guard_L(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %1 = call i1 @intrinsics.java_lang_System_arraycopy_guard(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length)
+    br i1 %1, label %CheckClass, label %Fail
+CheckClass:
+    %srcClass = call %Class* @Object_class(%Object* %src)
+    %dstClass = call %Class* @Object_class(%Object* %dst)
+    %2 = icmp eq %Class* %srcClass, %dstClass
+    ret i1 %2
+Fail:
+    ret i1 false
+}
+
+; Used for boolean[] and byte[].
+define private void @intrinsics.java_lang_System_arraycopy_B(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %1 = bitcast %Object* %src to %ByteArray*
+    %2 = getelementptr %ByteArray* %1, i32 0, i32 2
+    %3 = getelementptr i8* %2, i32 %srcPos
+    
+    %4 = bitcast %Object* %dst to %ByteArray*
+    %5 = getelementptr %ByteArray* %4, i32 0, i32 2
+    %6 = getelementptr i8* %5, i32 %dstPos
+    
+    %n = sext i32 %length to i64
+    call void @llvm.memmove.p0i8.p0i8.i64(i8* %6, i8* %3, i64 %n, i32 1, i1 false)
+    ret void
+}
+
+; Used for int[] and float[].
+define private void @intrinsics.java_lang_System_arraycopy_I(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %1 = bitcast %Object* %src to %IntArray*
+    %2 = getelementptr %IntArray* %1, i32 0, i32 2
+    %3 = getelementptr i32* %2, i32 %srcPos
+    
+    %4 = bitcast %Object* %dst to %IntArray*
+    %5 = getelementptr %IntArray* %4, i32 0, i32 2
+    %6 = getelementptr i32* %5, i32 %dstPos
+    
+    %s1 = bitcast i32* %6 to i8*
+    %s2 = bitcast i32* %3 to i8*
+    %n = sext i32 %length to i64
+    
+    call void @_bcMoveMemory32(i8* %s1, i8* %s2, i64 %n)
+    ret void
+}
+
+; Used for long[] and double[].
+define private void @intrinsics.java_lang_System_arraycopy_J(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %1 = bitcast %Object* %src to %LongArray*
+    %2 = getelementptr %LongArray* %1, i32 0, i32 2
+    %3 = getelementptr i64* %2, i32 %srcPos
+    
+    %4 = bitcast %Object* %dst to %LongArray*
+    %5 = getelementptr %LongArray* %4, i32 0, i32 2
+    %6 = getelementptr i64* %5, i32 %dstPos
+    
+    %s1 = bitcast i64* %6 to i8*
+    %s2 = bitcast i64* %3 to i8*
+    %n = sext i32 %length to i64
+    %n2 = shl i64 %n, 1
+    
+    call void @_bcMoveMemory32(i8* %s1, i8* %s2, i64 %n2)
+    ret void
+}
+
+; Copies references one at a time so that no other thread ever sees a
+; partially written reference.
+define private void @intrinsics.java_lang_System_arraycopy_L(%Env* %env, %Object* %src, i32 %srcPos, %Object* %dst, i32 %dstPos, i32 %length) alwaysinline {
+    %1 = bitcast %Object* %src to %ObjectArray*
+    %2 = getelementptr %ObjectArray* %1, i32 0, i32 2
+    %s = getelementptr %Object** %2, i32 %srcPos
+    %3 = bitcast %Object* %dst to %ObjectArray*
+    %4 = getelementptr %ObjectArray* %3, i32 0, i32 2
+    %d = getelementptr %Object** %4, i32 %dstPos
+    ; Copy backwards if the destination overlaps the end of the source
+    %backwards = icmp ult %Object** %s, %d
+    br i1 %backwards, label %Backwards, label %Forwards
+Forwards:
+    br label %ForwardsLoop
+ForwardsLoop:
+    %i = phi i32 [0, %Forwards], [%i1, %ForwardsBody]
+    %fdone = icmp eq i32 %i, %length
+    br i1 %fdone, label %Done, label %ForwardsBody
+ForwardsBody:
+    %fs = getelementptr %Object** %s, i32 %i
+    %fd = getelementptr %Object** %d, i32 %i
+    %fo = load %Object** %fs
+    store %Object* %fo, %Object** %fd
+    %i1 = add i32 %i, 1
+    br label %ForwardsLoop
+Backwards:
+    br label %BackwardsLoop
+BackwardsLoop:
+    %j = phi i32 [%length, %Backwards], [%j1, %BackwardsBody]
+    %bdone = icmp eq i32 %j, 0
+    br i1 %bdone, label %Done, label %BackwardsBody
+BackwardsBody:
+    %j1 = sub i32 %j, 1
+    %bs = getelementptr %Object** %s, i32 %j1
+    %bd = getelementptr %Object** %d, i32 %j1
+    %bo = load %Object** %bs
+    store %Object* %bo, %Object** %bd
+    br label %BackwardsLoop
+Done:
+    ret void
+}
+
+; Returns the number of elements to compare when checking arrays %a and %b
+; for equality as done by Arrays.equals() or -1 if they can't be equal.
+define private i32 @arrayequals_length(%Object* %a, %Object* %b) alwaysinline {
+    %same = icmp eq %Object* %a, %b
+    br i1 %same, label %Same, label %NotSame
+Same:
+    ret i32 0
+NotSame:
+    %aNull = icmp eq %Object* %a, null
+    %bNull = icmp eq %Object* %b, null
+    %null = or i1 %aNull, %bNull
+    br i1 %null, label %Differ, label %NotNull
+NotNull:
+    %aLength = call i32 @arraylength_inbounds(%Object* %a)
+    %bLength = call i32 @arraylength_inbounds(%Object* %b)
+    %1 = icmp eq i32 %aLength, %bLength
+    br i1 %1, label %Length, label %Differ
+Length:
+    ret i32 %aLength
+Differ:
+    ret i32 -1
+}
+
+define private i8 @arrayequals_i8(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %ByteArray*
+    %p = getelementptr %ByteArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %ByteArray*
+    %q = getelementptr %ByteArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr i8* %p, i32 %i
+    %qi = getelementptr i8* %q, i32 %i
+    %x = load i8* %pi
+    %y = load i8* %qi
+    %next = add i32 %i, 1
+    %eq = icmp eq i8 %x, %y
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i8 @arrayequals_i16(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %CharArray*
+    %p = getelementptr %CharArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %CharArray*
+    %q = getelementptr %CharArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr i16* %p, i32 %i
+    %qi = getelementptr i16* %q, i32 %i
+    %x = load i16* %pi
+    %y = load i16* %qi
+    %next = add i32 %i, 1
+    %eq = icmp eq i16 %x, %y
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i8 @arrayequals_i32(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %IntArray*
+    %p = getelementptr %IntArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %IntArray*
+    %q = getelementptr %IntArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr i32* %p, i32 %i
+    %qi = getelementptr i32* %q, i32 %i
+    %x = load i32* %pi
+    %y = load i32* %qi
+    %next = add i32 %i, 1
+    %eq = icmp eq i32 %x, %y
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i8 @arrayequals_i64(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %LongArray*
+    %p = getelementptr %LongArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %LongArray*
+    %q = getelementptr %LongArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr i64* %p, i32 %i
+    %qi = getelementptr i64* %q, i32 %i
+    %x = load i64* %pi
+    %y = load i64* %qi
+    %next = add i32 %i, 1
+    %eq = icmp eq i64 %x, %y
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+; Floating point elements are compared like Float.floatToIntBits() and
+; Double.doubleToLongBits() do: the bits must be equal or both must be NaN.
+define private i8 @arrayequals_float(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %FloatArray*
+    %p = getelementptr %FloatArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %FloatArray*
+    %q = getelementptr %FloatArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr float* %p, i32 %i
+    %qi = getelementptr float* %q, i32 %i
+    %x = load float* %pi
+    %y = load float* %qi
+    %next = add i32 %i, 1
+    %xBits = bitcast float %x to i32
+    %yBits = bitcast float %y to i32
+    %sameBits = icmp eq i32 %xBits, %yBits
+    %xNaN = fcmp uno float %x, %x
+    %yNaN = fcmp uno float %y, %y
+    %bothNaN = and i1 %xNaN, %yNaN
+    %eq = or i1 %sameBits, %bothNaN
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i8 @arrayequals_double(%Object* %a, %Object* %b) alwaysinline {
+    %n = call i32 @arrayequals_length(%Object* %a, %Object* %b)
+    %differ = icmp slt i32 %n, 0
+    br i1 %differ, label %False, label %Init
+Init:
+    %1 = bitcast %Object* %a to %DoubleArray*
+    %p = getelementptr %DoubleArray* %1, i32 0, i32 2
+    %2 = bitcast %Object* %b to %DoubleArray*
+    %q = getelementptr %DoubleArray* %2, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr double* %p, i32 %i
+    %qi = getelementptr double* %q, i32 %i
+    %x = load double* %pi
+    %y = load double* %qi
+    %next = add i32 %i, 1
+    %xBits = bitcast double %x to i64
+    %yBits = bitcast double %y to i64
+    %sameBits = icmp eq i64 %xBits, %yBits
+    %xNaN = fcmp uno double %x, %x
+    %yNaN = fcmp uno double %y, %y
+    %bothNaN = and i1 %xNaN, %yNaN
+    %eq = or i1 %sameBits, %bothNaN
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_B(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_i8(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_C(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_i16(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_I(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_i32(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_J(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_i64(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_F(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_float(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+define private i8 @intrinsics.java_util_Arrays_equals_D(%Env* %env, %Object* %a, %Object* %b) alwaysinline {
+    %1 = call i8 @arrayequals_double(%Object* %a, %Object* %b)
+    ret i8 %1
+}
+
+; Used for boolean[] and byte[].
+define private void @intrinsics.java_util_Arrays_fill_B(%Env* %env, %Object* %a, i8 %v) alwaysinline {
+    call void @checknull_explicit(%Env* %env, %Object* %a)
+    %n = call i32 @arraylength_inbounds(%Object* %a)
+    %1 = bitcast %Object* %a to %ByteArray*
+    %p = getelementptr %ByteArray* %1, i32 0, i32 2
+    call void @llvm.memset.p0i8.i32(i8* %p, i8 %v, i32 %n, i32 1, i1 false)
+    ret void
+}
+
+; Used for char[] and short[].
+define private void @intrinsics.java_util_Arrays_fill_C(%Env* %env, %Object* %a, i16 %v) alwaysinline {
+    call void @checknull_explicit(%Env* %env, %Object* %a)
+    %n = call i32 @arraylength_inbounds(%Object* %a)
+    %1 = bitcast %Object* %a to %CharArray*
+    %p = getelementptr %CharArray* %1, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %0], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %Done, label %Body
+Body:
+    %pi = getelementptr i16* %p, i32 %i
+    store i16 %v, i16* %pi
+    %next = add i32 %i, 1
+    br label %Loop
+Done:
+    ret void
+}
+
+; Used for int[] and float[].
+define private void @intrinsics.java_util_Arrays_fill_I(%Env* %env, %Object* %a, i32 %v) alwaysinline {
+    call void @checknull_explicit(%Env* %env, %Object* %a)
+    %n = call i32 @arraylength_inbounds(%Object* %a)
+    %1 = bitcast %Object* %a to %IntArray*
+    %p = getelementptr %IntArray* %1, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %0], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %Done, label %Body
+Body:
+    %pi = getelementptr i32* %p, i32 %i
+    store i32 %v, i32* %pi
+    %next = add i32 %i, 1
+    br label %Loop
+Done:
+    ret void
+}
+
+; Used for long[] and double[].
+define private void @intrinsics.java_util_Arrays_fill_J(%Env* %env, %Object* %a, i64 %v) alwaysinline {
+    call void @checknull_explicit(%Env* %env, %Object* %a)
+    %n = call i32 @arraylength_inbounds(%Object* %a)
+    %1 = bitcast %Object* %a to %LongArray*
+    %p = getelementptr %LongArray* %1, i32 0, i32 2
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %0], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %Done, label %Body
+Body:
+    %pi = getelementptr i64* %p, i32 %i
+    store i64 %v, i64* %pi
+    %next = add i32 %i, 1
+    br label %Loop
+Done:
+    ret void
+}
+
+define private void @intrinsics.java_util_Arrays_fill_F(%Env* %env, %Object* %a, float %v) alwaysinline {
+    %1 = bitcast float %v to i32
+    call void @intrinsics.java_util_Arrays_fill_I(%Env* %env, %Object* %a, i32 %1)
+    ret void
+}
+
+define private void @intrinsics.java_util_Arrays_fill_D(%Env* %env, %Object* %a, double %v) alwaysinline {
+    %1 = bitcast double %v to i64
+    call void @intrinsics.java_util_Arrays_fill_J(%Env* %env, %Object* %a, i64 %1)
+    ret void
+}
+
+; Returns a pointer to the first char of String %s.
+define private i16* @String_chars(%Object* %s) alwaysinline {
+    %1 = bitcast %Object* %s to %String*
+    %2 = getelementptr %String* %1, i32 0, i32 1 ; String->value
+    %3 = load %Object** %2
+    %4 = getelementptr %String* %1, i32 0, i32 4 ; String->offset
+    %offset = load i32* %4
+    %5 = bitcast %Object* %3 to %CharArray*
+    %6 = getelementptr %CharArray* %5, i32 0, i32 2
+    %7 = getelementptr i16* %6, i32 %offset
+    ret i16* %7
+}
+
+define private i32 @String_count(%Object* %s) alwaysinline {
+    %1 = bitcast %Object* %s to %String*
+    %2 = getelementptr %String* %1, i32 0, i32 2 ; String->count
+    %3 = load i32* %2
+    ret i32 %3
+}
+
+define private i32* @String_hashCodePtr(%Object* %s) alwaysinline {
+    %1 = bitcast %Object* %s to %String*
+    %2 = getelementptr %String* %1, i32 0, i32 3 ; String->hashCode
+    ret i32* %2
+}
+
+define private i8 @intrinsics.java_lang_String_equals(%Env* %env, %Object* %s, %Object* %o) alwaysinline {
+    %same = icmp eq %Object* %s, %o
+    br i1 %same, label %True, label %NotSame
+NotSame:
+    %null = icmp eq %Object* %o, null
+    br i1 %null, label %False, label %NotNull
+NotNull:
+    ; String is final so %o is a String if it is of the same class as %s
+    %sClass = call %Class* @Object_class(%Object* %s)
+    %oClass = call %Class* @Object_class(%Object* %o)
+    %isString = icmp eq %Class* %sClass, %oClass
+    br i1 %isString, label %IsString, label %False
+IsString:
+    %n = call i32 @String_count(%Object* %s)
+    %oCount = call i32 @String_count(%Object* %o)
+    %sameCount = icmp eq i32 %n, %oCount
+    br i1 %sameCount, label %CheckHash, label %False
+CheckHash:
+    ; Strings with different hash codes can't be equal. 0 means not computed.
+    %sHashPtr = call i32* @String_hashCodePtr(%Object* %s)
+    %oHashPtr = call i32* @String_hashCodePtr(%Object* %o)
+    %sHash = load i32* %sHashPtr
+    %oHash = load i32* %oHashPtr
+    %1 = icmp ne i32 %sHash, %oHash
+    %2 = icmp ne i32 %sHash, 0
+    %3 = icmp ne i32 %oHash, 0
+    %4 = and i1 %1, %2
+    %differentHash = and i1 %4, %3
+    br i1 %differentHash, label %False, label %Init
+Init:
+    %p = call i16* @String_chars(%Object* %s)
+    %q = call i16* @String_chars(%Object* %o)
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %True, label %Body
+Body:
+    %pi = getelementptr i16* %p, i32 %i
+    %qi = getelementptr i16* %q, i32 %i
+    %x = load i16* %pi
+    %y = load i16* %qi
+    %next = add i32 %i, 1
+    %eq = icmp eq i16 %x, %y
+    br i1 %eq, label %Loop, label %False
+True:
+    ret i8 1
+False:
+    ret i8 0
+}
+
+define private i32 @intrinsics.java_lang_String_hashCode(%Env* %env, %Object* %s) alwaysinline {
+    %hashPtr = call i32* @String_hashCodePtr(%Object* %s)
+    %cached = load i32* %hashPtr
+    %computed = icmp ne i32 %cached, 0
+    br i1 %computed, label %Cached, label %Init
+Cached:
+    ret i32 %cached
+Init:
+    %n = call i32 @String_count(%Object* %s)
+    %p = call i16* @String_chars(%Object* %s)
+    br label %Loop
+Loop:
+    %i = phi i32 [0, %Init], [%next, %Body]
+    %hash = phi i32 [0, %Init], [%h, %Body]
+    %done = icmp eq i32 %i, %n
+    br i1 %done, label %Done, label %Body
+Body:
+    %pi = getelementptr i16* %p, i32 %i
+    %c = load i16* %pi
+    %1 = zext i16 %c to i32
+    %2 = mul i32 %hash, 31
+    %h = add i32 %2, %1
+    %next = add i32 %i, 1
+    br label %Loop
+Done:
+    store i32 %hash, i32* %hashPtr
+    ret i32 %hash
+}
+
+; Returns true if String.indexOf(%c) and String.indexOf(%c, start) can be
+; done by the intrinsics below. Supplementary code points need to be searched
+; for as surrogate pairs which is left to the Java code.
+define private i1 @intrinsics.java_lang_String_indexOf_guard(%Env* %env, %Object* %s, i32 %c) alwaysinline {
+    %1 = icmp sle i32 %c, 65535
+    ret i1 %1
+}
+
+define private i32 @intrinsics.java_lang_String_indexOf_start(%Env* %env, %Object* %s, i32 %c, i32 %start) alwaysinline {
+    %n = call i32 @String_count(%Object* %s)
+    %1 = icmp slt i32 %start, 0
+    %from = select i1 %1, i32 0, i32 %start
+    %p = call i16* @String_chars(%Object* %s)
+    br label %Loop
+Loop:
+    %i = phi i32 [%from, %0], [%next, %Body]
+    %done = icmp sge i32 %i, %n
+    br i1 %done, label %NotFound, label %Body
+Body:
+    %pi = getelementptr i16* %p, i32 %i
+    %x = load i16* %pi
+    %2 = zext i16 %x to i32
+    %next = add i32 %i, 1
+    %found = icmp eq i32 %2, %c
+    br i1 %found, label %Found, label %Loop
+Found:
+    ret i32 %i
+NotFound:
+    ret i32 -1
+}
+
+define private i32 @intrinsics.java_lang_String_indexOf(%Env* %env, %Object* %s, i32 %c) alwaysinline {
+    %1 = call i32 @intrinsics.java_lang_String_indexOf_start(%Env* %env, %Object* %s, i32 %c, i32 0)
+    ret i32 %1
+}
+
 define linkonce_odr i32 @arraylength(%Object* %o) alwaysinline {
     %array = bitcast %Object* %o to %Array*
     %length = getelementptr %Array* %array, i32 0, i32 1
@@ -395,6 +1184,66 @@ define linkonce_odr i32 @arraylength(%Object* %o) alwaysinline {
     ret i32 %res
 }
 
+; Initializes the memory of an object or array allocated on the stack of the
+; method creating it. See EscapeAnalysis.java.
+; Initializes the class with the specified info struct unless done already.
+; The info struct may be declared constant but is updated by the runtime so
+; the flags must be loaded using a volatile load.
+define linkonce_odr void @initializeclass(%Env* %env, i8** %info) alwaysinline {
+    %header = bitcast i8** %info to {i8*, i32}*
+    %flagsPtr = getelementptr {i8*, i32}* %header, i32 0, i32 1
+    %flags = load volatile i32* %flagsPtr
+    %initializedFlag = and i32 %flags, 512 ; CI_INITIALIZED
+    %initialized = icmp eq i32 %initializedFlag, 512
+    br i1 %initialized, label %done, label %initialize
+initialize:
+    call void @_bcInitializeClass(%Env* %env, i8** %info)
+    br label %done
+done:
+    ret void
+}
+
+; Allocates an instance of a class which may be served from the per-thread
+; free lists in the Env. The sizes and counts used here must match 
+; RVM_ALLOC_* in types.h. %size is a constant so once inlined only the
+; list pop remains. Falls back to _bcAllocate() which refills the list.
+define linkonce_odr %Object* @allocobject(%Env* %env, i8** %info, i32 %size) alwaysinline {
+    call void @initializeclass(%Env* %env, i8** %info)
+    %small = icmp ule i32 %size, 128 ; RVM_ALLOC_MAX_SIZE
+    br i1 %small, label %list, label %slow
+list:
+    %roundedSize = add i32 %size, 15
+    %granules = lshr i32 %roundedSize, 4 ; RVM_ALLOC_GRANULE
+    %index = sub i32 %granules, 1
+    %listPtr = getelementptr %Env* %env, i32 0, i32 9, i32 %index
+    %head = load i8** %listPtr
+    %empty = icmp eq i8* %head, null
+    br i1 %empty, label %slow, label %pop
+pop:
+    ; The first word links to the next object on the list. It becomes the
+    ; Class pointer. The rest of the object has been cleared by the GC.
+    %link = bitcast i8* %head to i8**
+    %next = load i8** %link
+    store i8* %next, i8** %listPtr
+    %o = bitcast i8* %head to %Object*
+    %header = bitcast i8** %info to %Class**
+    %clazz = load volatile %Class** %header
+    %clazzPtr = getelementptr %Object* %o, i32 0, i32 0
+    store %Class* %clazz, %Class** %clazzPtr
+    ret %Object* %o
+slow:
+    %slowResult = call %Object* @_bcAllocate(%Env* %env, i8** %info)
+    ret %Object* %slowResult
+}
+
+define linkonce_odr void @initstackobject(%Object* %o, i32 %size, %Class* %clazz) alwaysinline {
+    %p = bitcast %Object* %o to i8*
+    call void @llvm.memset.p0i8.i32(i8* %p, i8 0, i32 %size, i32 8, i1 false)
+    %clazzPtr = getelementptr %Object* %o, i32 0, i32 0
+    store %Class* %clazz, %Class** %clazzPtr
+    ret void
+}
+
 define linkonce_odr i32 @iaload(%Object* %o, i32 %index) alwaysinline {
     %array = bitcast %Object* %o to %IntArray*
     %base = getelementptr %IntArray* %array, i32 0, i32 2
@@ -523,12 +1372,169 @@ define linkonce_odr void @aastore(%Object* %o, i32 %index, %Object* %value) alwa
     ret void
 }
 
+; Non-volatile variants of the array element accessors above used for
+; accesses which RangeAnalysis has proven to be in bounds of a non-null
+; array. Such accesses can't fault which lets LLVM hoist, reorder and
+; vectorize them.
+define linkonce_odr i32 @arraylength_inbounds(%Object* %o) alwaysinline {
+    %array = bitcast %Object* %o to %Array*
+    %length = getelementptr %Array* %array, i32 0, i32 1
+    %res = load i32* %length
+    ret i32 %res
+}
+
+; Returns true if %o is non-null and has at least %bound elements. Computed
+; before loops to decide whether the accesses in the loop need checks.
+define linkonce_odr i1 @arraycovers(%Object* %o, i32 %bound) alwaysinline {
+    %isNull = icmp eq %Object* %o, null
+    br i1 %isNull, label %null, label %notNull
+null:
+    ret i1 false
+notNull:
+    %length = call i32 @arraylength_inbounds(%Object* %o)
+    %cond = icmp sge i32 %length, %bound
+    ret i1 %cond
+}
+
+define linkonce_odr i8 @baload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %ByteArray*
+    %base = getelementptr %ByteArray* %array, i32 0, i32 2
+    %ptr = getelementptr i8* %base, i32 %index
+    %value = load i8* %ptr
+    ret i8 %value
+}
+
+define linkonce_odr void @bastore_inbounds(%Object* %o, i32 %index, i8 %value) alwaysinline {
+    %array = bitcast %Object* %o to %ByteArray*
+    %base = getelementptr %ByteArray* %array, i32 0, i32 2
+    %ptr = getelementptr i8* %base, i32 %index
+    store i8 %value, i8* %ptr
+    ret void
+}
+
+define linkonce_odr i16 @saload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %ShortArray*
+    %base = getelementptr %ShortArray* %array, i32 0, i32 2
+    %ptr = getelementptr i16* %base, i32 %index
+    %value = load i16* %ptr
+    ret i16 %value
+}
+
+define linkonce_odr void @sastore_inbounds(%Object* %o, i32 %index, i16 %value) alwaysinline {
+    %array = bitcast %Object* %o to %ShortArray*
+    %base = getelementptr %ShortArray* %array, i32 0, i32 2
+    %ptr = getelementptr i16* %base, i32 %index
+    store i16 %value, i16* %ptr
+    ret void
+}
+
+define linkonce_odr i16 @caload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %CharArray*
+    %base = getelementptr %CharArray* %array, i32 0, i32 2
+    %ptr = getelementptr i16* %base, i32 %index
+    %value = load i16* %ptr
+    ret i16 %value
+}
+
+define linkonce_odr void @castore_inbounds(%Object* %o, i32 %index, i16 %value) alwaysinline {
+    %array = bitcast %Object* %o to %CharArray*
+    %base = getelementptr %CharArray* %array, i32 0, i32 2
+    %ptr = getelementptr i16* %base, i32 %index
+    store i16 %value, i16* %ptr
+    ret void
+}
+
+define linkonce_odr i32 @iaload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %IntArray*
+    %base = getelementptr %IntArray* %array, i32 0, i32 2
+    %ptr = getelementptr i32* %base, i32 %index
+    %value = load i32* %ptr
+    ret i32 %value
+}
+
+define linkonce_odr void @iastore_inbounds(%Object* %o, i32 %index, i32 %value) alwaysinline {
+    %array = bitcast %Object* %o to %IntArray*
+    %base = getelementptr %IntArray* %array, i32 0, i32 2
+    %ptr = getelementptr i32* %base, i32 %index
+    store i32 %value, i32* %ptr
+    ret void
+}
+
+define linkonce_odr i64 @laload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %LongArray*
+    %base = getelementptr %LongArray* %array, i32 0, i32 2
+    %ptr = getelementptr i64* %base, i32 %index
+    %value = load i64* %ptr
+    ret i64 %value
+}
+
+define linkonce_odr void @lastore_inbounds(%Object* %o, i32 %index, i64 %value) alwaysinline {
+    %array = bitcast %Object* %o to %LongArray*
+    %base = getelementptr %LongArray* %array, i32 0, i32 2
+    %ptr = getelementptr i64* %base, i32 %index
+    store i64 %value, i64* %ptr
+    ret void
+}
+
+define linkonce_odr float @faload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %FloatArray*
+    %base = getelementptr %FloatArray* %array, i32 0, i32 2
+    %ptr = getelementptr float* %base, i32 %index
+    %value = load float* %ptr
+    ret float %value
+}
+
+define linkonce_odr void @fastore_inbounds(%Object* %o, i32 %index, float %value) alwaysinline {
+    %array = bitcast %Object* %o to %FloatArray*
+    %base = getelementptr %FloatArray* %array, i32 0, i32 2
+    %ptr = getelementptr float* %base, i32 %index
+    store float %value, float* %ptr
+    ret void
+}
+
+define linkonce_odr double @daload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %DoubleArray*
+    %base = getelementptr %DoubleArray* %array, i32 0, i32 2
+    %ptr = getelementptr double* %base, i32 %index
+    %value = load double* %ptr
+    ret double %value
+}
+
+define linkonce_odr void @dastore_inbounds(%Object* %o, i32 %index, double %value) alwaysinline {
+    %array = bitcast %Object* %o to %DoubleArray*
+    %base = getelementptr %DoubleArray* %array, i32 0, i32 2
+    %ptr = getelementptr double* %base, i32 %index
+    store double %value, double* %ptr
+    ret void
+}
+
+define linkonce_odr %Object* @aaload_inbounds(%Object* %o, i32 %index) alwaysinline {
+    %array = bitcast %Object* %o to %ObjectArray*
+    %base = getelementptr %ObjectArray* %array, i32 0, i32 2
+    %ptr = getelementptr %Object** %base, i32 %index
+    %value = load %Object** %ptr
+    ret %Object* %value
+}
+
 define linkonce_odr i8 @checknull(%Env* %env, %Object* %o) alwaysinline {
     %p = bitcast %Object* %o to i8*
     %i = load volatile i8* %p
     ret i8 %i
 }
 
+; Used instead of checknull inside try blocks when compiling with landingpads.
+; A fault isn't a call site covered by the unwind tables so the exception
+; must be thrown by a call.
+define linkonce_odr void @checknull_explicit(%Env* %env, %Object* %o) alwaysinline {
+    %cond = icmp ne %Object* %o, null
+    br i1 %cond, label %notNull, label %null
+notNull:
+    ret void
+null:
+    call void @_bcThrowNullPointerException(%Env* %env)
+    unreachable
+}
+
 define linkonce_odr void @checklower(%Env* %env, %Object* %o, i32 %index) alwaysinline {
     %cond = icmp sge i32 %index, 0
     br i1 %cond, label %success, label %failure
@@ -730,6 +1736,60 @@ notLoaded:
     ret %Object* %4
 }
 
+define private i8* @ic_lookup(%Env* %env, %InlineCache* %ic, i8** %header, %Object* %o, i32 %index, i8* %fallback) alwaysinline {
+entry:
+    %clazz = call %Class* @Object_class(%Object* %o)
+    br label %probe
+probe:
+    %i = phi i32 [0, %entry], [%next, %nextEntry]
+    %clazzPtr = getelementptr %InlineCache* %ic, i32 0, i32 0, i32 %i, i32 0 ; InlineCache->entries[i].clazz
+    %cached = load %Class** %clazzPtr
+    %match = icmp eq %Class* %cached, %clazz
+    br i1 %match, label %found, label %nextEntry
+found:
+    %implPtr = getelementptr %InlineCache* %ic, i32 0, i32 0, i32 %i, i32 1 ; InlineCache->entries[i].impl
+    %impl = load i8** %implPtr
+    %isNull = icmp eq i8* %impl, null
+    br i1 %isNull, label %miss, label %hit
+hit:
+    ret i8* %impl
+nextEntry:
+    %next = add i32 %i, 1
+    %done = icmp eq i32 %next, 4
+    br i1 %done, label %miss, label %probe
+miss:
+    %result = call i8* @_bcInlineCacheMiss(%Env* %env, %InlineCache* %ic, i8** %header, %Object* %o, i32 %index, i8* %fallback)
+    ret i8* %result
+}
+
+define private void @profile_count(%ProfileCounter* %c) alwaysinline {
+    %1 = getelementptr %ProfileCounter* %c, i32 0, i32 0 ; ProfileCounter->count
+    %2 = atomicrmw add i64* %1, i64 1 monotonic
+    ret void
+}
+
+define private i64 @profile_enter(%ProfileCounter* %c) alwaysinline {
+    call void @profile_count(%ProfileCounter* %c)
+    %1 = call i64 @llvm.readcyclecounter()
+    ret i64 %1
+}
+
+define private void @profile_exit(%ProfileCounter* %c, i64 %start) alwaysinline {
+    %1 = call i64 @llvm.readcyclecounter()
+    %2 = sub i64 %1, %start
+    %3 = getelementptr %ProfileCounter* %c, i32 0, i32 1 ; ProfileCounter->value
+    %4 = atomicrmw add i64* %3, i64 %2 monotonic
+    ret void
+}
+
+define private void @profile_branch(%ProfileCounter* %c, i1 %taken) alwaysinline {
+    call void @profile_count(%ProfileCounter* %c)
+    %1 = zext i1 %taken to i64
+    %2 = getelementptr %ProfileCounter* %c, i32 0, i32 1 ; ProfileCounter->value
+    %3 = atomicrmw add i64* %2, i64 %1 monotonic
+    ret void
+}
+
 define private void @register_finalizable(%Env* %env, %Object* %o) alwaysinline {
     %1 = call %Class* @Object_class(%Object* %o)
     %2 = call i32 @Class_flags(%Class* %1)
@@ -746,12 +1806,11 @@ done:
 }
 
 define private i1 @isinstance_class(%Object* %o, i32 %offset, i32 %id) alwaysinline {
+    ; Cohen display check. The id of a class at depth n in the hierarchy is
+    ; always at the same offset in the TypeInfo of any of its subclasses so 
+    ; no cache is needed.
     %c = call %Class* @Object_class(%Object* %o)
     %ti = call %TypeInfo* @Class_typeInfo(%Class* %c)
-    %cachedId = call i32 @TypeInfo_cache(%TypeInfo* %ti)
-    %isCachedEQ = icmp eq i32 %id, %cachedId
-    br i1 %isCachedEQ, label %found, label %notInCache
-notInCache:
     %otherOffset = call i32 @TypeInfo_offset(%TypeInfo* %ti)
     %isOffsetLE = icmp ule i32 %offset, %otherOffset
     br i1 %isOffsetLE, label %compareIds, label %notFound
@@ -759,24 +1818,28 @@ compareIds:
     %1 = bitcast %TypeInfo* %ti to [0 x i8]*
     %2 = getelementptr [0 x i8]* %1, i32 0, i32 %offset
     %3 = bitcast i8* %2 to i32*
-    %otherId = load volatile i32* %3
+    %otherId = load i32* %3
     %isIdEQ = icmp eq i32 %id, %otherId
-    br i1 %isIdEQ, label %storeCache, label %notFound
-storeCache:
-    call void @TypeInfo_cache_store(%TypeInfo* %ti, i32 %id)
-    br label %found
-found:
-    ret i1 1
+    ret i1 %isIdEQ
 notFound:
     ret i1 0
 }
 
-define private i1 @isinstance_interface(%Object* %o, i32 %id) alwaysinline {
+define private i1 @isinstance_interface(%Object* %o, i32 %id, i8* %cache) alwaysinline {
+    ; %cache points to a direct mapped cache of 8 TypeInfos known to 
+    ; implement the interface. It is private to the checkcast or instanceof 
+    ; function of the interface so different target interfaces don't evict 
+    ; each other like they do with TypeInfo->cache.
     %c = call %Class* @Object_class(%Object* %o)
     %ti = call %TypeInfo* @Class_typeInfo(%Class* %c)
-    %cachedId = call i32 @TypeInfo_cache(%TypeInfo* %ti)
-    %isCachedEQ = icmp eq i32 %id, %cachedId
-    br i1 %isCachedEQ, label %found, label %notInCache
+    %entries = bitcast i8* %cache to [8 x %TypeInfo*]*
+    %tiInt = ptrtoint %TypeInfo* %ti to i32
+    %tiShr = lshr i32 %tiInt, 3
+    %slot = and i32 %tiShr, 7
+    %entryPtr = getelementptr [8 x %TypeInfo*]* %entries, i32 0, i32 %slot
+    %cached = load %TypeInfo** %entryPtr
+    %isCached = icmp eq %TypeInfo* %cached, %ti
+    br i1 %isCached, label %found, label %notInCache
 notInCache:
     %ifCount = call i32 @TypeInfo_interfaceCount(%TypeInfo* %ti)
     %hasIfs = icmp ne i32 %ifCount, 0
@@ -793,14 +1856,16 @@ loop:
     %n_phi = phi i32 [0, %computeBase], [%n, %checkDone]
     %4 = getelementptr [0 x i32]* %base, i32 0, i32 %n_phi
     %n = add i32 %n_phi, 1
-    %otherId = load volatile i32* %4
+    %otherId = load i32* %4
     %isIdEQ = icmp eq i32 %id, %otherId
     br i1 %isIdEQ, label %storeCache, label %checkDone
 checkDone:
     %isDone = icmp eq i32 %n, %ifCount
     br i1 %isDone, label %notFound, label %loop
 storeCache:
-    call void @TypeInfo_cache_store(%TypeInfo* %ti, i32 %id)
+    ; A single pointer store. Racing threads may overwrite each other's 
+    ; entries but every entry ever stored is valid.
+    store %TypeInfo* %ti, %TypeInfo** %entryPtr
     br label %found
 found:
     ret i1 1
@@ -823,13 +1888,13 @@ throw:
     unreachable
 }
 
-define private %Object* @checkcast_interface(%Env* %env, i8** %header, %Object* %o, i32 %id) alwaysinline {
+define private %Object* @checkcast_interface(%Env* %env, i8** %header, %Object* %o, i32 %id, i8* %cache) alwaysinline {
     %isNotNull = icmp ne %Object* %o, null
     br i1 %isNotNull, label %notNull, label %null
 null:
     ret %Object* null
 notNull:
-    %isInstance = call i1 @isinstance_interface(%Object* %o, i32 %id)
+    %isInstance = call i1 @isinstance_interface(%Object* %o, i32 %id, i8* %cache)
     br i1 %isInstance, label %ok, label %throw
 ok:
     ret %Object* %o
@@ -850,11 +1915,11 @@ false:
     ret i32 0
 }
 
-define private i32 @instanceof_interface(%Env* %env, i8** %header, %Object* %o, i32 %id) alwaysinline {
+define private i32 @instanceof_interface(%Env* %env, i8** %header, %Object* %o, i32 %id, i8* %cache) alwaysinline {
     %isNotNull = icmp ne %Object* %o, null
     br i1 %isNotNull, label %notNull, label %false
 notNull:
-    %isInstance = call i1 @isinstance_interface(%Object* %o, i32 %id)
+    %isInstance = call i1 @isinstance_interface(%Object* %o, i32 %id, i8* %cache)
     br i1 %isInstance, label %true, label %false
 true:
     ret i32 1
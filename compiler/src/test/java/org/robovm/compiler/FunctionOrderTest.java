@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import static org.junit.Assert.*;
+
+import java.io.File;
+import java.util.Arrays;
+import java.util.List;
+
+import org.apache.commons.io.FileUtils;
+import org.junit.Test;
+
+/**
+ * Tests {@link FunctionOrder}.
+ */
+public class FunctionOrderTest {
+
+    @Test
+    public void testParse() {
+        List<String> symbols = FunctionOrder.parse(Arrays.asList(
+                "# Startup trace",
+                "",
+                "com.example.Main.<clinit>()V",
+                "  com/example/Main.main([Ljava/lang/String;)V  ",
+                "[J]java.lang.Object.<init>()V",
+                "_bcInitializeClass",
+                "com.example.Main.<clinit>()V"));
+        assertEquals(Arrays.asList(
+                "[j]com.example.Main.<clinit>()V[synchronized]",
+                "[J]com.example.Main.<clinit>()V",
+                "[j]com.example.Main.main([Ljava/lang/String;)V[synchronized]",
+                "[J]com.example.Main.main([Ljava/lang/String;)V",
+                "[J]java.lang.Object.<init>()V",
+                "_bcInitializeClass"), symbols);
+    }
+
+    @Test
+    public void testWriteLinkerScript() throws Exception {
+        File file = File.createTempFile(getClass().getSimpleName(), ".ld");
+        try {
+            FunctionOrder.writeLinkerScript(file, Arrays.asList(
+                    "[J]com.example.Main.main([Ljava/lang/String;)V", "_bcInitializeClass"));
+            assertEquals("SECTIONS\n"
+                    + "{\n"
+                    + "    .text.ordered :\n"
+                    + "    {\n"
+                    + "        *(.text.hot .text.hot.*)\n"
+                    + "        *(\".text.?J?com.example.Main.main(?Ljava/lang/String;)V\")\n"
+                    + "        *(\".text._bcInitializeClass\")\n"
+                    + "    }\n"
+                    + "}\n"
+                    + "INSERT BEFORE .text;\n", FileUtils.readFileToString(file, "UTF-8"));
+        } finally {
+            file.delete();
+        }
+    }
+}
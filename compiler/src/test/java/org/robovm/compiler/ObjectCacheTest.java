@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler;
+
+import static org.junit.Assert.*;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.file.Files;
+
+import org.apache.commons.io.FileUtils;
+import org.junit.After;
+import org.junit.Before;
+import org.junit.BeforeClass;
+import org.junit.Test;
+import org.robovm.compiler.a.A;
+import org.robovm.compiler.b.B;
+import org.robovm.compiler.clazz.Clazz;
+import org.robovm.compiler.clazz.ClazzInfo;
+import org.robovm.compiler.clazz.Dependency;
+import org.robovm.compiler.config.Config;
+import org.robovm.compiler.config.FakeHome;
+
+import soot.Scene;
+import soot.options.Options;
+
+/**
+ * Tests {@link ObjectCache}.
+ */
+public class ObjectCacheTest {
+
+    File tmpDir;
+    File sharedCacheDir;
+
+    @BeforeClass
+    public static void initializeSoot() throws IOException {
+        soot.G.reset();
+        Options.v().set_output_format(Options.output_format_jimple);
+        Options.v().set_include_all(true);
+        Options.v().set_print_tags_in_output(true);
+        Options.v().set_allow_phantom_refs(true);
+        Options.v().set_soot_classpath(System.getProperty("sun.boot.class.path") +
+                ":" + System.getProperty("java.class.path"));
+        Scene.v().loadNecessaryClasses();
+    }
+
+    @Before
+    public void setup() throws Exception {
+        tmpDir = Files.createTempDirectory(getClass().getSimpleName()).toFile();
+        sharedCacheDir = new File(tmpDir, "shared");
+    }
+
+    @After
+    public void teardown() throws Exception {
+        FileUtils.deleteDirectory(tmpDir);
+    }
+
+    private Config createConfig(String cacheDirName, boolean debug) throws Exception {
+        Config.Builder builder = new Config.Builder()
+                .home(new FakeHome())
+                .cacheDir(new File(tmpDir, cacheDirName))
+                .sharedCacheDir(sharedCacheDir)
+                .debug(debug)
+                .skipRuntimeLib(true)
+                .skipLinking(true);
+        for (String path : System.getProperty("sun.boot.class.path").split(File.pathSeparator)) {
+            builder.addBootClasspathEntry(new File(path));
+        }
+        for (String path : System.getProperty("java.class.path").split(File.pathSeparator)) {
+            builder.addClasspathEntry(new File(path));
+        }
+        return builder.build();
+    }
+
+    private Clazz load(Config config, Class<?> cls) {
+        return config.getClazzes().load(cls.getName().replace('.', '/'));
+    }
+
+    /**
+     * Writes the files the {@link ClassCompiler} would have written for the
+     * specified class.
+     */
+    private Clazz fakeCompile(Config config, Class<?> cls, String oFileContent) throws Exception {
+        Clazz clazz = load(config, cls);
+        ClazzInfo ci = clazz.resetClazzInfo();
+        ci.initClassInfo();
+        ci.addClassDependency("java/lang/Object", false);
+        ci.addClassDependency(B.class.getName().replace('.', '/'), false);
+        ci.addClassDependency("com/example/Missing", true);
+        clazz.saveClazzInfo();
+        File oFile = config.getOFile(clazz);
+        oFile.getParentFile().mkdirs();
+        FileUtils.writeStringToFile(oFile, oFileContent, "UTF-8");
+        return clazz;
+    }
+
+    @Test
+    public void testStoreAndRestore() throws Exception {
+        Config config1 = createConfig("cache1", false);
+        ObjectCache cache1 = new ObjectCache(config1, sharedCacheDir);
+        cache1.store(fakeCompile(config1, A.class, "A.o"));
+        assertEquals(1, cache1.getStores());
+        cache1.store(load(config1, A.class));
+        assertEquals(1, cache1.getStores());
+
+        // Simulates a fresh checkout with an empty per-build cache
+        Config config2 = createConfig("cache2", false);
+        ObjectCache cache2 = new ObjectCache(config2, sharedCacheDir);
+        Clazz clazz = load(config2, A.class);
+        assertNull(clazz.getClazzInfo());
+        assertTrue(cache2.restore(clazz));
+        assertEquals(1, cache2.getHits());
+        assertEquals(0, cache2.getMisses());
+        assertEquals("A.o", FileUtils.readFileToString(config2.getOFile(clazz), "UTF-8"));
+        assertFalse(config2.getLinesOFile(clazz).exists());
+
+        ClazzInfo ci = clazz.getClazzInfo();
+        assertNotNull(ci);
+        assertEquals(3, ci.getDependencies().size());
+        for (Dependency dep : ci.getDependencies()) {
+            Clazz depClazz = config2.getClazzes().load(dep.getClassName());
+            if (depClazz == null) {
+                assertNull(dep.getPath());
+            } else {
+                assertEquals(depClazz.getPath().getFile().getAbsolutePath(), dep.getPath());
+            }
+        }
+    }
+
+    @Test
+    public void testMiss() throws Exception {
+        Config config = createConfig("cache", false);
+        ObjectCache cache = new ObjectCache(config, sharedCacheDir);
+        cache.store(fakeCompile(config, A.class, "A.o"));
+        assertFalse(cache.restore(load(config, B.class)));
+        assertEquals(0, cache.getHits());
+        assertEquals(1, cache.getMisses());
+    }
+
+    @Test
+    public void testDifferentOptionsMiss() throws Exception {
+        Config config1 = createConfig("cache1", false);
+        new ObjectCache(config1, sharedCacheDir).store(fakeCompile(config1, A.class, "A.o"));
+
+        Config config2 = createConfig("cache2", true);
+        ObjectCache cache2 = new ObjectCache(config2, sharedCacheDir);
+        assertFalse(cache2.restore(load(config2, A.class)));
+        assertEquals(1, cache2.getMisses());
+    }
+}
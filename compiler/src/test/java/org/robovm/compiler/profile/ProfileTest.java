@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/gpl-2.0.html>.
+ */
+package org.robovm.compiler.profile;
+
+import static org.junit.Assert.*;
+
+import java.io.IOException;
+import java.io.StringReader;
+import java.io.StringWriter;
+import java.util.List;
+
+import org.junit.Test;
+import org.robovm.compiler.profile.Profile.BranchProfile;
+import org.robovm.compiler.profile.Profile.MethodProfile;
+import org.robovm.compiler.profile.Profile.ReceiverProfile;
+
+/**
+ * Tests {@link Profile}.
+ */
+public class ProfileTest {
+
+    private static final String REPORT = 
+            "# robovm-profile 2\n"
+            + "# m\tcount\tcycles\tmethod\n"
+            + "# b\tcount\ttaken\tmethod\tindex\n"
+            + "# r\tcount\tclass\tmethod\tindex\n"
+            + "m\t1000\t50000\tjava/lang/String.hashCode()I\n"
+            + "m\t10\t900\tcom/example/Main.<init>()V\n"
+            + "m\t10\t1200\tcom/example/Main$Inner.run([Ljava/lang/String;)V\n"
+            + "b\t1000\t990\tjava/lang/String.hashCode()I\t0\n"
+            + "r\t95\tcom/example/Foo\tcom/example/Main$Inner.run([Ljava/lang/String;)V\t2\n"
+            + "r\t3\tcom/example/Bar\tcom/example/Main$Inner.run([Ljava/lang/String;)V\t2\n"
+            + "r\t2\t*\tcom/example/Main$Inner.run([Ljava/lang/String;)V\t2\n";
+
+    private static final String REPORT_V1 = 
+            "# robovm-profile 1\n"
+            + "# count\tcycles\tmethod\n"
+            + "1000\t50000\tjava/lang/String.hashCode()I\n"
+            + "10\t900\tcom/example/Main.<init>()V\n";
+
+    @Test
+    public void testRead() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT));
+        assertFalse(profile.isEmpty());
+        assertEquals(1000, profile.getCount("java/lang/String", "hashCode", "()I"));
+        assertEquals(10, profile.getCount("com/example/Main", "<init>", "()V"));
+        assertEquals(0, profile.getCount("com/example/Main", "main", "([Ljava/lang/String;)V"));
+        MethodProfile mp = profile.getMethod("com/example/Main$Inner", "run", "([Ljava/lang/String;)V");
+        assertNotNull(mp);
+        assertEquals(1200, mp.getCycles());
+        assertEquals(1000, profile.getMaxCount());
+    }
+
+    @Test
+    public void testReadVersion1() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT_V1));
+        assertEquals(1000, profile.getCount("java/lang/String", "hashCode", "()I"));
+        assertEquals(900, profile.getMethod("com/example/Main", "<init>", "()V").getCycles());
+    }
+
+    @Test
+    public void testBranches() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT));
+        BranchProfile bp = profile.getBranch("java/lang/String", "hashCode", "()I", 0);
+        assertNotNull(bp);
+        assertEquals(1000, bp.getCount());
+        assertEquals(990, bp.getTaken());
+        assertEquals(10, bp.getNotTaken());
+        assertNull(profile.getBranch("java/lang/String", "hashCode", "()I", 1));
+    }
+
+    @Test
+    public void testReceivers() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT));
+        ReceiverProfile rp = profile.getReceivers("com/example/Main$Inner", "run", "([Ljava/lang/String;)V", 2);
+        assertNotNull(rp);
+        assertEquals(100, rp.getCount());
+        assertEquals(95, rp.getCount("com/example/Foo"));
+        assertEquals(2, rp.getCount(Profile.OTHER_RECEIVERS));
+        assertEquals("com/example/Foo", rp.getDominantClass(0.9, 100));
+        assertNull(rp.getDominantClass(0.96, 100));
+        assertNull(rp.getDominantClass(0.9, 101));
+    }
+
+    @Test
+    public void testIsHot() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT));
+        assertTrue(profile.isHot("java/lang/String", "hashCode", "()I"));
+        assertFalse(profile.isHot("com/example/Main", "<init>", "()V"));
+        assertFalse(profile.isHot("com/example/Main", "main", "([Ljava/lang/String;)V"));
+    }
+
+    @Test
+    public void testGetMethodsSortedHottestFirst() throws Exception {
+        List<MethodProfile> methods = Profile.read(new StringReader(REPORT)).getMethods();
+        assertEquals(3, methods.size());
+        assertEquals("java/lang/String.hashCode()I", methods.get(0).toString());
+        // Equal counts are sorted on cycles
+        assertEquals("com/example/Main$Inner.run([Ljava/lang/String;)V", methods.get(1).toString());
+        assertEquals("com/example/Main.<init>()V", methods.get(2).toString());
+    }
+
+    @Test
+    public void testMerge() throws Exception {
+        Profile p1 = Profile.read(new StringReader(REPORT));
+        Profile p2 = Profile.read(new StringReader("5\t7\tjava/lang/String.hashCode()I\n"
+                + "b\t10\t1\tjava/lang/String.hashCode()I\t0\n"
+                + "r\t5\tcom/example/Bar\tcom/example/Main$Inner.run([Ljava/lang/String;)V\t2\n"));
+        p1.merge(p2);
+        assertEquals(1005, p1.getCount("java/lang/String", "hashCode", "()I"));
+        assertEquals(50007, p1.getMethod("java/lang/String", "hashCode", "()I").getCycles());
+        assertEquals(1010, p1.getBranch("java/lang/String", "hashCode", "()I", 0).getCount());
+        assertEquals(991, p1.getBranch("java/lang/String", "hashCode", "()I", 0).getTaken());
+        ReceiverProfile rp = p1.getReceivers("com/example/Main$Inner", "run", "([Ljava/lang/String;)V", 2);
+        assertEquals(105, rp.getCount());
+        assertEquals(8, rp.getCount("com/example/Bar"));
+    }
+
+    @Test
+    public void testWriteRoundTrip() throws Exception {
+        Profile profile = Profile.read(new StringReader(REPORT));
+        StringWriter sw = new StringWriter();
+        profile.write(sw);
+        assertEquals(REPORT.replace("m\t10\t900\tcom/example/Main.<init>()V\n", "")
+                .replace("b\t1000", "m\t10\t900\tcom/example/Main.<init>()V\nb\t1000"), sw.toString());
+    }
+
+    @Test(expected = IOException.class)
+    public void testReadMalformedLine() throws Exception {
+        Profile.read(new StringReader("1000 java/lang/String.hashCode()I\n"));
+    }
+
+    @Test(expected = IOException.class)
+    public void testReadMalformedBranchLine() throws Exception {
+        Profile.read(new StringReader("b\t10\t1\tjava/lang/String.hashCode()I\n"));
+    }
+
+    @Test(expected = IOException.class)
+    public void testReadMalformedCount() throws Exception {
+        Profile.read(new StringReader("x\t0\tjava/lang/String.hashCode()I\n"));
+    }
+}
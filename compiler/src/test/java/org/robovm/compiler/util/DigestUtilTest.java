@@ -18,6 +18,9 @@ package org.robovm.compiler.util;
 
 import static org.junit.Assert.*;
 
+import java.io.File;
+
+import org.apache.commons.io.FileUtils;
 import org.junit.Test;
 
 /**
@@ -31,4 +34,20 @@ public class DigestUtilTest {
         assertEquals("8843d7f92416211de9ebb963ff4ce28125932878", DigestUtil.sha1("foobar"));
     }
 
+    @Test
+    public void testSha1Bytes() throws Exception {
+        assertEquals("da39a3ee5e6b4b0d3255bfef95601890afd80709", DigestUtil.sha1(new byte[0]));
+        assertEquals("8843d7f92416211de9ebb963ff4ce28125932878", DigestUtil.sha1("foobar".getBytes("ASCII")));
+    }
+
+    @Test
+    public void testSha1File() throws Exception {
+        File f = File.createTempFile(DigestUtilTest.class.getSimpleName(), ".txt");
+        try {
+            FileUtils.writeStringToFile(f, "foobar", "ASCII");
+            assertEquals("8843d7f92416211de9ebb963ff4ce28125932878", DigestUtil.sha1(f));
+        } finally {
+            f.delete();
+        }
+    }
 }
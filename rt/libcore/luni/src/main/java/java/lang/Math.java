@@ -318,6 +318,22 @@ public final class Math {
      */
     public static native double floor(double d);
 
+    /**
+     * Returns {@code a * b + c} computed with a single rounding, i.e. as if
+     * the product was computed with infinite precision.
+     *
+     * @since 9
+     */
+    public static native double fma(double a, double b, double c);
+
+    /**
+     * Returns {@code a * b + c} computed with a single rounding, i.e. as if
+     * the product was computed with infinite precision.
+     *
+     * @since 9
+     */
+    public static native float fma(float a, float b, float c);
+
     /**
      * Returns {@code sqrt(}<i>{@code x}</i><sup>{@code 2}</sup>{@code +} <i>
      * {@code y}</i><sup>{@code 2}</sup>{@code )}. The final result is without
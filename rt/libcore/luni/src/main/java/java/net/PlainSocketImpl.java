@@ -46,6 +46,14 @@ import static libcore.io.OsConstants.*;
  */
 public class PlainSocketImpl extends SocketImpl {
 
+    // RoboVM note: The accept() timeout work around is only needed on Darwin.
+    private static final boolean DARWIN;
+
+    static {
+        String osName = System.getProperty("os.name");
+        DARWIN = osName.contains("iOS") || osName.contains("Mac");
+    }
+
     // For SOCKS support. A SOCKS bind() uses the last
     // host connected to in its request.
     private static InetAddress lastConnectedAddress;
@@ -94,13 +102,14 @@ public class PlainSocketImpl extends SocketImpl {
             return;
         }
 
+        int inheritedTimeout;
         try {
             // RovmVM note: accept() on Darwin does not honor the SO_RCVTIMEO
             // set using setSoTimeout() on blocking sockets. As a work around we 
             // do poll() if a timeout has been set followed by an accept().
             int timeout = (Integer) getOption(SO_TIMEOUT);
-            int flags = Libcore.os.fcntlVoid(fd, F_GETFL);
-            if (timeout > 0 && (flags & O_NONBLOCK) == 0) {
+            inheritedTimeout = timeout;
+            if (DARWIN && timeout > 0 && (Libcore.os.fcntlVoid(fd, F_GETFL) & O_NONBLOCK) == 0) {
                 StructPollfd pfd = new StructPollfd();
                 pfd.fd = fd;
                 pfd.events = (short) (POLLIN | POLLERR);
@@ -125,7 +134,9 @@ public class PlainSocketImpl extends SocketImpl {
             }
             
             InetSocketAddress peerAddress = new InetSocketAddress();
-            FileDescriptor clientFd = Libcore.os.accept(fd, peerAddress);
+            // RoboVM note: SOCK_CLOEXEC (Linux only) avoids leaking the fd
+            // into child processes without a separate fcntl() call.
+            FileDescriptor clientFd = Libcore.os.accept4(fd, peerAddress, SOCK_CLOEXEC);
 
             // TODO: we can't just set newImpl.fd to clientFd because a nio SocketChannel may
             // be sharing the FileDescriptor. http://b//4452981.
@@ -141,7 +152,9 @@ public class PlainSocketImpl extends SocketImpl {
         }
 
         // Reset the client's inherited read timeout to the Java-specified default of 0.
-        newImpl.setOption(SocketOptions.SO_TIMEOUT, Integer.valueOf(0));
+        if (inheritedTimeout != 0) {
+            newImpl.setOption(SocketOptions.SO_TIMEOUT, Integer.valueOf(0));
+        }
 
         newImpl.localport = IoBridge.getSocketLocalPort(newImpl.fd);
     }
@@ -41,6 +41,7 @@ import libcore.io.IoBridge;
 import libcore.io.IoUtils;
 import libcore.io.Libcore;
 import libcore.util.EmptyArray;
+import static libcore.io.OsConstants.*;
 
 /*
  * The default implementation class of java.nio.channels.DatagramChannel.
@@ -67,6 +68,10 @@ class DatagramChannelImpl extends DatagramChannel implements FileDescriptorChann
     private final Object readLock = new Object();
     private final Object writeLock = new Object();
 
+    // Whether recvmmsg() and sendmmsg() are available. MSG_WAITFORONE is 0 on
+    // platforms without them.
+    private static final boolean MMSG_SUPPORTED = MSG_WAITFORONE != 0;
+
     /*
      * Constructor
      */
@@ -267,6 +272,125 @@ class DatagramChannelImpl extends DatagramChannel implements FileDescriptorChann
         }
     }
 
+    /**
+     * RoboVM note: Receives up to {@code targets.length} datagrams, one into
+     * each buffer, using a single recvmmsg() call where supported. Unless
+     * {@code sources} is {@code null} the sender of datagram i is stored in
+     * {@code sources[i]}. If this channel is blocking this blocks until at
+     * least one datagram has been received. Returns the number of datagrams
+     * received.
+     */
+    int receive(ByteBuffer[] targets, InetSocketAddress[] sources) throws IOException {
+        for (ByteBuffer target : targets) {
+            target.checkWritable();
+        }
+        if (sources != null && sources.length < targets.length) {
+            throw new IllegalArgumentException("sources.length < targets.length");
+        }
+        checkOpen();
+        if (!isBound || targets.length == 0) {
+            return 0;
+        }
+
+        InetSocketAddress[] srcAddresses = null;
+        if (sources != null) {
+            srcAddresses = new InetSocketAddress[targets.length];
+            for (int i = 0; i < targets.length; i++) {
+                srcAddresses[i] = new InetSocketAddress();
+            }
+        }
+        synchronized (readLock) {
+            int count = 0;
+            try {
+                begin();
+                if (MMSG_SUPPORTED) {
+                    int[] byteCounts = new int[targets.length];
+                    int flags = isBlocking() ? MSG_WAITFORONE : MSG_DONTWAIT;
+                    count = Libcore.os.recvmmsg(fd, targets, byteCounts, srcAddresses, flags);
+                    for (int i = 0; i < count; i++) {
+                        targets[i].position(targets[i].position() + byteCounts[i]);
+                    }
+                } else {
+                    // Only the first recvfrom() may block.
+                    for (; count < targets.length; count++) {
+                        int flags = (count == 0 && isBlocking()) ? 0 : MSG_DONTWAIT;
+                        InetSocketAddress srcAddress = (srcAddresses != null) ? srcAddresses[count] : null;
+                        int received = Libcore.os.recvfrom(fd, targets[count], flags, srcAddress);
+                        targets[count].position(targets[count].position() + received);
+                    }
+                }
+            } catch (ErrnoException errnoException) {
+                if (errnoException.errno != EAGAIN) {
+                    throw errnoException.rethrowAsIOException();
+                }
+            } finally {
+                end(count > 0);
+            }
+            if (sources != null) {
+                System.arraycopy(srcAddresses, 0, sources, 0, count);
+            }
+            return count;
+        }
+    }
+
+    /**
+     * RoboVM note: Sends the remaining bytes of each buffer as one datagram
+     * using a single sendmmsg() call where supported. Datagram i is sent to
+     * {@code targets[i]} or to the connected address if {@code targets} is
+     * {@code null}. Returns the number of datagrams sent.
+     */
+    int send(ByteBuffer[] sources, InetSocketAddress[] targets) throws IOException {
+        if (targets == null) {
+            checkOpenConnected();
+        } else {
+            if (targets.length < sources.length) {
+                throw new IllegalArgumentException("targets.length < sources.length");
+            }
+            checkOpen();
+            for (int i = 0; i < sources.length; i++) {
+                if (targets[i].getAddress() == null) {
+                    throw new IOException();
+                }
+                if (isConnected() && !connectAddress.equals(targets[i])) {
+                    throw new IllegalArgumentException("Connected to " + connectAddress +
+                                                       ", not " + targets[i]);
+                }
+            }
+        }
+        if (sources.length == 0) {
+            return 0;
+        }
+
+        synchronized (writeLock) {
+            int count = 0;
+            try {
+                begin();
+                if (MMSG_SUPPORTED) {
+                    int[] byteCounts = new int[sources.length];
+                    count = Libcore.os.sendmmsg(fd, sources, byteCounts, targets, 0);
+                    for (int i = 0; i < count; i++) {
+                        sources[i].position(sources[i].position() + byteCounts[i]);
+                    }
+                } else {
+                    for (; count < sources.length; count++) {
+                        InetAddress address = (targets != null) ? targets[count].getAddress() : null;
+                        int port = (targets != null) ? targets[count].getPort() : 0;
+                        int sent = Libcore.os.sendto(fd, sources[count], 0, address, port);
+                        sources[count].position(sources[count].position() + sent);
+                    }
+                }
+                isBound = true;
+            } catch (ErrnoException errnoException) {
+                if (errnoException.errno != EAGAIN) {
+                    throw errnoException.rethrowAsIOException();
+                }
+            } finally {
+                end(count > 0);
+            }
+            return count;
+        }
+    }
+
     @Override
     public int read(ByteBuffer target) throws IOException {
         target.checkWritable();
@@ -50,6 +50,9 @@ final class FileChannelImpl extends FileChannel {
         }
     };
 
+    // The maximum buffer size used by transferFrom() when copying via userspace.
+    private static final int TRANSFER_BUFFER_SIZE = 64 * 1024;
+
     private final Object stream;
     private final FileDescriptor fd;
     private final int mode;
@@ -374,7 +377,23 @@ final class FileChannelImpl extends FileChannel {
         // Although sendfile(2) originally supported writing to a regular file.
         // In Linux 2.6 and later, it only supports writing to sockets.
 
-        // If our source is a regular file, mmap(2) rather than reading.
+        // If our source is a regular file, try copy_file_range(2) which copies
+        // in the kernel (or even shares the blocks on filesystems supporting it).
+        if (src instanceof FileChannelImpl) {
+            FileChannelImpl fileSrc = (FileChannelImpl) src;
+            long filePosition = fileSrc.position();
+            long copyCount = Math.min(count, fileSrc.size() - filePosition);
+            if (copyCount <= 0) {
+                return 0;
+            }
+            long rc = copyFileRange(fileSrc.fd, new MutableLong(filePosition), fd, new MutableLong(position), copyCount);
+            if (rc >= 0) {
+                fileSrc.position(filePosition + rc);
+                return rc;
+            }
+        }
+
+        // Otherwise mmap(2) the source file rather than reading.
         // Callers should only be using transferFrom for large transfers,
         // so the mmap(2) overhead isn't a concern.
         if (src instanceof FileChannel) {
@@ -391,11 +410,80 @@ final class FileChannelImpl extends FileChannel {
             }
         }
 
-        // For non-file channels, all we can do is read and write via userspace.
-        ByteBuffer buffer = ByteBuffer.allocate((int) count);
-        src.read(buffer);
-        buffer.flip();
-        return write(buffer, position);
+        // RoboVM note: From a socket splice(2) through a pipe without copying to userspace.
+        if (src instanceof SocketChannelImpl && (mode & O_APPEND) == 0) {
+            SocketChannelImpl socketSrc = (SocketChannelImpl) src;
+            boolean completed = false;
+            try {
+                begin();
+                long rc = SpliceTransfer.transfer(socketSrc.getFD(), null, fd, new MutableLong(position), count,
+                        !socketSrc.isBlocking());
+                completed = true;
+                if (rc >= 0) {
+                    return rc;
+                }
+            } finally {
+                end(completed);
+            }
+        }
+
+        // For other channels, all we can do is read and write via userspace.
+        // Use a bounded buffer rather than one of count bytes.
+        ByteBuffer buffer = ByteBuffer.allocate((int) Math.min(count, TRANSFER_BUFFER_SIZE));
+        long transferred = 0;
+        while (transferred < count) {
+            buffer.clear();
+            if (count - transferred < buffer.capacity()) {
+                buffer.limit((int) (count - transferred));
+            }
+            if (src.read(buffer) <= 0) {
+                break;
+            }
+            buffer.flip();
+            while (buffer.hasRemaining()) {
+                transferred += write(buffer, position + transferred);
+            }
+        }
+        return transferred;
+    }
+
+    /**
+     * Copies up to {@code count} bytes between two files using copy_file_range(2).
+     * A {@code null} offset means the file's current position, which is updated.
+     * Returns -1 if the kernel can't copy between the two files and nothing has
+     * been copied, in which case the caller has to fall back to copying via
+     * userspace.
+     */
+    private long copyFileRange(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset,
+            long count) throws IOException {
+        long copied = 0;
+        boolean completed = false;
+        try {
+            begin();
+            while (copied < count) {
+                long rc;
+                try {
+                    rc = Libcore.os.copy_file_range(inFd, inOffset, outFd, outOffset, count - copied, 0);
+                } catch (ErrnoException errnoException) {
+                    // Not supported by the kernel, across filesystems or for these files (e.g. appending).
+                    int errno = errnoException.errno;
+                    if (copied == 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL
+                            || errno == EBADF || errno == EOPNOTSUPP)) {
+                        completed = true;
+                        return -1;
+                    }
+                    throw errnoException.rethrowAsIOException();
+                }
+                if (rc == 0) {
+                    break;
+                }
+                copied += rc;
+            }
+            completed = true;
+            return copied;
+        } finally {
+            end(completed);
+        }
     }
 
     public long transferTo(long position, long count, WritableByteChannel target) throws IOException {
@@ -438,6 +526,13 @@ final class FileChannelImpl extends FileChannel {
                 end(completed);
             }
         }
+        // ...or copy_file_range(2) to a file...
+        if (target instanceof FileChannelImpl) {
+            long rc = copyFileRange(fd, new MutableLong(position), ((FileChannelImpl) target).fd, null, count);
+            if (rc >= 0) {
+                return rc;
+            }
+        }
         // ...fall back to write(2).
         ByteBuffer buffer = null;
         try {
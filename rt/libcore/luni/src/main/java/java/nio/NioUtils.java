@@ -17,7 +17,16 @@
 package java.nio;
 
 import java.io.FileDescriptor;
+import java.io.IOException;
+import java.net.InetSocketAddress;
+import java.net.SocketException;
+import java.nio.channels.DatagramChannel;
 import java.nio.channels.FileChannel;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.SocketChannel;
+import libcore.io.ErrnoException;
+import libcore.io.Libcore;
+import static libcore.io.OsConstants.*;
 
 /**
  * @hide internal use only
@@ -26,6 +35,16 @@ public final class NioUtils {
     private NioUtils() {
     }
 
+    /**
+     * Removes the channel of the specified key from the selector's epoll set
+     * if it has one. Must be called before the channel's fd is closed.
+     */
+    public static void preClose(SelectionKey key) {
+        if (key instanceof SelectionKeyImpl) {
+            ((SelectorImpl) key.selector()).preClose((SelectionKeyImpl) key);
+        }
+    }
+
     public static void freeDirectBuffer(ByteBuffer buffer) {
         if (buffer == null) {
             return;
@@ -62,4 +81,94 @@ public final class NioUtils {
     public static int unsafeArrayOffset(ByteBuffer b) {
         return ((ByteArrayBuffer) b).arrayOffset;
     }
+
+    /**
+     * RoboVM note: Receives up to {@code targets.length} datagrams from
+     * {@code channel} with as few system calls as possible (recvmmsg() on
+     * Linux). Datagram i is stored in {@code targets[i]} and, unless
+     * {@code sources} is {@code null}, its sender in {@code sources[i]}.
+     * Returns the number of datagrams received.
+     */
+    public static int receive(DatagramChannel channel, ByteBuffer[] targets, InetSocketAddress[] sources) throws IOException {
+        return ((DatagramChannelImpl) channel).receive(targets, sources);
+    }
+
+    /**
+     * RoboVM note: Sends the remaining bytes of each of {@code sources} as a
+     * datagram with as few system calls as possible (sendmmsg() on Linux).
+     * Datagram i is sent to {@code targets[i]}, or to the connected address
+     * if {@code targets} is {@code null}. Returns the number of datagrams sent.
+     */
+    public static int send(DatagramChannel channel, ByteBuffer[] sources, InetSocketAddress[] targets) throws IOException {
+        return ((DatagramChannelImpl) channel).send(sources, targets);
+    }
+
+    /**
+     * RoboVM note: Transfers up to {@code count} bytes from the socket
+     * {@code src} to the socket {@code dst}, e.g. when proxying. On Linux the
+     * data is moved with splice(2) through a pipe without being copied to
+     * userspace. Stops early at end of stream or if {@code src} is
+     * non-blocking and has no more data available. Returns the number of
+     * bytes transferred.
+     */
+    public static long transfer(SocketChannel src, SocketChannel dst, long count) throws IOException {
+        if (count < 0) {
+            throw new IllegalArgumentException("count=" + count);
+        }
+        long rc = SpliceTransfer.transfer(((SocketChannelImpl) src).getFD(), null,
+                ((SocketChannelImpl) dst).getFD(), null, count, !src.isBlocking());
+        if (rc >= 0) {
+            return rc;
+        }
+        ByteBuffer buffer = ByteBuffer.allocateDirect((int) Math.min(count, 64 * 1024));
+        try {
+            long transferred = 0;
+            while (transferred < count) {
+                buffer.clear();
+                if (count - transferred < buffer.capacity()) {
+                    buffer.limit((int) (count - transferred));
+                }
+                if (src.read(buffer) <= 0) {
+                    break;
+                }
+                buffer.flip();
+                while (buffer.hasRemaining()) {
+                    transferred += dst.write(buffer);
+                }
+            }
+            return transferred;
+        } finally {
+            freeDirectBuffer(buffer);
+        }
+    }
+
+    /**
+     * RoboVM note: Sets the UDP generic segmentation offload (UDP_SEGMENT)
+     * size of {@code channel}. Datagrams sent larger than {@code size} are
+     * split by the kernel into datagrams of {@code size} bytes. 0 disables
+     * segmentation. Linux only.
+     */
+    public static void setUdpSegmentSize(DatagramChannel channel, int size) throws SocketException {
+        setUdpOption(channel, UDP_SEGMENT, size);
+    }
+
+    /**
+     * RoboVM note: Enables or disables UDP generic receive offload (UDP_GRO)
+     * for {@code channel}. With GRO enabled a received buffer may hold
+     * several coalesced datagrams of the same size. Linux only.
+     */
+    public static void setUdpGro(DatagramChannel channel, boolean enabled) throws SocketException {
+        setUdpOption(channel, UDP_GRO, enabled ? 1 : 0);
+    }
+
+    private static void setUdpOption(DatagramChannel channel, int option, int value) throws SocketException {
+        if (option == 0) {
+            throw new UnsupportedOperationException();
+        }
+        try {
+            Libcore.os.setsockoptInt(((DatagramChannelImpl) channel).getFD(), IPPROTO_UDP, option, value);
+        } catch (ErrnoException errnoException) {
+            throw errnoException.rethrowAsSocketException();
+        }
+    }
 }
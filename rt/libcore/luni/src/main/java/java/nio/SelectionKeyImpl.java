@@ -37,6 +37,16 @@ final class SelectionKeyImpl extends AbstractSelectionKey {
 
     private SelectorImpl selector;
 
+    /**
+     * The epoll events registered for the channel's fd, the fd they were
+     * registered with and whether an update is queued for the next select.
+     * Only used if the selector uses epoll. Guarded by the selector's
+     * keysLock.
+     */
+    int epollEvents;
+    int epollFdInt;
+    boolean epollUpdatePending;
+
     public SelectionKeyImpl(AbstractSelectableChannel channel, int operations,
             Object attachment, SelectorImpl selector) {
         this.channel = channel;
@@ -72,6 +82,7 @@ final class SelectionKeyImpl extends AbstractSelectionKey {
         }
         synchronized (selector.keysLock) {
             interestOps = operations;
+            selector.interestOpsChanged(this);
         }
         return this;
     }
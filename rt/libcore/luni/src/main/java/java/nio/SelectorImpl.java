@@ -28,6 +28,7 @@ import java.nio.channels.spi.AbstractSelectableChannel;
 import java.nio.channels.spi.AbstractSelectionKey;
 import java.nio.channels.spi.AbstractSelector;
 import java.nio.channels.spi.SelectorProvider;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Collection;
 import java.util.Collections;
@@ -39,12 +40,20 @@ import libcore.io.ErrnoException;
 import libcore.io.IoBridge;
 import libcore.io.IoUtils;
 import libcore.io.Libcore;
+import libcore.io.Memory;
 import libcore.io.StructPollfd;
 import libcore.util.EmptyArray;
 import static libcore.io.OsConstants.*;
 
 /*
- * Default implementation of java.nio.channels.Selector
+ * Default implementation of java.nio.channels.Selector. On Linux the
+ * registered channels are kept in an epoll set which is updated incrementally
+ * as keys are added, cancelled or change their interest ops. Elsewhere (or if
+ * the robovm.nio.epoll system property is false) every select() polls all
+ * registered channels.
+ *
+ * An epoll based selector can optionally be edge-triggered, see
+ * {@link SelectorProviderImpl#openEdgeTriggeredSelector()}.
  */
 final class SelectorImpl extends AbstractSelector {
 
@@ -71,16 +80,58 @@ final class SelectorImpl extends AbstractSelector {
     private final Set<SelectionKey> selectedKeys
             = new UnaddableSet<SelectionKey>(mutableSelectedKeys);
 
+    /**
+     * The value written to an eventfd to trigger a wakeup, in native byte order.
+     */
+    private static final byte[] EVENTFD_ONE = new byte[8];
+    static {
+        Memory.pokeLong(EVENTFD_ONE, 0, 1, ByteOrder.nativeOrder());
+    }
+
     /**
      * The wakeup pipe. To trigger a wakeup, write a byte to wakeupOut. Each
-     * time select returns, wakeupIn is drained.
+     * time select returns, wakeupIn is drained. On Linux this is an eventfd
+     * instead and wakeupIn and wakeupOut are the same fd.
      */
     private final FileDescriptor wakeupIn;
     private final FileDescriptor wakeupOut;
+    private final boolean wakeupIsEventFd;
 
     private final UnsafeArrayList<StructPollfd> pollFds = new UnsafeArrayList<StructPollfd>(StructPollfd.class, 8);
 
+    /**
+     * The epoll instance or {@code null} if this selector uses poll.
+     */
+    private final FileDescriptor epollFd;
+
+    /**
+     * Keys which have been registered or have had their interest ops changed
+     * since the last select. Only used with epoll. Guarded by keysLock.
+     */
+    private final ArrayList<SelectionKeyImpl> updatedKeys = new ArrayList<SelectionKeyImpl>();
+
+    /**
+     * The keys in the epoll set indexed by fd. Only used with epoll.
+     */
+    private SelectionKeyImpl[] keysByFd;
+
+    /**
+     * The fds and events returned by epoll_wait. Grown when a select fills
+     * them up. Only used with epoll.
+     */
+    private int[] readyFds;
+    private int[] readyEvents;
+
+    /**
+     * Whether channels are added to the epoll set with EPOLLET.
+     */
+    private final boolean edgeTriggered;
+
     public SelectorImpl(SelectorProvider selectorProvider) throws IOException {
+        this(selectorProvider, false);
+    }
+
+    SelectorImpl(SelectorProvider selectorProvider, boolean edgeTriggered) throws IOException {
         super(selectorProvider);
 
         /*
@@ -89,12 +140,37 @@ final class SelectorImpl extends AbstractSelector {
          * configure the pipe so we can fully drain it without blocking.
          */
         try {
-            FileDescriptor[] pipeFds = Libcore.os.pipe();
-            wakeupIn = pipeFds[0];
-            wakeupOut = pipeFds[1];
-            IoUtils.setBlocking(wakeupIn, false);
-            pollFds.add(new StructPollfd());
-            setPollFd(0, wakeupIn, POLLIN, null);
+            FileDescriptor eventFd = null;
+            if (EFD_NONBLOCK != 0) {
+                try {
+                    eventFd = Libcore.os.eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                } catch (ErrnoException e) {
+                    // Fall back to a pipe.
+                }
+            }
+            wakeupIsEventFd = eventFd != null;
+            if (wakeupIsEventFd) {
+                wakeupIn = eventFd;
+                wakeupOut = eventFd;
+            } else {
+                FileDescriptor[] pipeFds = Libcore.os.pipe();
+                wakeupIn = pipeFds[0];
+                wakeupOut = pipeFds[1];
+                IoUtils.setBlocking(wakeupIn, false);
+            }
+            if (isEpollEnabled()) {
+                epollFd = Libcore.os.epoll_create1(EPOLL_CLOEXEC);
+                Libcore.os.epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeupIn, EPOLLIN);
+                keysByFd = new SelectionKeyImpl[64];
+                readyFds = new int[64];
+                readyEvents = new int[64];
+                this.edgeTriggered = edgeTriggered;
+            } else {
+                epollFd = null;
+                this.edgeTriggered = false;
+                pollFds.add(new StructPollfd());
+                setPollFd(0, wakeupIn, POLLIN, null);
+            }
         } catch (ErrnoException errnoException) {
             throw errnoException.rethrowAsIOException();
         }
@@ -111,6 +187,7 @@ final class SelectorImpl extends AbstractSelector {
                     for (SelectionKey sk : mutableKeys) {
                         deregister((AbstractSelectionKey) sk);
                     }
+                    IoUtils.close(epollFd);
                 }
             }
         }
@@ -126,7 +203,13 @@ final class SelectorImpl extends AbstractSelector {
                 SelectionKeyImpl selectionKey = new SelectionKeyImpl(channel, operations,
                         attachment, this);
                 mutableKeys.add(selectionKey);
-                ensurePollFdsCapacity();
+                if (epollFd != null) {
+                    synchronized (keysLock) {
+                        interestOpsChanged(selectionKey);
+                    }
+                } else {
+                    ensurePollFdsCapacity();
+                }
                 return selectionKey;
             }
         }
@@ -168,7 +251,11 @@ final class SelectorImpl extends AbstractSelector {
                     doCancel();
                     boolean isBlocking = (timeout != 0);
                     synchronized (keysLock) {
-                        preparePollFds();
+                        if (epollFd != null) {
+                            updateEpollSet();
+                        } else {
+                            preparePollFds();
+                        }
                     }
                     int rc = -1;
                     try {
@@ -176,7 +263,11 @@ final class SelectorImpl extends AbstractSelector {
                             begin();
                         }
                         try {
-                            rc = Libcore.os.poll(pollFds.array(), (int) timeout);
+                            if (epollFd != null) {
+                                rc = Libcore.os.epoll_wait(epollFd, readyFds, readyEvents, (int) timeout);
+                            } else {
+                                rc = Libcore.os.poll(pollFds.array(), (int) timeout);
+                            }
                         } catch (ErrnoException errnoException) {
                             if (errnoException.errno != EINTR) {
                                 throw errnoException.rethrowAsIOException();
@@ -188,7 +279,10 @@ final class SelectorImpl extends AbstractSelector {
                         }
                     }
 
-                    int readyCount = (rc > 0) ? processPollFds() : 0;
+                    int readyCount = 0;
+                    if (rc > 0) {
+                        readyCount = (epollFd != null) ? processEpollEvents(rc) : processPollFds();
+                    }
                     readyCount -= doCancel();
                     return readyCount;
                 }
@@ -227,15 +321,208 @@ final class SelectorImpl extends AbstractSelector {
         }
     }
 
+    private static boolean isEpollEnabled() {
+        // EPOLLIN is 0 on platforms without epoll.
+        return EPOLLIN != 0 && Boolean.parseBoolean(System.getProperty("robovm.nio.epoll", "true"));
+    }
+
+    /**
+     * Called with keysLock held when a key has been registered or its
+     * interest ops have changed. The epoll set is updated on the next select.
+     */
+    void interestOpsChanged(SelectionKeyImpl key) {
+        if (epollFd != null && !key.epollUpdatePending) {
+            key.epollUpdatePending = true;
+            updatedKeys.add(key);
+        }
+    }
+
+    private int epollEvents(int interestOps) {
+        int events = 0;
+        if (((OP_ACCEPT | OP_READ) & interestOps) != 0) {
+            events |= EPOLLIN;
+        }
+        if (((OP_CONNECT | OP_WRITE) & interestOps) != 0) {
+            events |= EPOLLOUT;
+        }
+        if (events != 0 && edgeTriggered) {
+            events |= EPOLLET;
+        }
+        return events;
+    }
+
+    /**
+     * Applies the interest ops changes made since the last select to the
+     * epoll set. Keys without any interest ops are removed from the set like
+     * they are left out of the poll fds.
+     */
+    private void updateEpollSet() throws IOException {
+        for (int i = 0; i < updatedKeys.size(); ++i) {
+            SelectionKeyImpl key = updatedKeys.get(i);
+            key.epollUpdatePending = false;
+            if (!key.isValid() || !key.channel().isOpen()) {
+                continue; // Removed from the epoll set by doCancel().
+            }
+            int events = epollEvents(key.interestOpsNoCheck());
+            if (events == key.epollEvents) {
+                continue;
+            }
+            FileDescriptor fd = ((FileDescriptorChannel) key.channel()).getFD();
+            if (!fd.valid()) {
+                continue; // Closed. The key will be cancelled.
+            }
+            try {
+                if (key.epollEvents == 0) {
+                    Libcore.os.epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, events);
+                    int fdInt = fd.getInt$();
+                    if (fdInt >= keysByFd.length) {
+                        keysByFd = Arrays.copyOf(keysByFd, Math.max(fdInt + 1, keysByFd.length * 2));
+                    }
+                    keysByFd[fdInt] = key;
+                    key.epollFdInt = fdInt;
+                } else if (events == 0) {
+                    removeFromEpollSet(key);
+                } else {
+                    Libcore.os.epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, events);
+                }
+                key.epollEvents = events;
+            } catch (ErrnoException errnoException) {
+                throw errnoException.rethrowAsIOException();
+            }
+        }
+        updatedKeys.clear();
+    }
+
+    /**
+     * Called by {@link NioUtils#preClose} before the fd of the channel of the
+     * specified key is closed. The kernel only drops an fd from the epoll set
+     * once all fds referring to the same open file description have been
+     * closed. The description may be kept open by a dup()ed fd or a forked
+     * process so the fd must be removed while it is still valid.
+     */
+    void preClose(SelectionKeyImpl key) {
+        if (epollFd == null) {
+            return;
+        }
+        synchronized (keysLock) {
+            try {
+                removeFromEpollSet(key);
+            } catch (ErrnoException ignored) {
+                // Closing the channel must not fail because of this.
+            }
+        }
+    }
+
+    /**
+     * Called with keysLock held.
+     */
+    private void removeFromEpollSet(SelectionKeyImpl key) throws ErrnoException {
+        if (key.epollEvents == 0) {
+            return;
+        }
+        if (keysByFd[key.epollFdInt] == key) {
+            keysByFd[key.epollFdInt] = null;
+        }
+        key.epollEvents = 0;
+        // Channels remove themselves using preClose() before closing their
+        // fds so this only happens if the fd has been closed by other means.
+        FileDescriptor fd = ((FileDescriptorChannel) key.channel()).getFD();
+        if (fd.valid() && epollFd.valid()) {
+            try {
+                Libcore.os.epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, 0);
+            } catch (ErrnoException errnoException) {
+                if (errnoException.errno != ENOENT && errnoException.errno != EBADF) {
+                    throw errnoException;
+                }
+            }
+        }
+    }
+
+    /**
+     * Updates the ready ops and selected key set for the keys reported ready
+     * by epoll_wait.
+     */
+    private int processEpollEvents(int count) throws IOException {
+        int readyKeyCount = 0;
+        int wakeupFd = wakeupIn.getInt$();
+        for (int i = 0; i < count; ++i) {
+            int fd = readyFds[i];
+            int events = readyEvents[i];
+            if (fd == wakeupFd) {
+                drainWakeupPipe();
+                continue;
+            }
+            SelectionKeyImpl key = (fd < keysByFd.length) ? keysByFd[fd] : null;
+            if (key == null) {
+                continue;
+            }
+
+            int ops = key.interestOpsNoCheck();
+            int selectedOps = 0;
+            if ((events & (EPOLLHUP | EPOLLERR)) != 0) {
+                // As with poll, failure is always interesting.
+                selectedOps |= ops;
+            }
+            if ((events & EPOLLIN) != 0) {
+                selectedOps |= ops & (OP_ACCEPT | OP_READ);
+            }
+            if ((events & EPOLLOUT) != 0) {
+                if (key.isConnected()) {
+                    selectedOps |= ops & OP_WRITE;
+                } else {
+                    selectedOps |= ops & OP_CONNECT;
+                }
+            }
+            readyKeyCount += updateSelectedKey(key, selectedOps);
+        }
+
+        if (count == readyFds.length && readyFds.length < mutableKeys.size() + 1) {
+            // More fds may have been ready than fit. Make room for more next time.
+            int length = Math.min(readyFds.length * 2, mutableKeys.size() + 1);
+            readyFds = new int[length];
+            readyEvents = new int[length];
+        }
+
+        return readyKeyCount;
+    }
+
+    private void drainWakeupPipe() throws IOException {
+        byte[] buffer = new byte[8];
+        if (wakeupIsEventFd) {
+            // A single read resets the eventfd counter.
+            IoBridge.read(wakeupIn, buffer, 0, 8);
+            return;
+        }
+        // Read bytes from the wakeup pipe until the pipe is empty.
+        while (IoBridge.read(wakeupIn, buffer, 0, 1) > 0) {
+        }
+    }
+
+    /**
+     * Adds selectedOps to the ready ops of key and adds it to the selected
+     * key set. Returns 1 if key was updated and 0 otherwise.
+     */
+    private int updateSelectedKey(SelectionKeyImpl key, int selectedOps) {
+        if (selectedOps != 0) {
+            boolean wasSelected = mutableSelectedKeys.contains(key);
+            if (wasSelected && key.readyOps() != selectedOps) {
+                key.setReadyOps(key.readyOps() | selectedOps);
+                return 1;
+            } else if (!wasSelected) {
+                key.setReadyOps(selectedOps);
+                mutableSelectedKeys.add(key);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
     /**
      * Updates the key ready ops and selected key set.
      */
     private int processPollFds() throws IOException {
         if (pollFds.get(0).revents == POLLIN) {
-            // Read bytes from the wakeup pipe until the pipe is empty.
-            byte[] buffer = new byte[8];
-            while (IoBridge.read(wakeupIn, buffer, 0, 1) > 0) {
-            }
+            drainWakeupPipe();
         }
 
         int readyKeyCount = 0;
@@ -271,17 +558,7 @@ final class SelectorImpl extends AbstractSelector {
                 }
             }
 
-            if (selectedOps != 0) {
-                boolean wasSelected = mutableSelectedKeys.contains(key);
-                if (wasSelected && key.readyOps() != selectedOps) {
-                    key.setReadyOps(key.readyOps() | selectedOps);
-                    ++readyKeyCount;
-                } else if (!wasSelected) {
-                    key.setReadyOps(selectedOps);
-                    mutableSelectedKeys.add(key);
-                    ++readyKeyCount;
-                }
-            }
+            readyKeyCount += updateSelectedKey(key, selectedOps);
         }
 
         return readyKeyCount;
@@ -305,6 +582,15 @@ final class SelectorImpl extends AbstractSelector {
             if (cancelledKeys.size() > 0) {
                 for (SelectionKey currentKey : cancelledKeys) {
                     mutableKeys.remove(currentKey);
+                    if (epollFd != null) {
+                        synchronized (keysLock) {
+                            try {
+                                removeFromEpollSet((SelectionKeyImpl) currentKey);
+                            } catch (ErrnoException ignored) {
+                                // The fd stays in the epoll set but is no longer mapped to a key.
+                            }
+                        }
+                    }
                     deregister((AbstractSelectionKey) currentKey);
                     if (mutableSelectedKeys.remove(currentKey)) {
                         deselected++;
@@ -319,7 +605,11 @@ final class SelectorImpl extends AbstractSelector {
 
     @Override public Selector wakeup() {
         try {
-            Libcore.os.write(wakeupOut, new byte[] { 1 }, 0, 1);
+            if (wakeupIsEventFd) {
+                Libcore.os.write(wakeupOut, EVENTFD_ONE, 0, 8);
+            } else {
+                Libcore.os.write(wakeupOut, new byte[] { 1 }, 0, 1);
+            }
         } catch (ErrnoException ignored) {
         }
         return this;
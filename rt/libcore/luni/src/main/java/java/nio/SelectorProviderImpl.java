@@ -41,6 +41,18 @@ public final class SelectorProviderImpl extends SelectorProvider {
         return new SelectorImpl(this);
     }
 
+    /**
+     * RoboVM note: Opens a selector which registers its channels
+     * edge-triggered. A key is only selected when its channel becomes ready
+     * rather than whenever it is ready, so the interest ops don't have to be
+     * changed while a channel stays ready. Callers must read or write until
+     * the channel would block before selecting again. Only supported with
+     * epoll. Elsewhere this returns a normal level-triggered selector.
+     */
+    public AbstractSelector openEdgeTriggeredSelector() throws IOException {
+        return new SelectorImpl(this, true);
+    }
+
     public ServerSocketChannel openServerSocketChannel() throws IOException {
         return new ServerSocketChannelImpl(this);
     }
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package java.nio;
+
+import java.io.FileDescriptor;
+import java.io.IOException;
+import libcore.io.ErrnoException;
+import libcore.io.IoUtils;
+import libcore.io.Libcore;
+import libcore.io.StructPollfd;
+import libcore.util.MutableLong;
+import static libcore.io.OsConstants.*;
+
+/**
+ * Used to implement channel to channel transfers (socket to file and socket
+ * to socket) as splice(2) calls through a pipe so that the data never has to
+ * be copied to userspace. splice(2) requires one end of each call to be a
+ * pipe. Linux only.
+ */
+final class SpliceTransfer {
+    // The default pipe capacity on Linux.
+    private static final int CHUNK_SIZE = 64 * 1024;
+
+    static final boolean SUPPORTED = (SPLICE_F_MOVE != 0);
+
+    private SpliceTransfer() {
+    }
+
+    /**
+     * Transfers up to {@code count} bytes from {@code in} to {@code out}.
+     * Stops early at end of stream or, if {@code nonBlocking}, when
+     * {@code in} has no more data available. The offsets are used and
+     * updated as by splice(2) and must be {@code null} for sockets. Returns
+     * the number of bytes transferred or -1 if splice(2) can't be used with
+     * {@code in} and nothing has been transferred.
+     */
+    static long transfer(FileDescriptor in, MutableLong inOffset, FileDescriptor out, MutableLong outOffset,
+            long count, boolean nonBlocking) throws IOException {
+        if (!SUPPORTED) {
+            return -1;
+        }
+        FileDescriptor[] pipe;
+        try {
+            pipe = Libcore.os.pipe();
+        } catch (ErrnoException errnoException) {
+            return -1;
+        }
+        long transferred = 0;
+        try {
+            int flags = SPLICE_F_MOVE | (nonBlocking ? SPLICE_F_NONBLOCK : 0);
+            while (transferred < count) {
+                long n;
+                try {
+                    n = Libcore.os.splice(in, inOffset, pipe[1], null, Math.min(count - transferred, CHUNK_SIZE), flags);
+                } catch (ErrnoException errnoException) {
+                    if (errnoException.errno == EAGAIN) {
+                        break;
+                    }
+                    if (transferred == 0 && (errnoException.errno == EINVAL || errnoException.errno == ENOSYS)) {
+                        return -1;
+                    }
+                    throw errnoException.rethrowAsIOException();
+                }
+                if (n == 0) {
+                    break; // End of stream.
+                }
+                // Whatever is in the pipe has already been consumed from in
+                // so it must be written out even if out would block.
+                drain(pipe[0], out, outOffset, n);
+                transferred += n;
+            }
+        } finally {
+            IoUtils.close(pipe[0]);
+            IoUtils.close(pipe[1]);
+        }
+        return transferred;
+    }
+
+    private static void drain(FileDescriptor pipeIn, FileDescriptor out, MutableLong outOffset, long n) throws IOException {
+        try {
+            while (n > 0) {
+                try {
+                    n -= Libcore.os.splice(pipeIn, null, out, outOffset, n, SPLICE_F_MOVE);
+                } catch (ErrnoException errnoException) {
+                    if (errnoException.errno == EAGAIN) {
+                        awaitWritable(out);
+                    } else if (errnoException.errno == EINVAL) {
+                        // out doesn't support splice(2) (e.g. it has been
+                        // opened for appending). Copy via userspace.
+                        copy(pipeIn, out, outOffset, n);
+                        return;
+                    } else {
+                        throw errnoException;
+                    }
+                }
+            }
+        } catch (ErrnoException errnoException) {
+            throw errnoException.rethrowAsIOException();
+        }
+    }
+
+    private static void copy(FileDescriptor pipeIn, FileDescriptor out, MutableLong outOffset, long n) throws ErrnoException {
+        byte[] buffer = new byte[(int) Math.min(n, 8192)];
+        while (n > 0) {
+            int count = Libcore.os.read(pipeIn, buffer, 0, (int) Math.min(n, buffer.length));
+            for (int off = 0; off < count; ) {
+                try {
+                    if (outOffset != null) {
+                        int written = Libcore.os.pwrite(out, buffer, off, count - off, outOffset.value);
+                        outOffset.value += written;
+                        off += written;
+                    } else {
+                        off += Libcore.os.write(out, buffer, off, count - off);
+                    }
+                } catch (ErrnoException errnoException) {
+                    if (errnoException.errno != EAGAIN) {
+                        throw errnoException;
+                    }
+                    awaitWritable(out);
+                }
+            }
+            n -= count;
+        }
+    }
+
+    private static void awaitWritable(FileDescriptor fd) throws ErrnoException {
+        StructPollfd[] pollFds = new StructPollfd[] { new StructPollfd() };
+        pollFds[0].fd = fd;
+        pollFds[0].events = (short) POLLOUT;
+        Libcore.os.poll(pollFds, -1);
+    }
+}
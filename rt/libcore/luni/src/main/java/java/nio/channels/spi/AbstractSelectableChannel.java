@@ -18,6 +18,7 @@
 package java.nio.channels.spi;
 
 import java.io.IOException;
+import java.nio.NioUtils;
 import java.nio.channels.CancelledKeyException;
 import java.nio.channels.ClosedChannelException;
 import java.nio.channels.IllegalBlockingModeException;
@@ -161,8 +162,9 @@ public abstract class AbstractSelectableChannel extends SelectableChannel {
     }
 
     /**
-     * Implements the channel closing behavior. Calls
-     * {@code implCloseSelectableChannel()} first, then loops through the list
+     * Implements the channel closing behavior. Removes the channel from the
+     * epoll sets of the selectors it is registered with, calls
+     * {@code implCloseSelectableChannel()}, then loops through the list
      * of selection keys and cancels them, which unregisters this channel from
      * all selectors it is registered with.
      *
@@ -171,6 +173,11 @@ public abstract class AbstractSelectableChannel extends SelectableChannel {
      */
     @Override
     synchronized protected final void implCloseChannel() throws IOException {
+        for (SelectionKey key : keyList) {
+            if (key != null) {
+                NioUtils.preClose(key);
+            }
+        }
         implCloseSelectableChannel();
         for (SelectionKey key : keyList) {
             if (key != null) {
@@ -75,6 +75,13 @@ public final class Charsets {
      */
     public static native void isoLatin1BytesToChars(byte[] bytes, int offset, int length, char[] chars);
 
+    /**
+     * RoboVM note: Decodes the given UTF-8 bytes into the given char[], which must have room
+     * for at least {@code length} chars. Returns the number of chars decoded. Malformed input,
+     * surrogates encoded on their own and values above U+10FFFF are replaced by U+FFFD.
+     */
+    public static native int utf8BytesToChars(byte[] bytes, int offset, int length, char[] chars);
+
     private Charsets() {
     }
 }
@@ -17,6 +17,7 @@
 
 package java.util.zip;
 
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 
 /**
@@ -52,7 +53,12 @@ public class Adler32 implements Checksum {
      *            the byte to update checksum with.
      */
     public void update(int i) {
-        adler = updateByteImpl(i, adler);
+        // Done in Java as the JNI call would cost far more than the update.
+        int s1 = (int) adler & 0xffff;
+        int s2 = (int) (adler >>> 16);
+        s1 = (s1 + (i & 0xff)) % 65521;
+        s2 = (s2 + s1) % 65521;
+        adler = ((long) s2 << 16) | s1;
     }
 
     /**
@@ -74,7 +80,36 @@ public class Adler32 implements Checksum {
         adler = updateImpl(buf, offset, byteCount, adler);
     }
 
+    /**
+     * Updates this checksum with the remaining bytes of {@code buffer}. On
+     * return the buffer's position equals its limit. Direct buffers are
+     * checksummed in place.
+     *
+     * @since 1.8
+     */
+    public void update(ByteBuffer buffer) {
+        int position = buffer.position();
+        int byteCount = buffer.limit() - position;
+        if (byteCount <= 0) {
+            return;
+        }
+        if (buffer.isDirect()) {
+            adler = updateByteBufferImpl(buffer, position, byteCount, adler);
+            buffer.position(position + byteCount);
+        } else if (buffer.hasArray()) {
+            adler = updateImpl(buffer.array(), buffer.arrayOffset() + position, byteCount, adler);
+            buffer.position(position + byteCount);
+        } else {
+            byte[] chunk = new byte[Math.min(byteCount, 8192)];
+            while (buffer.hasRemaining()) {
+                int n = Math.min(buffer.remaining(), chunk.length);
+                buffer.get(chunk, 0, n);
+                adler = updateImpl(chunk, 0, n, adler);
+            }
+        }
+    }
+
     private native long updateImpl(byte[] buf, int offset, int byteCount, long adler1);
 
-    private native long updateByteImpl(int val, long adler1);
+    private native long updateByteBufferImpl(ByteBuffer buffer, int offset, int byteCount, long adler1);
 }
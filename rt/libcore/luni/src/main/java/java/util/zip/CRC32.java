@@ -17,6 +17,7 @@
 
 package java.util.zip;
 
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 
 /**
@@ -25,6 +26,20 @@ import java.util.Arrays;
  */
 public class CRC32 implements Checksum {
 
+    /**
+     * Table used by {@link #update(int)} so single bytes don't need a JNI call.
+     */
+    private static final int[] TABLE = new int[256];
+    static {
+        for (int i = 0; i < 256; i++) {
+            int c = i;
+            for (int j = 0; j < 8; j++) {
+                c = (c & 1) != 0 ? (c >>> 1) ^ 0xedb88320 : c >>> 1;
+            }
+            TABLE[i] = c;
+        }
+    }
+
     private long crc = 0L;
 
     long tbytes = 0L;
@@ -53,7 +68,9 @@ public class CRC32 implements Checksum {
      *            represents the byte to update the checksum.
      */
     public void update(int val) {
-        crc = updateByteImpl((byte) val, crc);
+        int c = ~(int) crc;
+        c = TABLE[(c ^ val) & 0xff] ^ (c >>> 8);
+        crc = ~c & 0xffffffffL;
     }
 
     /**
@@ -76,7 +93,37 @@ public class CRC32 implements Checksum {
         crc = updateImpl(buf, offset, byteCount, crc);
     }
 
+    /**
+     * Updates this checksum with the remaining bytes of {@code buffer}. On
+     * return the buffer's position equals its limit. Direct buffers are
+     * checksummed in place.
+     *
+     * @since 1.8
+     */
+    public void update(ByteBuffer buffer) {
+        int position = buffer.position();
+        int byteCount = buffer.limit() - position;
+        if (byteCount <= 0) {
+            return;
+        }
+        tbytes += byteCount;
+        if (buffer.isDirect()) {
+            crc = updateByteBufferImpl(buffer, position, byteCount, crc);
+            buffer.position(position + byteCount);
+        } else if (buffer.hasArray()) {
+            crc = updateImpl(buffer.array(), buffer.arrayOffset() + position, byteCount, crc);
+            buffer.position(position + byteCount);
+        } else {
+            byte[] chunk = new byte[Math.min(byteCount, 8192)];
+            while (buffer.hasRemaining()) {
+                int n = Math.min(buffer.remaining(), chunk.length);
+                buffer.get(chunk, 0, n);
+                crc = updateImpl(chunk, 0, n, crc);
+            }
+        }
+    }
+
     private native long updateImpl(byte[] buf, int offset, int byteCount, long crc1);
 
-    private native long updateByteImpl(byte val, long crc1);
+    private native long updateByteBufferImpl(ByteBuffer buffer, int offset, int byteCount, long crc1);
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package java.util.zip;
+
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+
+/**
+ * Computes a CRC-32C checksum using the Castagnoli polynomial (0x1EDC6F41)
+ * as used by iSCSI, ext4 and many storage and network protocols. Uses the
+ * CPU's CRC32C instructions where available.
+ *
+ * @since 1.9
+ */
+public final class CRC32C implements Checksum {
+
+    private long crc = 0L;
+
+    /**
+     * Creates a new {@code CRC32C} instance.
+     */
+    public CRC32C() {
+    }
+
+    /**
+     * Returns the CRC32C checksum for all input received.
+     *
+     * @return The checksum for this instance.
+     */
+    public long getValue() {
+        return crc;
+    }
+
+    /**
+     * Resets the CRC32C checksum to its initial state.
+     */
+    public void reset() {
+        crc = 0;
+    }
+
+    /**
+     * Updates this checksum with the byte value provided as integer.
+     *
+     * @param val
+     *            represents the byte to update the checksum.
+     */
+    public void update(int val) {
+        update(new byte[] { (byte) val }, 0, 1);
+    }
+
+    /**
+     * Updates this checksum with the bytes contained in buffer {@code buf}.
+     *
+     * @param buf
+     *            the buffer holding the data to update the checksum with.
+     */
+    public void update(byte[] buf) {
+        update(buf, 0, buf.length);
+    }
+
+    /**
+     * Update this {@code CRC32C} checksum with the contents of {@code buf},
+     * starting from {@code offset} and reading {@code byteCount} bytes of data.
+     */
+    public void update(byte[] buf, int offset, int byteCount) {
+        Arrays.checkOffsetAndCount(buf.length, offset, byteCount);
+        crc = updateImpl(buf, offset, byteCount, crc);
+    }
+
+    /**
+     * Updates this checksum with the remaining bytes of {@code buffer}. On
+     * return the buffer's position equals its limit. Direct buffers are
+     * checksummed in place.
+     */
+    public void update(ByteBuffer buffer) {
+        int position = buffer.position();
+        int byteCount = buffer.limit() - position;
+        if (byteCount <= 0) {
+            return;
+        }
+        if (buffer.isDirect()) {
+            crc = updateByteBufferImpl(buffer, position, byteCount, crc);
+            buffer.position(position + byteCount);
+        } else if (buffer.hasArray()) {
+            crc = updateImpl(buffer.array(), buffer.arrayOffset() + position, byteCount, crc);
+            buffer.position(position + byteCount);
+        } else {
+            byte[] chunk = new byte[Math.min(byteCount, 8192)];
+            while (buffer.hasRemaining()) {
+                int n = Math.min(buffer.remaining(), chunk.length);
+                buffer.get(chunk, 0, n);
+                crc = updateImpl(chunk, 0, n, crc);
+            }
+        }
+    }
+
+    private native long updateImpl(byte[] buf, int offset, int byteCount, long crc1);
+
+    private native long updateByteBufferImpl(ByteBuffer buffer, int offset, int byteCount, long crc1);
+}
@@ -0,0 +1,412 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package libcore.io;
+
+import java.io.Closeable;
+import java.io.FileDescriptor;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.channels.ClosedChannelException;
+import java.util.HashMap;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.Semaphore;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+/**
+ * RoboVM note: Asynchronous reads and writes on a file descriptor, in the
+ * spirit of Java 7's {@code AsynchronousFileChannel}. Operations return
+ * immediately with a {@link Future} and complete without blocking a thread
+ * per operation when {@link IoUring} is supported. Otherwise they're
+ * performed by a shared pool of threads.
+ * <p>
+ * Works with regular files as well as with pipes and sockets. Use a
+ * position of -1 for the latter to read or write at the current position.
+ * The buffer's position is advanced by the number of bytes transferred
+ * before the operation's {@link Future} completes and the buffer must not be
+ * touched until then. A read at end of file completes with -1.
+ *
+ * @hide
+ */
+public final class AsyncFileChannel implements Closeable {
+    private static Engine uringEngine;
+    private static Engine threadPoolEngine;
+
+    private final FileDescriptor fd;
+    private final Engine engine;
+
+    private AsyncFileChannel(FileDescriptor fd, Engine engine) {
+        this.fd = fd;
+        this.engine = engine;
+    }
+
+    /**
+     * Returns a new channel for {@code fd}. The channel takes ownership of
+     * {@code fd} and closes it when closed.
+     */
+    public static AsyncFileChannel open(FileDescriptor fd) {
+        return new AsyncFileChannel(fd, engine());
+    }
+
+    private static synchronized Engine engine() {
+        if (IoUring.isSupported()) {
+            if (uringEngine == null) {
+                try {
+                    uringEngine = new UringEngine(256, threadPoolEngine());
+                } catch (ErrnoException e) {
+                    // E.g. RLIMIT_MEMLOCK is too low. Fall back.
+                    System.logW("io_uring_setup failed, using a thread pool: " + e);
+                }
+            }
+            if (uringEngine != null) {
+                return uringEngine;
+            }
+        }
+        return threadPoolEngine();
+    }
+
+    private static synchronized Engine threadPoolEngine() {
+        if (threadPoolEngine == null) {
+            threadPoolEngine = new ThreadPoolEngine();
+        }
+        return threadPoolEngine;
+    }
+
+    /**
+     * Returns {@code true} if this channel's operations are performed by
+     * io_uring rather than by a thread pool.
+     */
+    public boolean usesIoUring() {
+        return engine instanceof UringEngine;
+    }
+
+    public boolean isOpen() {
+        return fd.valid();
+    }
+
+    /**
+     * Reads up to {@code dst.remaining()} bytes from {@code position} into
+     * {@code dst}.
+     */
+    public Future<Integer> read(ByteBuffer dst, long position) {
+        return submit(IoUring.IORING_OP_READ, dst, position);
+    }
+
+    /**
+     * Writes up to {@code src.remaining()} bytes from {@code src} at
+     * {@code position}.
+     */
+    public Future<Integer> write(ByteBuffer src, long position) {
+        return submit(IoUring.IORING_OP_WRITE, src, position);
+    }
+
+    private Future<Integer> submit(int opcode, ByteBuffer buffer, long position) {
+        if (position < -1) {
+            throw new IllegalArgumentException("position < -1: " + position);
+        }
+        if (opcode == IoUring.IORING_OP_READ && buffer.isReadOnly()) {
+            throw new IllegalArgumentException("read-only buffer");
+        }
+        Operation op = new Operation(opcode, buffer);
+        if (!isOpen()) {
+            op.fail(new ClosedChannelException());
+        } else {
+            engine.submit(fd, op, position);
+        }
+        return op;
+    }
+
+    public void close() throws IOException {
+        IoUtils.close(fd);
+    }
+
+    /**
+     * A pending read or write. Also the {@link Future} for its result.
+     */
+    private static final class Operation implements Future<Integer> {
+        final int opcode;
+        final ByteBuffer buffer;
+        final int byteCount;
+        // The buffer actually read into or written from. A direct copy of a
+        // heap buffer when using io_uring.
+        ByteBuffer ioBuffer;
+        private boolean done;
+        private int result;
+        private Throwable exception;
+
+        Operation(int opcode, ByteBuffer buffer) {
+            this.opcode = opcode;
+            this.buffer = buffer;
+            this.byteCount = buffer.remaining();
+            this.ioBuffer = buffer;
+        }
+
+        /**
+         * Called with the number of bytes transferred or a negated errno.
+         */
+        void complete(int rc) {
+            if (rc < 0) {
+                String functionName = opcode == IoUring.IORING_OP_READ ? "read" : "write";
+                fail(new ErrnoException(functionName, -rc));
+                return;
+            }
+            if (ioBuffer != buffer && opcode == IoUring.IORING_OP_READ) {
+                ioBuffer.limit(ioBuffer.position() + rc);
+                buffer.put(ioBuffer);
+            } else {
+                buffer.position(buffer.position() + rc);
+            }
+            if (rc == 0 && opcode == IoUring.IORING_OP_READ && byteCount > 0) {
+                rc = -1; // EOF.
+            }
+            synchronized (this) {
+                result = rc;
+                done = true;
+                notifyAll();
+            }
+        }
+
+        synchronized void fail(Throwable t) {
+            exception = t;
+            done = true;
+            notifyAll();
+        }
+
+        public boolean cancel(boolean mayInterruptIfRunning) {
+            return false;
+        }
+
+        public boolean isCancelled() {
+            return false;
+        }
+
+        public synchronized boolean isDone() {
+            return done;
+        }
+
+        public synchronized Integer get() throws InterruptedException, ExecutionException {
+            while (!done) {
+                wait();
+            }
+            return getResult();
+        }
+
+        public synchronized Integer get(long timeout, TimeUnit unit)
+                throws InterruptedException, ExecutionException, TimeoutException {
+            long deadline = System.nanoTime() + unit.toNanos(timeout);
+            while (!done) {
+                long remaining = deadline - System.nanoTime();
+                if (remaining <= 0) {
+                    throw new TimeoutException();
+                }
+                TimeUnit.NANOSECONDS.timedWait(this, remaining);
+            }
+            return getResult();
+        }
+
+        private Integer getResult() throws ExecutionException {
+            if (exception != null) {
+                throw new ExecutionException(exception);
+            }
+            return result;
+        }
+    }
+
+    private interface Engine {
+        void submit(FileDescriptor fd, Operation op, long position);
+    }
+
+    /**
+     * Submits operations to a shared {@link IoUring}. A daemon thread waits
+     * for completions and completes the corresponding operations. Operations
+     * which can't be queued without blocking, or which are submitted after
+     * the ring has failed, are handed to the thread pool instead.
+     */
+    private static final class UringEngine implements Engine, Runnable {
+        private final IoUring ring;
+        private final Engine fallback;
+        // Bounds the number of operations in flight so that the completion
+        // queue (twice the size of the submission queue) never overflows.
+        private final Semaphore slots;
+        // Operations which have been published to the submission queue but
+        // haven't completed yet.
+        private final HashMap<Long, Operation> pending = new HashMap<Long, Operation>();
+        // The number of pending operations the kernel has accepted. The rest
+        // are still in the submission queue.
+        private int inFlight;
+        private long nextUserData;
+        // Set once the ring has failed. No more operations are submitted.
+        private ErrnoException failure;
+
+        UringEngine(int entries, Engine fallback) throws ErrnoException {
+            ring = new IoUring(entries);
+            this.fallback = fallback;
+            slots = new Semaphore(ring.capacity());
+            Thread t = new Thread(this, "AsyncFileChannel io_uring completions");
+            t.setDaemon(true);
+            t.start();
+        }
+
+        public void submit(FileDescriptor fd, Operation op, long position) {
+            if (!slots.tryAcquire()) {
+                fallback.submit(fd, op, position);
+                return;
+            }
+            ByteBuffer buffer = op.buffer;
+            if (!buffer.isDirect()) {
+                op.ioBuffer = ByteBuffer.allocateDirect(buffer.remaining());
+                if (op.opcode == IoUring.IORING_OP_WRITE) {
+                    op.ioBuffer.put(buffer.duplicate()).flip();
+                }
+            }
+            synchronized (this) {
+                if (failure == null) {
+                    long userData = nextUserData++;
+                    // Can't fail since slots <= ring.capacity().
+                    boolean prepared = op.opcode == IoUring.IORING_OP_READ
+                            ? ring.prepareRead(fd, op.ioBuffer, position, userData)
+                            : ring.prepareWrite(fd, op.ioBuffer, position, userData);
+                    if (prepared) {
+                        pending.put(userData, op);
+                        flush();
+                        return;
+                    }
+                }
+            }
+            // Nothing has been published. Let the thread pool do it.
+            slots.release();
+            op.ioBuffer = buffer;
+            fallback.submit(fd, op, position);
+        }
+
+        /**
+         * Hands the operations still in the submission queue to the kernel.
+         * A failed submit leaves them queued. They're retried once the
+         * kernel has completed something if the error is transient and
+         * there is something in flight, otherwise the ring is shut down.
+         * Called with the lock held.
+         */
+        private void flush() {
+            if (failure != null || pending.size() == inFlight) {
+                return;
+            }
+            try {
+                inFlight += ring.submit();
+            } catch (ErrnoException errnoException) {
+                int errno = errnoException.errno;
+                if (inFlight == 0 || (errno != OsConstants.EAGAIN && errno != OsConstants.EBUSY)) {
+                    shutDown(errnoException);
+                }
+            }
+        }
+
+        /**
+         * Fails all pending operations. Completions for operations the kernel
+         * has already accepted are ignored when they arrive. Called with the
+         * lock held.
+         */
+        private void shutDown(ErrnoException errnoException) {
+            System.logW("io_uring failed, using a thread pool: " + errnoException);
+            failure = errnoException;
+            for (Operation op : pending.values()) {
+                slots.release();
+                op.fail(errnoException);
+            }
+            pending.clear();
+        }
+
+        public void run() {
+            long[] userData = new long[64];
+            int[] results = new int[userData.length];
+            while (true) {
+                try {
+                    ring.awaitCompletions(1);
+                } catch (ErrnoException errnoException) {
+                    if (errnoException.errno == OsConstants.EINTR) {
+                        continue;
+                    }
+                    synchronized (this) {
+                        if (failure == null) {
+                            shutDown(errnoException);
+                        }
+                    }
+                    return;
+                }
+                int count;
+                while ((count = ring.reap(userData, results)) > 0) {
+                    for (int i = 0; i < count; i++) {
+                        Operation op;
+                        synchronized (this) {
+                            inFlight--;
+                            op = pending.remove(userData[i]);
+                        }
+                        if (op == null) {
+                            // Failed by shutDown().
+                            continue;
+                        }
+                        slots.release();
+                        op.complete(results[i]);
+                    }
+                }
+                synchronized (this) {
+                    flush();
+                }
+            }
+        }
+    }
+
+    /**
+     * Performs operations using blocking system calls on a pool of daemon
+     * threads. Used when io_uring isn't supported.
+     */
+    private static final class ThreadPoolEngine implements Engine {
+        private final ExecutorService executor = Executors.newCachedThreadPool(new ThreadFactory() {
+            public Thread newThread(Runnable r) {
+                Thread t = new Thread(r, "AsyncFileChannel I/O");
+                t.setDaemon(true);
+                return t;
+            }
+        });
+
+        public void submit(final FileDescriptor fd, final Operation op, final long position) {
+            executor.execute(new Runnable() {
+                public void run() {
+                    int rc;
+                    try {
+                        // The buffer position is updated by op.complete().
+                        ByteBuffer buffer = op.buffer.duplicate();
+                        if (op.opcode == IoUring.IORING_OP_READ) {
+                            rc = position == -1 ? Libcore.os.read(fd, buffer) : Libcore.os.pread(fd, buffer, position);
+                        } else {
+                            rc = position == -1 ? Libcore.os.write(fd, buffer) : Libcore.os.pwrite(fd, buffer, position);
+                        }
+                    } catch (ErrnoException errnoException) {
+                        rc = -errnoException.errno;
+                    } catch (Throwable t) {
+                        op.fail(t);
+                        return;
+                    }
+                    op.complete(rc);
+                }
+            });
+        }
+    }
+}
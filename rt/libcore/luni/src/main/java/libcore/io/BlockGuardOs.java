@@ -55,6 +55,11 @@ public class BlockGuardOs extends ForwardingOs {
         return tagSocket(os.accept(fd, peerAddress));
     }
 
+    @Override public FileDescriptor accept4(FileDescriptor fd, InetSocketAddress peerAddress, int flags) throws ErrnoException, SocketException {
+        BlockGuard.getThreadPolicy().onNetwork();
+        return tagSocket(os.accept4(fd, peerAddress, flags));
+    }
+
     @Override public void close(FileDescriptor fd) throws ErrnoException {
         try {
             if (S_ISSOCK(Libcore.os.fstat(fd).st_mode)) {
@@ -87,6 +92,14 @@ public class BlockGuardOs extends ForwardingOs {
 
     // TODO: Untag newFd when needed for dup2(FileDescriptor oldFd, int newFd)
 
+    @Override public int epoll_wait(FileDescriptor epfd, int[] fds, int[] events, int timeoutMs) throws ErrnoException {
+        // As for poll, a timeout of 0 returns immediately and isn't subject to BlockGuard.
+        if (timeoutMs != 0) {
+            BlockGuard.getThreadPolicy().onNetwork();
+        }
+        return os.epoll_wait(epfd, fds, events, timeoutMs);
+    }
+
     @Override public void fdatasync(FileDescriptor fd) throws ErrnoException {
         BlockGuard.getThreadPolicy().onWriteToDisk();
         os.fdatasync(fd);
@@ -164,6 +177,16 @@ public class BlockGuardOs extends ForwardingOs {
         return os.recvfrom(fd, bytes, byteOffset, byteCount, flags, srcAddress);
     }
 
+    @Override public int recvmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] srcAddresses, int flags) throws ErrnoException, SocketException {
+        BlockGuard.getThreadPolicy().onNetwork();
+        return os.recvmmsg(fd, buffers, byteCounts, srcAddresses, flags);
+    }
+
+    @Override public int sendmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] dstAddresses, int flags) throws ErrnoException, SocketException {
+        BlockGuard.getThreadPolicy().onNetwork();
+        return os.sendmmsg(fd, buffers, byteCounts, dstAddresses, flags);
+    }
+
     @Override public int sendto(FileDescriptor fd, ByteBuffer buffer, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException {
         BlockGuard.getThreadPolicy().onNetwork();
         return os.sendto(fd, buffer, flags, inetAddress, port);
@@ -36,15 +36,21 @@ public class ForwardingOs implements Os {
     }
 
     public FileDescriptor accept(FileDescriptor fd, InetSocketAddress peerAddress) throws ErrnoException, SocketException { return os.accept(fd, peerAddress); }
+    public FileDescriptor accept4(FileDescriptor fd, InetSocketAddress peerAddress, int flags) throws ErrnoException, SocketException { return os.accept4(fd, peerAddress, flags); }
     public boolean access(String path, int mode) throws ErrnoException { return os.access(path, mode); }
     public void bind(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException { os.bind(fd, address, port); }
     public void chmod(String path, int mode) throws ErrnoException { os.chmod(path, mode); }
     public void chown(String path, int uid, int gid) throws ErrnoException { os.chown(path, uid, gid); }
     public void close(FileDescriptor fd) throws ErrnoException { os.close(fd); }
     public void connect(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException { os.connect(fd, address, port); }
+    public long copy_file_range(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException { return os.copy_file_range(inFd, inOffset, outFd, outOffset, byteCount, flags); }
     public FileDescriptor dup(FileDescriptor oldFd) throws ErrnoException { return os.dup(oldFd); }
     public FileDescriptor dup2(FileDescriptor oldFd, int newFd) throws ErrnoException { return os.dup2(oldFd, newFd); }
     public String[] environ() { return os.environ(); }
+    public FileDescriptor epoll_create1(int flags) throws ErrnoException { return os.epoll_create1(flags); }
+    public void epoll_ctl(FileDescriptor epfd, int op, FileDescriptor fd, int events) throws ErrnoException { os.epoll_ctl(epfd, op, fd, events); }
+    public int epoll_wait(FileDescriptor epfd, int[] fds, int[] events, int timeoutMs) throws ErrnoException { return os.epoll_wait(epfd, fds, events, timeoutMs); }
+    public FileDescriptor eventfd(int initval, int flags) throws ErrnoException { return os.eventfd(initval, flags); }
     public void execv(String filename, String[] argv) throws ErrnoException { os.execv(filename, argv); }
     public void execve(String filename, String[] argv, String[] envp) throws ErrnoException { os.execve(filename, argv, envp); }
     public void fchmod(FileDescriptor fd, int mode) throws ErrnoException { os.fchmod(fd, mode); }
@@ -107,9 +113,11 @@ public class ForwardingOs implements Os {
     public int readv(FileDescriptor fd, Object[] buffers, int[] offsets, int[] byteCounts) throws ErrnoException { return os.readv(fd, buffers, offsets, byteCounts); }
     public int recvfrom(FileDescriptor fd, ByteBuffer buffer, int flags, InetSocketAddress srcAddress) throws ErrnoException, SocketException { return os.recvfrom(fd, buffer, flags, srcAddress); }
     public int recvfrom(FileDescriptor fd, byte[] bytes, int byteOffset, int byteCount, int flags, InetSocketAddress srcAddress) throws ErrnoException, SocketException { return os.recvfrom(fd, bytes, byteOffset, byteCount, flags, srcAddress); }
+    public int recvmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] srcAddresses, int flags) throws ErrnoException, SocketException { return os.recvmmsg(fd, buffers, byteCounts, srcAddresses, flags); }
     public void remove(String path) throws ErrnoException { os.remove(path); }
     public void rename(String oldPath, String newPath) throws ErrnoException { os.rename(oldPath, newPath); }
     public long sendfile(FileDescriptor outFd, FileDescriptor inFd, MutableLong inOffset, long byteCount) throws ErrnoException { return os.sendfile(outFd, inFd, inOffset, byteCount); }
+    public int sendmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] dstAddresses, int flags) throws ErrnoException, SocketException { return os.sendmmsg(fd, buffers, byteCounts, dstAddresses, flags); }
     public int sendto(FileDescriptor fd, ByteBuffer buffer, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException { return os.sendto(fd, buffer, flags, inetAddress, port); }
     public int sendto(FileDescriptor fd, byte[] bytes, int byteOffset, int byteCount, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException { return os.sendto(fd, bytes, byteOffset, byteCount, flags, inetAddress, port); }
     public void setegid(int egid) throws ErrnoException { os.setegid(egid); }
@@ -128,6 +136,7 @@ public class ForwardingOs implements Os {
     public void shutdown(FileDescriptor fd, int how) throws ErrnoException { os.shutdown(fd, how); }
     public FileDescriptor socket(int domain, int type, int protocol) throws ErrnoException { return os.socket(domain, type, protocol); }
     public void socketpair(int domain, int type, int protocol, FileDescriptor fd1, FileDescriptor fd2) throws ErrnoException { os.socketpair(domain, type, protocol, fd1, fd2); }
+    public long splice(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException { return os.splice(inFd, inOffset, outFd, outOffset, byteCount, flags); }
     public StructStat stat(String path) throws ErrnoException { return os.stat(path); }
     public StructStatVfs statvfs(String path) throws ErrnoException { return os.statvfs(path); }
     public String strerror(int errno) { return os.strerror(errno); }
@@ -558,7 +558,9 @@ public final class IoBridge {
     public static FileDescriptor socket(boolean stream) throws SocketException {
         FileDescriptor fd;
         try {
-            fd = Libcore.os.socket(AF_INET6, stream ? SOCK_STREAM : SOCK_DGRAM, 0);
+            // RoboVM note: SOCK_CLOEXEC (Linux only) avoids leaking the fd
+            // into child processes without a separate fcntl() call.
+            fd = Libcore.os.socket(AF_INET6, (stream ? SOCK_STREAM : SOCK_DGRAM) | SOCK_CLOEXEC, 0);
 
             // The RFC (http://www.ietf.org/rfc/rfc3493.txt) says that IPV6_MULTICAST_HOPS defaults
             // to 1. The Linux kernel (at least up to 2.6.38) accidentally defaults to 64 (which
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+package libcore.io;
+
+import java.io.Closeable;
+import java.io.FileDescriptor;
+import java.nio.ByteBuffer;
+
+/**
+ * RoboVM note: A Linux io_uring(7) instance. Operations are prepared in the
+ * submission queue, handed to the kernel by {@link #submit()} and their
+ * results are later picked up from the completion queue by
+ * {@link #reap(long[], int[])}. Each operation carries a caller chosen
+ * {@code userData} value which identifies it in the completion queue.
+ * <p>
+ * Not thread safe. Preparing and submitting operations must be done by one
+ * thread at a time and so must waiting for and reaping completions, but the
+ * two sides may run concurrently. Buffers passed to the prepare methods must
+ * be direct and must not be touched until the operation has completed.
+ * <p>
+ * Requires Linux 5.6 or later. {@link #isSupported()} returns {@code false}
+ * on Darwin, on older kernels, if io_uring has been disabled by the system
+ * or if the {@code robovm.io.uring} system property is {@code false}.
+ *
+ * @hide
+ */
+public final class IoUring implements Closeable {
+    // From linux/io_uring.h. These are part of the kernel ABI.
+    public static final int IORING_OP_READ = 22;
+    public static final int IORING_OP_WRITE = 23;
+
+    private static final boolean AVAILABLE = probe();
+
+    private long ring;
+
+    public IoUring(int entries) throws ErrnoException {
+        ring = setup(entries);
+    }
+
+    public static boolean isSupported() {
+        return AVAILABLE && Boolean.parseBoolean(System.getProperty("robovm.io.uring", "true"));
+    }
+
+    /**
+     * Returns the number of operations which can be prepared without
+     * submitting. The kernel allows twice as many operations to be in flight
+     * before the completion queue overflows.
+     */
+    public int capacity() {
+        return capacity(ring);
+    }
+
+    /**
+     * Prepares a read of {@code buffer.remaining()} bytes into
+     * {@code buffer} at its position from {@code offset} in {@code fd}, or
+     * from the current file position if {@code offset} is -1. The result is
+     * the number of bytes read. The buffer position is not updated. Returns
+     * {@code false} if the submission queue is full.
+     */
+    public boolean prepareRead(FileDescriptor fd, ByteBuffer buffer, long offset, long userData) {
+        return prepareRw(ring, IORING_OP_READ, fd, buffer, buffer.position(), buffer.remaining(), offset, userData);
+    }
+
+    /**
+     * Like {@link #prepareRead} but writes {@code buffer.remaining()} bytes
+     * from {@code buffer}.
+     */
+    public boolean prepareWrite(FileDescriptor fd, ByteBuffer buffer, long offset, long userData) {
+        return prepareRw(ring, IORING_OP_WRITE, fd, buffer, buffer.position(), buffer.remaining(), offset, userData);
+    }
+
+    /**
+     * Submits all prepared operations. Returns the number submitted.
+     */
+    public int submit() throws ErrnoException {
+        return enter(ring, true, 0);
+    }
+
+    /**
+     * Blocks until at least {@code minComplete} operations have completed.
+     * May return early if interrupted by a signal.
+     */
+    public void awaitCompletions(int minComplete) throws ErrnoException {
+        enter(ring, false, minComplete);
+    }
+
+    /**
+     * Removes up to {@code userData.length} completions from the completion
+     * queue. The result of each completion is stored in {@code results}, a
+     * negative value is a negated {@code errno}. Never blocks. Returns the
+     * number of completions removed.
+     */
+    public int reap(long[] userData, int[] results) {
+        return reap(ring, userData, results);
+    }
+
+    public void close() {
+        if (ring != 0) {
+            destroy(ring);
+            ring = 0;
+        }
+    }
+
+    private static native boolean probe();
+    private static native long setup(int entries) throws ErrnoException;
+    private static native void destroy(long ring);
+    private static native int capacity(long ring);
+    private static native boolean prepareRw(long ring, int opcode, FileDescriptor fd, ByteBuffer buffer, int position, int byteCount, long offset, long userData);
+    private static native int enter(long ring, boolean submit, int minComplete) throws ErrnoException;
+    private static native int reap(long ring, long[] userData, int[] results);
+}
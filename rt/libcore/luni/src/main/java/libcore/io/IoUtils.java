@@ -25,6 +25,7 @@ import java.net.Socket;
 import java.nio.charset.Charset;
 import java.nio.charset.StandardCharsets;
 import java.util.Random;
+import libcore.util.MutableInt;
 import static libcore.io.OsConstants.*;
 
 public final class IoUtils {
@@ -88,6 +89,12 @@ public final class IoUtils {
      */
     public static void setBlocking(FileDescriptor fd, boolean blocking) throws IOException {
         try {
+            if (FIONBIO != 0) {
+                // RoboVM note: One ioctl() instead of an fcntl() to get and
+                // one to set the flags. FIONBIO is only available on Linux.
+                Libcore.os.ioctlInt(fd, FIONBIO, new MutableInt(blocking ? 0 : 1));
+                return;
+            }
             int flags = Libcore.os.fcntlVoid(fd, F_GETFL);
             if (!blocking) {
                 flags |= O_NONBLOCK;
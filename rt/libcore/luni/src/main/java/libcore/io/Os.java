@@ -27,15 +27,26 @@ import libcore.util.MutableLong;
 
 public interface Os {
     public FileDescriptor accept(FileDescriptor fd, InetSocketAddress peerAddress) throws ErrnoException, SocketException;
+    /* RoboVM note: SOCK_CLOEXEC and SOCK_NONBLOCK are 0 on Darwin where this is the same as accept. */
+    public FileDescriptor accept4(FileDescriptor fd, InetSocketAddress peerAddress, int flags) throws ErrnoException, SocketException;
     public boolean access(String path, int mode) throws ErrnoException;
     public void bind(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException;
     public void chmod(String path, int mode) throws ErrnoException;
     public void chown(String path, int uid, int gid) throws ErrnoException;
     public void close(FileDescriptor fd) throws ErrnoException;
     public void connect(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException;
+    /* RoboVM note: copy_file_range and splice are Linux only and fail with ENOSYS elsewhere. */
+    public long copy_file_range(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException;
     public FileDescriptor dup(FileDescriptor oldFd) throws ErrnoException;
     public FileDescriptor dup2(FileDescriptor oldFd, int newFd) throws ErrnoException;
     public String[] environ();
+    /* RoboVM note: The epoll functions are Linux only and fail with ENOSYS elsewhere. epoll_wait
+     * stores the fd and events of each ready fd in fds and events and returns the ready count. */
+    public FileDescriptor epoll_create1(int flags) throws ErrnoException;
+    public void epoll_ctl(FileDescriptor epfd, int op, FileDescriptor fd, int events) throws ErrnoException;
+    public int epoll_wait(FileDescriptor epfd, int[] fds, int[] events, int timeoutMs) throws ErrnoException;
+    /* RoboVM note: eventfd is Linux only and fails with ENOSYS elsewhere. */
+    public FileDescriptor eventfd(int initval, int flags) throws ErrnoException;
     public void execv(String filename, String[] argv) throws ErrnoException;
     public void execve(String filename, String[] argv, String[] envp) throws ErrnoException;
     public void fchmod(FileDescriptor fd, int mode) throws ErrnoException;
@@ -100,8 +111,12 @@ public interface Os {
     public int readv(FileDescriptor fd, Object[] buffers, int[] offsets, int[] byteCounts) throws ErrnoException;
     public int recvfrom(FileDescriptor fd, ByteBuffer buffer, int flags, InetSocketAddress srcAddress) throws ErrnoException, SocketException;
     public int recvfrom(FileDescriptor fd, byte[] bytes, int byteOffset, int byteCount, int flags, InetSocketAddress srcAddress) throws ErrnoException, SocketException;
+    /* RoboVM note: recvmmsg and sendmmsg are Linux only and fail with ENOSYS elsewhere. Each buffer holds one
+     * datagram and the number of bytes received or sent for each datagram is stored in byteCounts. */
+    public int recvmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] srcAddresses, int flags) throws ErrnoException, SocketException;
     public void remove(String path) throws ErrnoException;
     public void rename(String oldPath, String newPath) throws ErrnoException;
+    public int sendmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] dstAddresses, int flags) throws ErrnoException, SocketException;
     public int sendto(FileDescriptor fd, ByteBuffer buffer, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException;
     public int sendto(FileDescriptor fd, byte[] bytes, int byteOffset, int byteCount, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException;
     public long sendfile(FileDescriptor outFd, FileDescriptor inFd, MutableLong inOffset, long byteCount) throws ErrnoException;
@@ -121,6 +136,7 @@ public interface Os {
     public void shutdown(FileDescriptor fd, int how) throws ErrnoException;
     public FileDescriptor socket(int domain, int type, int protocol) throws ErrnoException;
     public void socketpair(int domain, int type, int protocol, FileDescriptor fd1, FileDescriptor fd2) throws ErrnoException;
+    public long splice(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException;
     public StructStat stat(String path) throws ErrnoException;
     public StructStatVfs statvfs(String path) throws ErrnoException;
     public String strerror(int errno);
@@ -116,6 +116,9 @@ public final class OsConstants {
     public static final int EEXIST = placeholder();
     public static final int EFAULT = placeholder();
     public static final int EFBIG = placeholder();
+    public static final int EFD_CLOEXEC = placeholder();
+    public static final int EFD_NONBLOCK = placeholder();
+    public static final int EFD_SEMAPHORE = placeholder();
     public static final int EHOSTUNREACH = placeholder();
     public static final int EIDRM = placeholder();
     public static final int EILSEQ = placeholder();
@@ -160,6 +163,16 @@ public final class OsConstants {
     public static final int EOVERFLOW = placeholder();
     public static final int EPERM = placeholder();
     public static final int EPIPE = placeholder();
+    public static final int EPOLLERR = placeholder();
+    public static final int EPOLLET = placeholder();
+    public static final int EPOLLHUP = placeholder();
+    public static final int EPOLLIN = placeholder();
+    public static final int EPOLLOUT = placeholder();
+    public static final int EPOLLRDHUP = placeholder();
+    public static final int EPOLL_CLOEXEC = placeholder();
+    public static final int EPOLL_CTL_ADD = placeholder();
+    public static final int EPOLL_CTL_DEL = placeholder();
+    public static final int EPOLL_CTL_MOD = placeholder();
     public static final int EPROTO = placeholder();
     public static final int EPROTONOSUPPORT = placeholder();
     public static final int EPROTOTYPE = placeholder();
@@ -176,6 +189,7 @@ public final class OsConstants {
     public static final int EXIT_FAILURE = placeholder();
     public static final int EXIT_SUCCESS = placeholder();
     public static final int FD_CLOEXEC = placeholder();
+    public static final int FIONBIO = placeholder();
     public static final int FIONREAD = placeholder();
     public static final int F_DUPFD = placeholder();
     public static final int F_GETFD = placeholder();
@@ -244,11 +258,13 @@ public final class OsConstants {
     public static final int MCL_FUTURE = placeholder();
     public static final int MSG_CTRUNC = placeholder();
     public static final int MSG_DONTROUTE = placeholder();
+    public static final int MSG_DONTWAIT = placeholder();
     public static final int MSG_EOR = placeholder();
     public static final int MSG_OOB = placeholder();
     public static final int MSG_PEEK = placeholder();
     public static final int MSG_TRUNC = placeholder();
     public static final int MSG_WAITALL = placeholder();
+    public static final int MSG_WAITFORONE = placeholder();
     public static final int MS_ASYNC = placeholder();
     public static final int MS_INVALIDATE = placeholder();
     public static final int MS_SYNC = placeholder();
@@ -327,7 +343,9 @@ public final class OsConstants {
     public static final int SIOCGIFBRDADDR = placeholder();
     public static final int SIOCGIFDSTADDR = placeholder();
     public static final int SIOCGIFNETMASK = placeholder();
+    public static final int SOCK_CLOEXEC = placeholder();
     public static final int SOCK_DGRAM = placeholder();
+    public static final int SOCK_NONBLOCK = placeholder();
     public static final int SOCK_RAW = placeholder();
     public static final int SOCK_SEQPACKET = placeholder();
     public static final int SOCK_STREAM = placeholder();
@@ -350,6 +368,9 @@ public final class OsConstants {
     public static final int SO_SNDLOWAT = placeholder();
     public static final int SO_SNDTIMEO = placeholder();
     public static final int SO_TYPE = placeholder();
+    public static final int SPLICE_F_MORE = placeholder();
+    public static final int SPLICE_F_MOVE = placeholder();
+    public static final int SPLICE_F_NONBLOCK = placeholder();
     public static final int STDERR_FILENO = placeholder();
     public static final int STDIN_FILENO = placeholder();
     public static final int STDOUT_FILENO = placeholder();
@@ -377,6 +398,8 @@ public final class OsConstants {
     public static final int S_IXOTH = placeholder();
     public static final int S_IXUSR = placeholder();
     public static final int TCP_NODELAY = placeholder();
+    public static final int UDP_GRO = placeholder();
+    public static final int UDP_SEGMENT = placeholder();
     public static final int WCONTINUED = placeholder();
     public static final int WEXITED = placeholder();
     public static final int WNOHANG = placeholder();
@@ -30,15 +30,21 @@ public final class Posix implements Os {
     Posix() { }
 
     public native FileDescriptor accept(FileDescriptor fd, InetSocketAddress peerAddress) throws ErrnoException, SocketException;
+    public native FileDescriptor accept4(FileDescriptor fd, InetSocketAddress peerAddress, int flags) throws ErrnoException, SocketException;
     public native boolean access(String path, int mode) throws ErrnoException;
     public native void bind(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException;
     public native void chmod(String path, int mode) throws ErrnoException;
     public native void chown(String path, int uid, int gid) throws ErrnoException;
     public native void close(FileDescriptor fd) throws ErrnoException;
     public native void connect(FileDescriptor fd, InetAddress address, int port) throws ErrnoException, SocketException;
+    public native long copy_file_range(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException;
     public native FileDescriptor dup(FileDescriptor oldFd) throws ErrnoException;
     public native FileDescriptor dup2(FileDescriptor oldFd, int newFd) throws ErrnoException;
     public native String[] environ();
+    public native FileDescriptor epoll_create1(int flags) throws ErrnoException;
+    public native void epoll_ctl(FileDescriptor epfd, int op, FileDescriptor fd, int events) throws ErrnoException;
+    public native int epoll_wait(FileDescriptor epfd, int[] fds, int[] events, int timeoutMs) throws ErrnoException;
+    public native FileDescriptor eventfd(int initval, int flags) throws ErrnoException;
     public native void execv(String filename, String[] argv) throws ErrnoException;
     public native void execve(String filename, String[] argv, String[] envp) throws ErrnoException;
     public native void fchmod(FileDescriptor fd, int mode) throws ErrnoException;
@@ -141,9 +147,23 @@ public final class Posix implements Os {
         return recvfromBytes(fd, bytes, byteOffset, byteCount, flags, srcAddress);
     }
     private native int recvfromBytes(FileDescriptor fd, Object buffer, int byteOffset, int byteCount, int flags, InetSocketAddress srcAddress) throws ErrnoException, SocketException;
+    public int recvmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] srcAddresses, int flags) throws ErrnoException, SocketException {
+        Object[] arrays = new Object[buffers.length];
+        int[] offsets = new int[buffers.length];
+        prepareMmsgBuffers(buffers, arrays, offsets, byteCounts);
+        return recvmmsgBytes(fd, arrays, offsets, byteCounts, srcAddresses, flags);
+    }
+    private native int recvmmsgBytes(FileDescriptor fd, Object[] buffers, int[] offsets, int[] byteCounts, InetSocketAddress[] srcAddresses, int flags) throws ErrnoException, SocketException;
     public native void remove(String path) throws ErrnoException;
     public native void rename(String oldPath, String newPath) throws ErrnoException;
     public native long sendfile(FileDescriptor outFd, FileDescriptor inFd, MutableLong inOffset, long byteCount) throws ErrnoException;
+    public int sendmmsg(FileDescriptor fd, ByteBuffer[] buffers, int[] byteCounts, InetSocketAddress[] dstAddresses, int flags) throws ErrnoException, SocketException {
+        Object[] arrays = new Object[buffers.length];
+        int[] offsets = new int[buffers.length];
+        prepareMmsgBuffers(buffers, arrays, offsets, byteCounts);
+        return sendmmsgBytes(fd, arrays, offsets, byteCounts, dstAddresses, flags);
+    }
+    private native int sendmmsgBytes(FileDescriptor fd, Object[] buffers, int[] offsets, int[] byteCounts, InetSocketAddress[] dstAddresses, int flags) throws ErrnoException, SocketException;
     public int sendto(FileDescriptor fd, ByteBuffer buffer, int flags, InetAddress inetAddress, int port) throws ErrnoException, SocketException {
         if (buffer.isDirect()) {
             return sendtoBytes(fd, buffer, buffer.position(), buffer.remaining(), flags, inetAddress, port);
@@ -172,6 +192,7 @@ public final class Posix implements Os {
     public native void shutdown(FileDescriptor fd, int how) throws ErrnoException;
     public native FileDescriptor socket(int domain, int type, int protocol) throws ErrnoException;
     public native void socketpair(int domain, int type, int protocol, FileDescriptor fd1, FileDescriptor fd2) throws ErrnoException;
+    public native long splice(FileDescriptor inFd, MutableLong inOffset, FileDescriptor outFd, MutableLong outOffset, long byteCount, int flags) throws ErrnoException;
     public native StructStat stat(String path) throws ErrnoException;
     public native StructStatVfs statvfs(String path) throws ErrnoException;
     public native String strerror(int errno);
@@ -203,4 +224,22 @@ public final class Posix implements Os {
     }
     private native int writeBytes(FileDescriptor fd, Object buffer, int offset, int byteCount) throws ErrnoException;
     public native int writev(FileDescriptor fd, Object[] buffers, int[] offsets, int[] byteCounts) throws ErrnoException;
+
+    /**
+     * Converts the ByteBuffers passed to recvmmsg/sendmmsg to the buffer, offset and byte count
+     * arrays expected by the natives. Direct buffers are passed as is, heap buffers as their arrays.
+     */
+    private static void prepareMmsgBuffers(ByteBuffer[] buffers, Object[] arrays, int[] offsets, int[] byteCounts) {
+        for (int i = 0; i < buffers.length; ++i) {
+            ByteBuffer buffer = buffers[i];
+            if (buffer.isDirect()) {
+                arrays[i] = buffer;
+                offsets[i] = buffer.position();
+            } else {
+                arrays[i] = NioUtils.unsafeArray(buffer);
+                offsets[i] = NioUtils.unsafeArrayOffset(buffer) + buffer.position();
+            }
+            byteCounts[i] = buffer.remaining();
+        }
+    }
 }
@@ -142,6 +142,27 @@ public final class VM {
 
     public native static final void generateHeapDump();
 
+    /**
+     * Returns the total number of bytes allocated on the heap since the VM
+     * was started. Objects allocated on the stack by compiled code are not
+     * included.
+     */
+    public native static final long getAllocatedBytes();
+
+    /**
+     * Writes the hot method report collected by profile instrumented code
+     * (compiled with {@code -profile-instrument}) to the specified file. The 
+     * report is empty if no instrumented code has been linked in.
+     * 
+     * @return {@code true} if the report was written successfully.
+     */
+    public native static final boolean dumpProfile(String path);
+
+    /**
+     * Resets all profile counters to 0.
+     */
+    public native static final void resetProfile();
+
     public native static final long allocateMemory(int size);
 
     public native static final long allocateMemoryUncollectable(int size);
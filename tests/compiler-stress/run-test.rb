@@ -18,6 +18,7 @@ puts "Using tmp dir #{@dir}"
   'org.specs2:specs2_2.10' # Makes gcc segfault on linking. 22006 classes. Too large?
 ]
 @compiled = []
+@timings = []
 
 def compile_artifact(group, artifact, version, n)
   puts "**************"
@@ -48,7 +49,12 @@ eof
   classpath = deps.join(':')
   cmd = "#{@dev_root}/bin/robovm -cp #{classpath} -tmp #{@dir}/#{group}-#{artifact}.tmp -cache #{@dir}/cache -d #{@dir}/#{group}-#{artifact} -o out -verbose -forcelinkclasses '**.*' " + (ARGV.join(' '))
   puts "Running command: #{cmd}"
+  start = Time.now
   system({"ROBOVM_DEV_ROOT" => @dev_root, "JVM_MX" => "4G"}, cmd) or raise "Compilation of #{group}:#{artifact} failed"
+  elapsed = Time.now - start
+  size = File.size("#{@dir}/#{group}-#{artifact}/out")
+  @timings.push([group, artifact, version, elapsed, size])
+  puts "Compiled #{group}:#{artifact}:#{version} in #{elapsed.round(1)} s (#{size} bytes)"
   system("rm -rf #{@dir}/#{group}-#{artifact}.tmp #{@dir}/#{group}-#{artifact}")
 end
 
@@ -91,3 +97,12 @@ end
     n = n + 1
   end
 end
+
+# Build times and executable sizes can be compared between runs with
+# different compiler options (e.g. -whole-program) by diffing the
+# timings.csv files.
+File.open("#{@dir}/timings.csv", 'w') do |f|
+  f.puts "artifact,version,seconds,bytes"
+  @timings.each {|t| f.puts "#{t[0]}:#{t[1]},#{t[2]},#{t[3].round(1)},#{t[4]}"}
+end
+puts "Compiled #{@timings.size} artifacts in #{@timings.map {|t| t[3]}.reduce(0, :+).round(1)} s. Timings written to #{@dir}/timings.csv"
@@ -19,8 +19,13 @@ package libcore.java.nio.channels;
 import java.io.File;
 import java.io.FileInputStream;
 import java.io.FileOutputStream;
+import java.io.RandomAccessFile;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
 import java.nio.ByteBuffer;
 import java.nio.channels.FileChannel;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
 import libcore.io.IoUtils;
 
 public class FileChannelTest extends junit.framework.TestCase {
@@ -110,4 +115,76 @@ public class FileChannelTest extends junit.framework.TestCase {
 
         assertEquals("hello world", new String(IoUtils.readFileAsString(tmp.getPath())));
     }
+
+    private static File createFile(String contents) throws Exception {
+        File tmp = File.createTempFile("FileChannelTest", "tmp");
+        FileOutputStream fos = new FileOutputStream(tmp);
+        fos.write(contents.getBytes("US-ASCII"));
+        fos.close();
+        return tmp;
+    }
+
+    public void test_transferFrom_file() throws Exception {
+        FileChannel src = new FileInputStream(createFile("0123456789")).getChannel();
+        src.position(2);
+        File dstFile = createFile("abcd");
+        FileChannel dst = new RandomAccessFile(dstFile, "rw").getChannel();
+        assertEquals(5, dst.transferFrom(src, 2, 5));
+        assertEquals(7, src.position());
+        // transferFrom doesn't change the position of the destination.
+        assertEquals(0, dst.position());
+        src.close();
+        dst.close();
+        assertEquals("ab23456", IoUtils.readFileAsString(dstFile.getPath()));
+    }
+
+    public void test_transferTo_file() throws Exception {
+        FileChannel src = new FileInputStream(createFile("0123456789")).getChannel();
+        File dstFile = createFile("");
+        FileChannel dst = new FileOutputStream(dstFile).getChannel();
+        assertEquals(4, src.transferTo(3, 4, dst));
+        assertEquals(0, src.position());
+        assertEquals(4, dst.position());
+        assertEquals(3, src.transferTo(7, 10, dst));
+        src.close();
+        dst.close();
+        assertEquals("3456789", IoUtils.readFileAsString(dstFile.getPath()));
+    }
+
+    public void test_transferTo_appendingFile() throws Exception {
+        FileChannel src = new FileInputStream(createFile("0123456789")).getChannel();
+        File dstFile = createFile("abc");
+        FileChannel dst = new FileOutputStream(dstFile, true).getChannel();
+        assertEquals(3, src.transferTo(0, 3, dst));
+        src.close();
+        dst.close();
+        assertEquals("abc012", IoUtils.readFileAsString(dstFile.getPath()));
+    }
+
+    public void test_transferFrom_socket() throws Exception {
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        SocketChannel client = SocketChannel.open(ssc.socket().getLocalSocketAddress());
+        SocketChannel server = ssc.accept();
+        byte[] data = new byte[50000];
+        for (int i = 0; i < data.length; i++) {
+            data[i] = (byte) i;
+        }
+        client.write(ByteBuffer.wrap(data));
+        client.close();
+
+        File dstFile = createFile("");
+        FileChannel dst = new RandomAccessFile(dstFile, "rw").getChannel();
+        // Asks for more than is available. Stops at end of stream.
+        assertEquals(data.length, dst.transferFrom(server, 0, data.length + 100));
+        dst.close();
+        server.close();
+        ssc.close();
+
+        FileInputStream fis = new FileInputStream(dstFile);
+        byte[] actual = new byte[data.length];
+        new java.io.DataInputStream(fis).readFully(actual);
+        fis.close();
+        assertTrue(java.util.Arrays.equals(data, actual));
+    }
 }
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+import java.net.SocketException;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import org.junit.After;
+import org.junit.Test;
+
+/**
+ * Stress tests closing sockets while many threads are blocked reading from
+ * and accepting on them. Every blocked thread must be woken up by the close.
+ */
+public class AsyncSocketCloseTest {
+    private final List<java.io.Closeable> sockets = new ArrayList<>();
+
+    @After
+    public void tearDown() throws Exception {
+        for (java.io.Closeable s : sockets) {
+            s.close();
+        }
+        sockets.clear();
+    }
+
+    private ServerSocket openServer() throws IOException {
+        ServerSocket server = new ServerSocket();
+        sockets.add(server);
+        server.bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0), 1024);
+        return server;
+    }
+
+    private static Thread blocked(final String name, final Callback callback, final AtomicInteger woken,
+            final CountDownLatch done) {
+
+        Thread t = new Thread(name) {
+            public void run() {
+                try {
+                    callback.block();
+                } catch (SocketException e) {
+                    woken.incrementAndGet();
+                } catch (IOException e) {
+                } finally {
+                    done.countDown();
+                }
+            }
+        };
+        t.setDaemon(true);
+        t.start();
+        return t;
+    }
+
+    private interface Callback {
+        void block() throws IOException;
+    }
+
+    private static void closeConcurrently(final List<? extends java.io.Closeable> toClose, int closerCount)
+            throws InterruptedException {
+
+        final AtomicInteger next = new AtomicInteger();
+        Thread[] closers = new Thread[closerCount];
+        for (int i = 0; i < closers.length; i++) {
+            closers[i] = new Thread() {
+                public void run() {
+                    int i;
+                    while ((i = next.getAndIncrement()) < toClose.size()) {
+                        try {
+                            toClose.get(i).close();
+                        } catch (IOException e) {
+                        }
+                    }
+                }
+            };
+            closers[i].start();
+        }
+        for (Thread t : closers) {
+            t.join();
+        }
+    }
+
+    @Test
+    public void testCloseBlockedReaders() throws Exception {
+        ServerSocket server = openServer();
+        int count = 300;
+        final List<Socket> clients = new ArrayList<>();
+        for (int i = 0; i < count; i++) {
+            Socket client = new Socket(server.getInetAddress(), server.getLocalPort());
+            sockets.add(client);
+            sockets.add(server.accept());
+            clients.add(client);
+        }
+
+        AtomicInteger woken = new AtomicInteger();
+        CountDownLatch done = new CountDownLatch(count);
+        for (final Socket client : clients) {
+            blocked("reader", new Callback() {
+                public void block() throws IOException {
+                    client.getInputStream().read();
+                }
+            }, woken, done);
+        }
+        // Give the readers a chance to actually block.
+        Thread.sleep(500);
+        closeConcurrently(clients, 8);
+
+        assertTrue("Readers still blocked: " + done.getCount(), done.await(30, TimeUnit.SECONDS));
+        assertEquals(count, woken.get());
+    }
+
+    @Test
+    public void testCloseBlockedAcceptors() throws Exception {
+        int count = 100;
+        final List<ServerSocket> servers = new ArrayList<>();
+        for (int i = 0; i < count; i++) {
+            servers.add(openServer());
+        }
+
+        AtomicInteger woken = new AtomicInteger();
+        // Several threads blocked on each server socket.
+        CountDownLatch done = new CountDownLatch(count * 3);
+        for (final ServerSocket server : servers) {
+            for (int i = 0; i < 3; i++) {
+                blocked("acceptor", new Callback() {
+                    public void block() throws IOException {
+                        server.accept();
+                    }
+                }, woken, done);
+            }
+        }
+        Thread.sleep(500);
+        closeConcurrently(servers, 8);
+
+        assertTrue("Acceptors still blocked: " + done.getCount(), done.await(30, TimeUnit.SECONDS));
+        assertEquals(count * 3, woken.get());
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+/**
+ * Base class for benchmarks run by {@link RunBenchmarks}. Benchmarks take
+ * too long to be part of the test suite and only report numbers so they are
+ * plain classes rather than tests. Neither surefire nor {@link RunAllTests} 
+ * picks them up.
+ */
+public abstract class Benchmark {
+    private boolean reporting = true;
+
+    /**
+     * Runs the benchmark and reports the results using {@link #report}.
+     */
+    public abstract void run() throws Exception;
+
+    /**
+     * Returns the number of times {@link #run()} is called with reporting
+     * disabled before the measured run. Benchmarks which take a long time or
+     * set up a lot of state on their own may return 0.
+     */
+    public int getWarmupRuns() {
+        return 1;
+    }
+
+    void setReporting(boolean reporting) {
+        this.reporting = reporting;
+    }
+
+    /**
+     * Reports a single result of this benchmark.
+     */
+    protected void report(String what, double value, String unit) {
+        if (reporting) {
+            System.out.format("%s: %s: %.1f %s%n", getClass().getSimpleName(), what, value, unit);
+        }
+    }
+
+    /**
+     * Returns the rate of {@code count} operations done in {@code nanos} ns
+     * per second.
+     */
+    protected static double perSecond(long count, long nanos) {
+        return count * 1000000000.0 / nanos;
+    }
+
+    /**
+     * Returns the throughput in MB/s of {@code bytes} bytes processed in 
+     * {@code nanos} ns.
+     */
+    protected static double mbPerSecond(long bytes, long nanos) {
+        return perSecond(bytes, nanos) / (1024 * 1024);
+    }
+}
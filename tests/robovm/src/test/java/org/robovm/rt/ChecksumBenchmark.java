@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import java.nio.ByteBuffer;
+import java.util.Random;
+import java.util.zip.Adler32;
+import java.util.zip.CRC32;
+import java.util.zip.CRC32C;
+import java.util.zip.Checksum;
+
+/**
+ * Measures the throughput of {@link CRC32}, {@link CRC32C} and 
+ * {@link Adler32} over a 256k heap and direct {@link ByteBuffer}.
+ */
+public class ChecksumBenchmark extends Benchmark {
+    private static final int ITERATIONS = 2000;
+
+    @Override
+    public void run() throws Exception {
+        byte[] bytes = new byte[256 * 1024];
+        new Random(42).nextBytes(bytes);
+        ByteBuffer direct = ByteBuffer.allocateDirect(bytes.length);
+        direct.put(bytes);
+        for (Checksum checksum : new Checksum[] {new CRC32(), new CRC32C(), new Adler32()}) {
+            benchmark(checksum, ByteBuffer.wrap(bytes));
+            benchmark(checksum, direct);
+        }
+    }
+
+    private void benchmark(Checksum checksum, ByteBuffer buffer) {
+        long start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            buffer.rewind();
+            ChecksumTest.update(checksum, buffer);
+        }
+        long duration = System.nanoTime() - start;
+        report(checksum.getClass().getSimpleName() + (buffer.isDirect() ? " direct" : " heap"),
+                mbPerSecond(buffer.capacity() * (long) ITERATIONS, duration), "MB/s");
+    }
+}
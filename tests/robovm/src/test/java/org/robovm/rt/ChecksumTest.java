@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.nio.ByteBuffer;
+import java.util.Random;
+import java.util.zip.Adler32;
+import java.util.zip.CRC32;
+import java.util.zip.CRC32C;
+import java.util.zip.Checksum;
+
+import org.junit.Test;
+
+/**
+ * Tests the native {@link CRC32}, {@link CRC32C} and {@link Adler32}
+ * implementations with inputs around the block sizes used internally.
+ */
+public class ChecksumTest {
+
+    private static long checksum(Checksum checksum, byte[] bytes, int offset, int length) {
+        checksum.reset();
+        checksum.update(bytes, offset, length);
+        return checksum.getValue();
+    }
+
+    @Test
+    public void testKnownValues() throws Exception {
+        byte[] digits = "123456789".getBytes("US-ASCII");
+        assertEquals(0xcbf43926L, checksum(new CRC32(), digits, 0, digits.length));
+        assertEquals(0xe3069283L, checksum(new CRC32C(), digits, 0, digits.length));
+        assertEquals(0x091e01deL, checksum(new Adler32(), digits, 0, digits.length));
+        byte[] wikipedia = "Wikipedia".getBytes("US-ASCII");
+        assertEquals(0x11e60398L, checksum(new Adler32(), wikipedia, 0, wikipedia.length));
+        assertEquals(0L, checksum(new CRC32(), digits, 0, 0));
+        assertEquals(0L, checksum(new CRC32C(), digits, 0, 0));
+        assertEquals(1L, checksum(new Adler32(), digits, 0, 0));
+    }
+
+    private void testConsistency(Checksum checksum) {
+        Random random = new Random(42);
+        byte[] bytes = new byte[70000];
+        random.nextBytes(bytes);
+        for (int length : new int[] {0, 1, 15, 16, 17, 63, 64, 65, 100, 1000, 5552, 5553, 65536}) {
+            for (int offset = 0; offset < 4; offset++) {
+                long expected = checksum(checksum, bytes, offset, length);
+
+                // Byte at a time.
+                checksum.reset();
+                for (int i = 0; i < length; i++) {
+                    checksum.update(bytes[offset + i]);
+                }
+                assertEquals(expected, checksum.getValue());
+
+                // In two chunks.
+                int split = random.nextInt(length + 1);
+                checksum.reset();
+                checksum.update(bytes, offset, split);
+                checksum.update(bytes, offset + split, length - split);
+                assertEquals(expected, checksum.getValue());
+
+                // Direct, heap and read-only ByteBuffers.
+                ByteBuffer direct = ByteBuffer.allocateDirect(length + 8);
+                direct.position(offset);
+                direct.put(bytes, offset, length);
+                direct.limit(offset + length);
+                direct.position(offset);
+                ByteBuffer heap = ByteBuffer.wrap(bytes, offset, length);
+                ByteBuffer readOnly = heap.asReadOnlyBuffer();
+                for (ByteBuffer b : new ByteBuffer[] {direct, heap, readOnly}) {
+                    checksum.reset();
+                    update(checksum, b);
+                    assertEquals(offset + length, b.position());
+                    assertEquals(expected, checksum.getValue());
+                }
+            }
+        }
+    }
+
+    static void update(Checksum checksum, ByteBuffer b) {
+        if (checksum instanceof CRC32) {
+            ((CRC32) checksum).update(b);
+        } else if (checksum instanceof CRC32C) {
+            ((CRC32C) checksum).update(b);
+        } else {
+            ((Adler32) checksum).update(b);
+        }
+    }
+
+    @Test
+    public void testCRC32() {
+        testConsistency(new CRC32());
+    }
+
+    @Test
+    public void testCRC32C() {
+        testConsistency(new CRC32C());
+    }
+
+    @Test
+    public void testAdler32() {
+        testConsistency(new Adler32());
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.lang.reflect.InvocationHandler;
+import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+
+import org.junit.Test;
+
+/**
+ * Tests virtual and interface calls to methods with few implementations
+ * which the linker calls directly instead of through the vtable or itable.
+ */
+public class DevirtualizationTest {
+
+    public interface Service {
+        String name();
+    }
+
+    static class OnlyService implements Service {
+        public String name() {
+            return "only";
+        }
+    }
+
+    public interface Shape {
+        int sides();
+    }
+
+    static class Triangle implements Shape {
+        public int sides() {
+            return 3;
+        }
+    }
+
+    static class Square implements Shape {
+        public int sides() {
+            return 4;
+        }
+    }
+
+    static class Pentagon extends Square {
+        public int sides() {
+            return 5;
+        }
+    }
+
+    // Inherits Square.sides()
+    static class Rectangle extends Square {
+    }
+
+    static abstract class Animal {
+        abstract String sound();
+        String greet() {
+            return "I say " + sound();
+        }
+    }
+
+    static class Dog extends Animal {
+        String sound() {
+            return "woof";
+        }
+    }
+
+    static class Puppy extends Dog {
+        String sound() {
+            return "yip";
+        }
+    }
+
+    static class Counter {
+        int count;
+        synchronized void increment() {
+            count++;
+        }
+    }
+
+    private static String callName(Service s) {
+        return s.name();
+    }
+
+    private static int callSides(Shape s) {
+        return s.sides();
+    }
+
+    @Test
+    public void testSingleInterfaceImplementation() {
+        assertEquals("only", callName(new OnlyService()));
+    }
+
+    @Test
+    public void testProxyOfSingleImplementationInterface() {
+        Service proxy = (Service) Proxy.newProxyInstance(getClass().getClassLoader(),
+                new Class<?>[] {Service.class}, new InvocationHandler() {
+                    public Object invoke(Object proxy, Method method, Object[] args) {
+                        return "proxy";
+                    }
+                });
+        assertEquals("proxy", callName(proxy));
+        assertEquals("only", callName(new OnlyService()));
+    }
+
+    @Test
+    public void testFewInterfaceImplementations() {
+        assertEquals(3, callSides(new Triangle()));
+        assertEquals(4, callSides(new Square()));
+        assertEquals(5, callSides(new Pentagon()));
+        assertEquals(4, callSides(new Rectangle()));
+    }
+
+    @Test
+    public void testFewClassImplementations() {
+        Animal[] animals = {new Dog(), new Puppy(), new Dog()};
+        StringBuilder sb = new StringBuilder();
+        for (Animal a : animals) {
+            sb.append(a.greet()).append(';');
+        }
+        assertEquals("I say woof;I say yip;I say woof;", sb.toString());
+    }
+
+    @Test
+    public void testSynchronizedImplementation() {
+        Counter c = new Counter();
+        for (int i = 0; i < 10; i++) {
+            c.increment();
+        }
+        assertEquals(10, c.count);
+    }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import org.robovm.rt.EscapeAnalysisTest.Point;
+
+/**
+ * Measures the time and heap bytes per call of a loop which allocates a 
+ * short-lived object and array per iteration. Neither escapes so with 
+ * escape analysis both should be allocated on the stack and the heap bytes
+ * per call should drop to 0.
+ */
+public class EscapeAnalysisBenchmark extends Benchmark {
+    private static final int ITERATIONS = 100000;
+
+    private static int sumOfSquares(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            Point p = new Point(i, n - i);
+            sum += p.lengthSquared();
+            int[] tmp = new int[2];
+            tmp[0] = p.x;
+            tmp[1] = p.y;
+            sum -= tmp[0] + tmp[1];
+        }
+        return sum;
+    }
+
+    @Override
+    public void run() throws Exception {
+        long sum = 0;
+        long bytes = VM.getAllocatedBytes();
+        long start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            sum += sumOfSquares(16);
+        }
+        long duration = System.nanoTime() - start;
+        bytes = VM.getAllocatedBytes() - bytes;
+        report("short-lived objects, time (checksum " + sum + ")", (double) duration / ITERATIONS, "ns/call");
+        report("short-lived objects, heap allocated", (double) bytes / ITERATIONS, "bytes/call");
+    }
+}
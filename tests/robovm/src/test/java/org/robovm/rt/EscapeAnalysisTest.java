@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import org.junit.Test;
+
+/**
+ * Tests objects and arrays which never leave the method allocating them and
+ * which the compiler allocates on the stack instead of the heap.
+ */
+public class EscapeAnalysisTest {
+
+    static class Point {
+        int x;
+        int y;
+        Point(int x, int y) {
+            this.x = x;
+            this.y = y;
+        }
+        int lengthSquared() {
+            return x * x + y * y;
+        }
+        void translate(int dx, int dy) {
+            x += dx;
+            y += dy;
+        }
+    }
+
+    static class Point3D extends Point {
+        int z;
+        Point3D(int x, int y, int z) {
+            super(x, y);
+            this.z = z;
+        }
+        @Override
+        int lengthSquared() {
+            return super.lengthSquared() + z * z;
+        }
+    }
+
+    static class Holder {
+        Object value;
+        Holder(Object value) {
+            this.value = value;
+        }
+    }
+
+    static int initCount;
+
+    static class Initialized {
+        static final int[] VALUES;
+        static {
+            initCount++;
+            VALUES = new int[] {1, 2, 3};
+        }
+        int index;
+        int value() {
+            return VALUES[index];
+        }
+    }
+
+    static class FailingConstructor {
+        int value;
+        FailingConstructor(int value) {
+            this.value = 10 / value;
+        }
+    }
+
+    static Object escaped;
+
+    static class Leaking {
+        int value;
+        Leaking() {
+            escaped = this;
+        }
+    }
+
+    @Test
+    public void testFieldAccess() {
+        Point p = new Point(3, 4);
+        assertEquals(3, p.x);
+        assertEquals(4, p.y);
+        assertEquals(25, p.lengthSquared());
+        p.translate(1, 1);
+        assertEquals(41, p.lengthSquared());
+    }
+
+    @Test
+    public void testVirtualCallOnSubclass() {
+        Point3D p = new Point3D(1, 2, 3);
+        assertEquals(14, p.lengthSquared());
+    }
+
+    @Test
+    public void testAllocationInLoop() {
+        int sum = 0;
+        for (int i = 0; i < 1000; i++) {
+            Point p = new Point(i, i);
+            assertEquals(i, p.x);
+            p.translate(1, 0);
+            sum += p.x - p.y;
+        }
+        assertEquals(1000, sum);
+    }
+
+    @Test
+    public void testFieldsAreCleared() {
+        for (int i = 0; i < 10; i++) {
+            Holder h = new Holder(null);
+            assertNull(h.value);
+            int[] a = new int[4];
+            for (int j = 0; j < a.length; j++) {
+                assertEquals(0, a[j]);
+                a[j] = i + 1;
+            }
+            Initialized o = new Initialized();
+            assertEquals(0, o.index);
+            o.index = 1;
+        }
+    }
+
+    @Test
+    public void testClassInitialization() {
+        Initialized o = new Initialized();
+        o.index = 2;
+        assertEquals(3, o.value());
+        assertEquals(1, initCount);
+    }
+
+    @Test
+    public void testReferencedObjectSurvivesGC() {
+        Holder h = new Holder(new StringBuilder("foo"));
+        for (int i = 0; i < 3; i++) {
+            System.gc();
+            byte[][] garbage = new byte[1000][];
+            for (int j = 0; j < garbage.length; j++) {
+                garbage[j] = new byte[100];
+            }
+        }
+        assertEquals("foo", h.value.toString());
+    }
+
+    @Test
+    public void testSmallArrays() {
+        long[] l = new long[3];
+        l[0] = Long.MAX_VALUE;
+        l[2] = Long.MIN_VALUE;
+        assertEquals(3, l.length);
+        assertEquals(Long.MAX_VALUE, l[0]);
+        assertEquals(0, l[1]);
+        assertEquals(Long.MIN_VALUE, l[2]);
+
+        boolean[] b = new boolean[0];
+        assertEquals(0, b.length);
+
+        char[] c = new char[2];
+        c[0] = 'a';
+        c[1] = 'b';
+        assertEquals('a' + 'b', c[0] + c[1]);
+
+        try {
+            double[] d = new double[2];
+            d[2] = 1.0;
+            fail();
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+    }
+
+    @Test
+    public void testExceptionInConstructor() {
+        try {
+            FailingConstructor f = new FailingConstructor(0);
+            fail("" + f.value);
+        } catch (ArithmeticException e) {
+        }
+        FailingConstructor f = new FailingConstructor(5);
+        assertEquals(2, f.value);
+    }
+
+    private static void leak() {
+        Leaking l = new Leaking();
+        l.value = 42;
+    }
+
+    @Test
+    public void testEscapingConstructor() {
+        leak();
+        // Overwrite the stack frame used by leak()
+        assertEquals(25, new Point(3, 4).lengthSquared());
+        System.gc();
+        assertEquals(42, ((Leaking) escaped).value);
+    }
+}
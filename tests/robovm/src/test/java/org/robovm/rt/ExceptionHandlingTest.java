@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.lang.reflect.InvocationHandler;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.lang.reflect.Proxy;
+import java.util.concurrent.Callable;
+
+import org.junit.Test;
+
+/**
+ * Tests try/catch blocks in compiled code. On Linux x86_64 these are
+ * compiled using landingpads and unwind tables which have to interoperate
+ * with the TrycatchContexts used by synchronized methods, reflection,
+ * proxies and native code.
+ */
+public class ExceptionHandlingTest {
+
+    static class AException extends RuntimeException {}
+    static class BException extends AException {}
+
+    private static Object nullObject;
+    private static int zero;
+
+    private static void throwA() {
+        throw new AException();
+    }
+
+    private static void throwB(int depth) {
+        if (depth == 0) {
+            throw new BException();
+        }
+        throwB(depth - 1);
+    }
+
+    private static String catchMostSpecific(RuntimeException e) {
+        try {
+            throw e;
+        } catch (BException b) {
+            return "B";
+        } catch (AException a) {
+            return "A";
+        } catch (RuntimeException r) {
+            return "R";
+        }
+    }
+
+    @Test
+    public void testCatchClauseOrder() {
+        assertEquals("B", catchMostSpecific(new BException()));
+        assertEquals("A", catchMostSpecific(new AException()));
+        assertEquals("R", catchMostSpecific(new IllegalStateException()));
+    }
+
+    @Test
+    public void testCatchFromCallee() {
+        int caught = 0;
+        for (int i = 0; i < 10; i++) {
+            try {
+                throwB(i);
+                fail();
+            } catch (AException e) {
+                assertTrue(e instanceof BException);
+                caught++;
+            }
+        }
+        assertEquals(10, caught);
+    }
+
+    @Test
+    public void testNestedTryBlocks() {
+        StringBuilder sb = new StringBuilder();
+        try {
+            try {
+                sb.append('a');
+                throwA();
+            } catch (BException e) {
+                fail();
+            } finally {
+                sb.append('f');
+            }
+        } catch (AException e) {
+            sb.append('c');
+            try {
+                throwB(2);
+            } catch (BException e2) {
+                sb.append('b');
+            }
+        }
+        assertEquals("afcb", sb.toString());
+    }
+
+    @Test
+    public void testThrowFromCatchBlock() {
+        try {
+            try {
+                throwA();
+            } catch (AException e) {
+                throw new IllegalArgumentException(e);
+            }
+        } catch (IllegalArgumentException e) {
+            assertTrue(e.getCause() instanceof AException);
+            return;
+        }
+        fail();
+    }
+
+    @Test
+    public void testFinallyOnReturn() {
+        final int[] counter = new int[1];
+        Callable<Integer> c = new Callable<Integer>() {
+            public Integer call() {
+                try {
+                    return 42;
+                } finally {
+                    counter[0]++;
+                }
+            }
+        };
+        for (int i = 0; i < 3; i++) {
+            try {
+                assertEquals(42, (int) c.call());
+            } catch (Exception e) {
+                fail();
+            }
+        }
+        assertEquals(3, counter[0]);
+    }
+
+    @Test
+    public void testImplicitExceptionsInTryBlock() {
+        try {
+            nullObject.hashCode();
+            fail();
+        } catch (NullPointerException e) {
+        }
+        try {
+            int[] a = (int[]) nullObject;
+            a[0] = 1;
+            fail();
+        } catch (NullPointerException e) {
+        }
+        try {
+            int x = 10 / zero;
+            fail("" + x);
+        } catch (ArithmeticException e) {
+        }
+        try {
+            int[] a = new int[1];
+            a[zero + 1] = 1;
+            fail();
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        try {
+            Object o = "foo";
+            Integer i = (Integer) o;
+            fail("" + i);
+        } catch (ClassCastException e) {
+        }
+    }
+
+    @Test
+    public void testLocalsSurviveThrow() {
+        int a = 1;
+        long b = 2;
+        double c = 3.0;
+        String d = "4";
+        try {
+            a = 5;
+            b = 6;
+            throwA();
+            c = 7.0;
+        } catch (AException e) {
+            d = "8";
+        }
+        assertEquals(5, a);
+        assertEquals(6, b);
+        assertEquals(3.0, c, 0.0);
+        assertEquals("8", d);
+    }
+
+    private synchronized void synchronizedThrow() {
+        throwB(3);
+    }
+
+    @Test
+    public void testThrowThroughSynchronizedMethod() {
+        try {
+            synchronizedThrow();
+            fail();
+        } catch (BException e) {
+        }
+        // The monitor must have been released.
+        assertFalse(Thread.holdsLock(this));
+        synchronizedThrow2();
+    }
+
+    private synchronized void synchronizedThrow2() {
+        try {
+            throwA();
+        } catch (AException e) {
+            assertTrue(Thread.holdsLock(this));
+        }
+    }
+
+    public static void reflectiveThrow() {
+        throwB(1);
+    }
+
+    @Test
+    public void testThrowThroughReflection() throws Exception {
+        Method m = ExceptionHandlingTest.class.getMethod("reflectiveThrow");
+        try {
+            m.invoke(null);
+            fail();
+        } catch (InvocationTargetException e) {
+            assertTrue(e.getCause() instanceof BException);
+        }
+    }
+
+    @Test
+    public void testThrowThroughProxy() {
+        Runnable r = (Runnable) Proxy.newProxyInstance(getClass().getClassLoader(),
+                new Class<?>[] {Runnable.class}, new InvocationHandler() {
+                    public Object invoke(Object proxy, Method method, Object[] args) {
+                        throw new BException();
+                    }
+                });
+        try {
+            r.run();
+            fail();
+        } catch (BException e) {
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+/**
+ * Times the calls handled by the compiler's intrinsics: short 
+ * {@link System#arraycopy(Object, int, Object, int, int)} calls on 
+ * primitive and reference arrays, {@link String#equals(Object)} and 
+ * {@link String#indexOf(int)}.
+ */
+public class IntrinsicsBenchmark extends Benchmark {
+    private static final int ITERATIONS = 1000000;
+    private static final int LENGTH = 32;
+
+    @Override
+    public void run() throws Exception {
+        int[] srcInts = new int[LENGTH * 2];
+        int[] dstInts = new int[LENGTH * 2];
+        long start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            System.arraycopy(srcInts, i & 31, dstInts, 0, LENGTH);
+        }
+        report("int[] arraycopy", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        Object[] srcObjects = new Object[LENGTH * 2];
+        Object[] dstObjects = new Object[LENGTH * 2];
+        for (int i = 0; i < srcObjects.length; i++) {
+            srcObjects[i] = Integer.valueOf(i);
+        }
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            System.arraycopy(srcObjects, i & 31, dstObjects, 0, LENGTH);
+        }
+        report("Object[] arraycopy", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        String s = "The quick brown fox jumps over the lazy dog";
+        // Use a distinct instance so equals() can't return on identity.
+        String t = new String(s.toCharArray());
+        int matches = 0;
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            if (s.equals(t)) {
+                matches++;
+            }
+        }
+        report("String.equals() (" + matches + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        int index = 0;
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            index += s.indexOf('z');
+        }
+        report("String.indexOf() (" + index + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+    }
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.util.Arrays;
+
+import org.junit.Test;
+
+/**
+ * Tests the methods which the compiler replaces with intrinsics. The
+ * intrinsics must behave exactly like the Java implementations they replace.
+ */
+public class IntrinsicsTest {
+
+    @Test
+    public void testArraycopyPrimitives() {
+        byte[] b = {1, 2, 3, 4, 5};
+        System.arraycopy(b, 0, b, 1, 4);
+        assertTrue(Arrays.equals(new byte[] {1, 1, 2, 3, 4}, b));
+        char[] c = {'a', 'b', 'c'};
+        char[] c2 = new char[4];
+        System.arraycopy(c, 1, c2, 2, 2);
+        assertTrue(Arrays.equals(new char[] {0, 0, 'b', 'c'}, c2));
+        int[] i = {1, 2, 3, 4};
+        System.arraycopy(i, 1, i, 0, 3);
+        assertTrue(Arrays.equals(new int[] {2, 3, 4, 4}, i));
+        long[] l = {Long.MIN_VALUE, Long.MAX_VALUE};
+        long[] l2 = new long[2];
+        System.arraycopy(l, 0, l2, 0, 2);
+        assertTrue(Arrays.equals(l, l2));
+        double[] d = {1.5, Double.NaN};
+        double[] d2 = new double[2];
+        System.arraycopy(d, 0, d2, 0, 0);
+        assertTrue(Arrays.equals(new double[2], d2));
+        System.arraycopy(d, 0, d2, 0, 2);
+        assertTrue(Arrays.equals(d, d2));
+    }
+
+    @Test
+    public void testArraycopyReferences() {
+        String[] s = {"a", "b", "c", "d"};
+        System.arraycopy(s, 0, s, 1, 3);
+        assertArrayEquals(new String[] {"a", "a", "b", "c"}, s);
+        System.arraycopy(s, 1, s, 0, 3);
+        assertArrayEquals(new String[] {"a", "b", "c", "c"}, s);
+        Object[] o = new Object[4];
+        System.arraycopy(s, 1, o, 0, 2);
+        assertArrayEquals(new Object[] {"b", "c", null, null}, o);
+        Object[] o2 = new Integer[] {1, 2};
+        System.arraycopy(o2, 0, o, 2, 2);
+        assertArrayEquals(new Object[] {"b", "c", 1, 2}, o);
+        Object[] dst = new Integer[4];
+        try {
+            System.arraycopy(o, 1, dst, 0, 3);
+            fail("ArrayStoreException expected");
+        } catch (ArrayStoreException e) {
+        }
+    }
+
+    @Test
+    public void testArraycopyExceptions() {
+        int[] src = new int[4];
+        int[] dst = new int[4];
+        int[] nullArray = null;
+        try {
+            System.arraycopy(nullArray, 0, dst, 0, 1);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+            assertEquals("src == null", e.getMessage());
+        }
+        try {
+            System.arraycopy(src, 0, nullArray, 0, 1);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+            assertEquals("dst == null", e.getMessage());
+        }
+        int[][] bounds = {{-1, 0, 1}, {0, -1, 1}, {0, 0, -1}, {1, 0, 4}, {0, 1, 4},
+                {Integer.MAX_VALUE, 0, 2}, {0, 0, Integer.MAX_VALUE}};
+        for (int[] bound : bounds) {
+            try {
+                System.arraycopy(src, bound[0], dst, bound[1], bound[2]);
+                fail("ArrayIndexOutOfBoundsException expected");
+            } catch (ArrayIndexOutOfBoundsException e) {
+            }
+        }
+        System.arraycopy(src, 4, dst, 4, 0);
+        Object o = new long[4];
+        try {
+            System.arraycopy(o, 0, dst, 0, 1);
+            fail("ArrayStoreException expected");
+        } catch (ArrayStoreException e) {
+        }
+    }
+
+    @Test
+    public void testArraysFill() {
+        boolean[] z = new boolean[3];
+        Arrays.fill(z, true);
+        assertTrue(Arrays.equals(new boolean[] {true, true, true}, z));
+        short[] s = new short[2];
+        Arrays.fill(s, (short) -1);
+        assertTrue(Arrays.equals(new short[] {-1, -1}, s));
+        int[] i = new int[0];
+        Arrays.fill(i, 1);
+        float[] f = new float[3];
+        Arrays.fill(f, -0.0f);
+        assertEquals(0x80000000, Float.floatToRawIntBits(f[2]));
+        double[] d = new double[17];
+        Arrays.fill(d, 2.5);
+        for (double v : d) {
+            assertEquals(2.5, v, 0);
+        }
+        long[] l = null;
+        try {
+            Arrays.fill(l, 1L);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+        }
+    }
+
+    @Test
+    public void testArraysEquals() {
+        int[] a = {1, 2, 3};
+        int[] nullArray = null;
+        assertTrue(Arrays.equals(a, a));
+        assertTrue(Arrays.equals(nullArray, nullArray));
+        assertFalse(Arrays.equals(a, nullArray));
+        assertFalse(Arrays.equals(nullArray, a));
+        assertTrue(Arrays.equals(a, new int[] {1, 2, 3}));
+        assertFalse(Arrays.equals(a, new int[] {1, 2}));
+        assertFalse(Arrays.equals(a, new int[] {1, 2, 4}));
+        assertTrue(Arrays.equals(new byte[0], new byte[0]));
+        assertFalse(Arrays.equals(new char[] {'a'}, new char[] {'b'}));
+        assertFalse(Arrays.equals(new long[] {1L << 40}, new long[] {0}));
+        assertFalse(Arrays.equals(new boolean[] {true}, new boolean[] {false}));
+
+        // Compared like floatToIntBits() and doubleToLongBits()
+        float otherNaN = Float.intBitsToFloat(0x7fc00001);
+        assertTrue(Arrays.equals(new float[] {Float.NaN}, new float[] {otherNaN}));
+        assertFalse(Arrays.equals(new float[] {0.0f}, new float[] {-0.0f}));
+        assertTrue(Arrays.equals(new double[] {Double.NaN, 1}, new double[] {-Double.NaN, 1}));
+        assertFalse(Arrays.equals(new double[] {0.0}, new double[] {-0.0}));
+    }
+
+    @Test
+    public void testStringEquals() {
+        String s = "hello";
+        String t = new String(new char[] {'h', 'e', 'l', 'l', 'o'});
+        assertTrue(s.equals(s));
+        assertTrue(s.equals(t));
+        assertFalse(s.equals(null));
+        assertFalse(s.equals(new StringBuilder(s)));
+        assertFalse(s.equals("hell"));
+        assertFalse(s.equals("hellO"));
+        // Substrings share the chars with an offset
+        assertTrue("xhellox".substring(1, 6).equals(s));
+        s.hashCode();
+        assertFalse(s.equals("jello"));
+        "jello".hashCode();
+        assertFalse(s.equals("jello"));
+        assertTrue("".equals(new String()));
+    }
+
+    @Test
+    public void testStringHashCode() {
+        String s = "xhellox".substring(1, 6);
+        int hash = 0;
+        for (char c : "hello".toCharArray()) {
+            hash = 31 * hash + c;
+        }
+        assertEquals(hash, s.hashCode());
+        assertEquals(hash, s.hashCode());
+        assertEquals(0, "".hashCode());
+        assertEquals(31 * 0xffff + 0x80, "\uffff\u0080".hashCode());
+    }
+
+    @Test
+    public void testStringIndexOf() {
+        String s = "xhellox".substring(1, 6);
+        assertEquals(0, s.indexOf('h'));
+        assertEquals(2, s.indexOf('l'));
+        assertEquals(-1, s.indexOf('x'));
+        assertEquals(-1, s.indexOf(-1));
+        assertEquals(3, s.indexOf('l', 3));
+        assertEquals(-1, s.indexOf('l', 4));
+        assertEquals(0, s.indexOf('h', -10));
+        assertEquals(-1, s.indexOf('o', 100));
+        assertEquals(1, "a\uffff".indexOf(0xffff));
+        String supplementary = "a" + new String(Character.toChars(0x1f600));
+        assertEquals(1, supplementary.indexOf(0x1f600));
+        assertEquals(1, supplementary.indexOf(0x1f600, 1));
+        assertEquals(-1, supplementary.indexOf(0x1f600, 2));
+    }
+
+    @Test
+    public void testBitOperations() {
+        int[] ints = {0, 1, -1, 0x80000000, 0x7fffffff, 0x12345678, 0x00f00000};
+        int[] bitCounts = {0, 1, 32, 1, 31, 13, 4};
+        int[] leadingZeros = {32, 31, 0, 0, 1, 3, 8};
+        int[] trailingZeros = {32, 0, 0, 31, 0, 3, 20};
+        for (int i = 0; i < ints.length; i++) {
+            assertEquals(bitCounts[i], Integer.bitCount(ints[i]));
+            assertEquals(leadingZeros[i], Integer.numberOfLeadingZeros(ints[i]));
+            assertEquals(trailingZeros[i], Integer.numberOfTrailingZeros(ints[i]));
+        }
+        assertEquals(0x78563412, Integer.reverseBytes(0x12345678));
+        assertEquals(0, Long.bitCount(0L));
+        assertEquals(64, Long.bitCount(-1L));
+        assertEquals(64, Long.numberOfLeadingZeros(0L));
+        assertEquals(31, Long.numberOfLeadingZeros(1L << 32));
+        assertEquals(64, Long.numberOfTrailingZeros(0L));
+        assertEquals(40, Long.numberOfTrailingZeros(1L << 40));
+        assertEquals(0x0807060504030201L, Long.reverseBytes(0x0102030405060708L));
+    }
+
+    @Test
+    public void testMinMax() {
+        assertEquals(-1, Math.min(-1, 1));
+        assertEquals(1, Math.max(-1, 1));
+        assertEquals(Long.MIN_VALUE, Math.min(Long.MIN_VALUE, 0L));
+        assertEquals(Long.MAX_VALUE, Math.max(Long.MAX_VALUE, 0L));
+        assertEquals(1.0f, Math.min(1.0f, 2.0f), 0);
+        assertEquals(2.0f, Math.max(1.0f, 2.0f), 0);
+        assertEquals(0x80000000, Float.floatToRawIntBits(Math.min(0.0f, -0.0f)));
+        assertEquals(0x80000000, Float.floatToRawIntBits(Math.min(-0.0f, 0.0f)));
+        assertEquals(0, Float.floatToRawIntBits(Math.max(0.0f, -0.0f)));
+        assertEquals(0, Float.floatToRawIntBits(Math.max(-0.0f, 0.0f)));
+        assertTrue(Float.isNaN(Math.min(Float.NaN, 1.0f)));
+        assertTrue(Float.isNaN(Math.max(1.0f, Float.NaN)));
+        assertEquals(-3.0, Math.min(-3.0, 2.0), 0);
+        assertEquals(2.0, Math.max(-3.0, 2.0), 0);
+        assertEquals(0x8000000000000000L, Double.doubleToRawLongBits(Math.min(0.0, -0.0)));
+        assertEquals(0L, Double.doubleToRawLongBits(Math.max(-0.0, 0.0)));
+        assertEquals(0x7ff8000000000000L, Double.doubleToRawLongBits(Math.min(Double.NaN, 1.0)));
+        assertEquals(0x7ff8000000000000L, Double.doubleToRawLongBits(Math.max(1.0, -Double.NaN)));
+    }
+
+    @Test
+    public void testFma() {
+        assertEquals(10.0, Math.fma(2.0, 3.0, 4.0), 0);
+        assertEquals(10.0f, Math.fma(2.0f, 3.0f, 4.0f), 0);
+        // (1 + u) * (1 - u) rounds to 1.0 unless fused
+        double u = Math.ulp(1.0);
+        assertEquals(-u * u, Math.fma(1.0 + u, 1.0 - u, -1.0), 0);
+        assertTrue(Double.isNaN(Math.fma(Double.NaN, 1.0, 1.0)));
+    }
+
+    @Test
+    public void testRawBits() {
+        assertEquals(0x3f800000, Float.floatToRawIntBits(1.0f));
+        assertEquals(1.0f, Float.intBitsToFloat(0x3f800000), 0);
+        assertEquals(0x7fc00001, Float.floatToRawIntBits(Float.intBitsToFloat(0x7fc00001)));
+        assertEquals(0x7fc00000, Float.floatToIntBits(Float.intBitsToFloat(0x7fc00001)));
+        assertEquals(0x80000000, Float.floatToIntBits(-0.0f));
+        assertEquals(0x3ff0000000000000L, Double.doubleToRawLongBits(1.0));
+        assertEquals(1.0, Double.longBitsToDouble(0x3ff0000000000000L), 0);
+        assertEquals(0x7ff8000000000001L, Double.doubleToRawLongBits(Double.longBitsToDouble(0x7ff8000000000001L)));
+        assertEquals(0x7ff8000000000000L, Double.doubleToLongBits(Double.longBitsToDouble(0x7ff8000000000001L)));
+        assertEquals(0x7ff8000000000000L, Double.doubleToLongBits(Double.longBitsToDouble(0xfff8000000000000L)));
+    }
+}
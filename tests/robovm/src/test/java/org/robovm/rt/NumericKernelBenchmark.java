@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+/**
+ * Times simple loops over primitive arrays: an int[] sum, a float[] dot 
+ * product, saxpy and a byte[] xor. Compare builds with and without 
+ * {@code -vectorize-loops} to see the effect of bounds check elimination, 
+ * loop versioning and the LLVM vectorizers.
+ */
+public class NumericKernelBenchmark extends Benchmark {
+    private static final int ITERATIONS = 10000;
+    private static final int LENGTH = 4096;
+
+    private static int sum(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    private static float dot(float[] a, float[] b) {
+        float sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    private static void saxpy(float a, float[] x, float[] y) {
+        for (int i = 0; i < y.length; i++) {
+            y[i] = a * x[i] + y[i];
+        }
+    }
+
+    private static void xor(byte[] data, byte[] key) {
+        for (int i = 0; i < data.length; i++) {
+            data[i] ^= key[i];
+        }
+    }
+
+    @Override
+    public void run() throws Exception {
+        int[] ints = new int[LENGTH];
+        float[] x = new float[LENGTH];
+        float[] y = new float[LENGTH];
+        byte[] data = new byte[LENGTH];
+        byte[] key = new byte[LENGTH];
+        for (int i = 0; i < LENGTH; i++) {
+            ints[i] = i;
+            x[i] = i;
+            y[i] = i * 0.5f;
+            key[i] = (byte) i;
+        }
+
+        // The results are reported to keep the loops from being optimized
+        // away.
+        long start = System.nanoTime();
+        long sum = 0;
+        for (int i = 0; i < ITERATIONS; i++) {
+            sum += sum(ints);
+        }
+        report("int[] sum (" + sum + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        start = System.nanoTime();
+        float f = 0;
+        for (int i = 0; i < ITERATIONS; i++) {
+            f += dot(x, y);
+        }
+        report("float[] dot product (" + f + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            saxpy(1.0001f, x, y);
+        }
+        report("float[] saxpy (" + y[100] + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            xor(data, key);
+        }
+        report("byte[] xor (" + data[100] + ")", (double) (System.nanoTime() - start) / ITERATIONS, "ns/call");
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+/**
+ * Measures the cost of heap allocating objects of different sizes. Small and
+ * medium objects are popped from the per-thread free lists by the inline 
+ * allocator. Large and finalizable objects go through the runtime and show
+ * what the fast path is compared against. The objects are linked into short
+ * chains so that escape analysis can't move them to the stack.
+ */
+public class ObjectAllocationBenchmark extends Benchmark {
+    private static final int ITERATIONS = 10000000;
+
+    static class Small {
+        Object next;
+    }
+
+    static class Medium {
+        long a, b, c, d, e, f, g, h;
+        Object next;
+    }
+
+    static class Large {
+        long a0, a1, a2, a3, a4, a5, a6, a7, a8, a9;
+        long b0, b1, b2, b3, b4, b5, b6, b7, b8, b9;
+        Object next;
+    }
+
+    static class Finalizable {
+        Object next;
+        @Override
+        protected void finalize() throws Throwable {
+        }
+    }
+
+    private static Object small(int n) {
+        Object o = null;
+        for (int i = 0; i < n; i++) {
+            Small s = new Small();
+            s.next = o;
+            o = (i & 0xff) == 0 ? null : s;
+        }
+        return o;
+    }
+
+    private static Object medium(int n) {
+        Object o = null;
+        for (int i = 0; i < n; i++) {
+            Medium m = new Medium();
+            m.next = o;
+            o = (i & 0xff) == 0 ? null : m;
+        }
+        return o;
+    }
+
+    private static Object large(int n) {
+        Object o = null;
+        for (int i = 0; i < n; i++) {
+            Large l = new Large();
+            l.next = o;
+            o = (i & 0xff) == 0 ? null : l;
+        }
+        return o;
+    }
+
+    private static Object finalizable(int n) {
+        Object o = null;
+        for (int i = 0; i < n; i++) {
+            Finalizable f = new Finalizable();
+            f.next = o;
+            o = (i & 0xff) == 0 ? null : f;
+        }
+        return o;
+    }
+
+    @Override
+    public void run() throws Exception {
+        long start = System.nanoTime();
+        small(ITERATIONS);
+        report("small", (double) (System.nanoTime() - start) / ITERATIONS, "ns/object");
+        start = System.nanoTime();
+        medium(ITERATIONS);
+        report("medium", (double) (System.nanoTime() - start) / ITERATIONS, "ns/object");
+        start = System.nanoTime();
+        large(ITERATIONS);
+        report("large", (double) (System.nanoTime() - start) / ITERATIONS, "ns/object");
+        // Finalizable objects are far more expensive. Don't fill the 
+        // finalizer queue with millions of them.
+        start = System.nanoTime();
+        finalizable(ITERATIONS / 100);
+        report("finalizable", (double) (System.nanoTime() - start) / (ITERATIONS / 100), "ns/object");
+    }
+}
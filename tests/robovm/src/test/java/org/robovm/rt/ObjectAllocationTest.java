@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.junit.Test;
+
+/**
+ * Tests the inline allocation fast path which hands out objects from the
+ * per-thread free lists and the classes which must bypass it.
+ */
+public class ObjectAllocationTest {
+
+    static class Small {
+        int a;
+    }
+
+    // Same size class as Small on most archs
+    static class SmallToo {
+        float a;
+        Object next;
+    }
+
+    static class Medium {
+        long a, b, c, d, e, f, g, h;
+        Object o;
+    }
+
+    static class Large {
+        long a0, a1, a2, a3, a4, a5, a6, a7, a8, a9;
+        long b0, b1, b2, b3, b4, b5, b6, b7, b8, b9;
+        Object o;
+    }
+
+    static abstract class Abstract {
+        static Abstract create() throws Exception {
+            return Abstract.class.newInstance();
+        }
+    }
+
+    @Test
+    public void testFieldsAreCleared() {
+        for (int i = 0; i < 100; i++) {
+            Small s = new Small();
+            assertEquals(0, s.a);
+            s.a = i + 1;
+            SmallToo t = new SmallToo();
+            assertEquals(0.0f, t.a, 0.0f);
+            assertNull(t.next);
+            t.a = i;
+            t.next = s;
+            Medium m = new Medium();
+            assertEquals(0, m.a + m.b + m.c + m.d + m.e + m.f + m.g + m.h);
+            assertNull(m.o);
+            m.h = i;
+            m.o = t;
+            Large l = new Large();
+            assertEquals(0, l.a0 + l.a9 + l.b0 + l.b9);
+            assertNull(l.o);
+            l.b9 = i;
+            l.o = m;
+        }
+    }
+
+    @Test
+    public void testClassOfSameSizeObjects() {
+        List<Object> objects = new ArrayList<Object>();
+        for (int i = 0; i < 100; i++) {
+            objects.add(new Small());
+            objects.add(new SmallToo());
+        }
+        for (int i = 0; i < objects.size(); i += 2) {
+            assertSame(Small.class, objects.get(i).getClass());
+            assertSame(SmallToo.class, objects.get(i + 1).getClass());
+        }
+    }
+
+    @Test
+    public void testObjectsSurviveGC() {
+        SmallToo head = null;
+        for (int i = 0; i < 1000; i++) {
+            SmallToo t = new SmallToo();
+            t.a = i;
+            t.next = head;
+            head = t;
+            if (i % 100 == 0) {
+                System.gc();
+            }
+        }
+        for (int i = 999; i >= 0; i--) {
+            assertEquals(i, (int) head.a);
+            head = (SmallToo) head.next;
+        }
+        assertNull(head);
+    }
+
+    @Test
+    public void testAllocationInThreads() throws Exception {
+        final int[] sums = new int[4];
+        Thread[] threads = new Thread[sums.length];
+        for (int i = 0; i < threads.length; i++) {
+            final int index = i;
+            threads[i] = new Thread() {
+                public void run() {
+                    List<Small> l = new ArrayList<Small>();
+                    for (int j = 0; j < 10000; j++) {
+                        Small s = new Small();
+                        s.a = 1;
+                        l.add(s);
+                        if (l.size() == 100) {
+                            for (Small t : l) {
+                                sums[index] += t.a;
+                            }
+                            l.clear();
+                        }
+                    }
+                }
+            };
+        }
+        for (Thread t : threads) {
+            t.start();
+        }
+        for (Thread t : threads) {
+            t.join();
+        }
+        for (int sum : sums) {
+            assertEquals(10000, sum);
+        }
+    }
+
+    @Test(expected = InstantiationException.class)
+    public void testAbstractClass() throws Exception {
+        Abstract.create();
+    }
+
+    @Test
+    public void testWeakReferenceSubclass() {
+        class Ref extends WeakReference<Object> {
+            int a;
+            Ref(Object o) {
+                super(o);
+            }
+        }
+        List<Ref> refs = new ArrayList<Ref>();
+        for (int i = 0; i < 100; i++) {
+            Ref r = new Ref(new Small());
+            assertEquals(0, r.a);
+            refs.add(r);
+        }
+        for (int i = 0; i < 10 && refs.get(refs.size() - 1).get() != null; i++) {
+            System.gc();
+        }
+        int cleared = 0;
+        for (Ref r : refs) {
+            if (r.get() == null) {
+                cleared++;
+            }
+        }
+        // Had the referent field been scanned conservatively none of the
+        // referents would ever be cleared.
+        assertTrue(cleared > 0);
+    }
+
+    static class Finalizable {
+        static volatile int finalized;
+        int a;
+        @Override
+        protected void finalize() throws Throwable {
+            finalized++;
+        }
+    }
+
+    @Test
+    public void testFinalizableClass() throws Exception {
+        for (int i = 0; i < 1000; i++) {
+            Finalizable f = new Finalizable();
+            assertEquals(0, f.a);
+            f.a = i;
+        }
+        for (int i = 0; i < 20 && Finalizable.finalized == 0; i++) {
+            System.gc();
+            System.runFinalization();
+            Thread.sleep(10);
+        }
+        assertTrue(Finalizable.finalized > 0);
+    }
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.util.Arrays;
+
+import org.junit.Test;
+
+/**
+ * Tests loops over arrays from which the compiler removes the null and
+ * bounds checks or, with -vectorize-loops, which it versions into a checked
+ * and an unchecked loop.
+ */
+public class RangeAnalysisTest {
+
+    private static int sum(int[] a) {
+        int sum = 0;
+        for (int i = 0; i < a.length; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    private static int sum(int[] a, int start, int end) {
+        int sum = 0;
+        for (int i = start; i < end; i++) {
+            sum += a[i];
+        }
+        return sum;
+    }
+
+    private static void add(float[] dst, float[] src) {
+        for (int i = 0; i < dst.length; i++) {
+            dst[i] += src[i];
+        }
+    }
+
+    private static void copy(byte[] dst, byte[] src, int n) {
+        for (int i = 0; i < n; i++) {
+            dst[i] = src[i];
+        }
+    }
+
+    private static int countPartial(int[] a, int[] log) {
+        int n = 0;
+        for (int i = 0; i < a.length; i++) {
+            log[0] = i;
+            n += a[i];
+        }
+        return n;
+    }
+
+    private static long sum(long[][] m) {
+        long sum = 0;
+        for (int i = 0; i < m.length; i++) {
+            long[] row = m[i];
+            for (int j = 0; j < row.length; j++) {
+                sum += row[j];
+            }
+        }
+        return sum;
+    }
+
+    private static Object last(Object[] a) {
+        Object last = null;
+        for (int i = 0; i < a.length; i++) {
+            a[i] = Integer.valueOf(i);
+            last = a[i];
+        }
+        return last;
+    }
+
+    @Test
+    public void testLoopOverLength() {
+        assertEquals(0, sum(new int[0]));
+        assertEquals(6, sum(new int[] {1, 2, 3}));
+        try {
+            sum(null);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+        }
+    }
+
+    @Test
+    public void testLoopWithStartAndEnd() {
+        int[] a = {1, 2, 3, 4, 5};
+        assertEquals(9, sum(a, 1, 4));
+        assertEquals(15, sum(a, 0, 5));
+        assertEquals(0, sum(a, 3, 3));
+        assertEquals(0, sum(a, 10, -1));
+        try {
+            sum(a, 2, 6);
+            fail("ArrayIndexOutOfBoundsException expected");
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        try {
+            sum(a, -1, 2);
+            fail("ArrayIndexOutOfBoundsException expected");
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        try {
+            sum(null, 0, 1);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+        }
+        assertEquals(0, sum(null, 0, 0));
+    }
+
+    @Test
+    public void testVersionedLoop() {
+        float[] dst = {1, 2, 3};
+        add(dst, new float[] {1, 1, 1, 1});
+        assertTrue(Arrays.equals(new float[] {2, 3, 4}, dst));
+        try {
+            add(dst, new float[] {1, 1});
+            fail("ArrayIndexOutOfBoundsException expected");
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        // The elements before the failing one must have been updated
+        assertTrue(Arrays.equals(new float[] {3, 4, 4}, dst));
+        try {
+            add(dst, null);
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+        }
+        add(new float[0], null);
+    }
+
+    @Test
+    public void testExceptionAtCorrectIteration() {
+        byte[] dst = new byte[10];
+        byte[] src = {1, 2, 3, 4, 5};
+        try {
+            copy(dst, src, 8);
+            fail("ArrayIndexOutOfBoundsException expected");
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        assertTrue(Arrays.equals(new byte[] {1, 2, 3, 4, 5, 0, 0, 0, 0, 0}, dst));
+
+        int[] log = new int[1];
+        try {
+            countPartial(new int[3], new int[0]);
+            fail("ArrayIndexOutOfBoundsException expected");
+        } catch (ArrayIndexOutOfBoundsException e) {
+        }
+        assertEquals(3, countPartial(new int[] {1, 1, 1}, log));
+        assertEquals(2, log[0]);
+    }
+
+    @Test
+    public void testNestedLoops() {
+        long[][] m = {{1, 2}, {}, {3, 4, 5}};
+        assertEquals(15, sum(m));
+        try {
+            sum(new long[][] {{1}, null});
+            fail("NullPointerException expected");
+        } catch (NullPointerException e) {
+        }
+    }
+
+    @Test
+    public void testObjectArray() {
+        assertEquals(Integer.valueOf(2), last(new Object[3]));
+        try {
+            last(new String[1]);
+            fail("ArrayStoreException expected");
+        } catch (ArrayStoreException e) {
+        }
+    }
+}
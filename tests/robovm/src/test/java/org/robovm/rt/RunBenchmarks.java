@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import java.lang.reflect.Modifier;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.Comparator;
+import java.util.List;
+
+/**
+ * Runs the {@link Benchmark}s available in the classpath. Compile the tests
+ * with this class as main class to run them. Benchmarks are run in name 
+ * order. Pass class names, simple or fully qualified, as arguments to only 
+ * run those benchmarks, e.g. {@code SelectorScalingBenchmark}.
+ */
+public class RunBenchmarks {
+
+    public static void main(String[] args) {
+        List<String> names = Arrays.asList(args);
+        List<Class<?>> classes = new ArrayList<>();
+        for (Class<?> cls : VM.listClasses(Benchmark.class, ClassLoader.getSystemClassLoader())) {
+            if (Modifier.isAbstract(cls.getModifiers())) {
+                continue;
+            }
+            if (names.isEmpty() || names.contains(cls.getName()) || names.contains(cls.getSimpleName())) {
+                classes.add(cls);
+            }
+        }
+        Collections.sort(classes, new Comparator<Class<?>>() {
+            public int compare(Class<?> o1, Class<?> o2) {
+                return o1.getName().compareTo(o2.getName());
+            }
+        });
+
+        int failures = 0;
+        for (Class<?> cls : classes) {
+            try {
+                Benchmark benchmark = (Benchmark) cls.newInstance();
+                benchmark.setReporting(false);
+                for (int i = 0; i < benchmark.getWarmupRuns(); i++) {
+                    benchmark.run();
+                }
+                benchmark.setReporting(true);
+                benchmark.run();
+            } catch (Throwable t) {
+                System.out.println(cls.getSimpleName() + " failed:");
+                t.printStackTrace(System.out);
+                failures++;
+            }
+        }
+        System.out.flush();
+        System.exit(failures == 0 ? 0 : 1);
+    }
+    
+}
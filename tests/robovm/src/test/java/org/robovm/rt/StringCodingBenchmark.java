@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import java.util.Random;
+
+/**
+ * Measures {@link String#getBytes(String)} and 
+ * {@link String#String(byte[], String)} throughput for UTF-8, US-ASCII and
+ * ISO-8859-1 on 64k character strings with different amounts of non-ASCII
+ * text.
+ */
+public class StringCodingBenchmark extends Benchmark {
+    private static final int LENGTH = 64 * 1024;
+    private static final int ITERATIONS = 2000;
+
+    @Override
+    public void run() throws Exception {
+        Random random = new Random(42);
+        // Something like JSON: mostly ASCII with the occasional accented letter.
+        benchmark("ASCII-heavy", StringCodingTest.randomString(random, LENGTH, 1), "UTF-8");
+        // Something like a page of Cyrillic, CJK or emoji heavy text.
+        benchmark("mixed-script", StringCodingTest.randomString(random, LENGTH, 60), "UTF-8");
+        benchmark("ASCII", StringCodingTest.randomString(random, LENGTH, 0), "US-ASCII");
+        benchmark("ASCII", StringCodingTest.randomString(random, LENGTH, 0), "ISO-8859-1");
+    }
+
+    private void benchmark(String name, String s, String charsetName) throws Exception {
+        byte[] bytes = s.getBytes(charsetName);
+        long start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            s.getBytes(charsetName);
+        }
+        long encode = System.nanoTime() - start;
+        start = System.nanoTime();
+        for (int i = 0; i < ITERATIONS; i++) {
+            new String(bytes, charsetName);
+        }
+        long decode = System.nanoTime() - start;
+        report(name + " " + charsetName + " encode", mbPerSecond(bytes.length * (long) ITERATIONS, encode), "MB/s");
+        report(name + " " + charsetName + " decode", mbPerSecond(bytes.length * (long) ITERATIONS, decode), "MB/s");
+    }
+}
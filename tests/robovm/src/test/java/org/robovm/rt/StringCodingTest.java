@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt;
+
+import static org.junit.Assert.*;
+
+import java.util.Arrays;
+import java.util.Random;
+
+import org.junit.Test;
+
+/**
+ * Tests the native String encoders and decoders with inputs around the
+ * vector widths used internally.
+ */
+public class StringCodingTest {
+
+    static String randomString(Random random, int length, int nonAsciiPercent) {
+        StringBuilder sb = new StringBuilder();
+        while (sb.length() < length) {
+            int r = random.nextInt(100);
+            if (r >= nonAsciiPercent) {
+                sb.append((char) random.nextInt(0x80));
+            } else if (r % 4 == 0) {
+                sb.append((char) (0x80 + random.nextInt(0x780)));
+            } else if (r % 4 == 1) {
+                sb.appendCodePoint(0x10000 + random.nextInt(0x100000));
+            } else {
+                char c = (char) (0x800 + random.nextInt(0xf800 - 0x800));
+                sb.append(Character.isSurrogate(c) ? 'x' : c);
+            }
+        }
+        return sb.toString();
+    }
+
+    @Test
+    public void testUtf8RoundTrip() throws Exception {
+        Random random = new Random(42);
+        for (int length = 0; length < 200; length++) {
+            for (int nonAscii : new int[] {0, 1, 10, 50, 100}) {
+                String s = randomString(random, length, nonAscii);
+                byte[] bytes = s.getBytes("UTF-8");
+                assertArrayEquals(s, bytes, s.getBytes(java.nio.charset.StandardCharsets.UTF_8));
+                assertEquals(s, new String(bytes, "UTF-8"));
+            }
+        }
+    }
+
+    @Test
+    public void testUtf8EncodeUnpairedSurrogates() throws Exception {
+        for (int prefix = 0; prefix < 40; prefix++) {
+            char[] pad = new char[prefix];
+            Arrays.fill(pad, 'a');
+            String p = new String(pad);
+            assertArrayEquals((p + "?b").getBytes("UTF-8"), (p + "\ud800b").getBytes("UTF-8"));
+            assertArrayEquals((p + "?").getBytes("UTF-8"), (p + "\udc00").getBytes("UTF-8"));
+            assertArrayEquals((p + "?").getBytes("UTF-8"), (p + "\ud800").getBytes("UTF-8"));
+        }
+    }
+
+    private static void assertDecodes(String expected, int... bytes) throws Exception {
+        for (int prefix = 0; prefix < 40; prefix += 13) {
+            byte[] b = new byte[prefix + bytes.length];
+            Arrays.fill(b, 0, prefix, (byte) 'a');
+            for (int i = 0; i < bytes.length; i++) {
+                b[prefix + i] = (byte) bytes[i];
+            }
+            char[] pad = new char[prefix];
+            Arrays.fill(pad, 'a');
+            assertEquals(new String(pad) + expected, new String(b, "UTF-8"));
+        }
+    }
+
+    @Test
+    public void testUtf8DecodeMalformed() throws Exception {
+        assertDecodes("\ufffd", 0x80);
+        assertDecodes("\ufffd", 0xff);
+        // Truncated sequences.
+        assertDecodes("\ufffd", 0xc3);
+        assertDecodes("\ufffd\ufffd", 0xe2, 0x82);
+        // The byte ending a malformed sequence is decoded on its own.
+        assertDecodes("\ufffdA", 0xc3, 'A');
+        assertDecodes("\ufffdA", 0xe2, 0x82, 'A');
+        // Surrogates can't be encoded using 4 bytes.
+        assertDecodes("\ufffd", 0xf0, 0x8d, 0xa0, 0x80);
+        // Above U+10FFFF.
+        assertDecodes("\ufffd", 0xf4, 0x90, 0x80, 0x80);
+        // Supplementary characters.
+        assertDecodes("\ud83d\ude00", 0xf0, 0x9f, 0x98, 0x80);
+    }
+
+    @Test
+    public void testAsciiAndLatin1() throws Exception {
+        Random random = new Random(42);
+        for (int length = 0; length < 100; length++) {
+            char[] chars = new char[length];
+            byte[] bytes = new byte[length];
+            for (int i = 0; i < length; i++) {
+                chars[i] = (char) random.nextInt(random.nextBoolean() ? 0x80 : 0x200);
+                bytes[i] = (byte) random.nextInt(0x100);
+            }
+            String s = new String(chars);
+            byte[] ascii = s.getBytes("US-ASCII");
+            byte[] latin1 = s.getBytes("ISO-8859-1");
+            String asciiDecoded = new String(bytes, "US-ASCII");
+            String latin1Decoded = new String(bytes, "ISO-8859-1");
+            for (int i = 0; i < length; i++) {
+                assertEquals(chars[i] < 0x80 ? (byte) chars[i] : (byte) '?', ascii[i]);
+                assertEquals(chars[i] < 0x100 ? (byte) chars[i] : (byte) '?', latin1[i]);
+                assertEquals(bytes[i] >= 0 ? (char) bytes[i] : '\ufffd', asciiDecoded.charAt(i));
+                assertEquals((char) (bytes[i] & 0xff), latin1Decoded.charAt(i));
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.SocketAddress;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+
+import org.robovm.rt.Benchmark;
+
+/**
+ * Measures how many loopback connections per second can be connected, 
+ * accepted, switched to non-blocking and closed. This covers the sockets 
+ * created and accepted with close-on-exec set and the single ioctl used by
+ * {@code configureBlocking()}.
+ */
+public class AcceptBenchmark extends Benchmark {
+    private static final int CONNECTIONS = 20000;
+
+    @Override
+    public void run() throws Exception {
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        try {
+            ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0), 1024);
+            SocketAddress address = ssc.socket().getLocalSocketAddress();
+            long start = System.nanoTime();
+            for (int i = 0; i < CONNECTIONS; i++) {
+                SocketChannel client = SocketChannel.open(address);
+                SocketChannel server = ssc.accept();
+                server.configureBlocking(false);
+                server.close();
+                client.close();
+            }
+            report("connect/accept/close", perSecond(CONNECTIONS, System.nanoTime() - start), "connections/s");
+        } finally {
+            ssc.close();
+        }
+    }
+}
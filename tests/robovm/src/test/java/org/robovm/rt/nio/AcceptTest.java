@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.io.FileDescriptor;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+
+import libcore.io.Libcore;
+import libcore.io.OsConstants;
+
+import org.junit.Assume;
+import org.junit.Test;
+
+/**
+ * Tests that sockets are accepted and created with close-on-exec set.
+ */
+public class AcceptTest {
+
+    private static boolean isCloseOnExec(FileDescriptor fd) throws Exception {
+        return (Libcore.os.fcntlVoid(fd, OsConstants.F_GETFD) & OsConstants.FD_CLOEXEC) != 0;
+    }
+
+    @Test
+    public void testAcceptedSocket() throws Exception {
+        Assume.assumeTrue(OsConstants.SOCK_CLOEXEC != 0);
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        ssc.socket().setSoTimeout(10000);
+        SocketChannel client = SocketChannel.open(ssc.socket().getLocalSocketAddress());
+        SocketChannel server = ssc.socket().accept().getChannel();
+
+        assertTrue(isCloseOnExec(client.socket().getFileDescriptor$()));
+        assertTrue(isCloseOnExec(server.socket().getFileDescriptor$()));
+        // Accepted channels are blocking and the accept timeout isn't inherited.
+        assertTrue(server.isBlocking());
+        assertEquals(0, server.socket().getSoTimeout());
+        server.configureBlocking(false);
+        assertEquals(0, server.read(ByteBuffer.allocate(1)));
+
+        client.close();
+        server.close();
+        ssc.close();
+    }
+}
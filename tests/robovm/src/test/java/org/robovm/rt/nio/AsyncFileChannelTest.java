@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.io.File;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+
+import libcore.io.AsyncFileChannel;
+import libcore.io.ErrnoException;
+import libcore.io.IoUring;
+import libcore.io.Libcore;
+import libcore.io.OsConstants;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests {@link AsyncFileChannel} with and without io_uring on tmpfs files
+ * and loopback sockets.
+ */
+public class AsyncFileChannelTest {
+    private static final String URING_PROPERTY = "robovm.io.uring";
+
+    private File file;
+
+    @Before
+    public void setUp() throws Exception {
+        // Prefer tmpfs.
+        File dir = new File("/dev/shm");
+        if (!dir.isDirectory()) {
+            dir = new File(System.getProperty("java.io.tmpdir"));
+        }
+        file = File.createTempFile("AsyncFileChannelTest", ".dat", dir);
+    }
+
+    @After
+    public void tearDown() throws Exception {
+        file.delete();
+        System.clearProperty(URING_PROPERTY);
+    }
+
+    private AsyncFileChannel open(boolean uring) throws ErrnoException {
+        System.setProperty(URING_PROPERTY, String.valueOf(uring));
+        AsyncFileChannel channel = AsyncFileChannel.open(
+                Libcore.os.open(file.getAbsolutePath(), OsConstants.O_RDWR, 0));
+        assertEquals(uring && IoUring.isSupported(), channel.usesIoUring());
+        return channel;
+    }
+
+    private void testReadWrite(boolean uring, boolean direct) throws Exception {
+        AsyncFileChannel channel = open(uring);
+        int chunks = 100;
+        int chunkSize = 4096;
+        List<Future<Integer>> writes = new ArrayList<>();
+        for (int i = 0; i < chunks; i++) {
+            ByteBuffer b = direct ? ByteBuffer.allocateDirect(chunkSize) : ByteBuffer.allocate(chunkSize);
+            while (b.hasRemaining()) {
+                b.put((byte) i);
+            }
+            b.flip();
+            // Write the chunks in reverse order.
+            writes.add(channel.write(b, (chunks - 1 - i) * (long) chunkSize));
+        }
+        for (Future<Integer> f : writes) {
+            assertEquals(chunkSize, (int) f.get(10, TimeUnit.SECONDS));
+        }
+        assertEquals(chunks * (long) chunkSize, file.length());
+
+        List<ByteBuffer> buffers = new ArrayList<>();
+        List<Future<Integer>> reads = new ArrayList<>();
+        for (int i = 0; i < chunks; i++) {
+            ByteBuffer b = direct ? ByteBuffer.allocateDirect(chunkSize) : ByteBuffer.allocate(chunkSize);
+            buffers.add(b);
+            reads.add(channel.read(b, i * (long) chunkSize));
+        }
+        for (int i = 0; i < chunks; i++) {
+            assertEquals(chunkSize, (int) reads.get(i).get(10, TimeUnit.SECONDS));
+            ByteBuffer b = buffers.get(i);
+            assertEquals(chunkSize, b.position());
+            b.flip();
+            while (b.hasRemaining()) {
+                assertEquals((byte) (chunks - 1 - i), b.get());
+            }
+        }
+
+        // Reading at EOF.
+        assertEquals(-1, (int) channel.read(ByteBuffer.allocate(1), chunks * (long) chunkSize).get());
+        channel.close();
+        assertFalse(channel.isOpen());
+        try {
+            channel.read(ByteBuffer.allocate(1), 0).get();
+            fail();
+        } catch (ExecutionException expected) {
+        }
+    }
+
+    @Test
+    public void testReadWriteIoUringDirect() throws Exception {
+        testReadWrite(true, true);
+    }
+
+    @Test
+    public void testReadWriteIoUringHeap() throws Exception {
+        testReadWrite(true, false);
+    }
+
+    @Test
+    public void testReadWriteThreadPoolDirect() throws Exception {
+        testReadWrite(false, true);
+    }
+
+    @Test
+    public void testReadWriteThreadPoolHeap() throws Exception {
+        testReadWrite(false, false);
+    }
+
+    @Test
+    public void testErrno() throws Exception {
+        for (boolean uring : new boolean[] {true, false}) {
+            System.setProperty(URING_PROPERTY, String.valueOf(uring));
+            AsyncFileChannel channel = AsyncFileChannel.open(
+                    Libcore.os.open(file.getAbsolutePath(), OsConstants.O_RDONLY, 0));
+            try {
+                channel.write(ByteBuffer.allocate(1), 0).get();
+                fail();
+            } catch (ExecutionException e) {
+                assertEquals(OsConstants.EBADF, ((ErrnoException) e.getCause()).errno);
+            }
+            channel.close();
+        }
+    }
+
+    private void testSocket(boolean uring) throws Exception {
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        SocketChannel client = SocketChannel.open(ssc.socket().getLocalSocketAddress());
+        SocketChannel server = ssc.accept();
+
+        System.setProperty(URING_PROPERTY, String.valueOf(uring));
+        AsyncFileChannel channel = AsyncFileChannel.open(Libcore.os.dup(server.socket().getFileDescriptor$()));
+        ByteBuffer in = ByteBuffer.allocateDirect(16);
+        Future<Integer> read = channel.read(in, -1);
+        Thread.sleep(100);
+        assertFalse(read.isDone());
+
+        client.write(ByteBuffer.wrap(new byte[] {1, 2, 3}));
+        assertEquals(3, (int) read.get(10, TimeUnit.SECONDS));
+        assertEquals(3, in.position());
+        assertEquals(3, in.get(2));
+
+        ByteBuffer out = ByteBuffer.wrap(new byte[] {4, 5});
+        assertEquals(2, (int) channel.write(out, -1).get(10, TimeUnit.SECONDS));
+        ByteBuffer b = ByteBuffer.allocate(2);
+        while (b.hasRemaining()) {
+            client.read(b);
+        }
+        assertEquals(5, b.get(1));
+
+        channel.close();
+        client.close();
+        server.close();
+        ssc.close();
+    }
+
+    @Test
+    public void testSocketIoUring() throws Exception {
+        testSocket(true);
+    }
+
+    @Test
+    public void testSocketThreadPool() throws Exception {
+        testSocket(false);
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+import org.robovm.rt.Benchmark;
+
+/**
+ * Measures bulk {@code int[]} get and put through an {@link java.nio.IntBuffer}
+ * view of a direct {@link ByteBuffer} in native and swapped byte order.
+ */
+public class ByteOrderBulkBenchmark extends Benchmark {
+    private static final int ITERATIONS = 2000;
+
+    @Override
+    public void run() throws Exception {
+        int[] ints = new int[64 * 1024];
+        for (ByteOrder order : new ByteOrder[] {ByteOrder.BIG_ENDIAN, ByteOrder.LITTLE_ENDIAN}) {
+            ByteBuffer b = ByteBuffer.allocateDirect(ints.length * 4).order(order);
+            long start = System.nanoTime();
+            for (int i = 0; i < ITERATIONS; i++) {
+                b.clear();
+                b.asIntBuffer().get(ints);
+            }
+            long get = System.nanoTime() - start;
+            start = System.nanoTime();
+            for (int i = 0; i < ITERATIONS; i++) {
+                b.clear();
+                b.asIntBuffer().put(ints);
+            }
+            long put = System.nanoTime() - start;
+            String name = order + (order == ByteOrder.nativeOrder() ? " (native)" : "");
+            report(name + " get(int[])", mbPerSecond(b.capacity() * (long) ITERATIONS, get), "MB/s");
+            report(name + " put(int[])", mbPerSecond(b.capacity() * (long) ITERATIONS, put), "MB/s");
+        }
+    }
+}
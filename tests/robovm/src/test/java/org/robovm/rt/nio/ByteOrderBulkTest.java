@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.Random;
+
+import org.junit.Test;
+
+/**
+ * Tests bulk gets and puts of shorts, ints and longs on direct
+ * {@link ByteBuffer}s in both byte orders with counts and offsets around
+ * the vector widths used by the native byte swapping code.
+ */
+public class ByteOrderBulkTest {
+    private static final ByteOrder[] ORDERS = {ByteOrder.BIG_ENDIAN, ByteOrder.LITTLE_ENDIAN};
+
+    private static ByteBuffer randomDirect(Random random, int capacity, ByteOrder order) {
+        byte[] bytes = new byte[capacity];
+        random.nextBytes(bytes);
+        ByteBuffer b = ByteBuffer.allocateDirect(capacity).order(order);
+        b.put(bytes).clear();
+        return b;
+    }
+
+    @Test
+    public void testShorts() {
+        Random random = new Random(42);
+        for (ByteOrder order : ORDERS) {
+            for (int count = 0; count < 70; count++) {
+                for (int offset = 0; offset < 3; offset++) {
+                    ByteBuffer b = randomDirect(random, offset + count * 2, order);
+                    b.position(offset);
+                    short[] values = new short[count];
+                    b.asShortBuffer().get(values);
+                    char[] chars = new char[count];
+                    b.asCharBuffer().get(chars);
+                    for (int i = 0; i < count; i++) {
+                        assertEquals(b.getShort(offset + i * 2), values[i]);
+                        assertEquals(b.getChar(offset + i * 2), chars[i]);
+                    }
+                    ByteBuffer c = ByteBuffer.allocateDirect(offset + count * 2).order(order);
+                    c.position(offset);
+                    c.asShortBuffer().put(values);
+                    c.position(offset);
+                    assertEquals(b, c);
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testInts() {
+        Random random = new Random(42);
+        for (ByteOrder order : ORDERS) {
+            for (int count = 0; count < 40; count++) {
+                for (int offset = 0; offset < 5; offset++) {
+                    ByteBuffer b = randomDirect(random, offset + count * 4, order);
+                    b.position(offset);
+                    int[] values = new int[count];
+                    b.asIntBuffer().get(values);
+                    float[] floats = new float[count];
+                    b.asFloatBuffer().get(floats);
+                    for (int i = 0; i < count; i++) {
+                        assertEquals(b.getInt(offset + i * 4), values[i]);
+                        assertEquals(Float.floatToRawIntBits(b.getFloat(offset + i * 4)),
+                                Float.floatToRawIntBits(floats[i]));
+                    }
+                    ByteBuffer c = ByteBuffer.allocateDirect(offset + count * 4).order(order);
+                    c.position(offset);
+                    c.asIntBuffer().put(values);
+                    c.position(offset);
+                    assertEquals(b, c);
+                }
+            }
+        }
+    }
+
+    @Test
+    public void testLongs() {
+        Random random = new Random(42);
+        for (ByteOrder order : ORDERS) {
+            for (int count = 0; count < 20; count++) {
+                for (int offset = 0; offset < 9; offset++) {
+                    ByteBuffer b = randomDirect(random, offset + count * 8, order);
+                    b.position(offset);
+                    long[] values = new long[count];
+                    b.asLongBuffer().get(values);
+                    double[] doubles = new double[count];
+                    b.asDoubleBuffer().get(doubles);
+                    for (int i = 0; i < count; i++) {
+                        assertEquals(b.getLong(offset + i * 8), values[i]);
+                        assertEquals(Double.doubleToRawLongBits(b.getDouble(offset + i * 8)),
+                                Double.doubleToRawLongBits(doubles[i]));
+                    }
+                    ByteBuffer c = ByteBuffer.allocateDirect(offset + count * 8).order(order);
+                    c.position(offset);
+                    c.asLongBuffer().put(values);
+                    c.position(offset);
+                    assertEquals(b, c);
+                }
+            }
+        }
+    }
+}
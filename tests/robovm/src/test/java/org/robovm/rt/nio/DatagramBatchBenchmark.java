@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.NioUtils;
+import java.nio.channels.DatagramChannel;
+
+import org.robovm.rt.Benchmark;
+
+/**
+ * Compares the datagram rate over loopback of the batched receive and send
+ * methods in {@link NioUtils} against one datagram per call.
+ */
+public class DatagramBatchBenchmark extends Benchmark {
+    private static final int DATAGRAMS = 1000000;
+    private static final int DATAGRAM_SIZE = 64;
+
+    @Override
+    public void run() throws Exception {
+        DatagramChannel receiver = DatagramChannel.open();
+        DatagramChannel sender = DatagramChannel.open();
+        try {
+            receiver.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+            sender.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+            InetSocketAddress receiverAddress = (InetSocketAddress) receiver.socket().getLocalSocketAddress();
+            for (int batchSize : new int[] {8, 32, 64}) {
+                report("batch size " + batchSize + ", recvfrom/sendto",
+                        benchmark(sender, receiver, receiverAddress, false, batchSize), "datagrams/s");
+                report("batch size " + batchSize + ", recvmmsg/sendmmsg",
+                        benchmark(sender, receiver, receiverAddress, true, batchSize), "datagrams/s");
+            }
+        } finally {
+            receiver.close();
+            sender.close();
+        }
+    }
+
+    private static ByteBuffer[] buffers(int count) {
+        ByteBuffer[] buffers = new ByteBuffer[count];
+        for (int i = 0; i < count; i++) {
+            buffers[i] = ByteBuffer.allocateDirect(DATAGRAM_SIZE);
+        }
+        return buffers;
+    }
+
+    private static double benchmark(DatagramChannel sender, DatagramChannel receiver, 
+            InetSocketAddress receiverAddress, boolean batched, int batchSize) throws Exception {
+        
+        ByteBuffer[] out = buffers(batchSize);
+        ByteBuffer[] in = buffers(batchSize);
+        InetSocketAddress[] targets = new InetSocketAddress[batchSize];
+        for (int i = 0; i < batchSize; i++) {
+            targets[i] = receiverAddress;
+        }
+        long start = System.nanoTime();
+        for (int n = 0; n < DATAGRAMS; n += batchSize) {
+            for (ByteBuffer b : out) {
+                b.clear();
+            }
+            if (batched) {
+                NioUtils.send(sender, out, targets);
+            } else {
+                for (ByteBuffer b : out) {
+                    sender.send(b, receiverAddress);
+                }
+            }
+            int received = 0;
+            while (received < batchSize) {
+                for (ByteBuffer b : in) {
+                    b.clear();
+                }
+                if (batched) {
+                    received += NioUtils.receive(receiver, in, null);
+                } else {
+                    receiver.receive(in[received++]);
+                }
+            }
+        }
+        return perSecond(DATAGRAMS, System.nanoTime() - start);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.NioUtils;
+import java.nio.channels.DatagramChannel;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+/**
+ * Tests the batched datagram receive and send methods in {@link NioUtils}.
+ */
+public class DatagramBatchTest {
+    private DatagramChannel receiver;
+    private DatagramChannel sender;
+    private InetSocketAddress receiverAddress;
+
+    @Before
+    public void setUp() throws Exception {
+        receiver = DatagramChannel.open();
+        receiver.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        receiverAddress = (InetSocketAddress) receiver.socket().getLocalSocketAddress();
+        sender = DatagramChannel.open();
+        sender.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+    }
+
+    @After
+    public void tearDown() throws Exception {
+        receiver.close();
+        sender.close();
+    }
+
+    private static ByteBuffer[] buffers(int count, int size, boolean direct) {
+        ByteBuffer[] buffers = new ByteBuffer[count];
+        for (int i = 0; i < count; i++) {
+            buffers[i] = direct ? ByteBuffer.allocateDirect(size) : ByteBuffer.allocate(size);
+        }
+        return buffers;
+    }
+
+    private void testSendReceive(boolean direct) throws Exception {
+        ByteBuffer[] out = buffers(10, 16, direct);
+        InetSocketAddress[] targets = new InetSocketAddress[out.length];
+        for (int i = 0; i < out.length; i++) {
+            // Datagram i is i + 1 bytes long and filled with i.
+            for (int j = 0; j <= i; j++) {
+                out[i].put((byte) i);
+            }
+            out[i].flip();
+            targets[i] = receiverAddress;
+        }
+        assertEquals(out.length, NioUtils.send(sender, out, targets));
+        for (ByteBuffer b : out) {
+            assertFalse(b.hasRemaining());
+        }
+
+        ByteBuffer[] in = buffers(out.length, 16, direct);
+        InetSocketAddress[] sources = new InetSocketAddress[in.length];
+        int received = 0;
+        while (received < in.length) {
+            ByteBuffer[] remaining = new ByteBuffer[in.length - received];
+            System.arraycopy(in, received, remaining, 0, remaining.length);
+            InetSocketAddress[] remainingSources = new InetSocketAddress[remaining.length];
+            int count = NioUtils.receive(receiver, remaining, remainingSources);
+            assertTrue(count > 0);
+            System.arraycopy(remainingSources, 0, sources, received, count);
+            received += count;
+        }
+        for (int i = 0; i < in.length; i++) {
+            in[i].flip();
+            assertEquals(i + 1, in[i].remaining());
+            while (in[i].hasRemaining()) {
+                assertEquals(i, in[i].get());
+            }
+            assertEquals(sender.socket().getLocalSocketAddress(), sources[i]);
+        }
+    }
+
+    @Test
+    public void testSendReceiveDirect() throws Exception {
+        testSendReceive(true);
+    }
+
+    @Test
+    public void testSendReceiveHeap() throws Exception {
+        testSendReceive(false);
+    }
+
+    @Test
+    public void testReceiveNonBlockingNothingAvailable() throws Exception {
+        receiver.configureBlocking(false);
+        assertEquals(0, NioUtils.receive(receiver, buffers(4, 16, true), null));
+    }
+
+    @Test
+    public void testSendConnected() throws Exception {
+        sender.connect(receiverAddress);
+        ByteBuffer[] out = buffers(2, 4, true);
+        assertEquals(2, NioUtils.send(sender, out, null));
+        ByteBuffer in = ByteBuffer.allocate(8);
+        receiver.receive(in);
+        assertEquals(4, in.position());
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import java.io.IOException;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.channels.Pipe;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.util.ArrayList;
+import java.util.List;
+
+import org.robovm.rt.Benchmark;
+
+/**
+ * Measures how the cost of a select() with a single ready channel scales
+ * with the number of idle channels registered with the epoll and poll 
+ * {@link Selector} backends. Needs a high fd limit ({@code ulimit -n}) to 
+ * reach the larger counts. Stops early and reports the number actually 
+ * connected if it runs out of fds.
+ */
+public class SelectorScalingBenchmark extends Benchmark {
+    private static final String EPOLL_PROPERTY = "robovm.nio.epoll";
+    private static final int[] IDLE_COUNTS = {1000, 5000, 10000, 25000, 50000};
+    private static final int ITERATIONS = 1000;
+
+    private final List<java.nio.channels.Channel> channels = new ArrayList<>();
+
+    @Override
+    public int getWarmupRuns() {
+        // Each run opens up to 100000 sockets.
+        return 0;
+    }
+
+    @Override
+    public void run() throws Exception {
+        try {
+            for (int idle : IDLE_COUNTS) {
+                benchmark(true, idle);
+                benchmark(false, idle);
+            }
+        } finally {
+            System.clearProperty(EPOLL_PROPERTY);
+        }
+    }
+
+    /**
+     * Connects up to {@code count} socket pairs over the loopback interface
+     * and registers the client ends for reading. Returns the number of pairs
+     * actually connected which may be lower if the process runs out of fds.
+     */
+    private int connectIdleSockets(Selector selector, ServerSocketChannel server, int count) throws IOException {
+        for (int i = 0; i < count; i++) {
+            try {
+                SocketChannel client = SocketChannel.open(server.socket().getLocalSocketAddress());
+                channels.add(client);
+                channels.add(server.accept());
+                client.configureBlocking(false);
+                client.register(selector, SelectionKey.OP_READ);
+            } catch (IOException e) {
+                // Most likely EMFILE.
+                return i;
+            }
+        }
+        return count;
+    }
+
+    private void benchmark(boolean epoll, int idle) throws IOException {
+        try {
+            System.setProperty(EPOLL_PROPERTY, String.valueOf(epoll));
+            Selector selector = Selector.open();
+            channels.add(selector);
+            ServerSocketChannel server = ServerSocketChannel.open();
+            channels.add(server);
+            server.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0), idle);
+            int connected = connectIdleSockets(selector, server, idle);
+
+            Pipe active = Pipe.open();
+            channels.add(active.source());
+            channels.add(active.sink());
+            active.source().configureBlocking(false);
+            active.source().register(selector, SelectionKey.OP_READ);
+            ByteBuffer one = ByteBuffer.allocate(1);
+            long start = System.nanoTime();
+            for (int i = 0; i < ITERATIONS; i++) {
+                one.clear();
+                active.sink().write(one);
+                selector.select();
+                selector.selectedKeys().clear();
+                one.clear();
+                active.source().read(one);
+            }
+            long duration = System.nanoTime() - start;
+            report((epoll ? "epoll, " : "poll, ") + connected + " idle sockets", 
+                    (double) duration / ITERATIONS, "ns/select");
+        } finally {
+            for (java.nio.channels.Channel c : channels) {
+                c.close();
+            }
+            channels.clear();
+        }
+    }
+}
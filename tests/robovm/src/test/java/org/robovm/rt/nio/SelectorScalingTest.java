@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.io.FileDescriptor;
+import java.io.IOException;
+import java.lang.reflect.Method;
+import java.nio.ByteBuffer;
+import java.nio.SelectorProviderImpl;
+import java.nio.channels.Pipe;
+import java.nio.channels.SelectionKey;
+import java.nio.channels.Selector;
+import java.nio.channels.spi.SelectorProvider;
+import java.util.ArrayList;
+import java.util.List;
+
+import libcore.io.Libcore;
+import libcore.io.OsConstants;
+
+import org.junit.After;
+import org.junit.Assume;
+import org.junit.Test;
+
+/**
+ * Tests the epoll and poll {@link Selector} backends with many registered
+ * channels.
+ */
+public class SelectorScalingTest {
+    private static final String EPOLL_PROPERTY = "robovm.nio.epoll";
+
+    private final List<java.nio.channels.Channel> channels = new ArrayList<>();
+
+    @After
+    public void tearDown() throws Exception {
+        for (java.nio.channels.Channel c : channels) {
+            c.close();
+        }
+        channels.clear();
+        System.clearProperty(EPOLL_PROPERTY);
+    }
+
+    private Selector openSelector(boolean epoll) throws IOException {
+        System.setProperty(EPOLL_PROPERTY, String.valueOf(epoll));
+        Selector selector = Selector.open();
+        channels.add(selector);
+        return selector;
+    }
+
+    private Pipe openPipe() throws IOException {
+        Pipe pipe = Pipe.open();
+        channels.add(pipe.source());
+        channels.add(pipe.sink());
+        pipe.source().configureBlocking(false);
+        return pipe;
+    }
+
+    private void testReadiness(boolean epoll) throws Exception {
+        Selector selector = openSelector(epoll);
+        List<Pipe> pipes = new ArrayList<>();
+        for (int i = 0; i < 200; i++) {
+            Pipe pipe = openPipe();
+            pipe.source().register(selector, SelectionKey.OP_READ, i);
+            pipes.add(pipe);
+        }
+        assertEquals(0, selector.selectNow());
+
+        pipes.get(123).sink().write(ByteBuffer.wrap(new byte[] {1}));
+        assertEquals(1, selector.select(1000));
+        SelectionKey key = selector.selectedKeys().iterator().next();
+        assertEquals(123, key.attachment());
+        assertTrue(key.isReadable());
+        selector.selectedKeys().clear();
+
+        // No longer interested in the ready channel.
+        key.interestOps(0);
+        assertEquals(0, selector.selectNow());
+        key.interestOps(SelectionKey.OP_READ);
+        assertEquals(1, selector.selectNow());
+        selector.selectedKeys().clear();
+
+        // Cancelled keys must not be selected and the channel must be
+        // possible to register again.
+        key.cancel();
+        assertEquals(0, selector.selectNow());
+        key = pipes.get(123).source().register(selector, SelectionKey.OP_READ, 123);
+        assertEquals(1, selector.selectNow());
+        assertSame(key, selector.selectedKeys().iterator().next());
+    }
+
+    @Test
+    public void testReadinessEpoll() throws Exception {
+        testReadiness(true);
+    }
+
+    @Test
+    public void testReadinessPoll() throws Exception {
+        testReadiness(false);
+    }
+
+    @Test
+    public void testWakeup() throws Exception {
+        for (boolean epoll : new boolean[] {true, false}) {
+            final Selector selector = openSelector(epoll);
+            openPipe().source().register(selector, SelectionKey.OP_READ);
+            new Thread() {
+                public void run() {
+                    try {
+                        Thread.sleep(100);
+                    } catch (InterruptedException e) {
+                    }
+                    selector.wakeup();
+                }
+            }.start();
+            long start = System.currentTimeMillis();
+            assertEquals(0, selector.select(10000));
+            assertTrue(System.currentTimeMillis() - start < 5000);
+        }
+    }
+
+    @Test
+    public void testEdgeTriggered() throws Exception {
+        Assume.assumeTrue(OsConstants.EPOLLET != 0);
+        Selector selector = ((SelectorProviderImpl) SelectorProvider.provider()).openEdgeTriggeredSelector();
+        channels.add(selector);
+        Pipe pipe = openPipe();
+        SelectionKey key = pipe.source().register(selector, SelectionKey.OP_READ);
+        assertEquals(0, selector.selectNow());
+
+        pipe.sink().write(ByteBuffer.wrap(new byte[] {1}));
+        assertEquals(1, selector.select(1000));
+        assertTrue(key.isReadable());
+        selector.selectedKeys().clear();
+
+        // The pipe is still readable but there has been no new edge.
+        assertEquals(0, selector.selectNow());
+
+        // Whether a write to a pipe which is already readable raises a new
+        // edge depends on the kernel. Drain the pipe so the next write is a
+        // transition from empty to non-empty.
+        ByteBuffer buffer = ByteBuffer.allocate(8);
+        assertEquals(1, pipe.source().read(buffer));
+        assertEquals(0, selector.selectNow());
+
+        pipe.sink().write(ByteBuffer.wrap(new byte[] {2}));
+        assertEquals(1, selector.select(1000));
+        assertTrue(key.isReadable());
+        selector.selectedKeys().clear();
+        buffer.clear();
+        assertEquals(1, pipe.source().read(buffer));
+        assertEquals(2, buffer.get(0));
+    }
+
+    private static FileDescriptor getFD(java.nio.channels.Channel channel) throws Exception {
+        Method m = channel.getClass().getMethod("getFD");
+        m.setAccessible(true);
+        return (FileDescriptor) m.invoke(channel);
+    }
+
+    @Test
+    public void testCloseWithDupedFd() throws Exception {
+        Assume.assumeTrue(OsConstants.EPOLLIN != 0);
+        Selector selector = openSelector(true);
+        Pipe pipe = openPipe();
+        pipe.source().register(selector, SelectionKey.OP_READ);
+        assertEquals(0, selector.selectNow());
+
+        // The dup keeps the open file description alive after the channel
+        // has been closed. The kernel won't drop it from the epoll set.
+        FileDescriptor dup = Libcore.os.dup(getFD(pipe.source()));
+        try {
+            pipe.source().close();
+            pipe.sink().write(ByteBuffer.wrap(new byte[] {1}));
+            assertEquals(0, selector.selectNow());
+            // A stale registration makes select() return immediately.
+            long start = System.currentTimeMillis();
+            assertEquals(0, selector.select(500));
+            assertTrue(System.currentTimeMillis() - start >= 400);
+        } finally {
+            Libcore.os.close(dup);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package org.robovm.rt.nio;
+
+import static org.junit.Assert.*;
+
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.nio.ByteBuffer;
+import java.nio.NioUtils;
+import java.nio.channels.ServerSocketChannel;
+import java.nio.channels.SocketChannel;
+import java.util.Arrays;
+
+import org.junit.Test;
+
+/**
+ * Tests {@link NioUtils#transfer(SocketChannel, SocketChannel, long)}.
+ */
+public class SocketTransferTest {
+
+    private static SocketChannel[] connect(ServerSocketChannel ssc) throws Exception {
+        SocketChannel client = SocketChannel.open(ssc.socket().getLocalSocketAddress());
+        return new SocketChannel[] {client, ssc.accept()};
+    }
+
+    @Test
+    public void testTransfer() throws Exception {
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        SocketChannel[] in = connect(ssc);
+        SocketChannel[] out = connect(ssc);
+
+        byte[] data = new byte[50000];
+        for (int i = 0; i < data.length; i++) {
+            data[i] = (byte) (i * 31);
+        }
+        in[0].write(ByteBuffer.wrap(data));
+        in[0].close();
+
+        // Asks for more than is available. Stops at end of stream.
+        assertEquals(data.length, NioUtils.transfer(in[1], out[0], data.length + 100));
+        out[0].close();
+
+        ByteBuffer actual = ByteBuffer.allocate(data.length + 1);
+        while (out[1].read(actual) > 0) {
+        }
+        assertEquals(data.length, actual.position());
+        assertTrue(Arrays.equals(data, Arrays.copyOf(actual.array(), data.length)));
+
+        in[1].close();
+        out[1].close();
+        ssc.close();
+    }
+
+    @Test
+    public void testTransferNonBlockingNothingAvailable() throws Exception {
+        ServerSocketChannel ssc = ServerSocketChannel.open();
+        ssc.socket().bind(new InetSocketAddress(InetAddress.getLoopbackAddress(), 0));
+        SocketChannel[] in = connect(ssc);
+        SocketChannel[] out = connect(ssc);
+        in[1].configureBlocking(false);
+        assertEquals(0, NioUtils.transfer(in[1], out[0], 100));
+        for (SocketChannel c : new SocketChannel[] {in[0], in[1], out[0], out[1]}) {
+            c.close();
+        }
+        ssc.close();
+    }
+}
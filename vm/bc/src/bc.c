@@ -14,6 +14,10 @@
  * limitations under the License.
  */
 #include <robovm.h>
+#if defined(DARWIN)
+#   include <mach-o/getsect.h>
+#   include <mach-o/ldsyms.h>
+#endif
 #include "uthash.h"
 #include "utlist.h"
 #include "MurmurHash3.h"
@@ -39,7 +43,29 @@ typedef struct {
     LandingPad** landingPads;
 } BcTrycatchContext;
 
+#define INLINE_CACHE_SIZE 4
+
+typedef struct {
+    Class* clazz;
+    void* impl;
+} InlineCacheEntry;
+
+/*
+ * Per call site cache of the interface method implementations looked up at
+ * the site. Must match %InlineCache in header.ll. Entries are filled in
+ * order and never replaced. Each entry has a single writer (the thread which
+ * claimed it by incrementing count) and impl is written before clazz so a 
+ * reader which sees a matching clazz but a NULL impl just takes the slow 
+ * path.
+ */
+typedef struct {
+    InlineCacheEntry entries[INLINE_CACHE_SIZE];
+    jint count;
+} InlineCache;
+
 const char* __attribute__ ((weak)) _bcMainClass = NULL;
+// Set by the linker if methods have been compiled with zero-cost exceptions.
+jboolean __attribute__ ((weak)) _bcZeroCostExceptions = FALSE;
 extern char** _bcStaticLibs;
 extern char** _bcBootclasspath;
 extern char** _bcClasspath;
@@ -49,7 +75,6 @@ extern void* _bcStrippedMethodStubs;
 extern void* _bcRuntimeData;
 static Class* loadBootClass(Env*, const char*, Object*);
 static Class* loadUserClass(Env*, const char*, Object*);
-static void classInitialized(Env*, Class*);
 static Interface* loadInterfaces(Env*, Class*);
 static Field* loadFields(Env*, Class*);
 static Method* loadMethods(Env*, Class*);
@@ -58,25 +83,56 @@ static Class* createClass(Env*, ClassInfoHeader*, Object*);
 static jboolean exceptionMatch(Env* env, TrycatchContext*);
 static ObjectArray* listBootClasses(Env*, Class*);
 static ObjectArray* listUserClasses(Env*, Class*);
+#if defined(LINUX)
+// Defined by the linker if any instrumented code has been linked in
+extern ProfileCounter __start_robovm_prof[] __attribute__ ((weak));
+extern ProfileCounter __stop_robovm_prof[] __attribute__ ((weak));
+extern ProfileReceiverSite __start_robovm_prof_rcv[] __attribute__ ((weak));
+extern ProfileReceiverSite __stop_robovm_prof_rcv[] __attribute__ ((weak));
+#endif
 static Options options = {0};
 static VM* vm = NULL;
 static jint addressClassLookupsCount = 0;
 static AddressClassLookup* addressClassLookups = NULL;
 
+static void initProfileCounters() {
+    // The compiler puts the ProfileCounters of all methods and branches in 
+    // the robovm_prof section and the ProfileReceiverSites of all call sites
+    // in the robovm_prof_rcv section when compiling with profile 
+    // instrumentation enabled.
+#if defined(DARWIN)
+    unsigned long size = 0;
+    uint8_t* start = getsectiondata(&_mh_execute_header, "__DATA", "__robovm_prof", &size);
+    options.profileCounters = (ProfileCounter*) start;
+    options.profileCountersCount = start ? size / sizeof(ProfileCounter) : 0;
+    size = 0;
+    start = getsectiondata(&_mh_execute_header, "__DATA", "__robovm_prof_rc", &size);
+    options.profileReceiverSites = (ProfileReceiverSite*) start;
+    options.profileReceiverSitesCount = start ? size / sizeof(ProfileReceiverSite) : 0;
+#elif defined(LINUX)
+    options.profileCounters = __start_robovm_prof;
+    options.profileCountersCount = __start_robovm_prof ? __stop_robovm_prof - __start_robovm_prof : 0;
+    options.profileReceiverSites = __start_robovm_prof_rcv;
+    options.profileReceiverSitesCount = __start_robovm_prof_rcv 
+            ? __stop_robovm_prof_rcv - __start_robovm_prof_rcv : 0;
+#endif
+}
+
 static void initOptions() {
     options.mainClass = (char*) _bcMainClass;
     options.rawBootclasspath = _bcBootclasspath;
     options.rawClasspath = _bcClasspath;
     options.loadBootClass = loadBootClass;
     options.loadUserClass = loadUserClass;
-    options.classInitialized = classInitialized;
     options.loadInterfaces = loadInterfaces;
     options.loadFields = loadFields;
     options.loadMethods = loadMethods;
     options.findClassAt = findClassAt;
     options.exceptionMatch = exceptionMatch;
+    options.zeroCostExceptions = _bcZeroCostExceptions;
     options.staticLibs = _bcStaticLibs;
     options.runtimeData = &_bcRuntimeData;
+    initProfileCounters();
     options.listBootClasses = listBootClasses;
     options.listUserClasses = listUserClasses;
 }
@@ -289,9 +345,18 @@ static Class* createClass(Env* env, ClassInfoHeader* header, Object* classLoader
 
     Class* clazz = rvmAllocateClass(env, header->className, superclass, classLoader, ci.access, header->typeInfo, header->vitable, header->itables,
             header->classDataSize, header->instanceDataSize, header->instanceDataOffset, header->classRefCount, 
-            header->instanceRefCount, ci.attributes, header->initializer);
+            header->instanceRefCount, ci.attributes, 
+            (header->flags & CI_PREINITIALIZED) ? NULL : header->initializer);
 
     if (clazz) {
+        if ((header->flags & CI_PREINITIALIZED) && ci.preinitializedData) {
+            // The compiler has determined that the <clinit> of this class 
+            // only stores constants into its static fields. Copy them in 
+            // here. rvmInitialize() then initializes the class as if it had 
+            // no <clinit> which takes it through the same state transitions
+            // and callbacks as any other class.
+            memcpy(clazz->data, ci.preinitializedData, ci.preinitializedDataSize);
+        }
         if (!rvmRegisterClass(env, clazz)) {
             rvmReleaseClassLock(env);
             return NULL;
@@ -305,13 +370,6 @@ static Class* createClass(Env* env, ClassInfoHeader* header, Object* classLoader
     return clazz;
 }
 
-static void classInitialized(Env* env, Class* clazz) {
-    ClassInfoHeader* header = lookupClassInfo(env, clazz->name, 
-        !clazz->classLoader || !rvmGetParentClassLoader(env, clazz->classLoader) ? _bcBootClassesHash : _bcClassesHash);
-    if (!header) return;
-    rvmAtomicStoreInt(&header->flags, header->flags | CI_INITIALIZED);
-}
-
 static Interface* loadInterfaces(Env* env, Class* clazz) {
     ClassInfoHeader* header = lookupClassInfo(env, clazz->name, 
         !clazz->classLoader || !rvmGetParentClassLoader(env, clazz->classLoader) ? _bcBootClassesHash : _bcClassesHash);
@@ -507,17 +565,17 @@ Class* findClassAt(Env* env, void* pc) {
     return clazz;
 }
 
-jboolean exceptionMatch(Env* env, TrycatchContext* _tc) {
-    BcTrycatchContext* tc = (BcTrycatchContext*) _tc;
-    LandingPad* lps = tc->landingPads[tc->tc.sel - 1];
-    Object* throwable = rvmExceptionOccurred(env);
+/*
+ * Returns the id of the first landing pad in lps which catches throwable or 0
+ * if none of them does.
+ */
+static jint matchLandingPads(LandingPad* lps, Object* throwable) {
     jint i;
     for (i = 0; lps[i].landingPadId > 0; i++) {
         ClassInfoHeader* header = lps[i].exHeader;
         if (!header) {
             // NULL means java.lang.Throwable which always matches
-            tc->tc.sel = lps[i].landingPadId;
-            return TRUE;
+            return lps[i].landingPadId;
         }
         if (!header->clazz) {
             // Exception class not yet loaded so it cannot match.
@@ -529,13 +587,276 @@ jboolean exceptionMatch(Env* env, TrycatchContext* _tc) {
             c = c->superclass;
         }
         if (c == clazz) {
-            tc->tc.sel = lps[i].landingPadId;
-            return TRUE;
+            return lps[i].landingPadId;
         }
     }
+    return 0;
+}
+
+jboolean exceptionMatch(Env* env, TrycatchContext* _tc) {
+    BcTrycatchContext* tc = (BcTrycatchContext*) _tc;
+    LandingPad* lps = tc->landingPads[tc->tc.sel - 1];
+    jint landingPadId = matchLandingPads(lps, rvmExceptionOccurred(env));
+    if (landingPadId > 0) {
+        tc->tc.sel = landingPadId;
+        return TRUE;
+    }
     return FALSE;
 }
 
+#if defined(RVM_ZERO_COST_EXCEPTIONS)
+
+#define DW_EH_PE_absptr   0x00
+#define DW_EH_PE_uleb128  0x01
+#define DW_EH_PE_udata2   0x02
+#define DW_EH_PE_udata4   0x03
+#define DW_EH_PE_udata8   0x04
+#define DW_EH_PE_sleb128  0x09
+#define DW_EH_PE_sdata2   0x0a
+#define DW_EH_PE_sdata4   0x0b
+#define DW_EH_PE_sdata8   0x0c
+#define DW_EH_PE_pcrel    0x10
+#define DW_EH_PE_indirect 0x80
+#define DW_EH_PE_omit     0xff
+
+static uintptr_t readULEB128(const uint8_t** p) {
+    uintptr_t result = 0;
+    uint32_t shift = 0;
+    uint8_t b;
+    do {
+        b = *(*p)++;
+        result |= (uintptr_t) (b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    return result;
+}
+
+static intptr_t readSLEB128(const uint8_t** p) {
+    uintptr_t result = 0;
+    uint32_t shift = 0;
+    uint8_t b;
+    do {
+        b = *(*p)++;
+        result |= (uintptr_t) (b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+    if ((b & 0x40) && shift < sizeof(uintptr_t) * 8) {
+        result |= ~(uintptr_t) 0 << shift;
+    }
+    return (intptr_t) result;
+}
+
+/*
+ * Returns the size of a value with the specified encoding or 0 if the
+ * encoding isn't supported.
+ */
+static uint32_t encodedSize(uint8_t encoding) {
+    switch (encoding & 0x0f) {
+    case DW_EH_PE_absptr: return sizeof(void*);
+    case DW_EH_PE_udata2:
+    case DW_EH_PE_sdata2: return 2;
+    case DW_EH_PE_udata4:
+    case DW_EH_PE_sdata4: return 4;
+    case DW_EH_PE_udata8:
+    case DW_EH_PE_sdata8: return 8;
+    }
+    return 0;
+}
+
+/*
+ * Reads a value with the specified encoding into result. Returns FALSE if the
+ * encoding isn't supported.
+ */
+static jboolean readEncoded(const uint8_t** p, uint8_t encoding, uintptr_t* result) {
+    const uint8_t* start = *p;
+    uintptr_t value;
+    if (encoding == DW_EH_PE_omit) {
+        *result = 0;
+        return TRUE;
+    }
+    switch (encoding & 0x0f) {
+    case DW_EH_PE_absptr: memcpy(&value, *p, sizeof(uintptr_t)); *p += sizeof(uintptr_t); break;
+    case DW_EH_PE_uleb128: value = readULEB128(p); break;
+    case DW_EH_PE_sleb128: value = (uintptr_t) readSLEB128(p); break;
+    case DW_EH_PE_udata2: { uint16_t v; memcpy(&v, *p, 2); *p += 2; value = v; break; }
+    case DW_EH_PE_sdata2: { int16_t v; memcpy(&v, *p, 2); *p += 2; value = (uintptr_t) (intptr_t) v; break; }
+    case DW_EH_PE_udata4: { uint32_t v; memcpy(&v, *p, 4); *p += 4; value = v; break; }
+    case DW_EH_PE_sdata4: { int32_t v; memcpy(&v, *p, 4); *p += 4; value = (uintptr_t) (intptr_t) v; break; }
+    case DW_EH_PE_udata8:
+    case DW_EH_PE_sdata8: { uint64_t v; memcpy(&v, *p, 8); *p += 8; value = (uintptr_t) v; break; }
+    default:
+        return FALSE;
+    }
+    if (value != 0) {
+        // Only pc relative pointers are emitted for the code we compile.
+        if ((encoding & 0x70) == DW_EH_PE_pcrel) {
+            value += (uintptr_t) start;
+        } else if ((encoding & 0x70) != 0) {
+            return FALSE;
+        }
+        if (encoding & DW_EH_PE_indirect) {
+            value = *(uintptr_t*) value;
+        }
+    }
+    *result = value;
+    return TRUE;
+}
+
+/*
+ * Searches the LSDA (the call site table LLVM emits into .gcc_except_table)
+ * of the current frame for a landing pad which catches ue->throwable. Each
+ * landingpad emitted by MethodCompiler has a single catch clause referencing
+ * the LandingPad list of the trap set covering the call site. Returns
+ * _URC_FATAL_PHASE1_ERROR if the LSDA uses an unsupported encoding.
+ */
+static _Unwind_Reason_Code findLandingPad(UnwindException* ue, struct _Unwind_Context* context) {
+    const uint8_t* lsda = (const uint8_t*) _Unwind_GetLanguageSpecificData(context);
+    if (!lsda) {
+        return _URC_CONTINUE_UNWIND;
+    }
+    int ipBeforeInsn = 0;
+    uintptr_t ip = _Unwind_GetIPInfo(context, &ipBeforeInsn);
+    if (!ipBeforeInsn) {
+        // ip is the return address. Make it point into the call instruction.
+        ip--;
+    }
+    uintptr_t funcStart = _Unwind_GetRegionStart(context);
+
+    const uint8_t* p = lsda;
+    uint8_t lpStartEncoding = *p++;
+    uintptr_t lpStart = funcStart;
+    if (lpStartEncoding != DW_EH_PE_omit && !readEncoded(&p, lpStartEncoding, &lpStart)) {
+        return _URC_FATAL_PHASE1_ERROR;
+    }
+    uint8_t ttypeEncoding = *p++;
+    const uint8_t* classInfo = NULL;
+    uint32_t ttypeSize = 0;
+    if (ttypeEncoding != DW_EH_PE_omit) {
+        uintptr_t classInfoOffset = readULEB128(&p);
+        classInfo = p + classInfoOffset;
+        ttypeSize = encodedSize(ttypeEncoding);
+        if (ttypeSize == 0) {
+            return _URC_FATAL_PHASE1_ERROR;
+        }
+    }
+    uint8_t callSiteEncoding = *p++;
+    uint32_t callSiteTableLength = (uint32_t) readULEB128(&p);
+    const uint8_t* callSiteTableEnd = p + callSiteTableLength;
+    const uint8_t* actionTable = callSiteTableEnd;
+
+    while (p < callSiteTableEnd) {
+        uintptr_t start, length, landingPad;
+        if (!readEncoded(&p, callSiteEncoding, &start)
+                || !readEncoded(&p, callSiteEncoding, &length)
+                || !readEncoded(&p, callSiteEncoding, &landingPad)) {
+            return _URC_FATAL_PHASE1_ERROR;
+        }
+        uintptr_t actionEntry = readULEB128(&p);
+        if (ip < funcStart + start) {
+            // The table is sorted by start address.
+            break;
+        }
+        if (ip >= funcStart + start + length) {
+            continue;
+        }
+        if (landingPad == 0 || actionEntry == 0 || !classInfo) {
+            // No landing pad or only cleanups. MethodCompiler never emits
+            // cleanups.
+            return _URC_CONTINUE_UNWIND;
+        }
+        const uint8_t* action = actionTable + actionEntry - 1;
+        for (;;) {
+            intptr_t typeIndex = readSLEB128(&action);
+            const uint8_t* next = action;
+            intptr_t nextOffset = readSLEB128(&next);
+            if (typeIndex > 0) {
+                const uint8_t* entry = classInfo - typeIndex * ttypeSize;
+                uintptr_t lps;
+                if (!readEncoded(&entry, ttypeEncoding, &lps)) {
+                    return _URC_FATAL_PHASE1_ERROR;
+                }
+                jint landingPadId = lps ? matchLandingPads((LandingPad*) lps, ue->throwable) : 0;
+                if (landingPadId > 0) {
+                    ue->landingPadId = landingPadId;
+                    ue->landingPad = lpStart + landingPad;
+                    return _URC_HANDLER_FOUND;
+                }
+            }
+            if (nextOffset == 0) {
+                break;
+            }
+            action += nextOffset;
+        }
+        return _URC_CONTINUE_UNWIND;
+    }
+    return _URC_CONTINUE_UNWIND;
+}
+
+/*
+ * Returns TRUE if tc catches throwable. Unlike exceptionMatch() this doesn't
+ * update tc->sel.
+ */
+static jboolean trycatchContextCatches(TrycatchContext* tc, Object* throwable) {
+    if (tc->sel == 0) {
+        return FALSE;
+    }
+    if (tc->sel == CATCH_ALL_SEL) {
+        return TRUE;
+    }
+    BcTrycatchContext* btc = (BcTrycatchContext*) tc;
+    return matchLandingPads(btc->landingPads[tc->sel - 1], throwable) > 0;
+}
+
+/*
+ * Personality routine of compiled Java methods. Called by the system unwinder
+ * once per frame in the search phase and again in the cleanup phase when
+ * rvmRaiseException() raises an UnwindException.
+ */
+_Unwind_Reason_Code _bcPersonality(int version, _Unwind_Action actions, _Unwind_Exception_Class exceptionClass,
+        struct _Unwind_Exception* exception, struct _Unwind_Context* context) {
+
+    if (version != 1 || exceptionClass != RVM_UNWIND_EXCEPTION_CLASS) {
+        // Foreign exceptions can't be caught by Java code and compiled
+        // methods have no cleanups to run.
+        return _URC_CONTINUE_UNWIND;
+    }
+    UnwindException* ue = (UnwindException*) exception;
+    Env* env = ue->env;
+
+    if (actions & _UA_SEARCH_PHASE) {
+        // TrycatchContexts set up by frames younger than this one get to
+        // handle the exception first. Those which don't catch it are skipped
+        // so the stack is only walked once.
+        uintptr_t cfa = _Unwind_GetCFA(context);
+        while (ue->tc && (uintptr_t) ue->tc < cfa) {
+            if (trycatchContextCatches(ue->tc, ue->throwable)) {
+                // Stop the search and let rvmRaiseException() jump to tc.
+                return _URC_FATAL_PHASE1_ERROR;
+            }
+            ue->tc = ue->tc->prev;
+        }
+        return findLandingPad(ue, context);
+    }
+
+    if (actions & _UA_HANDLER_FRAME) {
+        // The TrycatchContexts skipped in the search phase belong to frames
+        // which are being unwound.
+        env->trycatchContext = ue->tc;
+        rvmRestoreThreadSignalMask(env);
+        rvmHookExceptionRaised(env, ue->throwable, TRUE);
+        // The landingpad switches on the selector. The exception pointer
+        // isn't used since the handler gets the throwable from env.
+        _Unwind_SetGR(context, __builtin_eh_return_data_regno(0), (uintptr_t) exception);
+        _Unwind_SetGR(context, __builtin_eh_return_data_regno(1), (uintptr_t) ue->landingPadId);
+        _Unwind_SetIP(context, ue->landingPad);
+        return _URC_INSTALL_CONTEXT;
+    }
+
+    return _URC_CONTINUE_UNWIND;
+}
+
+#endif
+
 #define ENTER rvmPushGatewayFrame(env)
 #define LEAVEV \
     rvmPopGatewayFrame(env); \
@@ -559,7 +880,15 @@ static Class* ldcClass(Env* env, ClassInfoHeader* header) {
 }
 static void initializeClass(Env* env, ClassInfoHeader* header) {
     Class* clazz = ldcClass(env, header);
-    if (clazz) rvmInitialize(env, clazz);
+    if (!clazz) return;
+    rvmInitialize(env, clazz);
+    // We already have the header so set CI_INITIALIZED here rather than
+    // looking it up again by name. rvmInitialize() returns without 
+    // initializing if the current thread is already running <clinit>. The
+    // flag must not be set until <clinit> has completed.
+    if (CLASS_IS_STATE_INITIALIZED(clazz) && !(header->flags & CI_INITIALIZED)) {
+        rvmAtomicStoreInt(&header->flags, header->flags | CI_INITIALIZED);
+    }
 }
 void _bcInitializeClass(Env* env, ClassInfoHeader* header) {
     ENTER;
@@ -671,6 +1000,63 @@ void _bcNonPublicMethodCalled(Env* env, Object* thiz) {
     LEAVEV;
 }
 
+void* _bcInlineCacheMiss(Env* env, InlineCache* ic, ClassInfoHeader* header, Object* thiz, uint32_t index, void* fallback) {
+    jint slot = rvmAtomicLoadInt(&ic->count);
+    if (slot >= INLINE_CACHE_SIZE) {
+        // Megamorphic call site. Use the per class cache.
+        return _bcLookupInterfaceMethodImpl(env, header, thiz, index);
+    }
+
+    // Scan the itables without touching itables->cache. The per class cache
+    // is left for megamorphic call sites.
+    TypeInfo* typeInfo = header->typeInfo;
+    ITables* itables = thiz->clazz->itables;
+    ITable* itable = NULL;
+    uint32_t i;
+    for (i = 0; i < itables->count; i++) {
+        if (itables->table[i]->typeInfo == typeInfo) {
+            itable = itables->table[i];
+            break;
+        }
+    }
+    if (!itable) {
+        // Throws IncompatibleClassChangeError
+        return _bcLookupInterfaceMethodImpl(env, header, thiz, index);
+    }
+    void* impl = itable->table.table[index];
+    if (impl == _bcAbstractMethodCalled || impl == _bcNonPublicMethodCalled) {
+        // These need the method name and descriptor set by the interface
+        // method lookup function. Let the trampoline call them.
+        return fallback;
+    }
+
+    while (slot < INLINE_CACHE_SIZE) {
+        // Another thread may have cached the same class since we checked. A
+        // NULL class means an entry is being filled in by another thread
+        // which may also be for the same class. Leave the cache as is in
+        // both cases so that a class never occupies more than one entry.
+        jint j;
+        for (j = 0; j < slot; j++) {
+            Class* clazz = rvmAtomicLoadPtr((void**) &ic->entries[j].clazz);
+            if (!clazz || clazz == thiz->clazz) {
+                return impl;
+            }
+        }
+        if (rvmAtomicCompareAndSwapInt(&ic->count, slot, slot + 1)) {
+            InlineCacheEntry* entry = &ic->entries[slot];
+            rvmAtomicStorePtr(&entry->impl, impl);
+            rvmAtomicStorePtr((void**) &entry->clazz, thiz->clazz);
+            break;
+        }
+        slot = rvmAtomicLoadInt(&ic->count);
+    }
+    return impl;
+}
+
+void _bcProfileReceiver(ProfileReceiverSite* site, Object* o) {
+    rvmProfileReceiver(site, o);
+}
+
 void _bcMoveMemory16(void* dest, const void* src, jlong n) {
     rvmMoveMemory16(dest, src, n);
 }
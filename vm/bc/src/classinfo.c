@@ -225,6 +225,13 @@ void readClassInfo(void** p, ClassInfo* result) {
         attributes = readPtr(p);
     }
 
+    void* preinitializedData = NULL;
+    jint preinitializedDataSize = 0;
+    if (header->flags & CI_PREINITIALIZED) {
+        preinitializedData = readPtr(p);
+        preinitializedDataSize = readInt(p);
+    }
+
     if (result) {
         result->header = *header;
         result->access = access;
@@ -233,6 +240,8 @@ void readClassInfo(void** p, ClassInfo* result) {
         result->methodCount = methodCount;
         result->superclassName = superclassName;
         result->attributes = attributes;
+        result->preinitializedData = preinitializedData;
+        result->preinitializedDataSize = preinitializedDataSize;
     }
 }
 
@@ -29,6 +29,7 @@
 #define CI_ERROR 0x100
 #define CI_INITIALIZED 0x200
 #define CI_FINALIZABLE 0x400
+#define CI_PREINITIALIZED 0x800
 
 #define CI_ERROR_TYPE_NONE 0x0
 #define CI_ERROR_TYPE_NO_CLASS_DEF_FOUND 0x1
@@ -66,6 +67,8 @@ typedef struct {
     jint methodCount;
     char* superclassName;
     void* attributes;
+    void* preinitializedData;
+    jint preinitializedDataSize;
 } ClassInfo;
 
 typedef struct {
@@ -63,6 +63,7 @@ extern "C" {
 #include "robovm/monitor.h"
 #include "robovm/signal.h"
 #include "robovm/hooks.h"
+#include "robovm/profile.h"
 #include "robovm/rt.h"
 #include "robovm/lazy_helpers.h"
 
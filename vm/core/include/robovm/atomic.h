@@ -44,6 +44,14 @@ static inline jboolean rvmAtomicCompareAndSwapPtr(void** ptr, void* oldval, void
 #endif
 }
 
+static inline jlong rvmAtomicAddLong(jlong* ptr, jlong value) {
+#if defined(DARWIN)
+    return OSAtomicAdd64(value, ptr);
+#else
+    return __sync_add_and_fetch(ptr, value);
+#endif
+}
+
 static inline jint rvmAtomicLoadInt(jint* ptr) {
     return __sync_fetch_and_or(ptr, 0);
 }
@@ -40,6 +40,7 @@ extern jboolean rvmRemoveRef(Env* env, RefTable* refTable, Object* object);
 extern jlong rvmGetFreeMemory(Env* env);
 extern jlong rvmGetTotalMemory(Env* env);
 extern jlong rvmGetMaxMemory(Env* env);
+extern jlong rvmGetAllocatedBytes(Env* env);
 extern void* rvmCopyMemoryAtomic(Env* env, const void* src, size_t size);
 extern void* rvmCopyMemoryAtomicZ(Env* env, const char* src);
 extern void* rvmCopyMemory(Env* env, const void* src, size_t size);
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2012 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ROBOVM_PROFILE_H
+#define ROBOVM_PROFILE_H
+
+extern jboolean rvmWriteProfile(Env* env, FILE* out);
+extern jboolean rvmDumpProfile(Env* env, const char* path);
+extern void rvmResetProfile(Env* env);
+extern void rvmProfileReceiver(ProfileReceiverSite* site, Object* o);
+
+#endif
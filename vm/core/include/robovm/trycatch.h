@@ -18,6 +18,35 @@
 
 #define CATCH_ALL_SEL -1
 
+#if defined(LINUX) && defined(RVM_X86_64)
+/*
+ * Methods compiled for Linux x86_64 may use LLVM landingpads and DWARF unwind
+ * tables instead of setting up a TrycatchContext for their try/catch blocks.
+ * If the app was compiled that way Options.zeroCostExceptions is set and
+ * rvmRaiseException() uses the system unwinder to find the handler. The
+ * unwinder calls _bcPersonality() for each compiled frame. TrycatchContexts
+ * are still used by native code calling into Java and by synchronized method
+ * wrappers, bridges and callbacks.
+ */
+#define RVM_ZERO_COST_EXCEPTIONS 1
+
+#include <unwind.h>
+
+// "RoboJava"
+#define RVM_UNWIND_EXCEPTION_CLASS 0x526f626f4a617661ULL
+
+typedef struct {
+    struct _Unwind_Exception header;
+    Env* env;
+    Object* throwable;
+    // The innermost TrycatchContext not yet passed by the search phase.
+    TrycatchContext* tc;
+    // Set by the personality routine in the search phase.
+    jint landingPadId;
+    uintptr_t landingPad;
+} UnwindException;
+#endif
+
 extern jint rvmTrycatchEnter(Env* env, TrycatchContext* tc) __attribute__((returns_twice));
 extern void rvmTrycatchJump(TrycatchContext* tc) __attribute__((noreturn));
 
@@ -319,6 +319,43 @@ struct SystemProperty {
   SystemProperty* next;
 };
 
+#define PROFILE_COUNTER_METHOD 0
+#define PROFILE_COUNTER_BRANCH 1
+#define PROFILE_RECEIVER_SLOTS 4
+
+/*
+ * Per-method and per-branch counter emitted by the compiler when profile 
+ * instrumentation is enabled. Must match %ProfileCounter in header.ll. The 
+ * compiler puts all counters in the same section so they form a contiguous 
+ * array at runtime. For PROFILE_COUNTER_METHOD counters value is the number
+ * of cycles spent in the method. For PROFILE_COUNTER_BRANCH counters value is
+ * the number of times the index:th branch in the method was taken.
+ */
+typedef struct ProfileCounter {
+    jlong count;
+    jlong value;
+    const char* name;
+    jint kind;
+    jint index;
+} __attribute__ ((aligned (8))) ProfileCounter;
+
+typedef struct ProfileReceiver {
+    Class* clazz;
+    jlong count;
+} ProfileReceiver;
+
+/*
+ * Receiver classes seen at the index:th virtual or interface call site in a
+ * method. Must match %ProfileReceiverSite in header.ll. Receivers which 
+ * don't fit in receivers are counted in other.
+ */
+typedef struct ProfileReceiverSite {
+    const char* name;
+    jint index;
+    jlong other;
+    ProfileReceiver receivers[PROFILE_RECEIVER_SLOTS];
+} __attribute__ ((aligned (8))) ProfileReceiverSite;
+
 typedef struct Options {
     char* mainClass;
     char** commandLineArgs;
@@ -333,6 +370,7 @@ typedef struct Options {
     char* pidFile;
     jboolean printDebugPort;
     char* debugPortFile;
+    char* profileFile;
     char resourcesPath[PATH_MAX];
     char imagePath[PATH_MAX];
     char** rawBootclasspath; 
@@ -342,6 +380,11 @@ typedef struct Options {
     ClasspathEntry* classpath;
     char** staticLibs; 
     void* runtimeData;
+    ProfileCounter* profileCounters;
+    jint profileCountersCount;
+    ProfileReceiverSite* profileReceiverSites;
+    jint profileReceiverSitesCount;
+    jboolean zeroCostExceptions;
     Class* (*loadBootClass)(Env*, const char*, Object*);
     Class* (*loadUserClass)(Env*, const char*, Object*);
     void (*classInitialized)(Env*, Class*);
@@ -466,6 +509,18 @@ struct TrycatchContext {
 #endif
 };
 
+/*
+ * Small instances of classes which the GC doesn't have to treat specially
+ * are handed out from per-thread free lists in the Env. There is one list 
+ * per size class. Size classes are RVM_ALLOC_GRANULE bytes apart. The lists
+ * are refilled using GC_malloc_many() and are linked through the first word 
+ * of each object. Compiled allocators pop objects inline. The layout of 
+ * these fields must match %Env in the compiler's header.ll.
+ */
+#define RVM_ALLOC_GRANULE 16
+#define RVM_ALLOC_FREE_LISTS 8
+#define RVM_ALLOC_MAX_SIZE (RVM_ALLOC_GRANULE * RVM_ALLOC_FREE_LISTS)
+
 struct Env {
     JNIEnv jni;
     VM* vm;
@@ -476,6 +531,7 @@ struct Env {
     GatewayFrame* gatewayFrames;
     TrycatchContext* trycatchContext;
     jint attachCount;
+    void* allocFreeLists[RVM_ALLOC_FREE_LISTS];
 };
 
 typedef struct DebugGcRoot {
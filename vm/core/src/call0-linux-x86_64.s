@@ -32,8 +32,12 @@ CallInfo_size         = 164
     .align    16, 0x90
     .type    _call0, @function
 _call0:
+    .cfi_startproc
     push  %rbp
+    .cfi_def_cfa_offset 16
+    .cfi_offset %rbp, -16
     mov   %rsp, %rbp
+    .cfi_def_cfa_register %rbp
     mov   %rdi, %rax
 
     mov   intArgs_offset+0(%rax), %rdi         # %rdi = intArgs[0]
@@ -79,4 +83,6 @@ _call0:
     call  *function_offset(%rax)
 
     leave
+    .cfi_def_cfa %rsp, 8
     ret
+    .cfi_endproc
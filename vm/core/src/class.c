@@ -1189,7 +1189,8 @@ void rvmInitialize(Env* env, Class* clazz) {
     void* initializer = clazz->initializer;
     if (!initializer) {
         // No <clinit> in class
-        if (!CLASS_IS_ARRAY(clazz) && !CLASS_IS_PROXY(clazz) && !CLASS_IS_PRIMITIVE(clazz)) {
+        if (env->vm->options->classInitialized 
+                && !CLASS_IS_ARRAY(clazz) && !CLASS_IS_PROXY(clazz) && !CLASS_IS_PRIMITIVE(clazz)) {
             env->vm->options->classInitialized(env, clazz);
         }
         rvmLockObject(env, (Object*) clazz);
@@ -1214,7 +1215,8 @@ void rvmInitialize(Env* env, Class* clazz) {
     Object* exception = rvmExceptionClear(env);
     if (!exception) {
         // Successful initialization
-        if (!CLASS_IS_ARRAY(clazz) && !CLASS_IS_PROXY(clazz) && !CLASS_IS_PRIMITIVE(clazz)) {
+        if (env->vm->options->classInitialized 
+                && !CLASS_IS_ARRAY(clazz) && !CLASS_IS_PROXY(clazz) && !CLASS_IS_PRIMITIVE(clazz)) {
             env->vm->options->classInitialized(env, clazz);
         }
         rvmLockObject(env, (Object*) clazz);
@@ -32,11 +32,37 @@ jboolean rvmInitExceptions(Env* env) {
     return TRUE;
 }
 
+#if defined(RVM_ZERO_COST_EXCEPTIONS)
+/*
+ * Searches the stack for a handler of e in a single pass. If a compiled frame
+ * catches e before any TrycatchContext does _bcPersonality() transfers control
+ * to it and this never returns. Otherwise the TrycatchContexts which don't
+ * catch e are popped and the innermost one which does, if any, is left in
+ * env->trycatchContext.
+ */
+static void raiseUnwindException(Env* env, Object* e) {
+    UnwindException ue;
+    memset(&ue, 0, sizeof(UnwindException));
+    ue.header.exception_class = RVM_UNWIND_EXCEPTION_CLASS;
+    ue.env = env;
+    ue.throwable = e;
+    ue.tc = env->trycatchContext;
+    // ue is only needed while unwinding so it can live on the stack.
+    _Unwind_RaiseException(&ue.header);
+    env->trycatchContext = ue.tc;
+}
+#endif
+
 void rvmRaiseException(Env* env, Object* e) {
     if (env->throwable != e) {
         rvmThrow(env, e);
     }
     jboolean (*exceptionMatch)(Env*, TrycatchContext*) = env->vm->options->exceptionMatch;
+#if defined(RVM_ZERO_COST_EXCEPTIONS)
+    if (env->vm->options->zeroCostExceptions) {
+        raiseUnwindException(env, e);
+    }
+#endif
     TrycatchContext* tc = env->trycatchContext;
     while (tc) {
         if (tc->sel != 0 && (tc->sel == CATCH_ALL_SEL || exceptionMatch(env, tc))) {
@@ -172,6 +172,11 @@ void rvmParseOption(char* arg, Options* options) {
         }
     } else if (startsWith(arg, "PrintDebugPort")) {
         options->printDebugPort = TRUE;
+    } else if (startsWith(arg, "ProfileFile=")) {
+        if (!options->profileFile) {
+            char* s = strdup(&arg[12]);
+            options->profileFile = s;
+        }
     } else if (startsWith(arg, "D")) {
         char* s = strdup(&arg[1]);
         // Split the arg string on the '='. 'key' will have the
@@ -519,6 +524,9 @@ jboolean rvmDestroyVM(VM* vm) {
 }
 
 void rvmShutdown(Env* env, jint code) {
+    if (env->vm->options->profileFile) {
+        rvmDumpProfile(env, env->vm->options->profileFile);
+    }
     // TODO: Cleanup, stop threads.
     exit(code);
 }
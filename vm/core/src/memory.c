@@ -986,8 +986,39 @@ Class* rvmAllocateMemoryForClass(Env* env, jint classDataSize) {
     return m;
 }
 
+/*
+ * Pops an object of at least size bytes from the current thread's free list
+ * for the size class. Refills the list using GC_malloc_many() when it's 
+ * empty. The objects are of the GC's normal kind and are scanned 
+ * conservatively. This keeps the links between objects on the list visible 
+ * to the GC. Links in a list of gcj objects would not be traced. Objects are
+ * cleared except for the link which the caller overwrites with the Class 
+ * pointer.
+ */
+static inline void* allocateFromFreeList(Env* env, jint size) {
+    jint index = (size + RVM_ALLOC_GRANULE - 1) / RVM_ALLOC_GRANULE - 1;
+    void* m = env->allocFreeLists[index];
+    if (!m) {
+        m = GC_malloc_many((index + 1) * RVM_ALLOC_GRANULE);
+        if (!m) {
+            return NULL;
+        }
+    }
+    env->allocFreeLists[index] = GC_NEXT(m);
+    GC_NEXT(m) = NULL;
+    return m;
+}
+
 Object* rvmAllocateMemoryForObject(Env* env, Class* clazz) {
-    Object* m = (Object*) gcAllocateObject(clazz->instanceDataSize, clazz);
+    Object* m = NULL;
+    if (clazz->instanceDataSize <= RVM_ALLOC_MAX_SIZE && clazz->gcDescriptor != markObjectGcDescriptor) {
+        // Classes which use markObject() (finalizable, references, 
+        // throwables, etc) must be allocated with their descriptor.
+        m = (Object*) allocateFromFreeList(env, clazz->instanceDataSize);
+    }
+    if (!m) {
+        m = (Object*) gcAllocateObject(clazz->instanceDataSize, clazz);
+    }
     if (!m) {
         if (clazz == java_lang_OutOfMemoryError) {
             // We can't even allocate an OutOfMemoryError object. Prevent
@@ -1166,6 +1197,12 @@ jlong rvmGetTotalMemory(Env* env) {
     return (jlong) pheap_size;
 }
 
+jlong rvmGetAllocatedBytes(Env* env) {
+    GC_word ptotal_bytes;
+    GC_CALL GC_get_heap_usage_safe(NULL, NULL, NULL, NULL, &ptotal_bytes);
+    return (jlong) ptotal_bytes;
+}
+
 jlong rvmGetMaxMemory(Env* env) {
     if (env->vm->options->maxHeapSize > 0) {
         return env->vm->options->maxHeapSize;
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2012 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <robovm.h>
+#include <string.h>
+#include <errno.h>
+
+#define LOG_TAG "core.profile"
+
+/*
+ * The report written by rvmWriteProfile() is a plain text file with one line
+ * per method which has been called at least once, sorted by call count in
+ * descending order, followed by one line per executed branch and one line
+ * per receiver class seen at a virtual or interface call site:
+ *
+ *   m TAB <count> TAB <cycles> TAB <owner>.<name><desc>
+ *   b TAB <count> TAB <taken> TAB <owner>.<name><desc> TAB <index>
+ *   r TAB <count> TAB <class> TAB <owner>.<name><desc> TAB <index>
+ *
+ * Receivers which didn't fit in a ProfileReceiverSite are reported with * as
+ * class. Lines starting with # are comments. The compiler reads this format
+ * back (see org.robovm.compiler.profile.Profile) to drive profile guided 
+ * optimizations.
+ */
+#define PROFILE_FORMAT_VERSION 2
+
+static int compareProfileCounters(const void* a, const void* b) {
+    ProfileCounter* c1 = (ProfileCounter*) a;
+    ProfileCounter* c2 = (ProfileCounter*) b;
+    if (c1->kind != c2->kind) {
+        return c1->kind < c2->kind ? -1 : 1;
+    }
+    if (c1->count != c2->count) {
+        return c1->count > c2->count ? -1 : 1;
+    }
+    if (c1->value != c2->value) {
+        return c1->value > c2->value ? -1 : 1;
+    }
+    jint result = strcmp(c1->name, c2->name);
+    if (result == 0) {
+        return c1->index - c2->index;
+    }
+    return result;
+}
+
+static void writeReceiverSites(FILE* out, ProfileReceiverSite* sites, jint count) {
+    jint i, j;
+    for (i = 0; i < count; i++) {
+        ProfileReceiverSite* site = &sites[i];
+        for (j = 0; j < PROFILE_RECEIVER_SLOTS; j++) {
+            Class* clazz = rvmAtomicLoadPtr((void**) &site->receivers[j].clazz);
+            jlong n = rvmAtomicLoadLong(&site->receivers[j].count);
+            if (clazz && n > 0) {
+                fprintf(out, "r\t%lld\t%s\t%s\t%d\n", (long long) n, clazz->name, site->name, site->index);
+            }
+        }
+        jlong other = rvmAtomicLoadLong(&site->other);
+        if (other > 0) {
+            fprintf(out, "r\t%lld\t*\t%s\t%d\n", (long long) other, site->name, site->index);
+        }
+    }
+}
+
+jboolean rvmWriteProfile(Env* env, FILE* out) {
+    Options* options = env->vm->options;
+    ProfileCounter* counters = options->profileCounters;
+    jint count = options->profileCountersCount;
+
+    fprintf(out, "# robovm-profile %d\n", PROFILE_FORMAT_VERSION);
+    fprintf(out, "# m\tcount\tcycles\tmethod\n");
+    fprintf(out, "# b\tcount\ttaken\tmethod\tindex\n");
+    fprintf(out, "# r\tcount\tclass\tmethod\tindex\n");
+    if (counters && count > 0) {
+        // Use malloc() rather than the GC heap. This is called from rvmShutdown()
+        // which may run when the heap is exhausted.
+        ProfileCounter* sorted = malloc(count * sizeof(ProfileCounter));
+        if (!sorted) {
+            return FALSE;
+        }
+        jint i, n = 0;
+        for (i = 0; i < count; i++) {
+            // Other threads may still be updating the counters. Sort and
+            // write a copy of them to get a consistent report.
+            ProfileCounter c = counters[i];
+            c.count = rvmAtomicLoadLong(&counters[i].count);
+            c.value = rvmAtomicLoadLong(&counters[i].value);
+            if (c.count > 0) {
+                sorted[n++] = c;
+            }
+        }
+        qsort(sorted, n, sizeof(ProfileCounter), compareProfileCounters);
+        for (i = 0; i < n; i++) {
+            ProfileCounter* c = &sorted[i];
+            if (c->kind == PROFILE_COUNTER_BRANCH) {
+                fprintf(out, "b\t%lld\t%lld\t%s\t%d\n", (long long) c->count, 
+                        (long long) c->value, c->name, c->index);
+            } else {
+                fprintf(out, "m\t%lld\t%lld\t%s\n", (long long) c->count, 
+                        (long long) c->value, c->name);
+            }
+        }
+        free(sorted);
+    }
+    if (options->profileReceiverSites) {
+        writeReceiverSites(out, options->profileReceiverSites, options->profileReceiverSitesCount);
+    }
+    return ferror(out) ? FALSE : TRUE;
+}
+
+jboolean rvmDumpProfile(Env* env, const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        WARNF("Failed to open profile file '%s': %s", path, strerror(errno));
+        return FALSE;
+    }
+    jboolean result = rvmWriteProfile(env, out);
+    if (fclose(out) != 0) {
+        result = FALSE;
+    }
+    if (!result) {
+        WARNF("Failed to write profile file '%s'", path);
+    }
+    return result;
+}
+
+void rvmResetProfile(Env* env) {
+    Options* options = env->vm->options;
+    jint i;
+    for (i = 0; i < options->profileCountersCount; i++) {
+        options->profileCounters[i].count = 0;
+        options->profileCounters[i].value = 0;
+    }
+    for (i = 0; i < options->profileReceiverSitesCount; i++) {
+        ProfileReceiverSite* site = &options->profileReceiverSites[i];
+        jint j;
+        for (j = 0; j < PROFILE_RECEIVER_SLOTS; j++) {
+            site->receivers[j].count = 0;
+        }
+        site->other = 0;
+    }
+}
+
+void rvmProfileReceiver(ProfileReceiverSite* site, Object* o) {
+    if (!o) {
+        // The call will throw NullPointerException
+        return;
+    }
+    Class* clazz = o->clazz;
+    jint i;
+    for (i = 0; i < PROFILE_RECEIVER_SLOTS; i++) {
+        ProfileReceiver* r = &site->receivers[i];
+        Class* c = rvmAtomicLoadPtr((void**) &r->clazz);
+        if (!c) {
+            // Claim the empty slot. If another thread beats us to it we 
+            // check whether it claimed it for the same class.
+            if (!rvmAtomicCompareAndSwapPtr((void**) &r->clazz, NULL, clazz)) {
+                c = rvmAtomicLoadPtr((void**) &r->clazz);
+            } else {
+                c = clazz;
+            }
+        }
+        if (c == clazz) {
+            rvmAtomicAddLong(&r->count, 1);
+            return;
+        }
+    }
+    rvmAtomicAddLong(&site->other, 1);
+}
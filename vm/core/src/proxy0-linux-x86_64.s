@@ -40,8 +40,12 @@ proxy0_stack_size_aligned = ((((proxy0_stack_size) + 16 - 1) & ~(16 - 1)))
     .align    16, 0x90
     .type    _proxy0, @function
 _proxy0:
+    .cfi_startproc
     push  %rbp
+    .cfi_def_cfa_offset 16
+    .cfi_offset %rbp, -16
     mov   %rsp, %rbp
+    .cfi_def_cfa_register %rbp
 
     sub   $proxy0_stack_size_aligned, %rsp     # Make room for a CallInfo struct on the stack
 
@@ -75,4 +79,6 @@ _proxy0:
     movsd returnValue_offset(%rsp), %xmm0      # if return value is float or double
 
     leave
+    .cfi_def_cfa %rsp, 8
     ret
+    .cfi_endproc
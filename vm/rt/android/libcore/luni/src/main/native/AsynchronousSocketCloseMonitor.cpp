@@ -24,15 +24,29 @@
 #include <string.h>
 
 /**
- * We use an intrusive doubly-linked list to keep track of blocked threads.
+ * We use intrusive doubly-linked lists to keep track of blocked threads.
  * This gives us O(1) insertion and removal, and means we don't need to do any allocation.
  * (The objects themselves are stack-allocated.)
- * Waking potentially-blocked threads when a socket is closed is O(n) in the total number of
- * blocked threads (not the number of threads actually blocked on the socket in question).
- * For now at least, this seems like a good compromise for Android.
+ *
+ * RoboVM note: Android uses a single list protected by a single mutex. With thousands of
+ * threads blocked in socket I/O that mutex is heavily contended and waking the threads blocked
+ * on a socket is O(n) in the total number of blocked threads. We hash fds into a fixed number
+ * of buckets, each with its own list and mutex, so that unrelated fds rarely share a lock and
+ * signalBlockedThreads() only has to walk the threads blocked on fds in the same bucket. fds
+ * are small and densely allocated so fd % BUCKET_COUNT spreads them evenly.
  */
-static pthread_mutex_t blockedThreadListMutex = PTHREAD_MUTEX_INITIALIZER;
-static AsynchronousSocketCloseMonitor* blockedThreadList = NULL;
+static const int BUCKET_COUNT = 256;
+
+struct BlockedThreadBucket {
+    pthread_mutex_t mutex;
+    AsynchronousSocketCloseMonitor* list;
+} __attribute__((aligned(64))); // Keep buckets on separate cache lines.
+
+static BlockedThreadBucket blockedThreadBuckets[BUCKET_COUNT];
+
+static BlockedThreadBucket& bucketFor(int fd) {
+    return blockedThreadBuckets[static_cast<unsigned int>(fd) % BUCKET_COUNT];
+}
 
 /**
  * The specific signal chosen here is arbitrary.
@@ -48,6 +62,11 @@ static void blockedThreadSignalHandler(int /*signal*/) {
 }
 
 void AsynchronousSocketCloseMonitor::init() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        pthread_mutex_init(&blockedThreadBuckets[i].mutex, NULL);
+        blockedThreadBuckets[i].list = NULL;
+    }
+
     // Ensure that the signal we send interrupts system calls but doesn't kill threads.
     // Using sigaction(2) lets us ensure that the SA_RESTART flag is not set.
     // (The whole reason we're sending this signal is to unblock system calls!)
@@ -62,8 +81,9 @@ void AsynchronousSocketCloseMonitor::init() {
 }
 
 void AsynchronousSocketCloseMonitor::signalBlockedThreads(int fd) {
-    ScopedPthreadMutexLock lock(&blockedThreadListMutex);
-    for (AsynchronousSocketCloseMonitor* it = blockedThreadList; it != NULL; it = it->mNext) {
+    BlockedThreadBucket& bucket = bucketFor(fd);
+    ScopedPthreadMutexLock lock(&bucket.mutex);
+    for (AsynchronousSocketCloseMonitor* it = bucket.list; it != NULL; it = it->mNext) {
         if (it->mFd == fd) {
             pthread_kill(it->mThread, BLOCKED_THREAD_SIGNAL);
             // Keep going, because there may be more than one thread...
@@ -72,27 +92,29 @@ void AsynchronousSocketCloseMonitor::signalBlockedThreads(int fd) {
 }
 
 AsynchronousSocketCloseMonitor::AsynchronousSocketCloseMonitor(int fd) {
-    ScopedPthreadMutexLock lock(&blockedThreadListMutex);
+    BlockedThreadBucket& bucket = bucketFor(fd);
+    ScopedPthreadMutexLock lock(&bucket.mutex);
     // Who are we, and what are we waiting for?
     mThread = pthread_self();
     mFd = fd;
     // Insert ourselves at the head of the intrusive doubly-linked list...
     mPrev = NULL;
-    mNext = blockedThreadList;
+    mNext = bucket.list;
     if (mNext != NULL) {
         mNext->mPrev = this;
     }
-    blockedThreadList = this;
+    bucket.list = this;
 }
 
 AsynchronousSocketCloseMonitor::~AsynchronousSocketCloseMonitor() {
-    ScopedPthreadMutexLock lock(&blockedThreadListMutex);
+    BlockedThreadBucket& bucket = bucketFor(mFd);
+    ScopedPthreadMutexLock lock(&bucket.mutex);
     // Unlink ourselves from the intrusive doubly-linked list...
     if (mNext != NULL) {
         mNext->mPrev = mPrev;
     }
     if (mPrev == NULL) {
-        blockedThreadList = mNext;
+        bucket.list = mNext;
     } else {
         mPrev->mNext = mNext;
     }
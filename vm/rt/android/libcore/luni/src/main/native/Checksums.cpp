@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Checksums.h"
+#include "CpuFeatures.h"
+#include "zlib.h"
+
+#include <string.h>
+
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// Below this many bytes the setup costs of the vectorized implementations
+// outweigh their gains.
+static const size_t SIMD_MINIMUM_LENGTH = 64;
+
+/*
+ * Adler32. The vectorized versions process 32 byte blocks and reduce the
+ * sums modulo BASE at most every NMAX bytes, like zlib does. The leftovers
+ * are handed to zlib. Adapted from Chromium's zlib (adler32_simd.c).
+ */
+
+static const uint32_t BASE = 65521;
+static const uint32_t NMAX = 5552;
+static const size_t ADLER32_BLOCK_SIZE = 32;
+
+#if defined(CPU_FEATURES_X86)
+
+__attribute__((target("ssse3")))
+static uint32_t adler32Ssse3(uint32_t adler, const uint8_t* buf, size_t blocks) {
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    while (blocks > 0) {
+        size_t n = NMAX / ADLER32_BLOCK_SIZE;
+        if (n > blocks) {
+            n = blocks;
+        }
+        blocks -= n;
+
+        // v_ps accumulates s1 as it was at the start of each block. Each such
+        // s1 contributes 32 times to s2.
+        __m128i v_ps = _mm_set_epi32(0, 0, 0, s1 * n);
+        __m128i v_s2 = _mm_set_epi32(0, 0, 0, s2);
+        __m128i v_s1 = _mm_setzero_si128();
+        do {
+            const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+            const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            // Horizontal byte sums for s1, the bytes weighted by [32, 31, ..., 1] for s2.
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+            buf += ADLER32_BLOCK_SIZE;
+        } while (--n);
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += _mm_cvtsi128_si32(v_s1);
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = _mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return s1 | (s2 << 16);
+}
+
+#elif defined(__aarch64__)
+
+static uint32_t adler32Neon(uint32_t adler, const uint8_t* buf, size_t blocks) {
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+
+    static const uint16_t taps[32] = {
+        32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1
+    };
+
+    while (blocks > 0) {
+        size_t n = NMAX / ADLER32_BLOCK_SIZE;
+        if (n > blocks) {
+            n = blocks;
+        }
+        blocks -= n;
+
+        uint32x4_t v_s2 = vsetq_lane_u32(s1 * n, vdupq_n_u32(0), 3);
+        uint32x4_t v_s1 = vdupq_n_u32(0);
+        // Per column byte sums. At most 255 * NMAX / 32 so they fit in 16 bits.
+        uint16x8_t v_column_sum_1 = vdupq_n_u16(0);
+        uint16x8_t v_column_sum_2 = vdupq_n_u16(0);
+        uint16x8_t v_column_sum_3 = vdupq_n_u16(0);
+        uint16x8_t v_column_sum_4 = vdupq_n_u16(0);
+        do {
+            const uint8x16_t bytes1 = vld1q_u8(buf);
+            const uint8x16_t bytes2 = vld1q_u8(buf + 16);
+            v_s2 = vaddq_u32(v_s2, v_s1);
+            v_s1 = vpadalq_u16(v_s1, vpadalq_u8(vpaddlq_u8(bytes1), bytes2));
+            v_column_sum_1 = vaddw_u8(v_column_sum_1, vget_low_u8(bytes1));
+            v_column_sum_2 = vaddw_u8(v_column_sum_2, vget_high_u8(bytes1));
+            v_column_sum_3 = vaddw_u8(v_column_sum_3, vget_low_u8(bytes2));
+            v_column_sum_4 = vaddw_u8(v_column_sum_4, vget_high_u8(bytes2));
+            buf += ADLER32_BLOCK_SIZE;
+        } while (--n);
+        v_s2 = vshlq_n_u32(v_s2, 5);
+
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(v_column_sum_1), vld1_u16(taps + 0));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(v_column_sum_1), vld1_u16(taps + 4));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(v_column_sum_2), vld1_u16(taps + 8));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(v_column_sum_2), vld1_u16(taps + 12));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(v_column_sum_3), vld1_u16(taps + 16));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(v_column_sum_3), vld1_u16(taps + 20));
+        v_s2 = vmlal_u16(v_s2, vget_low_u16(v_column_sum_4), vld1_u16(taps + 24));
+        v_s2 = vmlal_u16(v_s2, vget_high_u16(v_column_sum_4), vld1_u16(taps + 28));
+
+        s1 += vaddvq_u32(v_s1);
+        s2 += vaddvq_u32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+    return s1 | (s2 << 16);
+}
+
+#endif
+
+uint32_t adler32Update(uint32_t adler, const uint8_t* buf, size_t len) {
+    if (len >= SIMD_MINIMUM_LENGTH) {
+        size_t blocks = len / ADLER32_BLOCK_SIZE;
+#if defined(CPU_FEATURES_X86)
+        if (cpuHasSsse3()) {
+            adler = adler32Ssse3(adler, buf, blocks);
+            buf += blocks * ADLER32_BLOCK_SIZE;
+            len -= blocks * ADLER32_BLOCK_SIZE;
+        }
+#elif defined(__aarch64__)
+        adler = adler32Neon(adler, buf, blocks);
+        buf += blocks * ADLER32_BLOCK_SIZE;
+        len -= blocks * ADLER32_BLOCK_SIZE;
+#else
+        (void) blocks;
+#endif
+    }
+    return adler32(adler, buf, len);
+}
+
+/*
+ * CRC32 (the zip/gzip polynomial). On x86 blocks of 64 bytes are folded
+ * using carry-less multiplication as described in Intel's "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ * Adapted from Chromium's zlib (crc32_simd.c). The constants are for the
+ * bit-reflected polynomial.
+ */
+
+#if defined(CPU_FEATURES_X86)
+
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32Pclmul(uint32_t crc, const uint8_t* buf, size_t len) {
+    // len must be a multiple of 16 and >= 64. crc is not inverted.
+    static const uint64_t k1k2[] __attribute__((aligned(16))) = { 0x0154442bd4, 0x01c6e41596 };
+    static const uint64_t k3k4[] __attribute__((aligned(16))) = { 0x01751997d0, 0x00ccaa009e };
+    static const uint64_t k5k0[] __attribute__((aligned(16))) = { 0x0163cd6124, 0x0000000000 };
+    static const uint64_t poly[] __attribute__((aligned(16))) = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+    x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+    x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+    x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    buf += 64;
+    len -= 64;
+
+    // Fold 4 x 128 bits in parallel.
+    while (len >= 64) {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        y5 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x00));
+        y6 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x10));
+        y7 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x20));
+        y8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 0x30));
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+        buf += 64;
+        len -= 64;
+    }
+
+    // Fold into 128 bits.
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    // Fold in the remaining blocks of 16 bytes.
+    while (len >= 16) {
+        x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        buf += 16;
+        len -= 16;
+    }
+
+    // Fold 128 bits into 64 bits.
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduce to 32 bits.
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return _mm_extract_epi32(x1, 1);
+}
+
+#endif
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* buf, size_t len) {
+#if defined(__ARM_FEATURE_CRC32)
+    crc = ~crc;
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = __crc32d(crc, v);
+    }
+    for (; len > 0; buf++, len--) {
+        crc = __crc32b(crc, *buf);
+    }
+    return ~crc;
+#else
+#if defined(CPU_FEATURES_X86)
+    if (len >= SIMD_MINIMUM_LENGTH && cpuHasPclmul()) {
+        size_t chunk = len & ~static_cast<size_t>(15);
+        crc = ~crc32Pclmul(~crc, buf, chunk);
+        buf += chunk;
+        len -= chunk;
+    }
+#endif
+    return crc32(crc, buf, len);
+#endif
+}
+
+/*
+ * CRC32C (the Castagnoli polynomial used by iSCSI, ext4, etc). Uses the
+ * SSE4.2 or ARMv8 crc32c instructions if available. Otherwise falls back
+ * to slicing-by-8 tables.
+ */
+
+#if defined(CPU_FEATURES_X86)
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32cSse42(uint32_t crc, const uint8_t* buf, size_t len) {
+    crc = ~crc;
+#if defined(__x86_64__)
+    uint64_t crc64 = crc;
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc64 = _mm_crc32_u64(crc64, v);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    for (; len >= 4; buf += 4, len -= 4) {
+        uint32_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = _mm_crc32_u32(crc, v);
+    }
+    for (; len > 0; buf++, len--) {
+        crc = _mm_crc32_u8(crc, *buf);
+    }
+    return ~crc;
+}
+
+#endif
+
+#if !defined(__ARM_FEATURE_CRC32)
+
+class Crc32cTables {
+public:
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        // The bit-reflected Castagnoli polynomial.
+        static const uint32_t POLY = 0x82f63b78;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++) {
+                crc = (crc >> 1) ^ ((crc & 1) ? POLY : 0);
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+            }
+        }
+    }
+};
+
+static const Crc32cTables crc32cTables;
+
+static uint32_t crc32cSlicingBy8(uint32_t crc, const uint8_t* buf, size_t len) {
+    const uint32_t (*t)[256] = crc32cTables.table;
+    crc = ~crc;
+    for (; len >= 8; buf += 8, len -= 8) {
+        // Assumes a little-endian CPU like all platforms we run on.
+        uint32_t lo;
+        uint32_t hi;
+        memcpy(&lo, buf, sizeof(lo));
+        memcpy(&hi, buf + 4, sizeof(hi));
+        lo ^= crc;
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    }
+    for (; len > 0; buf++, len--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *buf) & 0xff];
+    }
+    return ~crc;
+}
+
+#endif
+
+uint32_t crc32cUpdate(uint32_t crc, const uint8_t* buf, size_t len) {
+#if defined(__ARM_FEATURE_CRC32)
+    crc = ~crc;
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t v;
+        memcpy(&v, buf, sizeof(v));
+        crc = __crc32cd(crc, v);
+    }
+    for (; len > 0; buf++, len--) {
+        crc = __crc32cb(crc, *buf);
+    }
+    return ~crc;
+#else
+#if defined(CPU_FEATURES_X86)
+    if (cpuHasSse42()) {
+        return crc32cSse42(crc, buf, len);
+    }
+#endif
+    return crc32cSlicingBy8(crc, buf, len);
+#endif
+}
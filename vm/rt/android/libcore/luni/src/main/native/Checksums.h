@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHECKSUMS_H_included
+#define CHECKSUMS_H_included
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Checksums used by java.util.zip. Each function takes the checksum of the
+ * data seen so far (0 for CRC32 and CRC32C, 1 for Adler32 initially) and
+ * returns the checksum updated with len bytes from buf. The fastest
+ * implementation supported by the CPU is used.
+ */
+
+uint32_t adler32Update(uint32_t adler, const uint8_t* buf, size_t len);
+uint32_t crc32Update(uint32_t crc, const uint8_t* buf, size_t len);
+uint32_t crc32cUpdate(uint32_t crc, const uint8_t* buf, size_t len);
+
+#endif  // CHECKSUMS_H_included
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPU_FEATURES_H_included
+#define CPU_FEATURES_H_included
+
+/**
+ * Runtime detection of optional instruction set extensions. Code using an
+ * extension which isn't part of the baseline we compile for puts it in a
+ * function marked with __attribute__((target("..."))) and only calls that
+ * function if the corresponding check below returns true.
+ *
+ * SSE2 is part of the x86 baseline and NEON is part of the arm64 baseline
+ * (and available on all armv7 iOS devices) so there are no checks for them.
+ * The ARMv8 CRC32 instructions are only used if the compiler targets them
+ * (__ARM_FEATURE_CRC32 is defined) since there's no portable way to detect
+ * them at runtime on iOS.
+ */
+
+#if defined(__i386__) || defined(__x86_64__)
+#define CPU_FEATURES_X86 1
+
+static inline bool cpuHasAvx2() {
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+}
+
+static inline bool cpuHasSsse3() {
+    static const bool result = __builtin_cpu_supports("ssse3");
+    return result;
+}
+
+static inline bool cpuHasSse42() {
+    static const bool result = __builtin_cpu_supports("sse4.2");
+    return result;
+}
+
+// Carry-less multiplication. Also checks for SSE4.1 which is always used
+// together with it.
+static inline bool cpuHasPclmul() {
+    static const bool result = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+    return result;
+}
+
+#endif
+
+#endif  // CPU_FEATURES_H_included
@@ -107,6 +107,15 @@ extern "C" jdouble Java_java_lang_Math_expm1(JNIEnv*, jclass, jdouble a) {
     return expm1(a);
 }
 
+// RoboVM note: Added. fma() is overloaded so the long JNI names are used.
+extern "C" jdouble Java_java_lang_Math_fma__DDD(JNIEnv*, jclass, jdouble a, jdouble b, jdouble c) {
+    return fma(a, b, c);
+}
+
+extern "C" jfloat Java_java_lang_Math_fma__FFF(JNIEnv*, jclass, jfloat a, jfloat b, jfloat c) {
+    return fmaf(a, b, c);
+}
+
 extern "C" jdouble Java_java_lang_Math_hypot(JNIEnv*, jclass, jdouble a, jdouble b) {
     return hypot(a, b);
 }
@@ -16,95 +16,241 @@
 
 #define LOG_TAG "String"
 
+#include "CpuFeatures.h"
 #include "JNIHelp.h"
 #include "JniConstants.h"
 #include "ScopedPrimitiveArray.h"
 #include "jni.h"
 #include "unicode/utf16.h"
 
+#include <stdint.h>
 #include <string.h>
 
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/*
+ * RoboVM note: The conversions below are built from a few kernels which
+ * process the long runs of ASCII (or Latin-1) found in most text 16 or 32
+ * units at a time: SSE2 (x86 baseline), AVX2 (if the CPU has it) or NEON
+ * (arm64). Other targets use the scalar versions.
+ */
+
+static const jchar REPLACEMENT_CHAR = 0xfffd;
+
 /**
- * Approximates java.lang.UnsafeByteSequence so we don't have to pay the cost of calling back into
- * Java when converting a char[] to a UTF-8 byte[]. This lets us have UTF-8 conversions slightly
- * faster than ICU for large char[]s without paying for the NIO overhead with small char[]s.
- *
- * We could avoid this by keeping the UTF-8 bytes on the native heap until we're done and only
- * creating a byte[] on the Java heap when we know how big it needs to be, but one shouldn't lie
- * to the garbage collector (nor hide potentially large allocations from it).
- *
- * Because a call to append might require an allocation, it might fail. Callers should always
- * check the return value of append.
+ * Returns the number of leading bytes in src[0, n) which are ASCII.
  */
-class NativeUnsafeByteSequence {
-public:
-    NativeUnsafeByteSequence(JNIEnv* env)
-        : mEnv(env), mJavaArray(NULL), mRawArray(NULL), mSize(-1), mOffset(0)
-    {
+static size_t asciiPrefixLengthScalar(const uint8_t* src, size_t n, size_t i) {
+    while (i < n && src[i] < 0x80) {
+        i++;
     }
+    return i;
+}
 
-    ~NativeUnsafeByteSequence() {
-        // Release our pointer to the raw array, copying changes back to the Java heap.
-        if (mRawArray != NULL) {
-            mEnv->ReleaseByteArrayElements(mJavaArray, mRawArray, 0);
-        }
+/**
+ * Widens the bytes in src[0, n) to chars.
+ */
+static void widenBytesScalar(const uint8_t* src, jchar* dst, size_t n, size_t i) {
+    for (; i < n; i++) {
+        dst[i] = src[i];
+    }
+}
+
+/**
+ * Returns the number of leading chars in src[0, n) which are <= maxChar.
+ */
+static size_t charPrefixLengthScalar(const jchar* src, size_t n, jchar maxChar, size_t i) {
+    while (i < n && src[i] <= maxChar) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Narrows the chars in src[0, n), which must all be <= 0xff, to bytes.
+ */
+static void narrowCharsScalar(const jchar* src, uint8_t* dst, size_t n, size_t i) {
+    for (; i < n; i++) {
+        dst[i] = static_cast<uint8_t>(src[i]);
     }
+}
+
+#if defined(CPU_FEATURES_X86)
 
-    bool append(jbyte b) {
-        if (mOffset == mSize && !resize(mSize * 2)) {
-            return false;
+__attribute__((target("avx2")))
+static size_t asciiPrefixLengthAvx2(const uint8_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        uint32_t mask = _mm256_movemask_epi8(v);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
         }
-        mRawArray[mOffset++] = b;
-        return true;
     }
+    return asciiPrefixLengthScalar(src, n, i);
+}
+
+__attribute__((target("avx2")))
+static void widenBytesAvx2(const uint8_t* src, jchar* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtepu8_epi16(v));
+    }
+    widenBytesScalar(src, dst, n, i);
+}
 
-    bool resize(int newSize) {
-        if (newSize == mSize) {
-            return true;
+__attribute__((target("avx2")))
+static size_t charPrefixLengthAvx2(const jchar* src, size_t n, jchar maxChar) {
+    const __m256i invalidBits = _mm256_set1_epi16(static_cast<short>(~maxChar));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        if (!_mm256_testz_si256(v, invalidBits)) {
+            break;
         }
+    }
+    return charPrefixLengthScalar(src, n, maxChar, i);
+}
 
-        // Allocate a new array.
-        jbyteArray newJavaArray = mEnv->NewByteArray(newSize);
-        if (newJavaArray == NULL) {
-            return false;
+__attribute__((target("avx2")))
+static void narrowCharsAvx2(const jchar* src, uint8_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 16));
+        // packus works on 128-bit lanes. Put the quadwords back in order.
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), packed);
+    }
+    narrowCharsScalar(src, dst, n, i);
+}
+
+static size_t asciiPrefixLength(const uint8_t* src, size_t n) {
+    if (cpuHasAvx2()) {
+        return asciiPrefixLengthAvx2(src, n);
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        uint32_t mask = _mm_movemask_epi8(v);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
         }
-        jbyte* newRawArray = mEnv->GetByteArrayElements(newJavaArray, NULL);
-        if (newRawArray == NULL) {
-            return false;
+    }
+    return asciiPrefixLengthScalar(src, n, i);
+}
+
+static void widenBytes(const uint8_t* src, jchar* dst, size_t n) {
+    if (cpuHasAvx2()) {
+        widenBytesAvx2(src, dst, n);
+        return;
+    }
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+    widenBytesScalar(src, dst, n, i);
+}
+
+static size_t charPrefixLength(const jchar* src, size_t n, jchar maxChar) {
+    if (cpuHasAvx2()) {
+        return charPrefixLengthAvx2(src, n, maxChar);
+    }
+    const __m128i invalidBits = _mm_set1_epi16(static_cast<short>(~maxChar));
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, invalidBits), zero)) != 0xffff) {
+            break;
         }
+    }
+    return charPrefixLengthScalar(src, n, maxChar, i);
+}
 
-        // Copy data out of the old array and then let go of it.
-        // Note that we may be trimming the array.
-        if (mRawArray != NULL) {
-            memcpy(newRawArray, mRawArray, mOffset);
-            mEnv->ReleaseByteArrayElements(mJavaArray, mRawArray, JNI_ABORT);
-            mEnv->DeleteLocalRef(mJavaArray);
+static void narrowChars(const jchar* src, uint8_t* dst, size_t n) {
+    if (cpuHasAvx2()) {
+        narrowCharsAvx2(src, dst, n);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(a, b));
+    }
+    narrowCharsScalar(src, dst, n, i);
+}
+
+#elif defined(__aarch64__)
+
+static size_t asciiPrefixLength(const uint8_t* src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(src + i)) >= 0x80) {
+            break;
         }
+    }
+    return asciiPrefixLengthScalar(src, n, i);
+}
 
-        // Point ourselves at the new array.
-        mJavaArray = newJavaArray;
-        mRawArray = newRawArray;
-        mSize = newSize;
-        return true;
+static void widenBytes(const uint8_t* src, jchar* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        vst1q_u16(dst + i, vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(dst + i + 8, vmovl_high_u8(v));
     }
+    widenBytesScalar(src, dst, n, i);
+}
 
-    jbyteArray toByteArray() {
-        // Trim any unused space, if necessary.
-        bool okay = resize(mOffset);
-        return okay ? mJavaArray : NULL;
+static size_t charPrefixLength(const jchar* src, size_t n, jchar maxChar) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (vmaxvq_u16(vld1q_u16(src + i)) > maxChar) {
+            break;
+        }
     }
+    return charPrefixLengthScalar(src, n, maxChar, i);
+}
 
-private:
-    JNIEnv* mEnv;
-    jbyteArray mJavaArray;
-    jbyte* mRawArray;
-    jint mSize;
-    jint mOffset;
+static void narrowChars(const jchar* src, uint8_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x8_t a = vmovn_u16(vld1q_u16(src + i));
+        uint8x8_t b = vmovn_u16(vld1q_u16(src + i + 8));
+        vst1q_u8(dst + i, vcombine_u8(a, b));
+    }
+    narrowCharsScalar(src, dst, n, i);
+}
+
+#else
 
-    // Disallow copy and assignment.
-    NativeUnsafeByteSequence(const NativeUnsafeByteSequence&);
-    void operator=(const NativeUnsafeByteSequence&);
-};
+static size_t asciiPrefixLength(const uint8_t* src, size_t n) {
+    return asciiPrefixLengthScalar(src, n, 0);
+}
+
+static void widenBytes(const uint8_t* src, jchar* dst, size_t n) {
+    widenBytesScalar(src, dst, n, 0);
+}
+
+static size_t charPrefixLength(const jchar* src, size_t n, jchar maxChar) {
+    return charPrefixLengthScalar(src, n, maxChar, 0);
+}
+
+static void narrowChars(const jchar* src, uint8_t* dst, size_t n) {
+    narrowCharsScalar(src, dst, n, 0);
+}
+
+#endif
 
 extern "C" void Java_java_nio_charset_Charsets_asciiBytesToChars(JNIEnv* env, jclass, jbyteArray javaBytes, jint offset, jint length, jcharArray javaChars) {
     ScopedByteArrayRO bytes(env, javaBytes);
@@ -116,12 +262,16 @@ extern "C" void Java_java_nio_charset_Charsets_asciiBytesToChars(JNIEnv* env, jc
         return;
     }
 
-    const jbyte* src = &bytes[offset];
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&bytes[offset]);
     jchar* dst = &chars[0];
-    static const jchar REPLACEMENT_CHAR = 0xfffd;
-    for (int i = length - 1; i >= 0; --i) {
-        jchar ch = static_cast<jchar>(*src++ & 0xff);
-        *dst++ = (ch <= 0x7f) ? ch : REPLACEMENT_CHAR;
+    size_t i = 0;
+    while (i < static_cast<size_t>(length)) {
+        size_t n = asciiPrefixLength(src + i, length - i);
+        widenBytes(src + i, dst + i, n);
+        i += n;
+        if (i < static_cast<size_t>(length)) {
+            dst[i++] = REPLACEMENT_CHAR;
+        }
     }
 }
 
@@ -135,11 +285,89 @@ extern "C" void Java_java_nio_charset_Charsets_isoLatin1BytesToChars(JNIEnv* env
         return;
     }
 
-    const jbyte* src = &bytes[offset];
-    jchar* dst = &chars[0];
-    for (int i = length - 1; i >= 0; --i) {
-        *dst++ = static_cast<jchar>(*src++ & 0xff);
+    widenBytes(reinterpret_cast<const uint8_t*>(&bytes[offset]), &chars[0], length);
+}
+
+/**
+ * Decodes UTF-8 exactly like the decoder formerly inlined in String(byte[], int, int, Charset):
+ * malformed sequences, surrogates encoded on their own and values above U+10FFFF are replaced
+ * by U+FFFD while overlong forms are accepted. Returns the number of chars written to dst which
+ * is never more than length.
+ */
+static jint decodeUtf8(const uint8_t* src, jint length, jchar* dst) {
+    jint idx = 0;
+    jint s = 0;
+    while (idx < length) {
+        size_t n = asciiPrefixLength(src + idx, length - idx);
+        widenBytes(src + idx, dst + s, n);
+        idx += n;
+        s += n;
+
+        // Decode until we're back in ASCII.
+        while (idx < length && src[idx] >= 0x80) {
+            uint8_t b0 = src[idx++];
+            int utfCount;
+            if ((b0 & 0xe0) == 0xc0) {
+                utfCount = 1;
+            } else if ((b0 & 0xf0) == 0xe0) {
+                utfCount = 2;
+            } else if ((b0 & 0xf8) == 0xf0) {
+                utfCount = 3;
+            } else if ((b0 & 0xfc) == 0xf8) {
+                utfCount = 4;
+            } else if ((b0 & 0xfe) == 0xfc) {
+                utfCount = 5;
+            } else {
+                // Illegal values 0x8*, 0x9*, 0xa*, 0xb*, 0xfe-0xff
+                dst[s++] = REPLACEMENT_CHAR;
+                continue;
+            }
+            if (idx + utfCount > length) {
+                dst[s++] = REPLACEMENT_CHAR;
+                continue;
+            }
+
+            uint32_t val = b0 & (0x1f >> (utfCount - 1));
+            int i = 0;
+            for (; i < utfCount; ++i) {
+                uint8_t b = src[idx + i];
+                if ((b & 0xc0) != 0x80) {
+                    break;
+                }
+                val = (val << 6) | (b & 0x3f);
+            }
+            if (i < utfCount) {
+                // Consume the valid continuation bytes but not the byte which ended the sequence.
+                idx += i;
+                dst[s++] = REPLACEMENT_CHAR;
+                continue;
+            }
+            idx += utfCount;
+
+            // Surrogates may only be encoded using 3-byte sequences.
+            if ((utfCount != 2 && val >= 0xd800 && val <= 0xdfff) || val > 0x10ffff) {
+                dst[s++] = REPLACEMENT_CHAR;
+            } else if (val < 0x10000) {
+                dst[s++] = val;
+            } else {
+                dst[s++] = U16_LEAD(val);
+                dst[s++] = U16_TRAIL(val);
+            }
+        }
+    }
+    return s;
+}
+
+extern "C" jint Java_java_nio_charset_Charsets_utf8BytesToChars(JNIEnv* env, jclass, jbyteArray javaBytes, jint offset, jint length, jcharArray javaChars) {
+    ScopedByteArrayRO bytes(env, javaBytes);
+    if (bytes.get() == NULL) {
+        return 0;
+    }
+    ScopedCharArrayRW chars(env, javaChars);
+    if (chars.get() == NULL) {
+        return 0;
     }
+    return decodeUtf8(reinterpret_cast<const uint8_t*>(&bytes[offset]), length, &chars[0]);
 }
 
 /**
@@ -160,13 +388,15 @@ static jbyteArray charsToBytes(JNIEnv* env, jcharArray javaChars, jint offset, j
     }
 
     const jchar* src = &chars[offset];
-    jbyte* dst = &bytes[0];
-    for (int i = length - 1; i >= 0; --i) {
-        jchar ch = *src++;
-        if (ch > maxValidChar) {
-            ch = '?';
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&bytes[0]);
+    size_t i = 0;
+    while (i < static_cast<size_t>(length)) {
+        size_t n = charPrefixLength(src + i, length - i, maxValidChar);
+        narrowChars(src + i, dst + i, n);
+        i += n;
+        if (i < static_cast<size_t>(length)) {
+            dst[i++] = '?';
         }
-        *dst++ = static_cast<jbyte>(ch);
     }
 
     return javaBytes;
@@ -180,61 +410,92 @@ extern "C" jbyteArray Java_java_nio_charset_Charsets_toIsoLatin1Bytes(JNIEnv* en
     return charsToBytes(env, javaChars, offset, length, 0xff);
 }
 
+/**
+ * Returns true if src[i] starts a valid surrogate pair.
+ */
+static inline bool isSurrogatePair(const jchar* src, size_t n, size_t i) {
+    return U16_IS_SURROGATE_LEAD(src[i]) && i + 1 < n && U16_IS_SURROGATE_TRAIL(src[i + 1]);
+}
+
+/**
+ * Returns the exact number of bytes needed to encode src[0, n) as UTF-8. Unpaired surrogates
+ * are encoded as '?'.
+ */
+static size_t utf8Length(const jchar* src, size_t n) {
+    size_t length = 0;
+    size_t i = 0;
+    while (i < n) {
+        size_t ascii = charPrefixLength(src + i, n - i, 0x7f);
+        length += ascii;
+        i += ascii;
+        while (i < n && src[i] >= 0x80) {
+            jchar ch = src[i++];
+            if (ch < 0x800) {
+                length += 2;
+            } else if (!U16_IS_SURROGATE(ch)) {
+                length += 3;
+            } else if (isSurrogatePair(src, n, i - 1)) {
+                length += 4;
+                i++;
+            } else {
+                length += 1;
+            }
+        }
+    }
+    return length;
+}
+
 extern "C" jbyteArray Java_java_nio_charset_Charsets_toUtf8Bytes(JNIEnv* env, jclass, jcharArray javaChars, jint offset, jint length) {
     ScopedCharArrayRO chars(env, javaChars);
     if (chars.get() == NULL) {
         return NULL;
     }
 
-    NativeUnsafeByteSequence out(env);
-    if (!out.resize(length)) {
+    // RoboVM note: Android appends to a buffer which doubles in size when full and is trimmed
+    // at the end. We compute the exact length first and allocate the result just once.
+    const jchar* src = &chars[offset];
+    size_t n = length;
+    size_t byteCount = utf8Length(src, n);
+    if (byteCount > 0x7fffffff) {
+        jniThrowException(env, "java/lang/OutOfMemoryError", "UTF-8 encoding too long");
+        return NULL;
+    }
+    jbyteArray javaBytes = env->NewByteArray(byteCount);
+    ScopedByteArrayRW bytes(env, javaBytes);
+    if (bytes.get() == NULL) {
         return NULL;
     }
 
-    const int end = offset + length;
-    for (int i = offset; i < end; ++i) {
-        jint ch = chars[i];
-        if (ch < 0x80) {
-            // One byte.
-            if (!out.append(ch)) {
-                return NULL;
-            }
-        } else if (ch < 0x800) {
-            // Two bytes.
-            if (!out.append((ch >> 6) | 0xc0) || !out.append((ch & 0x3f) | 0x80)) {
-                return NULL;
-            }
-        } else if (U16_IS_SURROGATE(ch)) {
-            // A supplementary character.
-            jchar high = (jchar) ch;
-            jchar low = (i + 1 != end) ? chars[i + 1] : 0;
-            if (!U16_IS_SURROGATE_LEAD(high) || !U16_IS_SURROGATE_TRAIL(low)) {
-                if (!out.append('?')) {
-                    return NULL;
-                }
-                continue;
-            }
-            // Now we know we have a *valid* surrogate pair, we can consume the low surrogate.
-            ++i;
-            ch = U16_GET_SUPPLEMENTARY(high, low);
-            // Four bytes.
-            jbyte b1 = (ch >> 18) | 0xf0;
-            jbyte b2 = ((ch >> 12) & 0x3f) | 0x80;
-            jbyte b3 = ((ch >> 6) & 0x3f) | 0x80;
-            jbyte b4 = (ch & 0x3f) | 0x80;
-            if (!out.append(b1) || !out.append(b2) || !out.append(b3) || !out.append(b4)) {
-                return NULL;
-            }
-        } else {
-            // Three bytes.
-            jbyte b1 = (ch >> 12) | 0xe0;
-            jbyte b2 = ((ch >> 6) & 0x3f) | 0x80;
-            jbyte b3 = (ch & 0x3f) | 0x80;
-            if (!out.append(b1) || !out.append(b2) || !out.append(b3)) {
-                return NULL;
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&bytes[0]);
+    size_t i = 0;
+    while (i < n) {
+        size_t ascii = charPrefixLength(src + i, n - i, 0x7f);
+        narrowChars(src + i, dst, ascii);
+        dst += ascii;
+        i += ascii;
+        while (i < n && src[i] >= 0x80) {
+            uint32_t ch = src[i++];
+            if (ch < 0x800) {
+                // Two bytes.
+                *dst++ = (ch >> 6) | 0xc0;
+                *dst++ = (ch & 0x3f) | 0x80;
+            } else if (!U16_IS_SURROGATE(ch)) {
+                // Three bytes.
+                *dst++ = (ch >> 12) | 0xe0;
+                *dst++ = ((ch >> 6) & 0x3f) | 0x80;
+                *dst++ = (ch & 0x3f) | 0x80;
+            } else if (isSurrogatePair(src, n, i - 1)) {
+                // A supplementary character. Four bytes.
+                ch = U16_GET_SUPPLEMENTARY(ch, src[i]);
+                i++;
+                *dst++ = (ch >> 18) | 0xf0;
+                *dst++ = ((ch >> 12) & 0x3f) | 0x80;
+                *dst++ = ((ch >> 6) & 0x3f) | 0x80;
+                *dst++ = (ch & 0x3f) | 0x80;
+            } else {
+                *dst++ = '?';
             }
         }
     }
-    return out.toByteArray();
+    return javaBytes;
 }
-
@@ -17,22 +17,25 @@
 
 #define LOG_TAG "Adler32"
 
+#include "Checksums.h"
 #include "JNIHelp.h"
 #include "JniConstants.h"
 #include "ScopedPrimitiveArray.h"
 #include "jni.h"
-#include "zlib.h"
 
 extern "C" jlong Java_java_util_zip_Adler32_updateImpl(JNIEnv* env, jobject, jbyteArray byteArray, int off, int len, jlong crc) {
     ScopedByteArrayRO bytes(env, byteArray);
     if (bytes.get() == NULL) {
         return 0;
     }
-    return adler32(crc, reinterpret_cast<const Bytef*>(bytes.get() + off), len);
+    return adler32Update(crc, reinterpret_cast<const uint8_t*>(bytes.get() + off), len);
 }
 
-extern "C" jlong Java_java_util_zip_Adler32_updateByteImpl(JNIEnv*, jobject, jint val, jlong crc) {
-    Bytef bytefVal = val;
-    return adler32(crc, reinterpret_cast<const Bytef*>(&bytefVal), 1);
+extern "C" jlong Java_java_util_zip_Adler32_updateByteBufferImpl(JNIEnv* env, jobject, jobject buffer, int off, int len, jlong crc) {
+    const uint8_t* address = reinterpret_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    if (address == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "not a direct buffer");
+        return 0;
+    }
+    return adler32Update(crc, address + off, len);
 }
-
@@ -17,22 +17,25 @@
 
 #define LOG_TAG "CRC32"
 
+#include "Checksums.h"
 #include "JNIHelp.h"
 #include "JniConstants.h"
 #include "ScopedPrimitiveArray.h"
 #include "jni.h"
-#include "zlib.h"
 
 extern "C" jlong Java_java_util_zip_CRC32_updateImpl(JNIEnv* env, jobject, jbyteArray byteArray, int off, int len, jlong crc) {
     ScopedByteArrayRO bytes(env, byteArray);
     if (bytes.get() == NULL) {
         return 0;
     }
-    jlong result = crc32(crc, reinterpret_cast<const Bytef*>(bytes.get() + off), len);
-    return result;
+    return crc32Update(crc, reinterpret_cast<const uint8_t*>(bytes.get() + off), len);
 }
 
-extern "C" jlong Java_java_util_zip_CRC32_updateByteImpl(JNIEnv*, jobject, jbyte val, jlong crc) {
-    return crc32(crc, reinterpret_cast<const Bytef*>(&val), 1);
+extern "C" jlong Java_java_util_zip_CRC32_updateByteBufferImpl(JNIEnv* env, jobject, jobject buffer, int off, int len, jlong crc) {
+    const uint8_t* address = reinterpret_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    if (address == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "not a direct buffer");
+        return 0;
+    }
+    return crc32Update(crc, address + off, len);
 }
-
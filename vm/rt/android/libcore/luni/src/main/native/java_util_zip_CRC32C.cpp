@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CRC32C"
+
+#include "Checksums.h"
+#include "JNIHelp.h"
+#include "JniConstants.h"
+#include "ScopedPrimitiveArray.h"
+#include "jni.h"
+
+extern "C" jlong Java_java_util_zip_CRC32C_updateImpl(JNIEnv* env, jobject, jbyteArray byteArray, int off, int len, jlong crc) {
+    ScopedByteArrayRO bytes(env, byteArray);
+    if (bytes.get() == NULL) {
+        return 0;
+    }
+    return crc32cUpdate(crc, reinterpret_cast<const uint8_t*>(bytes.get() + off), len);
+}
+
+extern "C" jlong Java_java_util_zip_CRC32C_updateByteBufferImpl(JNIEnv* env, jobject, jobject buffer, int off, int len, jlong crc) {
+    const uint8_t* address = reinterpret_cast<const uint8_t*>(env->GetDirectBufferAddress(buffer));
+    if (address == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "not a direct buffer");
+        return 0;
+    }
+    return crc32cUpdate(crc, address + off, len);
+}
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2015 RoboVM AB
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "IoUring"
+
+#include "JNIHelp.h"
+#include "JniConstants.h"
+#include "ScopedLocalRef.h"
+#include "ScopedPrimitiveArray.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if !defined(__APPLE__)
+#include <linux/io_uring.h>
+
+// Older libcs don't know about io_uring. The syscall numbers are the same on
+// all architectures.
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+static void throwErrnoException(JNIEnv* env, const char* functionName, int error) {
+    static jmethodID ctor = env->GetMethodID(JniConstants::errnoExceptionClass,
+            "<init>", "(Ljava/lang/String;I)V");
+    ScopedLocalRef<jstring> detailMessage(env, env->NewStringUTF(functionName));
+    if (detailMessage.get() == NULL) {
+        return;
+    }
+    jobject exception = env->NewObject(JniConstants::errnoExceptionClass, ctor, detailMessage.get(), error);
+    env->Throw(reinterpret_cast<jthrowable>(exception));
+}
+
+#if !defined(__APPLE__)
+
+/**
+ * The submission and completion queues of an io_uring instance as mapped
+ * into our address space. The submission queue is only ever modified by
+ * one thread at a time (IoUring.java serializes submissions) and the
+ * completion queue is only ever consumed by one thread at a time.
+ */
+struct Ring {
+    int fd;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned* sqArray;
+    io_uring_sqe* sqes;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+};
+
+static void unmapRing(Ring* ring) {
+    if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+        munmap(ring->sqes, ring->sqesSize);
+    }
+    if (ring->cqRing != NULL && ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing) {
+        munmap(ring->cqRing, ring->cqRingSize);
+    }
+    if (ring->sqRing != NULL && ring->sqRing != MAP_FAILED) {
+        munmap(ring->sqRing, ring->sqRingSize);
+    }
+    close(ring->fd);
+}
+
+/**
+ * Sets up a new io_uring with (at least) the specified number of
+ * submission queue entries. Returns NULL and sets errno on failure.
+ */
+static Ring* setupRing(unsigned entries) {
+    io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (fd == -1) {
+        return NULL;
+    }
+    // IORING_OP_READ and IORING_OP_WRITE were added in the same kernel
+    // release (5.6) as IORING_FEAT_RW_CUR_POS.
+    if ((p.features & IORING_FEAT_RW_CUR_POS) == 0) {
+        close(fd);
+        errno = ENOSYS;
+        return NULL;
+    }
+
+    Ring* ring = reinterpret_cast<Ring*>(calloc(1, sizeof(Ring)));
+    if (ring == NULL) {
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+    ring->fd = fd;
+    ring->sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cqRingSize > ring->sqRingSize) {
+            ring->sqRingSize = ring->cqRingSize;
+        }
+        ring->cqRingSize = ring->sqRingSize;
+    }
+    ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            fd, IORING_OFF_SQ_RING);
+    if (ring->sqRing == MAP_FAILED) {
+        int error = errno;
+        unmapRing(ring);
+        free(ring);
+        errno = error;
+        return NULL;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cqRing = ring->sqRing;
+    } else {
+        ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                fd, IORING_OFF_CQ_RING);
+    }
+    ring->sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+    if (ring->cqRing != MAP_FAILED) {
+        ring->sqes = reinterpret_cast<io_uring_sqe*>(mmap(NULL, ring->sqesSize,
+                PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    }
+    if (ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED) {
+        int error = errno;
+        unmapRing(ring);
+        free(ring);
+        errno = error;
+        return NULL;
+    }
+
+    char* sq = reinterpret_cast<char*>(ring->sqRing);
+    ring->sqHead = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    ring->sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    ring->sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    ring->sqEntries = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_entries);
+    ring->sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    char* cq = reinterpret_cast<char*>(ring->cqRing);
+    ring->cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    ring->cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    ring->cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return ring;
+}
+
+/**
+ * Returns the next free submission queue entry, cleared, or NULL if the
+ * submission queue is full. The entry is handed to the kernel by
+ * publishSqe().
+ */
+static io_uring_sqe* nextSqe(Ring* ring) {
+    unsigned head = __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *ring->sqTail;
+    if (tail - head >= ring->sqEntries) {
+        return NULL;
+    }
+    io_uring_sqe* sqe = &ring->sqes[tail & ring->sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+static void publishSqe(Ring* ring, io_uring_sqe* sqe) {
+    unsigned tail = *ring->sqTail;
+    ring->sqArray[tail & ring->sqMask] = sqe - ring->sqes;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Submits all published entries if submit is true and, if minComplete > 0,
+ * waits until at least that many completions are available. Only the
+ * thread preparing entries may submit them. Returns the number of entries
+ * submitted or -1 and sets errno.
+ */
+static int enterRing(Ring* ring, bool submit, unsigned minComplete) {
+    unsigned toSubmit = submit ? *ring->sqTail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) : 0;
+    unsigned flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    if (toSubmit == 0 && flags == 0) {
+        return 0;
+    }
+    return syscall(__NR_io_uring_enter, ring->fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+/**
+ * Copies up to count completions to userData/results and consumes them.
+ * Never blocks. Returns the number of completions copied.
+ */
+static int reapRing(Ring* ring, jlong* userData, jint* results, int count) {
+    unsigned head = *ring->cqHead;
+    unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+    int n = 0;
+    while (head != tail && n < count) {
+        io_uring_cqe* cqe = &ring->cqes[head & ring->cqMask];
+        userData[n] = cqe->user_data;
+        results[n] = cqe->res;
+        n++;
+        head++;
+    }
+    __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+#endif
+
+// RoboVM note: Darwin doesn't have io_uring. IoUring.isSupported() returns
+// false there and the natives fail with ENOSYS.
+
+extern "C" jboolean Java_libcore_io_IoUring_probe(JNIEnv*, jclass) {
+#if !defined(__APPLE__)
+    Ring* ring = setupRing(1);
+    if (ring == NULL) {
+        // ENOSYS on old kernels, EPERM if io_uring has been disabled by
+        // seccomp or the io_uring_disabled sysctl.
+        return JNI_FALSE;
+    }
+    unmapRing(ring);
+    free(ring);
+    return JNI_TRUE;
+#else
+    return JNI_FALSE;
+#endif
+}
+
+extern "C" jlong Java_libcore_io_IoUring_setup(JNIEnv* env, jclass, jint entries) {
+#if !defined(__APPLE__)
+    Ring* ring = setupRing(entries);
+    if (ring == NULL) {
+        throwErrnoException(env, "io_uring_setup", errno);
+        return 0;
+    }
+    return reinterpret_cast<uintptr_t>(ring);
+#else
+    throwErrnoException(env, "io_uring_setup", ENOSYS);
+    return 0;
+#endif
+}
+
+extern "C" void Java_libcore_io_IoUring_destroy(JNIEnv*, jclass, jlong javaRing) {
+#if !defined(__APPLE__)
+    Ring* ring = reinterpret_cast<Ring*>(static_cast<uintptr_t>(javaRing));
+    unmapRing(ring);
+    free(ring);
+#endif
+}
+
+extern "C" jint Java_libcore_io_IoUring_capacity(JNIEnv*, jclass, jlong javaRing) {
+#if !defined(__APPLE__)
+    Ring* ring = reinterpret_cast<Ring*>(static_cast<uintptr_t>(javaRing));
+    return ring->sqEntries;
+#else
+    return 0;
+#endif
+}
+
+extern "C" jboolean Java_libcore_io_IoUring_prepareRw(JNIEnv* env, jclass, jlong javaRing, jint opcode,
+        jobject javaFd, jobject javaBuffer, jint position, jint byteCount, jlong offset, jlong userData) {
+#if !defined(__APPLE__)
+    Ring* ring = reinterpret_cast<Ring*>(static_cast<uintptr_t>(javaRing));
+    char* address = reinterpret_cast<char*>(env->GetDirectBufferAddress(javaBuffer));
+    if (address == NULL) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "not a direct buffer");
+        return JNI_FALSE;
+    }
+    io_uring_sqe* sqe = nextSqe(ring);
+    if (sqe == NULL) {
+        return JNI_FALSE;
+    }
+    sqe->opcode = opcode;
+    sqe->fd = jniGetFDFromFileDescriptor(env, javaFd);
+    sqe->addr = reinterpret_cast<uintptr_t>(address + position);
+    sqe->len = byteCount;
+    sqe->off = offset;
+    sqe->user_data = userData;
+    publishSqe(ring, sqe);
+    return JNI_TRUE;
+#else
+    throwErrnoException(env, "io_uring_enter", ENOSYS);
+    return JNI_FALSE;
+#endif
+}
+
+extern "C" jint Java_libcore_io_IoUring_enter(JNIEnv* env, jclass, jlong javaRing, jboolean submit,
+        jint minComplete) {
+#if !defined(__APPLE__)
+    Ring* ring = reinterpret_cast<Ring*>(static_cast<uintptr_t>(javaRing));
+    int rc = enterRing(ring, submit, minComplete);
+    if (rc == -1) {
+        if (errno == EINTR) {
+            // Nothing was submitted. The caller will retry.
+            return 0;
+        }
+        throwErrnoException(env, "io_uring_enter", errno);
+    }
+    return rc;
+#else
+    throwErrnoException(env, "io_uring_enter", ENOSYS);
+    return -1;
+#endif
+}
+
+extern "C" jint Java_libcore_io_IoUring_reap(JNIEnv* env, jclass, jlong javaRing,
+        jlongArray javaUserData, jintArray javaResults) {
+#if !defined(__APPLE__)
+    Ring* ring = reinterpret_cast<Ring*>(static_cast<uintptr_t>(javaRing));
+    ScopedLongArrayRW userData(env, javaUserData);
+    if (userData.get() == NULL) {
+        return -1;
+    }
+    ScopedIntArrayRW results(env, javaResults);
+    if (results.get() == NULL) {
+        return -1;
+    }
+    int count = userData.size() < results.size() ? userData.size() : results.size();
+    return reapRing(ring, userData.get(), results.get(), count);
+#else
+    return 0;
+#endif
+}
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "Memory"
 
+#include "CpuFeatures.h"
 #include "JNIHelp.h"
 #include "JniConstants.h"
 #include "Portability.h"
@@ -28,6 +29,12 @@
 #include <string.h>
 #include <sys/mman.h>
 
+#if defined(CPU_FEATURES_X86)
+#include <immintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #if defined(__arm__)
 // 32-bit ARM has load/store alignment restrictions for longs.
 #define LONG_ALIGNMENT_MASK 0x3
@@ -66,6 +73,89 @@ template <typename T> static T cast(jlong address) {
     return reinterpret_cast<T>(static_cast<uintptr_t>(address));
 }
 
+// Vectorized byte swapping of 2, 4 or 8 byte elements. Swaps whole 16 (or 32)
+// byte blocks and returns the number of bytes processed. The caller swaps
+// whatever is left using the scalar loops below. The vector loads and stores
+// don't care about alignment.
+#if defined(CPU_FEATURES_X86)
+
+static const uint8_t SWAP_SHUFFLES[3][16] __attribute__((aligned(16))) = {
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+};
+
+static inline const uint8_t* swapShuffleFor(size_t elementSize) {
+    return SWAP_SHUFFLES[elementSize == 2 ? 0 : (elementSize == 4 ? 1 : 2)];
+}
+
+__attribute__((target("ssse3")))
+static size_t swapBytesSsse3(uint8_t* dst, const uint8_t* src, size_t byteCount, size_t elementSize) {
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffleFor(elementSize)));
+    size_t i = 0;
+    for (; i + 16 <= byteCount; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, shuffle));
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+static size_t swapBytesAvx2(uint8_t* dst, const uint8_t* src, size_t byteCount, size_t elementSize) {
+    // vpshufb shuffles within each 128-bit lane so the same mask is used for both lanes.
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffleFor(elementSize))));
+    size_t i = 0;
+    for (; i + 32 <= byteCount; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(v, shuffle));
+    }
+    return i;
+}
+
+static inline size_t swapBytesVectorized(void* dst, const void* src, size_t byteCount, size_t elementSize) {
+    uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+    size_t done = 0;
+    if (byteCount >= 64 && cpuHasAvx2()) {
+        done = swapBytesAvx2(d, s, byteCount, elementSize);
+    }
+    if (byteCount - done >= 16 && cpuHasSsse3()) {
+        done += swapBytesSsse3(d + done, s + done, byteCount - done, elementSize);
+    }
+    return done;
+}
+
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+
+static inline size_t swapBytesVectorized(void* dst, const void* src, size_t byteCount, size_t elementSize) {
+    uint8_t* d = reinterpret_cast<uint8_t*>(dst);
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(src);
+    size_t i = 0;
+    if (elementSize == 2) {
+        for (; i + 16 <= byteCount; i += 16) {
+            vst1q_u8(d + i, vrev16q_u8(vld1q_u8(s + i)));
+        }
+    } else if (elementSize == 4) {
+        for (; i + 16 <= byteCount; i += 16) {
+            vst1q_u8(d + i, vrev32q_u8(vld1q_u8(s + i)));
+        }
+    } else {
+        for (; i + 16 <= byteCount; i += 16) {
+            vst1q_u8(d + i, vrev64q_u8(vld1q_u8(s + i)));
+        }
+    }
+    return i;
+}
+
+#else
+
+static inline size_t swapBytesVectorized(void*, const void*, size_t, size_t) {
+    return 0;
+}
+
+#endif
+
 // Byte-swap 2 jshort values packed in a jint.
 static inline jint bswap_2x16(jint v) {
     // v is initially ABCD
@@ -79,6 +169,11 @@ static inline jint bswap_2x16(jint v) {
 }
 
 static inline void swapShorts(jshort* dstShorts, const jshort* srcShorts, size_t count) {
+    size_t vectorized = swapBytesVectorized(dstShorts, srcShorts, count * 2, 2) / 2;
+    dstShorts += vectorized;
+    srcShorts += vectorized;
+    count -= vectorized;
+
     // Do 32-bit swaps as long as possible...
     jint* dst = reinterpret_cast<jint*>(dstShorts);
     const jint* src = reinterpret_cast<const jint*>(srcShorts);
@@ -107,6 +202,11 @@ static inline void swapShorts(jshort* dstShorts, const jshort* srcShorts, size_t
 }
 
 static inline void swapInts(jint* dstInts, const jint* srcInts, size_t count) {
+    size_t vectorized = swapBytesVectorized(dstInts, srcInts, count * 4, 4) / 4;
+    dstInts += vectorized;
+    srcInts += vectorized;
+    count -= vectorized;
+
     if ((reinterpret_cast<uintptr_t>(dstInts) & INT_ALIGNMENT_MASK) == 0 &&
         (reinterpret_cast<uintptr_t>(srcInts) & INT_ALIGNMENT_MASK) == 0) {
         for (size_t i = 0; i < count; ++i) {
@@ -122,6 +222,11 @@ static inline void swapInts(jint* dstInts, const jint* srcInts, size_t count) {
 }
 
 static inline void swapLongs(jlong* dstLongs, const jlong* srcLongs, size_t count) {
+    size_t vectorized = swapBytesVectorized(dstLongs, srcLongs, count * 8, 8) / 8;
+    dstLongs += vectorized;
+    srcLongs += vectorized;
+    count -= vectorized;
+
     jint* dst = reinterpret_cast<jint*>(dstLongs);
     const jint* src = reinterpret_cast<const jint*>(srcLongs);
     if ((reinterpret_cast<uintptr_t>(dstLongs) & INT_ALIGNMENT_MASK) == 0 &&
@@ -24,12 +24,17 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <netinet/udp.h>
 #include <poll.h>
 #include <signal.h>
 #include <stdlib.h>
 #if !defined(__APPLE__)
 // RoboVM note: Darwin doesn't have sys/capability.h
 #include <sys/capability.h>
+// RoboVM note: Darwin doesn't have sys/epoll.h
+#include <sys/epoll.h>
+// RoboVM note: Darwin doesn't have sys/eventfd.h
+#include <sys/eventfd.h>
 #endif
 #include <sys/ioctl.h>
 #include <sys/mman.h>
@@ -137,6 +142,12 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "EEXIST", EEXIST);
     initConstant(env, c, "EFAULT", EFAULT);
     initConstant(env, c, "EFBIG", EFBIG);
+// RoboVM note: Darwin doesn't have eventfd
+#if !defined(__APPLE__)
+    initConstant(env, c, "EFD_CLOEXEC", EFD_CLOEXEC);
+    initConstant(env, c, "EFD_NONBLOCK", EFD_NONBLOCK);
+    initConstant(env, c, "EFD_SEMAPHORE", EFD_SEMAPHORE);
+#endif
     initConstant(env, c, "EHOSTUNREACH", EHOSTUNREACH);
     initConstant(env, c, "EIDRM", EIDRM);
     initConstant(env, c, "EILSEQ", EILSEQ);
@@ -181,6 +192,19 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "EOVERFLOW", EOVERFLOW);
     initConstant(env, c, "EPERM", EPERM);
     initConstant(env, c, "EPIPE", EPIPE);
+// RoboVM note: Darwin doesn't have epoll
+#if !defined(__APPLE__)
+    initConstant(env, c, "EPOLLERR", EPOLLERR);
+    initConstant(env, c, "EPOLLET", EPOLLET);
+    initConstant(env, c, "EPOLLHUP", EPOLLHUP);
+    initConstant(env, c, "EPOLLIN", EPOLLIN);
+    initConstant(env, c, "EPOLLOUT", EPOLLOUT);
+    initConstant(env, c, "EPOLLRDHUP", EPOLLRDHUP);
+    initConstant(env, c, "EPOLL_CLOEXEC", EPOLL_CLOEXEC);
+    initConstant(env, c, "EPOLL_CTL_ADD", EPOLL_CTL_ADD);
+    initConstant(env, c, "EPOLL_CTL_DEL", EPOLL_CTL_DEL);
+    initConstant(env, c, "EPOLL_CTL_MOD", EPOLL_CTL_MOD);
+#endif
     initConstant(env, c, "EPROTO", EPROTO);
     initConstant(env, c, "EPROTONOSUPPORT", EPROTONOSUPPORT);
     initConstant(env, c, "EPROTOTYPE", EPROTOTYPE);
@@ -199,6 +223,10 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "EXIT_FAILURE", EXIT_FAILURE);
     initConstant(env, c, "EXIT_SUCCESS", EXIT_SUCCESS);
     initConstant(env, c, "FD_CLOEXEC", FD_CLOEXEC);
+// RoboVM note: FIONBIO doesn't fit in a jint on Darwin
+#if !defined(__APPLE__)
+    initConstant(env, c, "FIONBIO", FIONBIO);
+#endif
     initConstant(env, c, "FIONREAD", FIONREAD);
     initConstant(env, c, "F_DUPFD", F_DUPFD);
     initConstant(env, c, "F_GETFD", F_GETFD);
@@ -301,11 +329,15 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "MCL_FUTURE", MCL_FUTURE);
     initConstant(env, c, "MSG_CTRUNC", MSG_CTRUNC);
     initConstant(env, c, "MSG_DONTROUTE", MSG_DONTROUTE);
+    initConstant(env, c, "MSG_DONTWAIT", MSG_DONTWAIT);
     initConstant(env, c, "MSG_EOR", MSG_EOR);
     initConstant(env, c, "MSG_OOB", MSG_OOB);
     initConstant(env, c, "MSG_PEEK", MSG_PEEK);
     initConstant(env, c, "MSG_TRUNC", MSG_TRUNC);
     initConstant(env, c, "MSG_WAITALL", MSG_WAITALL);
+#if defined(MSG_WAITFORONE)
+    initConstant(env, c, "MSG_WAITFORONE", MSG_WAITFORONE);
+#endif
     initConstant(env, c, "MS_ASYNC", MS_ASYNC);
     initConstant(env, c, "MS_INVALIDATE", MS_INVALIDATE);
     initConstant(env, c, "MS_SYNC", MS_SYNC);
@@ -392,7 +424,14 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "SIOCGIFBRDADDR", SIOCGIFBRDADDR);
     initConstant(env, c, "SIOCGIFDSTADDR", SIOCGIFDSTADDR);
     initConstant(env, c, "SIOCGIFNETMASK", SIOCGIFNETMASK);
+// RoboVM note: Darwin doesn't have SOCK_CLOEXEC or SOCK_NONBLOCK
+#if !defined(__APPLE__)
+    initConstant(env, c, "SOCK_CLOEXEC", SOCK_CLOEXEC);
+#endif
     initConstant(env, c, "SOCK_DGRAM", SOCK_DGRAM);
+#if !defined(__APPLE__)
+    initConstant(env, c, "SOCK_NONBLOCK", SOCK_NONBLOCK);
+#endif
     initConstant(env, c, "SOCK_RAW", SOCK_RAW);
     initConstant(env, c, "SOCK_SEQPACKET", SOCK_SEQPACKET);
     initConstant(env, c, "SOCK_STREAM", SOCK_STREAM);
@@ -417,6 +456,12 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "SO_SNDLOWAT", SO_SNDLOWAT);
     initConstant(env, c, "SO_SNDTIMEO", SO_SNDTIMEO);
     initConstant(env, c, "SO_TYPE", SO_TYPE);
+// RoboVM note: Darwin doesn't have splice
+#if !defined(__APPLE__)
+    initConstant(env, c, "SPLICE_F_MORE", SPLICE_F_MORE);
+    initConstant(env, c, "SPLICE_F_MOVE", SPLICE_F_MOVE);
+    initConstant(env, c, "SPLICE_F_NONBLOCK", SPLICE_F_NONBLOCK);
+#endif
     initConstant(env, c, "STDERR_FILENO", STDERR_FILENO);
     initConstant(env, c, "STDIN_FILENO", STDIN_FILENO);
     initConstant(env, c, "STDOUT_FILENO", STDOUT_FILENO);
@@ -444,6 +489,13 @@ extern "C" void Java_libcore_io_OsConstants_initConstants(JNIEnv* env, jclass c)
     initConstant(env, c, "S_IXOTH", S_IXOTH);
     initConstant(env, c, "S_IXUSR", S_IXUSR);
     initConstant(env, c, "TCP_NODELAY", TCP_NODELAY);
+// RoboVM note: UDP GSO/GRO are Linux only.
+#if defined(UDP_GRO)
+    initConstant(env, c, "UDP_GRO", UDP_GRO);
+#endif
+#if defined(UDP_SEGMENT)
+    initConstant(env, c, "UDP_SEGMENT", UDP_SEGMENT);
+#endif
     initConstant(env, c, "WCONTINUED", WCONTINUED);
     initConstant(env, c, "WEXITED", WEXITED);
     initConstant(env, c, "WNOHANG", WNOHANG);
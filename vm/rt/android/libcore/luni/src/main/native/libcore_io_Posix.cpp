@@ -58,6 +58,10 @@
 #if defined(__APPLE__)
 // RoboVM note: For SOL_LOCAL, LOCAL_PEERPID on Darwin.
   #include <sys/un.h>
+#else
+// RoboVM note: Darwin doesn't have epoll or eventfd.
+  #include <sys/epoll.h>
+  #include <sys/eventfd.h>
 #endif
 
 #define TO_JAVA_STRING(NAME, EXP) \
@@ -405,13 +409,24 @@ private:
     struct passwd* mResult;
 };
 
-extern "C" jobject Java_libcore_io_Posix_accept(JNIEnv* env, jobject, jobject javaFd, jobject javaInetSocketAddress) {
+#if defined(__APPLE__)
+// RoboVM note: Darwin doesn't have accept4(), SOCK_NONBLOCK or SOCK_CLOEXEC. Those constants are 0 in Java so the
+// flags are always 0 there and doAccept() calls accept() instead.
+static int accept4(int, sockaddr*, socklen_t*, int) {
+    errno = ENOSYS;
+    return -1;
+}
+#endif
+
+static jobject doAccept(JNIEnv* env, jobject javaFd, jobject javaInetSocketAddress, jint flags) {
     sockaddr_storage ss;
     socklen_t sl = sizeof(ss);
     memset(&ss, 0, sizeof(ss));
     sockaddr* peer = (javaInetSocketAddress != NULL) ? reinterpret_cast<sockaddr*>(&ss) : NULL;
     socklen_t* peerLength = (javaInetSocketAddress != NULL) ? &sl : 0;
-    jint clientFd = NET_FAILURE_RETRY(env, int, accept, javaFd, peer, peerLength);
+    jint clientFd = (flags == 0)
+            ? NET_FAILURE_RETRY(env, int, accept, javaFd, peer, peerLength)
+            : NET_FAILURE_RETRY(env, int, accept4, javaFd, peer, peerLength, flags);
     if (clientFd == -1 || !fillInetSocketAddress(env, clientFd, javaInetSocketAddress, ss)) {
         close(clientFd);
         return NULL;
@@ -419,6 +434,14 @@ extern "C" jobject Java_libcore_io_Posix_accept(JNIEnv* env, jobject, jobject ja
     return (clientFd != -1) ? jniCreateFileDescriptor(env, clientFd) : NULL;
 }
 
+extern "C" jobject Java_libcore_io_Posix_accept(JNIEnv* env, jobject, jobject javaFd, jobject javaInetSocketAddress) {
+    return doAccept(env, javaFd, javaInetSocketAddress, 0);
+}
+
+extern "C" jobject Java_libcore_io_Posix_accept4(JNIEnv* env, jobject, jobject javaFd, jobject javaInetSocketAddress, jint flags) {
+    return doAccept(env, javaFd, javaInetSocketAddress, flags);
+}
+
 extern "C" jboolean Java_libcore_io_Posix_access(JNIEnv* env, jobject, jstring javaPath, jint mode) {
     ScopedUtfChars path(env, javaPath);
     if (path.c_str() == NULL) {
@@ -498,6 +521,48 @@ extern "C" void Java_libcore_io_Posix_connect(JNIEnv* env, jobject, jobject java
 #endif
 }
 
+// RoboVM note: splice() and copy_file_range() are Linux only. They fail with ENOSYS elsewhere (and copy_file_range()
+// also on Linux kernels older than 4.5) so that callers can fall back to read()/write().
+#if !defined(__APPLE__)
+// Reads the offset in the MutableLong javaOffset into offset and returns a pointer to it, or NULL if javaOffset is NULL.
+static loff_t* getMutableLongOffset(JNIEnv* env, jobject javaOffset, loff_t& offset) {
+    if (javaOffset == NULL) {
+        return NULL;
+    }
+    static jfieldID valueFid = env->GetFieldID(JniConstants::mutableLongClass, "value", "J");
+    offset = env->GetLongField(javaOffset, valueFid);
+    return &offset;
+}
+
+static void setMutableLongOffset(JNIEnv* env, jobject javaOffset, loff_t offset) {
+    if (javaOffset != NULL) {
+        static jfieldID valueFid = env->GetFieldID(JniConstants::mutableLongClass, "value", "J");
+        env->SetLongField(javaOffset, valueFid, offset);
+    }
+}
+#endif
+
+extern "C" jlong Java_libcore_io_Posix_copy_1file_1range(JNIEnv* env, jobject, jobject javaInFd, jobject javaInOffset, jobject javaOutFd, jobject javaOutOffset, jlong byteCount, jint flags) {
+#if !defined(__APPLE__) && defined(__NR_copy_file_range)
+    int inFd = jniGetFDFromFileDescriptor(env, javaInFd);
+    int outFd = jniGetFDFromFileDescriptor(env, javaOutFd);
+    loff_t inOffset = 0;
+    loff_t outOffset = 0;
+    loff_t* inOffsetPtr = getMutableLongOffset(env, javaInOffset, inOffset);
+    loff_t* outOffsetPtr = getMutableLongOffset(env, javaOutOffset, outOffset);
+    // Called through syscall() since older C libraries don't have a wrapper.
+    jlong result = throwIfMinusOne(env, "copy_file_range", TEMP_FAILURE_RETRY(syscall(__NR_copy_file_range,
+            inFd, inOffsetPtr, outFd, outOffsetPtr, (size_t) byteCount, (unsigned int) flags)));
+    setMutableLongOffset(env, javaInOffset, inOffset);
+    setMutableLongOffset(env, javaOutOffset, outOffset);
+    return result;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "copy_file_range");
+    return -1;
+#endif
+}
+
 extern "C" jobject Java_libcore_io_Posix_dup(JNIEnv* env, jobject, jobject javaOldFd) {
     int oldFd = jniGetFDFromFileDescriptor(env, javaOldFd);
     int newFd = throwIfMinusOne(env, "dup", TEMP_FAILURE_RETRY(dup(oldFd)));
@@ -515,6 +580,96 @@ extern "C" jobjectArray Java_libcore_io_Posix_environ(JNIEnv* env, jobject) {
     return toStringArray(env, environ);
 }
 
+// RoboVM note: Darwin doesn't have epoll. The epoll functions fail with ENOSYS
+// there so that callers can fall back to poll().
+extern "C" jobject Java_libcore_io_Posix_epoll_1create1(JNIEnv* env, jobject, jint flags) {
+#if !defined(__APPLE__)
+    int fd = throwIfMinusOne(env, "epoll_create1", epoll_create1(flags));
+    return (fd != -1) ? jniCreateFileDescriptor(env, fd) : NULL;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "epoll_create1");
+    return NULL;
+#endif
+}
+
+extern "C" void Java_libcore_io_Posix_epoll_1ctl(JNIEnv* env, jobject, jobject javaEpfd, jint op, jobject javaFd, jint events) {
+#if !defined(__APPLE__)
+    int epfd = jniGetFDFromFileDescriptor(env, javaEpfd);
+    int fd = jniGetFDFromFileDescriptor(env, javaFd);
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.fd = fd;
+    throwIfMinusOne(env, "epoll_ctl", epoll_ctl(epfd, op, fd, &event));
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "epoll_ctl");
+#endif
+}
+
+#if !defined(__APPLE__)
+// The number of epoll_events epoll_wait() can return without allocating.
+#define EPOLL_WAIT_STACK_EVENTS 64
+#endif
+
+extern "C" jint Java_libcore_io_Posix_epoll_1wait(JNIEnv* env, jobject, jobject javaEpfd, jintArray javaFds, jintArray javaEvents, jint timeoutMs) {
+#if !defined(__APPLE__)
+    int epfd = jniGetFDFromFileDescriptor(env, javaEpfd);
+    jsize maxEvents = env->GetArrayLength(javaFds);
+    if (env->GetArrayLength(javaEvents) < maxEvents) {
+        maxEvents = env->GetArrayLength(javaEvents);
+    }
+    if (maxEvents <= 0) {
+        jniThrowException(env, "java/lang/IllegalArgumentException", "maxEvents <= 0");
+        return -1;
+    }
+
+    epoll_event stackEvents[EPOLL_WAIT_STACK_EVENTS];
+    UniquePtr<epoll_event[]> heapEvents;
+    epoll_event* events = stackEvents;
+    if (maxEvents > EPOLL_WAIT_STACK_EVENTS) {
+        heapEvents.reset(new epoll_event[maxEvents]);
+        events = heapEvents.get();
+    }
+
+    int rc = epoll_wait(epfd, events, maxEvents, timeoutMs);
+    if (rc == -1) {
+        throwErrnoException(env, "epoll_wait");
+        return -1;
+    }
+
+    // Unlike poll() only the ready fds are copied back to Java.
+    if (rc > 0) {
+        jint* fds = (jint*) env->GetPrimitiveArrayCritical(javaFds, NULL);
+        jint* revents = (jint*) env->GetPrimitiveArrayCritical(javaEvents, NULL);
+        for (int i = 0; i < rc; ++i) {
+            fds[i] = events[i].data.fd;
+            revents[i] = events[i].events;
+        }
+        env->ReleasePrimitiveArrayCritical(javaEvents, revents, 0);
+        env->ReleasePrimitiveArrayCritical(javaFds, fds, 0);
+    }
+    return rc;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "epoll_wait");
+    return -1;
+#endif
+}
+
+// RoboVM note: Darwin doesn't have eventfd. Fails with ENOSYS there.
+extern "C" jobject Java_libcore_io_Posix_eventfd(JNIEnv* env, jobject, jint initval, jint flags) {
+#if !defined(__APPLE__)
+    int fd = throwIfMinusOne(env, "eventfd", eventfd(initval, flags));
+    return (fd != -1) ? jniCreateFileDescriptor(env, fd) : NULL;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "eventfd");
+    return NULL;
+#endif
+}
+
 extern "C" void Java_libcore_io_Posix_execve(JNIEnv* env, jobject, jstring javaFilename, jobjectArray javaArgv, jobjectArray javaEnvp) {
     ScopedUtfChars path(env, javaFilename);
     if (path.c_str() == NULL) {
@@ -1155,6 +1310,68 @@ extern "C" jint Java_libcore_io_Posix_recvfromBytes(JNIEnv* env, jobject, jobjec
     return recvCount;
 }
 
+// RoboVM note: Darwin doesn't have recvmmsg()/sendmmsg(). They fail with ENOSYS there so that callers can
+// fall back to recvfrom()/sendto().
+#if !defined(__APPLE__)
+// Points the message headers at the buffers in ioVec, one buffer per message.
+template <typename ScopedT>
+static void initMmsghdrs(std::vector<mmsghdr>& msgs, IoVec<ScopedT>& ioVec) {
+    memset(&msgs[0], 0, msgs.size() * sizeof(mmsghdr));
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        msgs[i].msg_hdr.msg_iov = ioVec.get() + i;
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+#endif
+
+extern "C" jint Java_libcore_io_Posix_recvmmsgBytes(JNIEnv* env, jobject, jobject javaFd, jobjectArray javaBuffers, jintArray javaOffsets, jintArray javaByteCounts, jobjectArray javaSrcAddresses, jint flags) {
+#if !defined(__APPLE__)
+    size_t count = env->GetArrayLength(javaBuffers);
+    if (count == 0) {
+        return 0;
+    }
+    IoVec<ScopedBytesRW> ioVec(env, count);
+    if (!ioVec.init(javaBuffers, javaOffsets, javaByteCounts)) {
+        return -1;
+    }
+    std::vector<mmsghdr> msgs(count);
+    initMmsghdrs(msgs, ioVec);
+    std::vector<sockaddr_storage> addresses;
+    if (javaSrcAddresses != NULL) {
+        addresses.resize(count);
+        memset(&addresses[0], 0, count * sizeof(sockaddr_storage));
+        for (size_t i = 0; i < count; ++i) {
+            msgs[i].msg_hdr.msg_name = &addresses[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        }
+    }
+
+    jint rc = NET_FAILURE_RETRY(env, int, recvmmsg, javaFd, &msgs[0], count, flags, NULL);
+    if (rc <= 0) {
+        return rc;
+    }
+
+    ScopedIntArrayRW byteCounts(env, javaByteCounts);
+    if (byteCounts.get() == NULL) {
+        return -1;
+    }
+    for (jint i = 0; i < rc; ++i) {
+        byteCounts[i] = msgs[i].msg_len;
+        if (javaSrcAddresses != NULL) {
+            ScopedLocalRef<jobject> srcAddress(env, env->GetObjectArrayElement(javaSrcAddresses, i));
+            if (!fillInetSocketAddress(env, rc, srcAddress.get(), addresses[i])) {
+                return -1;
+            }
+        }
+    }
+    return rc;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "recvmmsg");
+    return -1;
+#endif
+}
+
 extern "C" void Java_libcore_io_Posix_remove(JNIEnv* env, jobject, jstring javaPath) {
     ScopedUtfChars path(env, javaPath);
     if (path.c_str() == NULL) {
@@ -1193,6 +1410,59 @@ extern "C" jlong Java_libcore_io_Posix_sendfile(JNIEnv* env, jobject, jobject ja
     return result;
 }
 
+extern "C" jint Java_libcore_io_Posix_sendmmsgBytes(JNIEnv* env, jobject, jobject javaFd, jobjectArray javaBuffers, jintArray javaOffsets, jintArray javaByteCounts, jobjectArray javaDstAddresses, jint flags) {
+#if !defined(__APPLE__)
+    size_t count = env->GetArrayLength(javaBuffers);
+    if (count == 0) {
+        return 0;
+    }
+    IoVec<ScopedBytesRO> ioVec(env, count);
+    if (!ioVec.init(javaBuffers, javaOffsets, javaByteCounts)) {
+        return -1;
+    }
+    std::vector<mmsghdr> msgs(count);
+    initMmsghdrs(msgs, ioVec);
+    std::vector<sockaddr_storage> addresses;
+    if (javaDstAddresses != NULL) {
+        static jfieldID addressFid = env->GetFieldID(JniConstants::inetSocketAddressClass, "addr", "Ljava/net/InetAddress;");
+        static jfieldID portFid = env->GetFieldID(JniConstants::inetSocketAddressClass, "port", "I");
+        addresses.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            ScopedLocalRef<jobject> dstAddress(env, env->GetObjectArrayElement(javaDstAddresses, i));
+            if (dstAddress.get() == NULL) {
+                continue; // Connected socket.
+            }
+            ScopedLocalRef<jobject> inetAddress(env, env->GetObjectField(dstAddress.get(), addressFid));
+            jint port = env->GetIntField(dstAddress.get(), portFid);
+            socklen_t sa_len = 0;
+            if (!inetAddressToSockaddr(env, inetAddress.get(), port, addresses[i], sa_len)) {
+                return -1;
+            }
+            msgs[i].msg_hdr.msg_name = &addresses[i];
+            msgs[i].msg_hdr.msg_namelen = sa_len;
+        }
+    }
+
+    jint rc = NET_FAILURE_RETRY(env, int, sendmmsg, javaFd, &msgs[0], count, flags);
+    if (rc <= 0) {
+        return rc;
+    }
+
+    ScopedIntArrayRW byteCounts(env, javaByteCounts);
+    if (byteCounts.get() == NULL) {
+        return -1;
+    }
+    for (jint i = 0; i < rc; ++i) {
+        byteCounts[i] = msgs[i].msg_len;
+    }
+    return rc;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "sendmmsg");
+    return -1;
+#endif
+}
+
 extern "C" jint Java_libcore_io_Posix_sendtoBytes(JNIEnv* env, jobject, jobject javaFd, jobject javaBytes, jint byteOffset, jint byteCount, jint flags, jobject javaInetAddress, jint port) {
     ScopedBytesRO bytes(env, javaBytes);
     if (bytes.get() == NULL) {
@@ -1439,6 +1709,25 @@ extern "C" void Java_libcore_io_Posix_socketpair(JNIEnv* env, jobject, jint doma
     }
 }
 
+extern "C" jlong Java_libcore_io_Posix_splice(JNIEnv* env, jobject, jobject javaInFd, jobject javaInOffset, jobject javaOutFd, jobject javaOutOffset, jlong byteCount, jint flags) {
+#if !defined(__APPLE__)
+    int inFd = jniGetFDFromFileDescriptor(env, javaInFd);
+    int outFd = jniGetFDFromFileDescriptor(env, javaOutFd);
+    loff_t inOffset = 0;
+    loff_t outOffset = 0;
+    loff_t* inOffsetPtr = getMutableLongOffset(env, javaInOffset, inOffset);
+    loff_t* outOffsetPtr = getMutableLongOffset(env, javaOutOffset, outOffset);
+    jlong result = throwIfMinusOne(env, "splice", TEMP_FAILURE_RETRY(splice(inFd, inOffsetPtr, outFd, outOffsetPtr, byteCount, flags)));
+    setMutableLongOffset(env, javaInOffset, inOffset);
+    setMutableLongOffset(env, javaOutOffset, outOffset);
+    return result;
+#else
+    errno = ENOSYS;
+    throwErrnoException(env, "splice");
+    return -1;
+#endif
+}
+
 extern "C" jobject Java_libcore_io_Posix_stat(JNIEnv* env, jobject, jstring javaPath) {
     return doStat(env, javaPath, false);
 }
@@ -447,3 +447,21 @@ ObjectArray* Java_org_robovm_rt_VM_listClasses0(Env* env, Class* c, Class* insta
 void Java_org_robovm_rt_VM_generateHeapDump(Env* env, Class* c) {
     rvmGenerateHeapDump(env);
 }
+
+jlong Java_org_robovm_rt_VM_getAllocatedBytes(Env* env, Class* c) {
+    return rvmGetAllocatedBytes(env);
+}
+
+jboolean Java_org_robovm_rt_VM_dumpProfile(Env* env, Class* c, Object* path) {
+    if (!path) {
+        rvmThrowNullPointerException(env);
+        return FALSE;
+    }
+    char* s = rvmGetStringUTFChars(env, path);
+    if (!s) return FALSE;
+    return rvmDumpProfile(env, s);
+}
+
+void Java_org_robovm_rt_VM_resetProfile(Env* env, Class* c) {
+    rvmResetProfile(env);
+}